@@ -47,7 +47,7 @@ public:
 			{
 				++c_reads_mapped;
 				int sum_m = 0;
-				for (CigarOp& op : al.cigarData())
+				for (const CigarOp op : al.cigarView())
 				{
 					if (op.Type==BAM_CMATCH) sum_m += op.Length;
 				}
@@ -25,7 +25,9 @@ public:
 		//optional
 		addFlag("test", "Test mode: fix random number generator seed and write kept read names to STDOUT.");
 		addInfile("ref", "Reference genome for CRAM support (mandatory if CRAM is used).", true);
+		addInt("threads", "The number of threads used for BAM/CRAM compression and decompression.", true, 1);
 
+		changeLog(2026, 10, 17, "Added 'threads' parameter for multi-threaded BAM/CRAM compression/decompression.");
 		changeLog(2020,  11, 27, "Added CRAM support.");
 	}
 
@@ -38,6 +40,7 @@ public:
 		double percentage = getFloat("percentage");
 		if (percentage<=0 || percentage>=100) THROW(CommandLineParsingException, "Invalid percentage " + QString::number(percentage) +"!");
 
+		HtsThreadPool::setThreads(getInt("threads"));
 		BamReader reader(getInfile("in"), getInfile("ref"));
 
 		BamWriter writer(getOutfile("out"), getInfile("ref"));
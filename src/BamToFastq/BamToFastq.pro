@@ -16,9 +16,11 @@ TEMPLATE = app
 
 
 SOURCES += main.cpp \
-    OutputWorker.cpp
+    OutputWorker.cpp \
+    MateCache.cpp
 
 include("../app_cli.pri")
 
 HEADERS += \
-    OutputWorker.h
+    OutputWorker.h \
+    MateCache.h
@@ -0,0 +1,141 @@
+#include "MateCache.h"
+#include "Exceptions.h"
+#include <algorithm>
+
+static ExternalSortSettings mateCacheSortSettings(bool compress_tmp)
+{
+	ExternalSortSettings settings;
+	settings.compress_runs = compress_tmp;
+	return settings;
+}
+
+MateCache::MateCache(qint64 max_bytes, bool compress_tmp)
+	: max_bytes_(max_bytes)
+	, compress_tmp_(compress_tmp)
+	, bytes_(0)
+	, max_bytes_used_(0)
+	, max_count_(0)
+	, spilled_reads_(0)
+	, runs_(mateCacheSortSettings(compress_tmp))
+{
+	if (max_bytes_<0) THROW(ArgumentException, "Invalid memory budget '" + QString::number(max_bytes_) + "' for mate cache!");
+}
+
+bool MateCache::take(const QByteArray& name, Read& read)
+{
+	auto it = cache_.find(name);
+	if (it==cache_.end()) return false;
+
+	read = it.value();
+	bytes_ -= estimatedBytes(name, read);
+	cache_.erase(it);
+	return true;
+}
+
+void MateCache::add(const QByteArray& name, const Read& read)
+{
+	cache_.insert(name, read);
+	bytes_ += estimatedBytes(name, read);
+
+	max_count_ = std::max(max_count_, cache_.count());
+	max_bytes_used_ = std::max(max_bytes_used_, bytes_);
+
+	if (max_bytes_>0 && bytes_>max_bytes_) spill();
+}
+
+qint64 MateCache::estimatedBytes(const QByteArray& name, const Read& read)
+{
+	//string data plus overhead of hash node and QByteArray headers
+	return name.size() + read.bases.size() + read.qualities.size() + 100;
+}
+
+void MateCache::spill()
+{
+	//sort reads by name
+	QList<QByteArray> names = cache_.keys();
+	std::sort(names.begin(), names.end());
+
+	//write reads: name, read 1 flag, bases, qualities
+	ExternalSortRuns::Writer writer(runs_.addRun(), compress_tmp_);
+	QByteArray buffer;
+	foreach(const QByteArray& name, names)
+	{
+		const Read& read = cache_[name];
+		buffer.append(name);
+		buffer.append('\t');
+		buffer.append(read.is_read1 ? '1' : '2');
+		buffer.append('\t');
+		buffer.append(read.bases);
+		buffer.append('\t');
+		buffer.append(read.qualities);
+		buffer.append('\n');
+		if (buffer.size()>1048576)
+		{
+			writer.write(buffer);
+			buffer.clear();
+		}
+	}
+	writer.write(buffer);
+	writer.close();
+
+	spilled_reads_ += cache_.count();
+	cache_.clear();
+	bytes_ = 0;
+}
+
+qint64 MateCache::finalize(std::function<void(const QByteArray& name, const Read& read1, const Read& read2)> output)
+{
+	//no reads were written to disk: remaining reads are unmatched
+	if (runs_.count()==0) return cache_.count();
+
+	//write remaining reads and merge temporary files
+	spill();
+
+	qint64 unmatched = 0;
+	bool has_previous = false;
+	QByteArray previous_name;
+	Read previous;
+	auto parse = [](const QByteArray& line, QByteArray& name, Read& read)
+	{
+		int tab1 = line.indexOf('\t');
+		int tab2 = tab1==-1 ? -1 : line.indexOf('\t', tab1+1);
+		int tab3 = tab2==-1 ? -1 : line.indexOf('\t', tab2+1);
+		if (tab3==-1) THROW(FileParseException, "Invalid line in temporary mate cache file: " + line);
+
+		name = line.left(tab1);
+		read.is_read1 = line[tab1+1]=='1';
+		read.bases = line.mid(tab2+1, tab3-tab2-1);
+		read.qualities = line.mid(tab3+1);
+	};
+	runs_.merge<QByteArray>([](const QByteArray& line, QByteArray& key)
+	{
+		int tab = line.indexOf('\t');
+		key = tab==-1 ? line : line.left(tab);
+	},
+	[](const QByteArray& a, const QByteArray& b)
+	{
+		return a<b;
+	},
+	[&](const QByteArray& line)
+	{
+		QByteArray name;
+		Read read;
+		parse(line, name, read);
+
+		if (has_previous && previous_name==name)
+		{
+			output(name, previous, read);
+			has_previous = false;
+		}
+		else
+		{
+			if (has_previous) ++unmatched;
+			previous_name = name;
+			previous = read;
+			has_previous = true;
+		}
+	});
+	if (has_previous) ++unmatched;
+
+	return unmatched;
+}
@@ -0,0 +1,73 @@
+#ifndef MATECACHE_H
+#define MATECACHE_H
+
+#include "ExternalSort.h"
+#include "Sequence.h"
+#include <QHash>
+#include <QByteArray>
+#include <functional>
+
+///Cache for paired reads whose mate was not read yet.
+///If the memory budget is exceeded, the cached reads are sorted by name and written to a temporary file. The temporary files are merged at the end to find the remaining pairs.
+class MateCache
+{
+public:
+	///Cached read (bases and qualities are already in read orientation).
+	struct Read
+	{
+		bool is_read1 = false;
+		Sequence bases;
+		QByteArray qualities;
+	};
+
+	///Constructor. If @p max_bytes is 0, the memory usage is not limited.
+	MateCache(qint64 max_bytes, bool compress_tmp);
+
+	///Removes the read with the given name from the cache. Returns false if it is not in memory.
+	bool take(const QByteArray& name, Read& read);
+	///Adds a read to the cache. Writes the cache to a temporary file if the memory budget is exceeded.
+	void add(const QByteArray& name, const Read& read);
+	///Finds pairs of reads that were written to temporary files or are still cached (the mate read last is @p read2). Returns the number of unmatched reads.
+	qint64 finalize(std::function<void(const QByteArray& name, const Read& read1, const Read& read2)> output);
+
+	///Returns the number of cached reads.
+	int count() const
+	{
+		return cache_.count();
+	}
+	///Returns the maximum number of cached reads.
+	int maxCount() const
+	{
+		return max_count_;
+	}
+	///Returns the maximum estimated memory usage of cached reads in bytes.
+	qint64 maxBytes() const
+	{
+		return max_bytes_used_;
+	}
+	///Returns the number of reads written to temporary files.
+	qint64 spilledReads() const
+	{
+		return spilled_reads_;
+	}
+	///Returns the number of temporary files.
+	int spillFiles() const
+	{
+		return runs_.count();
+	}
+
+protected:
+	QHash<QByteArray, Read> cache_;
+	qint64 max_bytes_;
+	bool compress_tmp_;
+	qint64 bytes_;
+	qint64 max_bytes_used_;
+	int max_count_;
+	qint64 spilled_reads_;
+	ExternalSortRuns runs_;
+
+	static qint64 estimatedBytes(const QByteArray& name, const Read& read);
+	void spill();
+};
+
+#endif // MATECACHE_H
@@ -4,6 +4,7 @@
 #include "Helper.h"
 #include <QThreadPool>
 #include "OutputWorker.h"
+#include "MateCache.h"
 
 class ConcreteTool
 		: public ToolBase
@@ -30,7 +31,12 @@ public:
 		addInt("compression_level", "Output FASTQ compression level from 1 (fastest) to 9 (best compression).", true, 1);
 		addInt("write_buffer_size", "Output write buffer size (number of FASTQ entry pairs).", true, 100);
 		addInfile("ref", "Reference genome for CRAM support (mandatory if CRAM is used).", true);
+		addInt("threads", "The number of threads used for BAM/CRAM compression and decompression.", true, 1);
+		addFloat("max_cache", "Memory budget for reads whose mate was not read yet (in MB). If exceeded, cached reads are written to temporary files and paired at the end. 0 means no limit.", true, 0.0);
+		addFlag("compress_tmp", "Compress temporary files of the read cache (see 'max_cache').");
 
+		changeLog(2026, 10, 17, "Added 'max_cache' and 'compress_tmp' parameters to limit the memory usage of the mate cache.");
+		changeLog(2026, 10, 17, "Added 'threads' parameter for multi-threaded BAM/CRAM compression/decompression.");
 		changeLog(2020, 11, 27, "Added CRAM support.");
 		changeLog(2020,  5, 29, "Massive speed-up by writing in background. Added 'compression_level' parameter.");
 		changeLog(2020,  3, 21, "Added 'reg' parameter.");
@@ -51,12 +57,34 @@ public:
 		}
 	}
 
+	static void alignmentToCache(const QSharedPointer<BamAlignment>& al, MateCache::Read& read)
+	{
+		read.is_read1 = al->isRead1();
+		read.bases = al->bases();
+		read.qualities = al->qualities();
+
+		if (al->isReverseStrand())
+		{
+			read.bases.reverseComplement();
+			std::reverse(read.qualities.begin(), read.qualities.end());
+		}
+	}
+
+	static void cachedReadToFastq(const QByteArray& name, const MateCache::Read& read, FastqEntry& e)
+	{
+		e.header = "@" + name;
+		e.bases = read.bases;
+		e.header2 = "+";
+		e.qualities = read.qualities;
+	}
+
 	virtual void main()
 	{
 		//init
 		QTime timer;
 		timer.start();
 		QTextStream out(stdout);
+		HtsThreadPool::setThreads(getInt("threads"));
 		BamReader reader(getInfile("in"), getInfile("ref"));
 
 		QString out1 = getOutfile("out1");
@@ -80,12 +108,8 @@ public:
 		int write_buffer_size = getInt("write_buffer_size");
 
 		int compression_level = getInt("compression_level");
-
-
-
-
-
-
+		double max_cache = getFloat("max_cache");
+		if (max_cache<0) THROW(CommandLineParsingException, "Parameter 'max_cache' must not be negative!");
 		//create background FASTQ writer
 		ReadPairPool pair_pool(write_buffer_size);
 		QThreadPool analysis_pool;
@@ -109,10 +133,11 @@ public:
 		long long c_paired = 0;
 		long long c_duplicates = 0;
 		long long c_single_end = 0;
-		int max_cached = 0;
+		long long c_unmatched = 0;
 
 		//iterate through reads
-		QHash<QByteArray, QSharedPointer<BamAlignment>> al_cache;
+		MateCache mate_cache((qint64)(1048576.0 * max_cache), getFlag("compress_tmp"));
+		MateCache::Read mate;
 		QSharedPointer<BamAlignment> al = QSharedPointer<BamAlignment>(new BamAlignment());
 		while (true)
 		{
@@ -141,20 +166,17 @@ public:
 
 				//store cached read when we encounter the mate
 				QByteArray name = al->name();
-				if (al_cache.contains(name))
+				if (mate_cache.take(name, mate))
 				{
-					QSharedPointer<BamAlignment> mate = al_cache.take(name);
-					//out << name << " [AL] First: " << al.isRead1() << " Reverse: " << al.isReverseStrand() << " Seq: " << al.QueryBases.data() << endl;
-					//out << name << " [MA] First: " << mate.isRead1() << " Reverse: " << mate.isReverseStrand() << " Seq: " << mate.QueryBases.data() << endl;
 					ReadPair& pair = pair_pool.nextFreePair();
 					if (al->isRead1())
 					{
 						alignmentToFastq(al, pair.e1);
-						alignmentToFastq(mate, pair.e2);
+						cachedReadToFastq(name, mate, pair.e2);
 					}
 					else
 					{
-						alignmentToFastq(mate, pair.e1);
+						cachedReadToFastq(name, mate, pair.e1);
 						alignmentToFastq(al, pair.e2);
 					}
 					pair.status = ReadPair::TO_BE_WRITTEN;
@@ -163,11 +185,10 @@ public:
 				//cache read for later retrieval
 				else
 				{
-					al_cache.insert(name, al);
-					al = QSharedPointer<BamAlignment>(new BamAlignment());
+					MateCache::Read read;
+					alignmentToCache(al, read);
+					mate_cache.add(name, read);
 				}
-
-				max_cached = std::max(max_cached, al_cache.size());
 			}
 			else if (mode == "single-end")
 			{
@@ -182,12 +203,25 @@ public:
 			}
 		}
 
+		//pair reads that were written to temporary files
+		if(mode == "paired-end")
+		{
+			c_unmatched = mate_cache.finalize([&](const QByteArray& name, const MateCache::Read& read1, const MateCache::Read& read2)
+			{
+				ReadPair& pair = pair_pool.nextFreePair();
+				cachedReadToFastq(name, read2.is_read1 ? read2 : read1, pair.e1);
+				cachedReadToFastq(name, read2.is_read1 ? read1 : read2, pair.e2);
+				pair.status = ReadPair::TO_BE_WRITTEN;
+				++c_paired;
+			});
+		}
+
 		//write debug output
 		if(mode == "paired-end")
 		{
 			out << "Pair reads (written)            : " << c_paired << endl;
 			out << "Unpaired reads (skipped)        : " << c_unpaired << endl;
-			out << "Unmatched paired reads (skipped): " << al_cache.size() << endl;
+			out << "Unmatched paired reads (skipped): " << c_unmatched << endl;
 		}
 		else //single-end
 		{
@@ -199,7 +233,9 @@ public:
 			out << "Duplicate reads (skipped)       : " << c_duplicates << endl;
 		}
 		out << endl;
-		out << "Maximum cached reads            : " << max_cached << endl;
+		out << "Maximum cached reads            : " << mate_cache.maxCount() << endl;
+		out << "Maximum cache size (MB)         : " << QString::number(mate_cache.maxBytes() / 1048576.0, 'f', 2) << endl;
+		out << "Reads written to temporary files: " << mate_cache.spilledReads() << " (" << mate_cache.spillFiles() << " files)" << endl;
 		out << "Time elapsed                    : " << Helper::elapsedTime(timer, true) << endl;
 
 		//terminate FASTQ writer after all reads are written
@@ -29,7 +29,9 @@ public:
 		addInfile("ref", "Reference genome for CRAM support (mandatory if CRAM is used).", true);
 		addInt("min_mapq", "Minimum mapping quality.", true, 1);
 		addInt("min_baseq", "Minimum base quality.", true, 25);
+		addInt("threads", "Number of threads used to process chromosomes in parallel.", true, 1);
 
+		changeLog(2026,  10, 17, "Base counts are now extracted with one sorted pass over each chromosome. Added 'threads' parameter.");
 		changeLog(2020,  11, 27, "Added CRAM support.");
 	}
 
@@ -39,6 +41,7 @@ public:
 		QStringList bams = getInfileList("bam");
 		int min_mapq = getInt("min_mapq");
 		int min_baseq = getInt("min_baseq");
+		int threads = getInt("threads");
 
 		//open output stream
 		QString out = getOutfile("out");
@@ -54,19 +57,33 @@ public:
 			bams_open.append(QSharedPointer<BamReader>(new BamReader(bam, ref_string)));
 		}
 
-		//extract base counts from BAMs
+		//determine positions
 		BedFile file;
 		file.load(getInfile("in"));
+		QVector<PileupPosition> positions;
+		positions.reserve(file.count());
 		for(int i=0; i<file.count(); ++i)
 		{
 			if(file[i].length()!=1)
 			{
 				THROW(ToolFailedException, "BED file contains region with length > 1, which is not supported: " + file[i].toString(true));
 			}
+			positions << PileupPosition{file[i].chr(), file[i].end()};
+		}
+
+		//extract base counts from BAMs
+		QVector<QVector<Pileup>> pileups;
+		for(int j=0; j<bams.count(); ++j)
+		{
+			pileups << bams_open[j]->getPileups(positions, -1, min_mapq, false, min_baseq, threads);
+		}
 
+		//write output
+		for(int i=0; i<file.count(); ++i)
+		{
 			for(int j=0; j<bams.count(); ++j)
 			{
-				Pileup pileup = bams_open[j]->getPileup(file[i].chr(), file[i].end(), -1, min_mapq, false, min_baseq);
+				const Pileup& pileup = pileups[j][i];
 				outstream << file[i].toString(false)+"\t"+QFileInfo(bams[j]).baseName()+"\t"+QString::number(pileup.a())+"\t"+QString::number(pileup.c())+"\t"+QString::number(pileup.g())+"\t"+QString::number(pileup.t())+"\t"+QString::number(pileup.depth(false)) + "\n";
 			}
 		}
@@ -27,7 +27,10 @@ public:
 		addInt("max_deletion", "Allowed percentage of deleted/unmapped bases in each region.", true, 5);
 		addInt("max_increase", "Allowed percentage size increase of a region.", true, 10);
 		addFlag("remove_special_chr", "Removes regions that are mapped to special chromosomes.");
+		addInt("threads", "The number of threads used for lifting.", true, 1);
+		addFlag("cache", "Use a binary cache file of the parsed chain file to speed up loading. The cache file is created next to the chain file if it is missing or outdated.");
 
+		changeLog(2026, 10, 17, "Added parameters 'threads' and 'cache'.");
 		changeLog(2022,  02, 14, "First implementation");
 	}
 
@@ -40,6 +43,7 @@ public:
 		int max_inc = getInt("max_increase");
 		int max_del = getInt("max_deletion");
 		bool remove_special_chr = getFlag("remove_special_chr");
+		int threads = getInt("threads");
 
 
 		if (! QFile(chain).exists() && ! chain.contains('\\') && ! chain.contains('/'))
@@ -57,7 +61,7 @@ public:
 			THROW(ArgumentException, "Allowed maximum size increase of the region can't be negative");
 		}
 
-		ChainFileReader reader(chain, (max_del/100.0));
+		ChainFileReader reader(chain, (max_del/100.0), getFlag("cache"));
 
 		//open output
 		QString lifted_path = getOutfile("out");
@@ -84,13 +88,83 @@ public:
 		QString header_line = "#BedLiftOver: Lifted file '" + in + "' from " + from_to[0] + " to " + from_to[1] + "\n";
 		lifted->write(header_line.toUtf8());
 
+		//regions are lifted in batches to limit the memory usage (header lines are written before the region they precede)
+		const int batch_size = 100000;
+		QList<BedLine> regions;
+		QList<QPair<int, QByteArray>> headers;
+		BedFile regions_to_lift;
+		auto liftBatch = [&]()
+		{
+			//lift regions
+			QVector<ChainFileReader::LiftResult> results = reader.liftMany(regions_to_lift, threads);
+
+			//write output
+			int h = 0;
+			for (int r=0; r<regions.count(); ++r)
+			{
+				while (h<headers.count() && headers[h].first==r)
+				{
+					lifted->write(headers[h].second);
+					++h;
+				}
+
+				const BedLine& l = regions[r];
+				in_count++;
+				in_length += l.length();
+
+				QString error = results[r].error;
+				BedLine lifted_line = results[r].region;
+				if (error.isEmpty())
+				{
+					//convert back to 0-based for bed file.
+					lifted_line.setStart(lifted_line.start()-1);
+
+					if (lifted_line.length() > l.length()+l.length()*(max_inc/100.0))
+					{
+						error = "Region increased in size more than " + QString::number(max_inc) + "%.";
+					}
+					else if (! lifted_line.chr().isNonSpecial() && remove_special_chr)
+					{
+						error = "Region was mapped to a special chromosome.";
+					}
+				}
+
+				if (error.isEmpty())
+				{
+					lifted_line.annotations() = l.annotations();
+					lifted->write(lifted_line.toStringWithAnnotations().toUtf8() + "\n");
+					lifted_count++;
+					lifted_length += lifted_line.length();
+				}
+				else
+				{
+					unlifted_count++;
+					unlifted_in_length += l.length();
+
+					if (! unmapped.isNull())
+					{
+						unmapped->write("# " + error.toUtf8() + "\n");
+						unmapped->write(l.toString(false).toUtf8() + "\n");
+					}
+				}
+			}
+			for (; h<headers.count(); ++h)
+			{
+				lifted->write(headers[h].second);
+			}
+
+			regions.clear();
+			headers.clear();
+			regions_to_lift.clear();
+		};
+
 		while(! bed->atEnd())
 		{
 			QByteArray line = bed->readLine();
 			//write out headers
 			if (line.startsWith("#") || line.startsWith("track ") || line.startsWith("browser "))
 			{
-				lifted->write(line);
+				headers << qMakePair(regions.count(), line);
 				continue;
 			}
 
@@ -106,44 +180,14 @@ public:
 			}
 
 			BedLine l = BedLine(parts[0], Helper::toInt(parts[1], "range start position", line), Helper::toInt(parts[2], "range end position", line), annotations);
+			regions << l;
 
-			in_count++;
-			in_length += l.length();
-
-			try
-			{
-				// convert to 1-based coordinates for lifting
-				BedLine lifted_line = reader.lift(l.chr(), l.start()+1, l.end());
-				//convert back to 0-based for bed file.
-				lifted_line.setStart(lifted_line.start()-1);
-
-				if (lifted_line.length() > l.length()+l.length()*(max_inc/100.0))
-				{
-					THROW(ArgumentException, "Region increased in size more than " + QString::number(max_inc) + "%.");
-				}
-
-				if (! lifted_line.chr().isNonSpecial() && remove_special_chr)
-				{
-					THROW(ArgumentException, "Region was mapped to a special chromosome.");
-				}
-
-				lifted_line.annotations() = l.annotations();
-				lifted->write(lifted_line.toStringWithAnnotations().toUtf8() + "\n");
-				lifted_count++;
-				lifted_length += lifted_line.length();
-			}
-			catch (ArgumentException& e)
-			{
-				unlifted_count++;
-				unlifted_in_length += l.length();
+			// convert to 1-based coordinates for lifting
+			regions_to_lift.append(BedLine(l.chr(), l.start()+1, l.end()));
 
-				if (! unmapped.isNull())
-				{
-					unmapped->write("# " + e.message().toUtf8() + "\n");
-					unmapped->write(l.toString(false).toUtf8() + "\n");
-				}
-			}
+			if (regions.count()>=batch_size) liftBatch();
 		}
+		liftBatch();
 
 		// print statistics:
 		QTextStream out(stdout);
@@ -20,12 +20,28 @@ public:
 		addOutfile("out", "Output BED file. If unset, writes to STDOUT.", true);
 		addFlag("with_name", "Uses name column (i.e. the 4th column) to sort if chr/start/end are equal.");
 		addFlag("uniq", "If set, entries with the same chr/start/end are removed after sorting.");
+		addInt("buffer", "Enables external sorting for files that do not fit into memory: maximum size of the input chunks in MB that are sorted in memory. If unset, the whole file is sorted in memory.", true, 0);
+		addInt("threads", "Number of threads used to sort chunks in external sorting mode.", true, 1);
+		addFlag("compress_tmp", "Compress temporary files in external sorting mode.");
 
+		changeLog(2026, 10, 17, "Added external sorting mode (parameters '-buffer', '-threads' and '-compress_tmp').");
 		changeLog(2020,  5, 18, "Added 'with_name' flag.");
 	}
 
 	virtual void main()
 	{
+		//external sort
+		int buffer = getInt("buffer");
+		if (buffer>0)
+		{
+			ExternalSortSettings settings;
+			settings.buffer_size = 1000000ll * buffer;
+			settings.threads = getInt("threads");
+			settings.compress_runs = getFlag("compress_tmp");
+			BedFile::sortExternal(getInfile("in"), getOutfile("out"), settings, getFlag("with_name"), getFlag("uniq"));
+			return;
+		}
+
 		BedFile file;
 		file.load(getInfile("in"));
 		if (getFlag("with_name"))
@@ -9,6 +9,12 @@ QT       -= gui
 CONFIG   += console
 CONFIG   -= app_bundle
 
-SOURCES += main.cpp
+SOURCES += main.cpp \
+	ProfileMatrix.cpp \
+	CorrelationKernel.cpp
+
+HEADERS += \
+	ProfileMatrix.h \
+	CorrelationKernel.h
 
 include("../app_cli.pri")
@@ -0,0 +1,131 @@
+#include "CorrelationKernel.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CORRELATIONKERNEL_X86
+#include <immintrin.h>
+#endif
+
+double CorrelationKernel::dotScalar(const float* a, const float* b, int length)
+{
+	//four independent sums to shorten the dependency chain
+	double sum0 = 0.0;
+	double sum1 = 0.0;
+	double sum2 = 0.0;
+	double sum3 = 0.0;
+	int i = 0;
+	for (; i+4<=length; i+=4)
+	{
+		sum0 += (double)a[i] * b[i];
+		sum1 += (double)a[i+1] * b[i+1];
+		sum2 += (double)a[i+2] * b[i+2];
+		sum3 += (double)a[i+3] * b[i+3];
+	}
+	for (; i<length; ++i)
+	{
+		sum0 += (double)a[i] * b[i];
+	}
+	return (sum0 + sum1) + (sum2 + sum3);
+}
+
+#ifdef CORRELATIONKERNEL_X86
+
+__attribute__((target("sse2")))
+static double dotSSE2(const float* a, const float* b, int length)
+{
+	__m128d sum0 = _mm_setzero_pd();
+	__m128d sum1 = _mm_setzero_pd();
+	int i = 0;
+	for (; i+4<=length; i+=4)
+	{
+		__m128 va = _mm_loadu_ps(a + i);
+		__m128 vb = _mm_loadu_ps(b + i);
+		sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_cvtps_pd(va), _mm_cvtps_pd(vb)));
+		sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(va, va)), _mm_cvtps_pd(_mm_movehl_ps(vb, vb))));
+	}
+
+	double parts[2];
+	_mm_storeu_pd(parts, _mm_add_pd(sum0, sum1));
+	return parts[0] + parts[1] + CorrelationKernel::dotScalar(a + i, b + i, length - i);
+}
+
+__attribute__((target("avx2,fma")))
+static double dotAVX2(const float* a, const float* b, int length)
+{
+	__m256d sum0 = _mm256_setzero_pd();
+	__m256d sum1 = _mm256_setzero_pd();
+	int i = 0;
+	for (; i+8<=length; i+=8)
+	{
+		__m256 va = _mm256_loadu_ps(a + i);
+		__m256 vb = _mm256_loadu_ps(b + i);
+		sum0 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(va)), _mm256_cvtps_pd(_mm256_castps256_ps128(vb)), sum0);
+		sum1 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(va, 1)), _mm256_cvtps_pd(_mm256_extractf128_ps(vb, 1)), sum1);
+	}
+
+	double parts[4];
+	_mm256_storeu_pd(parts, _mm256_add_pd(sum0, sum1));
+	return (parts[0] + parts[1]) + (parts[2] + parts[3]) + dotSSE2(a + i, b + i, length - i);
+}
+
+#endif
+
+void CorrelationKernel::setImplementation(CorrelationKernel::Implementation impl)
+{
+	if (impl==AUTO)
+	{
+		impl = best();
+	}
+	else if (!supported(impl))
+	{
+		impl = SCALAR;
+	}
+
+	selected() = impl;
+	function() = functionOf(impl);
+}
+
+CorrelationKernel::Implementation CorrelationKernel::implementation()
+{
+	return selected();
+}
+
+CorrelationKernel::Function& CorrelationKernel::function()
+{
+	static Function output = functionOf(selected());
+	return output;
+}
+
+CorrelationKernel::Implementation& CorrelationKernel::selected()
+{
+	static Implementation output = best();
+	return output;
+}
+
+CorrelationKernel::Function CorrelationKernel::functionOf(CorrelationKernel::Implementation impl)
+{
+#ifdef CORRELATIONKERNEL_X86
+	if (impl==AVX2) return dotAVX2;
+	if (impl==SSE2) return dotSSE2;
+#else
+	(void)impl;
+#endif
+	return dotScalar;
+}
+
+CorrelationKernel::Implementation CorrelationKernel::best()
+{
+	if (supported(AVX2)) return AVX2;
+	if (supported(SSE2)) return SSE2;
+	return SCALAR;
+}
+
+bool CorrelationKernel::supported(CorrelationKernel::Implementation impl)
+{
+	if (impl==SCALAR) return true;
+#ifdef CORRELATIONKERNEL_X86
+	__builtin_cpu_init();
+	if (impl==SSE2) return __builtin_cpu_supports("sse2");
+	if (impl==AVX2) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+	return false;
+}
@@ -0,0 +1,41 @@
+#ifndef CORRELATIONKERNEL_H
+#define CORRELATIONKERNEL_H
+
+///Dot product kernel for float32 coverage profiles (the sums are accumulated in double precision).
+///Uses SSE2/AVX2 instructions if supported by the CPU (runtime dispatch) and a scalar implementation otherwise.
+class CorrelationKernel
+{
+public:
+	///Implementation types.
+	enum Implementation
+	{
+		AUTO,
+		SCALAR,
+		SSE2,
+		AVX2
+	};
+
+	///Returns the dot product of the first @p length elements of @p a and @p b.
+	static double dot(const float* a, const float* b, int length)
+	{
+		return function()(a, b, length);
+	}
+
+	///Sets the implementation used by 'dot' - mainly for testing. If the implementation is not supported by the CPU, the scalar implementation is used.
+	static void setImplementation(Implementation impl);
+	///Returns the implementation used by 'dot' (never AUTO).
+	static Implementation implementation();
+
+	///Scalar implementation.
+	static double dotScalar(const float* a, const float* b, int length);
+
+protected:
+	typedef double (*Function)(const float*, const float*, int);
+	static Function& function();
+	static Implementation& selected();
+	static Function functionOf(Implementation impl);
+	static Implementation best();
+	static bool supported(Implementation impl);
+};
+
+#endif // CORRELATIONKERNEL_H
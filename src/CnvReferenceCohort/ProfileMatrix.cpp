@@ -0,0 +1,178 @@
+#include "ProfileMatrix.h"
+#include "CorrelationKernel.h"
+#include "BasicStatistics.h"
+#include "Exceptions.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+ProfileMatrix::ProfileMatrix(int rows, int cols, const QVector<QPair<int, int>>& segments)
+	: rows_(rows)
+	, cols_(cols)
+	, stride_((cols + 15) / 16 * 16) //rows start at 64-byte boundaries relative to the matrix start
+	, segments_(segments)
+	, data_(rows * stride_, 0.0f)
+	, valid_(rows * segments.count(), false)
+{
+	foreach(const auto& segment, segments_)
+	{
+		if (segment.first<0 || segment.second>=cols_ || segment.first>segment.second) THROW(ArgumentException, "Invalid profile segment " + QString::number(segment.first) + "-" + QString::number(segment.second) + " for profiles with " + QString::number(cols_) + " columns!");
+	}
+}
+
+void ProfileMatrix::setProfile(int row, const QVector<double>& profile)
+{
+	if (profile.count()!=cols_) THROW(ArgumentException, "Profile size " + QString::number(profile.count()) + " does not match the column count " + QString::number(cols_) + "!");
+
+	float* output = data_.data() + row * stride_;
+	for (int s=0; s<segments_.count(); ++s)
+	{
+		const int start = segments_[s].first;
+		const int end = segments_[s].second;
+
+		//mean and sum of squared deviations (in double precision)
+		double mean = 0.0;
+		for (int c=start; c<=end; ++c)
+		{
+			mean += profile[c];
+		}
+		mean /= (end - start + 1);
+		double sum_sq = 0.0;
+		for (int c=start; c<=end; ++c)
+		{
+			sum_sq += (profile[c] - mean) * (profile[c] - mean);
+		}
+
+		//standardize
+		bool valid = sum_sq>0.0;
+		valid_[row * segments_.count() + s] = valid;
+		double factor = valid ? 1.0 / std::sqrt(sum_sq) : 0.0;
+		for (int c=start; c<=end; ++c)
+		{
+			output[c] = (float)((profile[c] - mean) * factor);
+		}
+	}
+}
+
+double ProfileMatrix::correlation(int row1, int row2) const
+{
+	QVector<double> correlations;
+	for (int s=0; s<segments_.count(); ++s)
+	{
+		if (!valid_[row1 * segments_.count() + s] || !valid_[row2 * segments_.count() + s]) continue;
+
+		const int start = segments_[s].first;
+		correlations << CorrelationKernel::dot(row(row1) + start, row(row2) + start, segments_[s].second - start + 1);
+	}
+
+	return median(correlations);
+}
+
+double ProfileMatrix::median(QVector<double>& correlations) const
+{
+	if (correlations.isEmpty()) return std::numeric_limits<double>::quiet_NaN();
+
+	//clamp rounding errors of the float32 representation
+	for (int i=0; i<correlations.count(); ++i)
+	{
+		correlations[i] = std::max(-1.0, std::min(1.0, correlations[i]));
+	}
+
+	std::sort(correlations.begin(), correlations.end());
+	return BasicStatistics::median(correlations);
+}
+
+void ProfileMatrix::calculateTile(int i_start, int i_end, int j_start, int j_end, double* output) const
+{
+	//dot products are accumulated in column blocks, so that the block of all rows of the tile stays in the cache
+	const int block_size = 4096;
+	const int tile_cols = j_end - j_start;
+	const int segment_count = segments_.count();
+	QVector<double> sums((i_end - i_start) * tile_cols * segment_count, 0.0);
+	for (int s=0; s<segment_count; ++s)
+	{
+		for (int block_start=segments_[s].first; block_start<=segments_[s].second; block_start+=block_size)
+		{
+			const int length = std::min(block_size, segments_[s].second - block_start + 1);
+			for (int i=i_start; i<i_end; ++i)
+			{
+				const float* row_i = row(i) + block_start;
+				for (int j=std::max(j_start, i+1); j<j_end; ++j)
+				{
+					sums[((i - i_start) * tile_cols + (j - j_start)) * segment_count + s] += CorrelationKernel::dot(row_i, row(j) + block_start, length);
+				}
+			}
+		}
+	}
+
+	//median of segment correlations
+	QVector<double> correlations;
+	for (int i=i_start; i<i_end; ++i)
+	{
+		for (int j=std::max(j_start, i+1); j<j_end; ++j)
+		{
+			correlations.clear();
+			for (int s=0; s<segment_count; ++s)
+			{
+				if (!valid_[i * segment_count + s] || !valid_[j * segment_count + s]) continue;
+				correlations << sums[((i - i_start) * tile_cols + (j - j_start)) * segment_count + s];
+			}
+
+			double value = median(correlations);
+			output[(qint64)i * rows_ + j] = value;
+			output[(qint64)j * rows_ + i] = value;
+		}
+	}
+}
+
+//Calculates one tile of the correlation matrix
+class ProfileMatrixTileWorker
+	: public QRunnable
+{
+public:
+	ProfileMatrixTileWorker(const ProfileMatrix& matrix, int i_start, int i_end, int j_start, int j_end, double* output)
+		: matrix_(matrix)
+		, i_start_(i_start)
+		, i_end_(i_end)
+		, j_start_(j_start)
+		, j_end_(j_end)
+		, output_(output)
+	{
+	}
+
+	void run() override
+	{
+		matrix_.calculateTile(i_start_, i_end_, j_start_, j_end_, output_);
+	}
+
+protected:
+	const ProfileMatrix& matrix_;
+	int i_start_;
+	int i_end_;
+	int j_start_;
+	int j_end_;
+	double* output_;
+};
+
+QVector<double> ProfileMatrix::correlationMatrix(int threads) const
+{
+	QVector<double> output((qint64)rows_ * rows_, 1.0);
+	if (rows_<2) return output;
+
+	//process tiles in parallel (only tiles on or above the diagonal are needed)
+	const int tile_size = 16;
+	QThreadPool pool;
+	pool.setMaxThreadCount(std::max(1, threads));
+	for (int i=0; i<rows_; i+=tile_size)
+	{
+		for (int j=i; j<rows_; j+=tile_size)
+		{
+			pool.start(new ProfileMatrixTileWorker(*this, i, std::min(i + tile_size, rows_), j, std::min(j + tile_size, rows_), output.data()));
+		}
+	}
+	pool.waitForDone();
+
+	return output;
+}
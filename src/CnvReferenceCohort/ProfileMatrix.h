@@ -0,0 +1,50 @@
+#ifndef PROFILEMATRIX_H
+#define PROFILEMATRIX_H
+
+#include <QVector>
+#include <QPair>
+#include <vector>
+
+///Coverage profiles of several samples stored in one contiguous float32 matrix (one row per sample).
+///The profiles are split into segments (chromosomes). Each segment of a profile is standardized (mean 0, sum of squares 1), so that the Pearson correlation of two profiles in a segment is the dot product of the standardized values.
+class ProfileMatrix
+{
+public:
+	///Constructor. @p segments contains the first and last column of each segment.
+	ProfileMatrix(int rows, int cols, const QVector<QPair<int, int>>& segments);
+
+	///Returns the number of rows (samples).
+	int rows() const
+	{
+		return rows_;
+	}
+
+	///Sets the profile of a row (the profile size must match the column count). Different rows can be set from different threads.
+	void setProfile(int row, const QVector<double>& profile);
+
+	///Returns the correlation of two rows, i.e. the median of the Pearson correlations of the segments. Segments without variance in one of the rows are skipped. Returns NaN if no segment is left.
+	double correlation(int row1, int row2) const;
+
+	///Returns the correlation matrix of all rows (row-major, symmetric, 1.0 on the diagonal). The matrix is calculated in tiles that are processed in parallel.
+	QVector<double> correlationMatrix(int threads) const;
+
+protected:
+	int rows_;
+	int cols_;
+	qint64 stride_;
+	QVector<QPair<int, int>> segments_;
+	std::vector<float> data_; //not a QVector, since the matrix can exceed the maximum QVector size
+	QVector<char> valid_; //segment of row has variance (row-major)
+
+	const float* row(int r) const
+	{
+		return data_.data() + r * stride_;
+	}
+	//returns the median of the per-segment correlations
+	double median(QVector<double>& correlations) const;
+	//calculates the correlations of a tile of rows/columns
+	void calculateTile(int i_start, int i_end, int j_start, int j_end, double* output) const;
+	friend class ProfileMatrixTileWorker;
+};
+
+#endif // PROFILEMATRIX_H
@@ -1,10 +1,14 @@
 #include "ToolBase.h"
 #include "Statistics.h"
 #include "BasicStatistics.h"
+#include "ProfileMatrix.h"
 #include <zlib.h>
 #include <QFileInfo>
 #include <QVector>
 #include <QElapsedTimer>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QScopedPointer>
 
 class ConcreteTool
 		: public ToolBase
@@ -150,7 +154,7 @@ public:
 	void parseGzFileCovProfile(CoverageProfile& cov_profile, const QString& filename, const QBitArray& rows_to_use, int main_file_size, const QList<BedLineRepresentation>& main_file)
 	{
 		const int buffer_size = 1048576;
-		char* buffer = new char[buffer_size];
+		std::vector<char> buffer(buffer_size);
 
 		//open stream
 		FILE* instream = fopen(filename.toUtf8().data(), "rb");
@@ -169,7 +173,7 @@ public:
 
 		while(!gzeof(file))
 		{
-			char* char_array = gzgets(file, buffer, buffer_size);
+			char* char_array = gzgets(file, buffer.data(), buffer_size);
 
 			//handle errors like truncated GZ file
 			if (char_array==nullptr)
@@ -229,6 +233,95 @@ public:
 		}
 	}
 
+	//Data shared by the reference profile workers (inputs are accessed read-only, results are written to the pre-allocated entry of the worker only)
+	struct ReferenceData
+	{
+		const QStringList& files;
+		const QBitArray& rows_to_use;
+		const QList<BedLineRepresentation>& main_file;
+		const CoverageProfile& main_profile;
+		const QMap<QByteArray, MinMaxIndex>& chr_indices;
+		ProfileMatrix* matrix; //if set, the reference profiles are stored in the matrix (reference i in row i+1)
+
+		//results per reference file
+		QVector<double> correlations;
+		QVector<QString> errors;
+		QVector<int> load_ms;
+		QVector<int> correlation_ms;
+	};
+
+	//Loads one reference coverage profile and calculates the correlation to the main sample
+	class ReferenceWorker
+		: public QRunnable
+	{
+	public:
+		ReferenceWorker(ConcreteTool& tool, ReferenceData& data, int index)
+			: tool_(tool)
+			, data_(data)
+			, index_(index)
+		{
+		}
+
+		void run() override
+		{
+			try
+			{
+				QTime timer;
+				timer.start();
+
+				//load coverage profile for ref_file
+				CoverageProfile cov2(data_.main_profile.size());
+				tool_.parseGzFileCovProfile(cov2, data_.files.at(index_), data_.rows_to_use, data_.main_file.size(), data_.main_file);
+				if (data_.matrix!=nullptr) data_.matrix->setProfile(index_+1, cov2);
+				data_.load_ms[index_] = timer.restart();
+
+				//calculate correlation between main_sample and current ref_file
+				QVector<double> corr;
+				for (auto it = data_.chr_indices.cbegin(); it != data_.chr_indices.cend(); ++it)
+				{
+					corr << BasicStatistics::correlation(data_.main_profile, cov2, it.value().min, it.value().max);
+				}
+
+				//sort correlation coefficents for the current ref_file and safe the median
+				std::sort(corr.begin(), corr.end());
+				data_.correlations[index_] = BasicStatistics::median(corr);
+				data_.correlation_ms[index_] = timer.elapsed();
+			}
+			catch(Exception& e)
+			{
+				data_.errors[index_] = e.message();
+			}
+		}
+
+	protected:
+		ConcreteTool& tool_;
+		ReferenceData& data_;
+		int index_;
+	};
+
+	//Writes the correlation matrix of the main sample and the reference samples
+	void writeCorrelationMatrix(QString filename, QString in, const QStringList& in_refs, const QVector<double>& matrix)
+	{
+		QStringList names;
+		names << sampleName(in);
+		foreach(const QString& ref_file, in_refs)
+		{
+			names << sampleName(ref_file);
+		}
+
+		QSharedPointer<QFile> outstream = Helper::openFileForWriting(filename, true);
+		QTextStream stream(outstream.data());
+		stream << "sample\t" << names.join("\t") << "\n";
+		for (int i=0; i<names.count(); ++i)
+		{
+			stream << names[i];
+			for (int j=0; j<names.count(); ++j)
+			{
+				stream << "\t" << QString::number(matrix[i*names.count() + j], 'f', 6);
+			}
+			stream << "\n";
+		}
+	}
 
 	virtual void setup()
 	{
@@ -242,8 +335,11 @@ public:
 		//optional
 		addInfileList("exclude", "Regions in the given BED file(s) are excluded from the coverage calcualtion, e.g. copy-number polymorphic regions.", true);
 		addInt("cov_max", "Best n reference coverage files to include in 'out' based on correlation.", true, 150);
+		addOutfile("out_matrix", "Output TSV file with the correlation matrix of the main sample and all reference samples (median of the per-chromosome correlations, calculated with single precision).", true);
+		addInt("threads", "The number of threads used for loading coverage profiles and calculating correlations.", true, 1);
 		addFlag("debug", "Enable debug output.");
 
+		changeLog(2026, 10, 17, "Added parameters 'out_matrix' and 'threads'.");
 		changeLog(2024,  8, 16, "Initial version.");
 	}
 
@@ -256,6 +352,8 @@ public:
 		QStringList exclude_files = getInfileList("exclude");
 		QStringList in_refs = getInfileList("in_ref");
 		int cov_max = getInt("cov_max");
+		QString out_matrix = getOutfile("out_matrix");
+		int threads = getInt("threads");
 		bool debug = getFlag("debug");
 
 		//Merge exclude files
@@ -321,6 +419,7 @@ public:
 				else
 				{
 					chr_indices[line.chr.str()].min = row_count;
+					chr_indices[line.chr.str()].max = row_count;
 				}
 				++row_count;
 			}
@@ -342,31 +441,42 @@ public:
 
 		//Load other samples and calculate correlation
 		QTime corr_timer;
-		QList<QPair<QString, double>> file2corr;
-		CoverageProfile cov2(cov1.size());
-
-		//iterate over each reference file
 		corr_timer.start();
-		foreach (const QString& ref_file, in_refs)
+		QScopedPointer<ProfileMatrix> matrix;
+		if (!out_matrix.isEmpty())
 		{
-			timer.restart();
-
-			//load coverage profile for ref_file
-			parseGzFileCovProfile(cov2, ref_file, correct_indices, main_file.size(), main_file);
-			if (debug) out << "loading coverage profile for " << QFileInfo(ref_file).fileName() << ": " << Helper::elapsedTime(timer.restart()) << endl;
-
-			//calculate correlation between main_sample and current ref_file
-			QVector<double> corr;
+			QVector<QPair<int, int>> segments;
 			for (auto it = chr_indices.cbegin(); it != chr_indices.cend(); ++it)
 			{
-				corr << BasicStatistics::correlation(cov1, cov2, it.value().min, it.value().max);
+				segments << qMakePair(it.value().min, it.value().max);
 			}
+			matrix.reset(new ProfileMatrix(in_refs.count()+1, cov1.size(), segments));
+			matrix->setProfile(0, cov1);
+		}
+		ReferenceData ref_data{in_refs, correct_indices, main_file, cov1, chr_indices, matrix.data(), QVector<double>(in_refs.count()), QVector<QString>(in_refs.count()), QVector<int>(in_refs.count()), QVector<int>(in_refs.count())};
 
-			//sort correlation coefficents for the current ref_file and safe the median
-			std::sort(corr.begin(), corr.end());
-			file2corr << qMakePair(ref_file, BasicStatistics::median(corr));
-			if (debug) out << "calculating correlation for " << QFileInfo(ref_file).fileName() << ": " << Helper::elapsedTime(timer.restart()) << endl;
+		//process each reference file
+		QThreadPool pool;
+		pool.setMaxThreadCount(std::max(1, threads));
+		for (int i=0; i<in_refs.count(); ++i)
+		{
+			pool.start(new ReferenceWorker(*this, ref_data, i));
+		}
+		pool.waitForDone();
+
+		QList<QPair<QString, double>> file2corr;
+		for (int i=0; i<in_refs.count(); ++i)
+		{
+			if (!ref_data.errors[i].isEmpty()) THROW(FileParseException, ref_data.errors[i]);
+
+			if (debug)
+			{
+				out << "loading coverage profile for " << QFileInfo(in_refs[i]).fileName() << ": " << Helper::elapsedTime(ref_data.load_ms[i]) << endl;
+				out << "calculating correlation for " << QFileInfo(in_refs[i]).fileName() << ": " << Helper::elapsedTime(ref_data.correlation_ms[i]) << endl;
+			}
+			file2corr << qMakePair(in_refs[i], ref_data.correlations[i]);
 		}
+		timer.restart();
 
 		//sort all reference files by descending correlation coefficent
 		std::sort(file2corr.begin(), file2corr.end(), [](const QPair<QString, double> &a, const QPair<QString,double> &b)
@@ -449,6 +559,13 @@ public:
 		outstream -> close();
 
 		if (debug) out << "writing output: " << Helper::elapsedTime(timer.restart()) << endl;
+
+		//Calculate and store correlation matrix
+		if (!matrix.isNull())
+		{
+			writeCorrelationMatrix(out_matrix, in, in_refs, matrix->correlationMatrix(threads));
+			if (debug) out << "calculating correlation matrix: " << Helper::elapsedTime(timer.restart()) << endl;
+		}
 	}
 };
 
@@ -43,6 +43,7 @@ int FilterCascadeWidget::currentFilterIndex() const
 
 void FilterCascadeWidget::markFailedFilters()
 {
+	QVector<int> times = filters_.filterTimes();
 	for(int i=0; i<ui_.filters_entries->count(); ++i)
 	{
 		QListWidgetItem* item = ui_.filters_entries->item(i);
@@ -51,6 +52,11 @@ void FilterCascadeWidget::markFailedFilters()
 		if (errors.isEmpty())
 		{
 			item->setBackground(QBrush());
+
+			//show time of last filter application (not available if the stored result was re-used)
+			QString tooltip = filters_[i]->description().join("\n");
+			if (i<times.count() && times[i]>=0) tooltip += "\n\nLast application took " + QString::number(times[i]) + " ms";
+			item->setToolTip(tooltip);
 		}
 		else
 		{
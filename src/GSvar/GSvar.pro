@@ -66,6 +66,7 @@ SOURCES += main.cpp\
     SequencingRunWidget.cpp \
     AnalysisStatusWidget.cpp \
     VariantTable.cpp \
+    VariantTableModel.cpp \
     SampleSearchWidget.cpp \
     SampleRelationDialog.cpp \
     ProcessedSampleSelector.cpp \
@@ -191,6 +192,7 @@ HEADERS += MainWindow.h \
     SequencingRunWidget.h \
     AnalysisStatusWidget.h \
     VariantTable.h \
+    VariantTableModel.h \
     SampleSearchWidget.h \
     SampleRelationDialog.h \
     ProcessedSampleSelector.h \
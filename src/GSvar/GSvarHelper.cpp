@@ -155,6 +155,18 @@ GenomeBuild GSvarHelper::build()
 }
 
 void GSvarHelper::colorGeneItem(QTableWidgetItem* item, const GeneSet& genes)
+{
+	QString tooltip = geneToolTip(genes);
+
+	//mark gene
+	if (!tooltip.isEmpty())
+	{
+		item->setBackgroundColor(Qt::yellow);
+		item->setToolTip(tooltip);
+	}
+}
+
+QString GSvarHelper::geneToolTip(const GeneSet& genes)
 {
 	//init
 	static const GeneSet& imprinting_genes = impritingGenes();
@@ -181,13 +193,8 @@ void GSvarHelper::colorGeneItem(QTableWidgetItem* item, const GeneSet& genes)
 		messages << (gene + ": Has pseudogene(s)");
 	}
 
-	//mark gene
-	if (!messages.isEmpty())
-	{
-		messages.sort();
-		item->setBackgroundColor(Qt::yellow);
-		item->setToolTip(messages.join('\n'));
-	}
+	messages.sort();
+	return messages.join('\n');
 }
 
 bool GSvarHelper::colorQcItem(QTableWidgetItem* item, const QString& accession, const QString& sys_type, const QString& gender)
@@ -320,7 +327,11 @@ BedLine GSvarHelper::liftOver(const Chromosome& chr, int start, int end, bool hg
 	{
 		QString filepath = Settings::string("liftover_" + chain, true).trimmed();
 		if (filepath.isEmpty()) THROW(ProgrammingException, "No chain file specified in settings.ini. Please inform the bioinformatics team!");
-		chain_reader_cache.insert(chain, QSharedPointer<ChainFileReader>(new ChainFileReader(filepath, 0.05)));
+
+		//binary cache of the chain file is stored in the user cache folder (the chain file folder is usually shared and not writable)
+		QString cache_folder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+		bool use_cache = !cache_folder.isEmpty() && Helper::mkdir(cache_folder)!=-1;
+		chain_reader_cache.insert(chain, QSharedPointer<ChainFileReader>(new ChainFileReader(filepath, 0.05, use_cache, cache_folder)));
 	}
 
 	//lift region
@@ -746,8 +757,9 @@ QList<QStringList> GSvarHelper::annotateCodingAndSplicing(const VcfLine& variant
 	transcripts.sortByRelevance();
 
 	//annotate consequence for each transcript
+	static QSharedPointer<TranscriptSequenceCache> sequence_cache(new TranscriptSequenceCache()); //shared between calls (the reference genome does not change)
 	FastaFileIndex genome_idx(Settings::string("reference_genome"));
-	VariantHgvsAnnotator hgvs_annotator(genome_idx);
+	VariantHgvsAnnotator hgvs_annotator(genome_idx, VariantHgvsAnnotator::Parameters(), sequence_cache);
 	foreach(const Transcript& trans, transcripts)
 	{
 		VariantConsequence consequence = hgvs_annotator.annotate(trans, variant);
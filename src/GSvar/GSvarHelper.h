@@ -33,6 +33,8 @@ public:
 
 	//colors imprinting and non-haploinsufficiency genes.
 	static void colorGeneItem(QTableWidgetItem* item, const GeneSet& genes);
+	//Returns the tooltip for imprinting and non-haploinsufficiency genes, or an empty string if no gene is special.
+	static QString geneToolTip(const GeneSet& genes);
 	//colors QC metric item background. Returns if the item was assigned a background color.
 	static bool colorQcItem(QTableWidgetItem* item, const QString& accession, const QString& sys_type, const QString& gender);
 
@@ -1777,12 +1777,12 @@ void MainWindow::editVariantValidation(int index)
 			int i_validation = variants_.annotationIndexByName("validation", true, true);
 			variant.annotations()[i_validation] = status;
 
+			//mark variant list as changed
+			markVariantListChanged(variant, "validation", status);
+
 			//update details widget and filtering
 			ui_.variant_details->updateVariant(variants_, index);
 			refreshVariantTable();
-
-			//mark variant list as changed
-			markVariantListChanged(variant, "validation", status);
 		}
 		else if (added_validation_entry)
 		{
@@ -1823,10 +1823,11 @@ void MainWindow::editVariantComment(int index)
 			if (col_index!=-1)
 			{
 				variant.annotations()[col_index] = text;
-				refreshVariantTable();
 
 				//mark variant list as changed
 				markVariantListChanged(variant, "comment", text);
+
+				refreshVariantTable();
 			}
 		}
 	}
@@ -2563,7 +2564,14 @@ void MainWindow::loadFile(QString filename, bool show_only_error_issues)
 	{
 		//load variants
 		timer.restart();
-		variants_.load(filename);
+		if (!Helper::isHttpUrl(filename) && Settings::boolean("gsvar_variant_cache", true))
+		{
+			variants_.loadWithCache(filename);
+		}
+		else
+		{
+			variants_.load(filename);
+		}
 		Log::perf("Loading small variant list took ", timer);
 		QString mode_title = "";
 		if (Helper::isHttpUrl(filename))
@@ -5412,11 +5420,6 @@ void MainWindow::refreshVariantTable(bool keep_widths)
 	applyFilters(false);
 	int passing_variants = filter_result_.countPassing();
 	QString status = QString::number(passing_variants) + " of " + QString::number(variants_.count()) + " variants passed filters.";
-	int max_variants = 10000;
-	if (passing_variants>max_variants)
-	{
-		status += " Displaying " + QString::number(max_variants) + " variants only!";
-	}
 	ui_.statusBar->showMessage(status);
 
 	Log::perf("Applying all filters took ", timer);
@@ -5430,11 +5433,11 @@ void MainWindow::refreshVariantTable(bool keep_widths)
 	AnalysisType type = variants_.type();
 	if (type==SOMATIC_SINGLESAMPLE || type==SOMATIC_PAIR || type==CFDNA)
 	{
-		ui_.vars->update(variants_, filter_result_, somatic_report_settings_, max_variants);
+		ui_.vars->update(variants_, filter_result_, somatic_report_settings_);
 	}
 	else if (type==GERMLINE_SINGLESAMPLE || type==GERMLINE_TRIO || type==GERMLINE_MULTISAMPLE)
 	{
-		ui_.vars->update(variants_, filter_result_, report_settings_, max_variants);
+		ui_.vars->update(variants_, filter_result_, report_settings_);
 	}
 	else
 	{
@@ -6175,6 +6178,9 @@ void MainWindow::updateReportConfigHeaderIcon(int index)
 void MainWindow::markVariantListChanged(const Variant& variant, QString column, QString text)
 {
 	variants_changed_ << VariantListChange{variant, column, text};
+
+	//cached data used by the filters (annotation data, results stored for incremental filtering) is outdated
+	variants_.markModified();
 }
 
 void MainWindow::storeCurrentVariantList()
@@ -6361,7 +6367,7 @@ void MainWindow::applyFilters(bool debug_time)
 
 		const FilterCascade& filter_cascade = ui_.filters->filters();
 
-		filter_result_ = filter_cascade.apply(variants_, false, debug_time);
+		filter_result_ = filter_cascade.applyIncremental(variants_, false, debug_time);
 
 		ui_.filters->markFailedFilters();
 
@@ -8,7 +8,6 @@
 #include "GeneInfoDBs.h"
 #include "GenomeVisualizationWidget.h"
 
-#include <QBitArray>
 #include <QApplication>
 #include <QClipboard>
 #include <QMessageBox>
@@ -17,16 +16,26 @@
 #include <QMenu>
 
 VariantTable::VariantTable(QWidget* parent)
-	: QTableWidget(parent)
+	: QTableView(parent)
+	, variants_(nullptr)
+	, model_(new VariantTableModel(this))
 	, registered_actions_()
 	, active_phenotypes_()
 {
+	setModel(model_);
+	connect(selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)), this, SIGNAL(itemSelectionChanged()));
+	connect(this, &QTableView::doubleClicked, this, [this](const QModelIndex& index){ emit cellDoubleClicked(index.row(), index.column()); });
+
 	//make sure the selection is visible when the table looses focus
 	QString fg = GUIHelper::colorToQssFormat(palette().color(QPalette::Active, QPalette::HighlightedText));
 	QString bg = GUIHelper::colorToQssFormat(palette().color(QPalette::Active, QPalette::Highlight));
-	setStyleSheet(QString("QTableWidget:!active { selection-color: %1; selection-background-color: %2; }").arg(fg).arg(bg));
+	setStyleSheet(QString("QTableView:!active { selection-color: %1; selection-background-color: %2; }").arg(fg).arg(bg));
 	setContextMenuPolicy(Qt::ContextMenuPolicy::CustomContextMenu);
 	connect(this, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(customContextMenu(QPoint)));
+
+	//sorting by clicking on the column header (no sort column by default, i.e. variants are shown in the original order)
+	horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+	setSortingEnabled(true);
 }
 
 void VariantTable::addCustomContextMenuActions(QList<QAction*> actions)
@@ -369,241 +378,16 @@ void VariantTable::customContextMenu(QPoint pos)
 	}
 }
 
-void VariantTable::updateTable(VariantList& variants, const FilterResult& filter_result, const QHash<int,bool>& index_show_report_icon, const QSet<int>& index_causal, int max_variants)
+void VariantTable::updateTable(VariantList& variants, const FilterResult& filter_result, const QHash<int,bool>& index_show_report_icon, const QSet<int>& index_causal)
 {
 	//update local reference to the variants
 	variants_ = &variants;
 
-	//set rows and cols
-	int row_count_new = std::min(filter_result.countPassing(), max_variants);
-	int col_count_new = 5 + variants.annotations().count();
-	if (rowCount()!=row_count_new || columnCount()!=col_count_new)
-	{
-		//completely clear items (is faster than resizing)
-		clearContents();
-		//set new size
-		setRowCount(row_count_new);
-		setColumnCount(col_count_new);
-	}
-
-	//header
-	setHorizontalHeaderItem(0, createTableItem("chr"));
-	horizontalHeaderItem(0)->setToolTip("Chromosome the variant is located on.");
-	setHorizontalHeaderItem(1, createTableItem("start"));
-	horizontalHeaderItem(1)->setToolTip("Start position of the variant on the chromosome.\nFor insertions, the position of the base before the insertion is shown.");
-	setHorizontalHeaderItem(2, createTableItem("end"));
-	horizontalHeaderItem(2)->setToolTip("End position of the variant on the chromosome.\nFor insertions, the position of the base before the insertion is shown.");
-	setHorizontalHeaderItem(3, createTableItem("ref"));
-	horizontalHeaderItem(3)->setToolTip("Reference bases in the reference genome at the variant position.\n`-` in case of an insertion.");
-	setHorizontalHeaderItem(4, createTableItem("obs"));
-	horizontalHeaderItem(4)->setToolTip("Alternate bases observed in the sample.\n`-` in case of an deletion.");
-	for (int i=0; i<variants.annotations().count(); ++i)
-	{
-		QString anno = variants.annotations()[i].name();
-		QTableWidgetItem* header = new QTableWidgetItem(anno);
-
-		//additional descriptions for filter column
-		QString add_desc = "";
-		if (anno=="filter")
-		{
-			auto it = variants.filters().cbegin();
-			while (it!=variants.filters().cend())
-			{
-				add_desc += "\n - "+it.key() + ": " + it.value();
-				++it;
-			}
-		}
-
-		//additional descriptions and color for genotype columns
-		SampleHeaderInfo sample_data = variants.getSampleHeader();
-		foreach(const SampleInfo& info, sample_data)
-		{
-			if (info.name==anno)
-			{
-				auto it = info.properties.cbegin();
-				while(it != info.properties.cend())
-				{
-					add_desc += "\n - " + it.key() + ": " + it.value();
-
-					if (info.isAffected())
-					{
-						header->setForeground(QBrush(Qt::darkRed));
-					}
-
-					++it;
-				}
-			}
-		}
-
-		QString header_desc = variants.annotationDescriptionByName(anno, false).description();
-		header->setToolTip(header_desc + add_desc);
-		setHorizontalHeaderItem(i+5, header);
-	}
-
-	//content
-	int i_genes = variants.annotationIndexByName("gene", true, false);
-	int i_co_sp = variants.annotationIndexByName("coding_and_splicing", true, false);
-	int i_validation = variants.annotationIndexByName("validation", true, false);
-	int i_classification = variants.annotationIndexByName("classification", true, false);
-	int i_comment = variants.annotationIndexByName("comment", true, false);
-	int i_ihdb_hom = variants.annotationIndexByName("NGSD_hom", true, false);
-	int i_ihdb_het = variants.annotationIndexByName("NGSD_het", true, false);
-	int i_clinvar = variants.annotationIndexByName("ClinVar", true, false);
-	int i_hgmd = variants.annotationIndexByName("HGMD", true, false);
-	int i_spliceai = variants.annotationIndexByName("SpliceAI", true, false);
-	int i_maxentscan = variants.annotationIndexByName("MaxEntScan", true, false);
-	int r = -1;
-	for (int i=0; i<variants.count(); ++i)
-	{
-		if (!filter_result.passing(i)) continue;
-
-		++r;
-		if (r>=max_variants) break; //maximum number of variants reached > abort
-		const Variant& variant = variants[i];
-
-		setItem(r, 0, createTableItem(variant.chr().str()));
-		if (!variant.chr().isAutosome())
-		{
-			item(r,0)->setBackgroundColor(Qt::yellow);
-			item(r,0)->setToolTip("Not autosome");
-		}
-		setItem(r, 1, createTableItem(QByteArray::number(variant.start())));
-		setItem(r, 2, createTableItem(QByteArray::number(variant.end())));
-		setItem(r, 3, createTableItem(variant.ref()));
-		setItem(r, 4, createTableItem(variant.obs()));
-		bool is_warning_line = false;
-		bool is_notice_line = false;
-		bool is_ngsd_benign = false;
-		for (int j=0; j<variant.annotations().count(); ++j)
-		{
-			const QByteArray& anno = variant.annotations().at(j);
-			QTableWidgetItem* item = createTableItem(anno);
-
-			//warning
-			if (j==i_co_sp && anno.contains(":HIGH:"))
-			{
-				item->setBackgroundColor(Qt::red);
-				is_warning_line = true;
-			}
-			else if (j==i_classification && (anno=="3" || anno=="M"))
-			{
-				item->setBackgroundColor(QColor(255, 135, 60)); //orange
-				is_notice_line = true;
-			}
-			else if (j==i_classification && (anno=="4" || anno=="5"))
-			{
-				item->setBackgroundColor(Qt::red);
-				is_warning_line = true;
-			}
-			else if (j==i_clinvar && anno.contains("pathogenic") && !anno.contains("conflicting interpretations of pathogenicity")) //matches "pathogenic" and "likely pathogenic"
-			{
-				item->setBackgroundColor(Qt::red);
-				is_warning_line = true;
-			}
-			else if (j==i_hgmd && anno.contains("CLASS=DM")) //matches both "DM" and "DM?"
-			{
-				item->setBackgroundColor(Qt::red);
-				is_warning_line = true;
-			}
-			else if (j==i_spliceai && NGSHelper::maxSpliceAiScore(anno) >= 0.8)
-			{
-				item->setBackgroundColor(Qt::red);
-				is_notice_line = true;
-			}
-			else if (j==i_spliceai && NGSHelper::maxSpliceAiScore(anno) >= 0.5)
-			{
-				item->setBackgroundColor(QColor(255, 135, 60)); //orange
-				is_notice_line = true;
-			}
-			else if (j==i_maxentscan && !anno.isEmpty())
-			{
-				//iterate over predictions per transcript
-				QList<MaxEntScanImpact> impacts;
-				foreach(const QByteArray& entry, anno.split(','))
-				{
-					QByteArray anno_with_percentages;
-					impacts << NGSHelper::maxEntScanImpact(entry.split('/'), anno_with_percentages, false);
-				}
-
-				//output: max import
-				if (impacts.contains(MaxEntScanImpact::HIGH))
-				{
-					item->setBackgroundColor(Qt::red); //orange
-					is_notice_line = true;
-				}
-				else if (impacts.contains(MaxEntScanImpact::MODERATE))
-				{
-					item->setBackgroundColor(QColor(255, 135, 60)); //orange
-					is_notice_line = true;
-				}
-			}
-
-			//non-pathogenic
-			if (j==i_classification && (anno=="1" || anno=="2"))
-			{
-				item->setBackgroundColor(Qt::green);
-				is_ngsd_benign = true;
-			}
-
-			//highlighed
-			if (j==i_validation && anno.contains("TP"))
-			{
-				item->setBackgroundColor(Qt::yellow);
-			}
-			else if (j==i_comment && anno!="")
-			{
-				item->setBackgroundColor(Qt::yellow);
-			}
-			else if (j==i_ihdb_hom && anno=="0")
-			{
-				item->setBackgroundColor(Qt::yellow);
-			}
-			else if (j==i_ihdb_het && anno=="0")
-			{
-				item->setBackgroundColor(Qt::yellow);
-			}
-			else if (j==i_clinvar && anno.contains("(confirmed)"))
-			{
-				item->setBackgroundColor(Qt::yellow);
-			}
-			else if (j==i_genes)
-			{
-				GeneSet anno_genes = GeneSet::createFromText(anno, ',');
-				GSvarHelper::colorGeneItem(item, anno_genes);
-			}
-
-			setItem(r, 5+j, item);
-		}
-
-		//vertical headers - warning (red), notice (orange)
-		QTableWidgetItem* item = createTableItem(QByteArray::number(i+1));
-		item->setData(Qt::UserRole, i); //store variant index in user data (for selection methods)
-		if (!is_ngsd_benign)
-		{
-			if (is_warning_line)
-			{
-				item->setForeground(QBrush(Qt::red));
-				QFont font;
-				font.setWeight(QFont::Bold);
-				item->setFont(font);
-			}
-			else if (is_notice_line)
-			{
-				item->setForeground(QBrush(QColor(255, 135, 60)));
-				QFont font;
-				font.setWeight(QFont::Bold);
-				item->setFont(font);
-			}
-		}
-		if (index_show_report_icon.keys().contains(i))
-		{
-			item->setIcon(reportIcon(index_show_report_icon.value(i), index_causal.contains(i)));
-		}
-		setVerticalHeaderItem(r, item);
-	}
+	//update model (only visible cells are rendered)
+	model_->setVariants(variants, filter_result, index_show_report_icon, index_causal);
 }
 
-void VariantTable::update(VariantList& variants, const FilterResult& filter_result, const ReportSettings& report_settings, int max_variants)
+void VariantTable::update(VariantList& variants, const FilterResult& filter_result, const ReportSettings& report_settings)
 {
 	//init
 	QHash<int, bool> index_show_report_icon;
@@ -615,10 +399,10 @@ void VariantTable::update(VariantList& variants, const FilterResult& filter_resu
 		if (rc.causal) index_causal << index;
 	}
 
-	updateTable(variants, filter_result, index_show_report_icon, index_causal, max_variants);
+	updateTable(variants, filter_result, index_show_report_icon, index_causal);
 }
 
-void VariantTable::update(VariantList& variants, const FilterResult& filter_result, const SomaticReportSettings& report_settings, int max_variants)
+void VariantTable::update(VariantList& variants, const FilterResult& filter_result, const SomaticReportSettings& report_settings)
 {
 	//init
 	QHash<int, bool> index_show_report_icon;
@@ -628,31 +412,32 @@ void VariantTable::update(VariantList& variants, const FilterResult& filter_resu
 		index_show_report_icon[index] = report_settings.report_config.get(VariantType::SNVS_INDELS, index).showInReport();
 	}
 
-	updateTable(variants, filter_result, index_show_report_icon, index_causal, max_variants);
+	updateTable(variants, filter_result, index_show_report_icon, index_causal);
 }
 
 void VariantTable::updateVariantHeaderIcon(const ReportSettings& report_settings, int variant_index)
 {
-	int row = variantIndexToRow(variant_index);
-
-	QIcon report_icon;
-	if (report_settings.report_config->exists(VariantType::SNVS_INDELS, variant_index))
+	bool exists = report_settings.report_config->exists(VariantType::SNVS_INDELS, variant_index);
+	bool show_in_report = false;
+	bool causal = false;
+	if (exists)
 	{
 		const ReportVariantConfiguration& rc = report_settings.report_config->get(VariantType::SNVS_INDELS, variant_index);
-		report_icon = reportIcon(rc.showInReport(), rc.causal);
+		show_in_report = rc.showInReport();
+		causal = rc.causal;
 	}
-	verticalHeaderItem(row)->setIcon(report_icon);
+	model_->setReportIcon(variant_index, exists, show_in_report, causal);
 }
 
 void VariantTable::updateVariantHeaderIcon(const SomaticReportSettings &report_settings, int variant_index)
 {
-	int row = variantIndexToRow(variant_index);
-	QIcon report_icon;
-	if(report_settings.report_config.exists(VariantType::SNVS_INDELS, variant_index))
+	bool exists = report_settings.report_config.exists(VariantType::SNVS_INDELS, variant_index);
+	bool show_in_report = false;
+	if (exists)
 	{
-		report_icon = reportIcon(report_settings.report_config.get(VariantType::SNVS_INDELS, variant_index).showInReport(), false);
+		show_in_report = report_settings.report_config.get(VariantType::SNVS_INDELS, variant_index).showInReport();
 	}
-	verticalHeaderItem(row)->setIcon(report_icon);
+	model_->setReportIcon(variant_index, exists, show_in_report, false);
 }
 
 int VariantTable::selectedVariantIndex(bool gui_indices) const
@@ -668,10 +453,10 @@ QList<int> VariantTable::selectedVariantsIndices(bool gui_indices) const
 {
 	QList<int> output;
 
-	QList<QTableWidgetSelectionRange> ranges = selectedRanges();
-	foreach(const QTableWidgetSelectionRange& range, ranges)
+	const QItemSelection ranges = selectionModel()->selection();
+	foreach(const QItemSelectionRange& range, ranges)
 	{
-		for(int row=range.topRow(); row<=range.bottomRow(); ++row)
+		for(int row=range.top(); row<=range.bottom(); ++row)
 		{
 			if (gui_indices)
 			{
@@ -691,43 +476,32 @@ QList<int> VariantTable::selectedVariantsIndices(bool gui_indices) const
 
 int VariantTable::rowToVariantIndex(int row) const
 {
-	//get header (variant index is stored in user data)
-	QTableWidgetItem* header = verticalHeaderItem(row);
-	if (header==nullptr) THROW(ProgrammingException, "Variant table row header not set!");
-
-	//convert header text to integer
-	bool ok;
-	int variant_index = header->data(Qt::UserRole).toInt(&ok);
-	if (!ok) THROW(ProgrammingException, "Variant table row header user data '" + header->data(Qt::UserRole).toString() + "' is not an integer!");
-
-	return variant_index;
+	return model_->rowToVariantIndex(row);
 }
 
 int VariantTable::variantIndexToRow(int index) const
 {
-	for (int row=0; row<verticalHeader()->count(); ++row)
-	{
-		QTableWidgetItem* item = verticalHeaderItem(row);
-		if (item==nullptr) THROW(ProgrammingException, "Variant table row header not set for row '" + QString::number(row) + "'!");
+	int row = model_->variantIndexToRow(index);
+	if (row==-1) THROW(ProgrammingException, "Variant table row not found for variant with index '" + QString::number(index) + "'!");
 
-		bool ok;
-		int index_header = item->data(Qt::UserRole).toInt(&ok);
-		if (!ok) THROW(ProgrammingException, "Variant table row header user data '" + item->data(Qt::UserRole).toString() + "' is not an integer!");
+	return row;
+}
 
-		if(index_header==index)
-		{
-			return row;
-		}
+int VariantTable::columnIndex(const QString& name) const
+{
+	for (int c=0; c<model_->columnCount(); ++c)
+	{
+		if (model_->columnName(c)==name) return c;
 	}
 
-	THROW(ProgrammingException, "Variant table row header not found for variant with index '" + QString::number(index) + "'!");
+	return -1;
 }
 
 QList<int> VariantTable::columnWidths() const
 {
 	QList<int> output;
 
-	for (int c=0; c<columnCount(); ++c)
+	for (int c=0; c<model_->columnCount(); ++c)
 	{
 		output << columnWidth(c);
 	}
@@ -737,7 +511,7 @@ QList<int> VariantTable::columnWidths() const
 
 void VariantTable::setColumnWidths(const QList<int>& widths)
 {
-	int col_count = std::min(widths.count(), columnCount());
+	int col_count = std::min(widths.count(), model_->columnCount());
 	for (int c=0; c<col_count; ++c)
 	{
 		setColumnWidth(c, widths[c]);
@@ -746,21 +520,18 @@ void VariantTable::setColumnWidths(const QList<int>& widths)
 
 void VariantTable::adaptRowHeights()
 {
-	if (rowCount()<1) return;
+	if (model_->rowCount()<1) return;
 
+	//all rows have the same height (fixed-size sections are not measured, which is important for big tables)
 	resizeRowToContents(0);
-	int height = rowHeight(0);
-
-	for (int i=0; i<rowCount(); ++i)
-	{
-		setRowHeight(i, height);
-	}
+	verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	verticalHeader()->setDefaultSectionSize(rowHeight(0));
 }
 
 void VariantTable::clearContents()
 {
-	setRowCount(0);
-	setColumnCount(0);
+	variants_ = nullptr;
+	model_->clear();
 }
 
 void VariantTable::adaptColumnWidths()
@@ -770,7 +541,7 @@ void VariantTable::adaptColumnWidths()
 
 	//restrict width
 	int max_col_width = 200;
-	for (int i=0; i<columnCount(); ++i)
+	for (int i=0; i<model_->columnCount(); ++i)
 	{
 		if (columnWidth(i)>max_col_width)
 		{
@@ -809,7 +580,7 @@ void VariantTable::adaptColumnWidthsCustom()
 
 	//restrict width
 	int max_col_width = 50;
-	for (int i=0; i<columnCount(); ++i)
+	for (int i=0; i<model_->columnCount(); ++i)
 	{
 		if (columnWidth(i)>max_col_width)
 		{
@@ -833,7 +604,7 @@ void VariantTable::adaptColumnWidthsCustom()
 
 	//big
 	int size_big = 400;
-	int index = GUIHelper:: GUIHelper::columnIndex(this, "OMIM", false);
+	int index = columnIndex("OMIM");
 	if (index!=-1) setColumnWidth(index, size_big);
 
 	//medium
@@ -841,95 +612,59 @@ void VariantTable::adaptColumnWidthsCustom()
 	SampleHeaderInfo header_info;
 	foreach(const SampleInfo& info, header_info)
 	{
-		index =  GUIHelper::columnIndex(this, info.name, false);
+		index = columnIndex(info.name);
 		if (index!=-1) setColumnWidth(index, size_med);
 	}
-	index =  GUIHelper::columnIndex(this, "gene", false);
+	index = columnIndex("gene");
 	if (index!=-1) setColumnWidth(index, size_med);
-	index =  GUIHelper::columnIndex(this, "variant_type", false);
+	index = columnIndex("variant_type");
 	if (index!=-1) setColumnWidth(index, size_med);
-	index =  GUIHelper::columnIndex(this, "filter", false);
+	index = columnIndex("filter");
 	if (index!=-1) setColumnWidth(index, size_med);
-	index =  GUIHelper::columnIndex(this, "ClinVar", false);
+	index = columnIndex("ClinVar");
 	if (index!=-1) setColumnWidth(index, size_med);
-	index =  GUIHelper::columnIndex(this, "HGMD", false);
+	index = columnIndex("HGMD");
 	if (index!=-1) setColumnWidth(index, size_med);
-	index =  GUIHelper::columnIndex(this, "NGSD_hom", false);
+	index = columnIndex("NGSD_hom");
 	if (index!=-1) setColumnWidth(index, size_med);
-	index =  GUIHelper::columnIndex(this, "NGSD_het", false);
+	index = columnIndex("NGSD_het");
 	if (index!=-1) setColumnWidth(index, size_med);
-	index =  GUIHelper::columnIndex(this, "NGSD_group", false);
+	index = columnIndex("NGSD_group");
 	if (index!=-1) setColumnWidth(index, size_med);
-	index =  GUIHelper::columnIndex(this, "classification", false);
+	index = columnIndex("classification");
 	if (index!=-1) setColumnWidth(index, size_med);
-	index =  GUIHelper::columnIndex(this, "gene_info", false);
+	index = columnIndex("gene_info");
 	if (index!=-1) setColumnWidth(index, size_med);
 }
 
 void VariantTable::copyToClipboard(bool split_quality, bool include_header_one_row)
 {
 	// Data to be copied is not selected en bloc
-	if (selectedRanges().count()!=1 && !split_quality)
+	const QItemSelection selection = selectionModel()->selection();
+	if (selection.count()!=1 && !split_quality)
 	{
-		//Create 2d list with empty QStrings (size equal to QTable in Main Window)
-		QList< QList<QString> > data;
-		for(int r=0;r<rowCount();++r)
-		{
-			QList<QString> line;
-			for(int c=0;c<columnCount();++c)
-			{
-				line.append("");
-			}
-			data.append(line);
-		}
-
-		//Fill data with non-empty entries from QTable in Main Window
-		QBitArray empty_columns;
-		empty_columns.fill(true,columnCount());
-		QList<QTableWidgetItem*> all_items = selectedItems();
-		foreach(QTableWidgetItem* item,all_items)
+		//collect non-empty selected cells (empty rows and columns are removed)
+		QMap<int, QMap<int, QString>> data;
+		QSet<int> used_columns;
+		foreach(const QModelIndex& index, selectionModel()->selectedIndexes())
 		{
-			if(!item->text().isEmpty())
+			QString text = model_->data(index).toString();
+			if(!text.isEmpty())
 			{
-				data[item->row()][item->column()] = item->text();
-				empty_columns[item->column()] = false;
-			}
-		}
-
-		//Remove empty columns
-		for(int c=columnCount()-1;c>=0;--c)
-		{
-			if(empty_columns[c])
-			{
-				for(int r=0;r<rowCount();++r)
-				{
-					data[r].removeAt(c);
-				}
-			}
-		}
-
-		//Remove empty rows
-		for(int r=rowCount()-1;r>=0;--r)
-		{
-			bool row_is_empty = true;
-			for(int c=0;c<data[r].count();++c)
-			{
-				if(!data[r][c].isEmpty())
-				{
-					row_is_empty = false;
-					break;
-				}
+				data[index.row()][index.column()] = text;
+				used_columns << index.column();
 			}
-			if(row_is_empty) data.removeAt(r);
 		}
+		QList<int> columns = used_columns.toList();
+		std::sort(columns.begin(), columns.end());
 
 		QString text = "";
-		for(int r=0;r<data.count();++r)
+		for(auto it=data.cbegin(); it!=data.cend(); ++it)
 		{
-			for(int c=0;c<data[r].count();++c)
+			for(int c=0;c<columns.count();++c)
 			{
-				text.append(data[r][c]);
-				if(c<data[r].count()-1) text.append("\t");
+				text.append(it.value().value(columns[c]));
+				if(c<columns.count()-1) text.append("\t");
 			}
 			text.append("\n");
 		}
@@ -937,8 +672,9 @@ void VariantTable::copyToClipboard(bool split_quality, bool include_header_one_r
 
 		return;
 	}
+	if (selection.count()==0) return;
 
-	QTableWidgetSelectionRange range = selectedRanges()[0];
+	const QItemSelectionRange range = selection[0];
 
 	//check quality column is present
 	QStringList quality_keys;
@@ -946,7 +682,7 @@ void VariantTable::copyToClipboard(bool split_quality, bool include_header_one_r
 	int qual_index = -1;
 	if (split_quality)
 	{
-		qual_index =  GUIHelper::columnIndex(this, "quality", false);
+		qual_index = columnIndex("quality");
 		if (qual_index==-1)
 		{
 			QMessageBox::warning(this, "Copy to clipboard", "Column with index 6 has other name than quality. Aborting!");
@@ -957,39 +693,39 @@ void VariantTable::copyToClipboard(bool split_quality, bool include_header_one_r
 
 	//copy header
 	QString selected_text = "";
-	if (range.rowCount()!=1 || include_header_one_row)
+	if (range.height()!=1 || include_header_one_row)
 	{
 		selected_text += "#";
-		for (int col=range.leftColumn(); col<=range.rightColumn(); ++col)
+		for (int col=range.left(); col<=range.right(); ++col)
 		{
-			if (col!=range.leftColumn()) selected_text.append("\t");
+			if (col!=range.left()) selected_text.append("\t");
 			if (split_quality && col==qual_index)
 			{
 				selected_text.append(quality_keys.join('\t'));
 			}
 			else
 			{
-				selected_text.append(horizontalHeaderItem(col)->text());
+				selected_text.append(model_->columnName(col));
 			}
 		}
 	}
 
 	//copy rows
-	for (int row=range.topRow(); row<=range.bottomRow(); ++row)
+	for (int row=range.top(); row<=range.bottom(); ++row)
 	{
 		if (selected_text!="") selected_text.append("\n");
-		for (int col=range.leftColumn(); col<=range.rightColumn(); ++col)
+		for (int col=range.left(); col<=range.right(); ++col)
 		{
-			if (col!=range.leftColumn()) selected_text.append("\t");
+			if (col!=range.left()) selected_text.append("\t");
 
-			QTableWidgetItem* current_item = item(row, col);
-			if (current_item==nullptr) continue;
+			QString current_text = model_->data(model_->index(row, col)).toString();
+			if (current_text.isEmpty()) continue;
 
 			if (split_quality && col==qual_index)
 			{
 				QStringList quality_values;
 				for(int i=0; i<quality_keys.count(); ++i) quality_values.append("");
-				QStringList entries = current_item->text().split(';');
+				QStringList entries = current_text.split(';');
 				foreach(const QString& entry, entries)
 				{
 					QStringList key_value = entry.split('=');
@@ -1011,7 +747,7 @@ void VariantTable::copyToClipboard(bool split_quality, bool include_header_one_r
 			}
 			else
 			{
-				selected_text.append(current_item->text().replace('\n',' ').replace('\r', ""));
+				selected_text.append(current_text.replace('\n',' ').replace('\r', ""));
 			}
 		}
 	}
@@ -1043,6 +779,6 @@ void VariantTable::keyPressEvent(QKeyEvent* event)
 	}
 	else //default key-press event
 	{
-		QTableWidget::keyPressEvent(event);
+		QTableView::keyPressEvent(event);
 	}
 }
@@ -1,17 +1,18 @@
 #ifndef VARIANTTABLE_H
 #define VARIANTTABLE_H
 
-#include <QTableWidget>
+#include <QTableView>
 #include "GeneSet.h"
 #include "FilterCascade.h"
 #include "ReportSettings.h"
 #include "SomaticReportSettings.h"
 #include <QMenu>
 #include <QMetaMethod>
+#include "VariantTableModel.h"
 
-//GUI representation of (filtered) variant table
+//GUI representation of (filtered) variant table. Only the visible cells are rendered, i.e. there is no row limit.
 class VariantTable
-	: public QTableWidget
+	: public QTableView
 {
 	Q_OBJECT
 
@@ -19,9 +20,9 @@ public:
 	VariantTable(QWidget* parent);
 
 	///Update table
-	void update(VariantList& variants, const FilterResult& filter_result, const ReportSettings& report_settings, int max_variants);
+	void update(VariantList& variants, const FilterResult& filter_result, const ReportSettings& report_settings);
 	///Update table, determine report icons from SomaticReportSettings
-	void update(VariantList& variants, const FilterResult& filter_result, const SomaticReportSettings& report_settings, int max_variants);
+	void update(VariantList& variants, const FilterResult& filter_result, const SomaticReportSettings& report_settings);
 	///Update header icon (report config)
 	void updateVariantHeaderIcon(const ReportSettings& report_settings, int variant_index);
 	///Update header icon (SOMATIC report config)
@@ -35,18 +36,9 @@ public:
 
 	///Convert table row to variant index.
 	int rowToVariantIndex(int row) const;
-	///Convert variant index to table row (attention this can be slow because it is done by linear search).
+	///Convert variant index to table row. Throws an exception if the variant is not shown in the table.
 	int variantIndexToRow(int index) const;
 
-	///Creates table widget items, or nullptr if the text is empty.
-	QTableWidgetItem* createTableItem(const QString& text) const
-	{
-		//no text > no item (optimization for WGS - empty items are big and take a lot of RAM)
-		if (text.isEmpty()) return nullptr;
-
-		return new QTableWidgetItem(text);
-	}
-
 	///Add custom context menu actions
 	void addCustomContextMenuActions(QList<QAction*> actions);
 
@@ -82,6 +74,10 @@ public slots:
 	void updateActivePhenotypes(PhenotypeList phenotypes);
 
 signals:
+	///Selection changed
+	void itemSelectionChanged();
+	///Cell was double-clicked
+	void cellDoubleClicked(int row, int column);
 	///An added context menu action was triggered
 	void customActionTriggered(QAction* action, int var_index);
 	///Publish to Clinvar menu action triggered
@@ -94,13 +90,16 @@ signals:
 protected:
 
 	///This method provides generic functionality independent of ReportSettings/SomaticReportSettings
-	void updateTable(VariantList& variants, const FilterResult& filter_result, const QHash<int, bool>& index_show_report_icon, const QSet<int>& index_causal, int max_variants);
+	void updateTable(VariantList& variants, const FilterResult& filter_result, const QHash<int, bool>& index_show_report_icon, const QSet<int>& index_causal);
+	///Returns the index of the column with the given name, or -1 if it does not exist.
+	int columnIndex(const QString& name) const;
 
 	///Override copy command
 	void keyPressEvent(QKeyEvent* event) override;
 
 private:
 	VariantList* variants_;
+	VariantTableModel* model_;
 	QList<QAction*> registered_actions_;
 	PhenotypeList active_phenotypes_;
 };
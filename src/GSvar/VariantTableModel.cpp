@@ -0,0 +1,469 @@
+#include "VariantTableModel.h"
+#include "VariantTable.h"
+#include "GSvarHelper.h"
+#include "NGSHelper.h"
+#include "GeneSet.h"
+#include "Exceptions.h"
+#include <QBrush>
+#include <QFont>
+#include <cmath>
+#include <limits>
+
+VariantTableModel::VariantTableModel(QObject* parent)
+	: QAbstractTableModel(parent)
+	, variants_(nullptr)
+	, sort_column_(-1)
+	, sort_order_(Qt::AscendingOrder)
+{
+}
+
+void VariantTableModel::setVariants(const VariantList& variants, const FilterResult& filter_result, const QHash<int, bool>& index_show_report_icon, const QSet<int>& index_causal)
+{
+	beginResetModel();
+
+	variants_ = &variants;
+	report_show_ = index_show_report_icon;
+	report_causal_ = index_causal;
+
+	//rows
+	rows_.clear();
+	rows_.reserve(filter_result.countPassing());
+	for (int i=0; i<variants.count(); ++i)
+	{
+		if (filter_result.passing(i)) rows_ << i;
+	}
+	row_flags_.fill(NOT_DETERMINED, variants.count());
+	sortRows();
+	updateVariantRows();
+
+	//header
+	header_names_ = QStringList() << "chr" << "start" << "end" << "ref" << "obs";
+	header_tooltips_ = QStringList() << "Chromosome the variant is located on."
+									 << "Start position of the variant on the chromosome.\nFor insertions, the position of the base before the insertion is shown."
+									 << "End position of the variant on the chromosome.\nFor insertions, the position of the base before the insertion is shown."
+									 << "Reference bases in the reference genome at the variant position.\n`-` in case of an insertion."
+									 << "Alternate bases observed in the sample.\n`-` in case of an deletion.";
+	header_affected_.clear();
+	SampleHeaderInfo sample_data = variants.getSampleHeader();
+	for (int i=0; i<variants.annotations().count(); ++i)
+	{
+		QString anno = variants.annotations()[i].name();
+
+		//additional descriptions for filter column
+		QString add_desc = "";
+		if (anno=="filter")
+		{
+			auto it = variants.filters().cbegin();
+			while (it!=variants.filters().cend())
+			{
+				add_desc += "\n - "+it.key() + ": " + it.value();
+				++it;
+			}
+		}
+
+		//additional descriptions and color for genotype columns
+		foreach(const SampleInfo& info, sample_data)
+		{
+			if (info.name==anno)
+			{
+				auto it = info.properties.cbegin();
+				while(it != info.properties.cend())
+				{
+					add_desc += "\n - " + it.key() + ": " + it.value();
+
+					if (info.isAffected())
+					{
+						header_affected_ << i+5;
+					}
+
+					++it;
+				}
+			}
+		}
+
+		header_names_ << anno;
+		header_tooltips_ << variants.annotationDescriptionByName(anno, false).description() + add_desc;
+	}
+
+	//annotation indices
+	i_genes_ = variants.annotationIndexByName("gene", true, false);
+	i_co_sp_ = variants.annotationIndexByName("coding_and_splicing", true, false);
+	i_validation_ = variants.annotationIndexByName("validation", true, false);
+	i_classification_ = variants.annotationIndexByName("classification", true, false);
+	i_comment_ = variants.annotationIndexByName("comment", true, false);
+	i_ihdb_hom_ = variants.annotationIndexByName("NGSD_hom", true, false);
+	i_ihdb_het_ = variants.annotationIndexByName("NGSD_het", true, false);
+	i_clinvar_ = variants.annotationIndexByName("ClinVar", true, false);
+	i_hgmd_ = variants.annotationIndexByName("HGMD", true, false);
+	i_spliceai_ = variants.annotationIndexByName("SpliceAI", true, false);
+	i_maxentscan_ = variants.annotationIndexByName("MaxEntScan", true, false);
+
+	endResetModel();
+}
+
+void VariantTableModel::clear()
+{
+	beginResetModel();
+
+	variants_ = nullptr;
+	rows_.clear();
+	variant_rows_.clear();
+	header_names_.clear();
+	header_tooltips_.clear();
+	header_affected_.clear();
+	report_show_.clear();
+	report_causal_.clear();
+	row_flags_.clear();
+
+	endResetModel();
+}
+
+void VariantTableModel::setReportIcon(int variant_index, bool exists, bool show_in_report, bool causal)
+{
+	if (exists)
+	{
+		report_show_[variant_index] = show_in_report;
+	}
+	else
+	{
+		report_show_.remove(variant_index);
+	}
+	if (exists && causal)
+	{
+		report_causal_ << variant_index;
+	}
+	else
+	{
+		report_causal_.remove(variant_index);
+	}
+
+	int row = variantIndexToRow(variant_index);
+	if (row!=-1) emit headerDataChanged(Qt::Vertical, row, row);
+}
+
+int VariantTableModel::rowToVariantIndex(int row) const
+{
+	if (row<0 || row>=rows_.count()) THROW(ProgrammingException, "Variant table row '" + QString::number(row) + "' out of range!");
+
+	return rows_[row];
+}
+
+int VariantTableModel::variantIndexToRow(int index) const
+{
+	return variant_rows_.value(index, -1);
+}
+
+QString VariantTableModel::columnName(int column) const
+{
+	return header_names_.value(column);
+}
+
+int VariantTableModel::rowCount(const QModelIndex& parent) const
+{
+	if (parent.isValid()) return 0;
+
+	return rows_.count();
+}
+
+int VariantTableModel::columnCount(const QModelIndex& parent) const
+{
+	if (parent.isValid()) return 0;
+
+	return header_names_.count();
+}
+
+QVariant VariantTableModel::data(const QModelIndex& index, int role) const
+{
+	if (variants_==nullptr || !index.isValid()) return QVariant();
+
+	const int variant_index = rows_[index.row()];
+	const int column = index.column();
+	if (role==Qt::DisplayRole)
+	{
+		return QString(text(variant_index, column));
+	}
+	else if (role==Qt::BackgroundRole || role==Qt::ToolTipRole)
+	{
+		CellHighlight cell;
+		if (column==0)
+		{
+			if (!(*variants_)[variant_index].chr().isAutosome())
+			{
+				cell.background = Qt::yellow;
+				cell.tooltip = "Not autosome";
+			}
+		}
+		else if (column>=5)
+		{
+			cell = highlight(variant_index, column-5);
+		}
+
+		if (role==Qt::BackgroundRole && cell.background.isValid()) return QBrush(cell.background);
+		if (role==Qt::ToolTipRole && !cell.tooltip.isEmpty()) return cell.tooltip;
+	}
+
+	return QVariant();
+}
+
+QVariant VariantTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation==Qt::Horizontal)
+	{
+		if (section<0 || section>=header_names_.count()) return QVariant();
+
+		if (role==Qt::DisplayRole) return header_names_[section];
+		if (role==Qt::ToolTipRole) return header_tooltips_[section];
+		if (role==Qt::ForegroundRole && header_affected_.contains(section)) return QBrush(Qt::darkRed);
+	}
+	else
+	{
+		if (section<0 || section>=rows_.count()) return QVariant();
+		const int variant_index = rows_[section];
+
+		if (role==Qt::DisplayRole) return QString::number(variant_index+1);
+		if (role==Qt::UserRole) return variant_index;
+		if (role==Qt::DecorationRole && report_show_.contains(variant_index)) return VariantTable::reportIcon(report_show_[variant_index], report_causal_.contains(variant_index));
+
+		//warning (red), notice (orange)
+		if (role==Qt::ForegroundRole || role==Qt::FontRole)
+		{
+			int flags = rowFlags(variant_index);
+			if (flags&BENIGN || !(flags&(WARNING|NOTICE))) return QVariant();
+
+			if (role==Qt::ForegroundRole) return QBrush((flags&WARNING) ? QColor(Qt::red) : QColor(255, 135, 60));
+
+			QFont font;
+			font.setWeight(QFont::Bold);
+			return font;
+		}
+	}
+
+	return QVariant();
+}
+
+void VariantTableModel::sort(int column, Qt::SortOrder order)
+{
+	beginResetModel();
+	sort_column_ = column;
+	sort_order_ = order;
+	sortRows();
+	updateVariantRows();
+	endResetModel();
+}
+
+QByteArray VariantTableModel::text(int variant_index, int column) const
+{
+	const Variant& variant = (*variants_)[variant_index];
+	switch(column)
+	{
+		case 0:
+			return variant.chr().str();
+		case 1:
+			return QByteArray::number(variant.start());
+		case 2:
+			return QByteArray::number(variant.end());
+		case 3:
+			return variant.ref();
+		case 4:
+			return variant.obs();
+		default:
+			return variant.annotations()[column-5];
+	}
+}
+
+VariantTableModel::CellHighlight VariantTableModel::highlight(int variant_index, int j) const
+{
+	CellHighlight output;
+	const QByteArray& anno = (*variants_)[variant_index].annotations().at(j);
+
+	//warning
+	if (j==i_co_sp_ && anno.contains(":HIGH:"))
+	{
+		output.background = Qt::red;
+		output.row_flags |= WARNING;
+	}
+	else if (j==i_classification_ && (anno=="3" || anno=="M"))
+	{
+		output.background = QColor(255, 135, 60); //orange
+		output.row_flags |= NOTICE;
+	}
+	else if (j==i_classification_ && (anno=="4" || anno=="5"))
+	{
+		output.background = Qt::red;
+		output.row_flags |= WARNING;
+	}
+	else if (j==i_clinvar_ && anno.contains("pathogenic") && !anno.contains("conflicting interpretations of pathogenicity")) //matches "pathogenic" and "likely pathogenic"
+	{
+		output.background = Qt::red;
+		output.row_flags |= WARNING;
+	}
+	else if (j==i_hgmd_ && anno.contains("CLASS=DM")) //matches both "DM" and "DM?"
+	{
+		output.background = Qt::red;
+		output.row_flags |= WARNING;
+	}
+	else if (j==i_spliceai_ && NGSHelper::maxSpliceAiScore(anno) >= 0.8)
+	{
+		output.background = Qt::red;
+		output.row_flags |= NOTICE;
+	}
+	else if (j==i_spliceai_ && NGSHelper::maxSpliceAiScore(anno) >= 0.5)
+	{
+		output.background = QColor(255, 135, 60); //orange
+		output.row_flags |= NOTICE;
+	}
+	else if (j==i_maxentscan_ && !anno.isEmpty())
+	{
+		//iterate over predictions per transcript
+		QList<MaxEntScanImpact> impacts;
+		foreach(const QByteArray& entry, anno.split(','))
+		{
+			QByteArray anno_with_percentages;
+			impacts << NGSHelper::maxEntScanImpact(entry.split('/'), anno_with_percentages, false);
+		}
+
+		//output: max import
+		if (impacts.contains(MaxEntScanImpact::HIGH))
+		{
+			output.background = Qt::red;
+			output.row_flags |= NOTICE;
+		}
+		else if (impacts.contains(MaxEntScanImpact::MODERATE))
+		{
+			output.background = QColor(255, 135, 60); //orange
+			output.row_flags |= NOTICE;
+		}
+	}
+
+	//non-pathogenic
+	if (j==i_classification_ && (anno=="1" || anno=="2"))
+	{
+		output.background = Qt::green;
+		output.row_flags |= BENIGN;
+	}
+
+	//highlighed
+	if (j==i_validation_ && anno.contains("TP"))
+	{
+		output.background = Qt::yellow;
+	}
+	else if (j==i_comment_ && anno!="")
+	{
+		output.background = Qt::yellow;
+	}
+	else if (j==i_ihdb_hom_ && anno=="0")
+	{
+		output.background = Qt::yellow;
+	}
+	else if (j==i_ihdb_het_ && anno=="0")
+	{
+		output.background = Qt::yellow;
+	}
+	else if (j==i_clinvar_ && anno.contains("(confirmed)"))
+	{
+		output.background = Qt::yellow;
+	}
+	else if (j==i_genes_)
+	{
+		output.tooltip = GSvarHelper::geneToolTip(GeneSet::createFromText(anno, ','));
+		if (!output.tooltip.isEmpty()) output.background = Qt::yellow;
+	}
+
+	return output;
+}
+
+int VariantTableModel::rowFlags(int variant_index) const
+{
+	quint8& flags = row_flags_[variant_index];
+	if (flags==NOT_DETERMINED)
+	{
+		flags = 0;
+		foreach(int j, QList<int>() << i_co_sp_ << i_classification_ << i_clinvar_ << i_hgmd_ << i_spliceai_ << i_maxentscan_)
+		{
+			if (j!=-1) flags |= highlight(variant_index, j).row_flags;
+		}
+	}
+
+	return flags;
+}
+
+void VariantTableModel::sortRows()
+{
+	//original order
+	std::sort(rows_.begin(), rows_.end());
+	if (sort_column_<0 || variants_==nullptr) return;
+
+	const VariantList& variants = *variants_;
+	const bool asc = (sort_order_==Qt::AscendingOrder);
+	if (sort_column_==0)
+	{
+		std::stable_sort(rows_.begin(), rows_.end(), [&](int a, int b){ return asc ? variants[a].chr().num()<variants[b].chr().num() : variants[b].chr().num()<variants[a].chr().num(); });
+	}
+	else if (sort_column_==1)
+	{
+		std::stable_sort(rows_.begin(), rows_.end(), [&](int a, int b){ return asc ? variants[a].start()<variants[b].start() : variants[b].start()<variants[a].start(); });
+	}
+	else if (sort_column_==2)
+	{
+		std::stable_sort(rows_.begin(), rows_.end(), [&](int a, int b){ return asc ? variants[a].end()<variants[b].end() : variants[b].end()<variants[a].end(); });
+	}
+	else if (sort_column_==3)
+	{
+		std::stable_sort(rows_.begin(), rows_.end(), [&](int a, int b){ return asc ? variants[a].ref()<variants[b].ref() : variants[b].ref()<variants[a].ref(); });
+	}
+	else if (sort_column_==4)
+	{
+		std::stable_sort(rows_.begin(), rows_.end(), [&](int a, int b){ return asc ? variants[a].obs()<variants[b].obs() : variants[b].obs()<variants[a].obs(); });
+	}
+	else if (sort_column_-5 < variants.annotations().count())
+	{
+		const int j = sort_column_-5;
+
+		//numeric column: sort by number, empty entries last
+		QVector<QPair<double, int>> keys;
+		keys.reserve(rows_.count());
+		bool numeric = true;
+		foreach(int i, rows_)
+		{
+			const QByteArray& anno = variants[i].annotations()[j];
+			double value = std::numeric_limits<double>::quiet_NaN();
+			if (!anno.isEmpty())
+			{
+				bool ok = false;
+				value = anno.toDouble(&ok);
+				if (!ok)
+				{
+					numeric = false;
+					break;
+				}
+			}
+			keys << qMakePair(value, i);
+		}
+
+		if (numeric)
+		{
+			std::stable_sort(keys.begin(), keys.end(), [asc](const QPair<double, int>& a, const QPair<double, int>& b)
+			{
+				if (std::isnan(a.first) || std::isnan(b.first)) return !std::isnan(a.first) && std::isnan(b.first);
+				return asc ? a.first<b.first : b.first<a.first;
+			});
+			for (int r=0; r<keys.count(); ++r)
+			{
+				rows_[r] = keys[r].second;
+			}
+		}
+		else //text column: sort by text
+		{
+			std::stable_sort(rows_.begin(), rows_.end(), [&](int a, int b){ return asc ? variants[a].annotations()[j]<variants[b].annotations()[j] : variants[b].annotations()[j]<variants[a].annotations()[j]; });
+		}
+	}
+}
+
+void VariantTableModel::updateVariantRows()
+{
+	variant_rows_.fill(-1, variants_==nullptr ? 0 : variants_->count());
+	for (int r=0; r<rows_.count(); ++r)
+	{
+		variant_rows_[rows_[r]] = r;
+	}
+}
@@ -0,0 +1,95 @@
+#ifndef VARIANTTABLEMODEL_H
+#define VARIANTTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QColor>
+#include "VariantList.h"
+#include "FilterCascade.h"
+
+///Table model over a (filtered) variant list. Cell contents and colors are created on demand for the visible cells only.
+///Rows are mapped to variant indices by a compact index vector, i.e. the variant list is not copied and there is no row limit.
+class VariantTableModel
+	: public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	VariantTableModel(QObject* parent = nullptr);
+
+	///Sets the variants to show. The variant list must stay valid until the model is cleared or new variants are set.
+	void setVariants(const VariantList& variants, const FilterResult& filter_result, const QHash<int, bool>& index_show_report_icon, const QSet<int>& index_causal);
+	///Removes all variants.
+	void clear();
+	///Updates the report icon of a variant. If @p exists is false, the icon is removed.
+	void setReportIcon(int variant_index, bool exists, bool show_in_report, bool causal);
+
+	///Convert table row to variant index.
+	int rowToVariantIndex(int row) const;
+	///Convert variant index to table row, or -1 if the variant is not shown.
+	int variantIndexToRow(int index) const;
+	///Returns the column name.
+	QString columnName(int column) const;
+
+	int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+	///Sorts the rows by a column. Only the row index vector is re-ordered. Column -1 restores the original order.
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+protected:
+	///Row header flags (warning, notice, NGSD benign)
+	enum RowFlag
+	{
+		NOT_DETERMINED = 1,
+		WARNING = 2,
+		NOTICE = 4,
+		BENIGN = 8
+	};
+
+	///Cell highlighting
+	struct CellHighlight
+	{
+		QColor background;
+		QString tooltip;
+		int row_flags = 0;
+	};
+
+	const VariantList* variants_;
+	QVector<int> rows_; //variant index for each row
+	QVector<int> variant_rows_; //row for each variant index (-1 if not shown), updated whenever rows_ changes
+	QStringList header_names_;
+	QStringList header_tooltips_;
+	QSet<int> header_affected_;
+	QHash<int, bool> report_show_;
+	QSet<int> report_causal_;
+	mutable QVector<quint8> row_flags_; //row header flags by variant index (determined on demand)
+	int sort_column_;
+	Qt::SortOrder sort_order_;
+
+	//annotation indices of columns with highlighting
+	int i_genes_;
+	int i_co_sp_;
+	int i_validation_;
+	int i_classification_;
+	int i_comment_;
+	int i_ihdb_hom_;
+	int i_ihdb_het_;
+	int i_clinvar_;
+	int i_hgmd_;
+	int i_spliceai_;
+	int i_maxentscan_;
+
+	///Returns the display text of a cell.
+	QByteArray text(int variant_index, int column) const;
+	///Returns the highlighting of an annotation cell.
+	CellHighlight highlight(int variant_index, int anno_index) const;
+	///Returns the row header flags of a variant.
+	int rowFlags(int variant_index) const;
+	///Sorts the rows by the given column.
+	void sortRows();
+	///Updates the row of each variant index after the rows were changed.
+	void updateVariantRows();
+};
+
+#endif // VARIANTTABLEMODEL_H
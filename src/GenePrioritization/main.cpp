@@ -1,5 +1,5 @@
 #include "ToolBase.h"
-#include "Graph.h"
+#include "CsrGraph.h"
 #include "Exceptions.h"
 #include "Helper.h"
 #include <cmath>
@@ -8,35 +8,10 @@
 #include <QString>
 #include <QStringList>
 #include <QList>
-#include <QListIterator>
-#include <QHash>
+#include <QVector>
 #include <QSharedPointer>
 #include <random>
 
-struct NodeContent
-{
-    double score;
-    double score_change;
-    int visit_count;
-
-    NodeContent()
-        : score(0.0),
-          score_change(0.0),
-          visit_count(0)
-    {
-    }
-};
-
-struct EdgeContent
-{
-    double weight;
-
-    EdgeContent()
-        : weight(0.0)
-    {
-    }
-};
-
 class ConcreteTool
         : public ToolBase
 {
@@ -44,32 +19,55 @@ class ConcreteTool
 
 private:
     QList<QString> starting_nodes_;
+    QVector<bool> is_starting_node_;
+
+    // node scores (indexed by node ID)
+    QVector<double> score_;
+    QVector<double> score_change_;
+    QVector<int> visit_count_;
 
-    void sortGenesByScore(QList<Graph<NodeContent, EdgeContent>::NodePointer>& node_list)
+    QVector<int> sortGenesByScore(const CsrGraph& graph)
     {
         // round score for each node to 6 decimal places
-        Graph<NodeContent, EdgeContent>::NodePointer node;
-        foreach(node, node_list)
+        for(int i = 0; i < score_.size(); i++)
+        {
+            score_[i] = round(score_[i] * 1e6) / 1e6;
+        }
+
+        QVector<int> node_list(graph.nodeCount());
+        for(int i = 0; i < node_list.size(); i++)
         {
-            node.data()->nodeContent().score = round(node.data()->nodeContent().score * 1e6) / 1e6;
+            node_list[i] = i;
         }
 
         std::sort(node_list.begin(), node_list.end(),\
-                  [](const Graph<NodeContent, EdgeContent>::NodePointer& a, const Graph<NodeContent, EdgeContent>::NodePointer& b)\
+                  [&](int a, int b)\
                   {
-            if(a.data()->nodeContent().score == b.data()->nodeContent().score)
+            if(score_[a] == score_[b])
             {
-                return a.data()->nodeName() < b.data()->nodeName();
+                return graph.nodeName(a) < graph.nodeName(b);
             }
-            return a.data()->nodeContent().score > b.data()->nodeContent().score;});
+            return score_[a] > score_[b];});
+
+        return node_list;
     }
 
-    double getStartGenesAtTop(QList<Graph<NodeContent, EdgeContent>::NodePointer>& node_list)
+    QVector<int> getRanks(const QVector<int>& node_list)
+    {
+        QVector<int> ranks(node_list.size());
+        for(int i = 0; i < node_list.size(); i++)
+        {
+            ranks[node_list[i]] = i+1;
+        }
+        return ranks;
+    }
+
+    double getStartGenesAtTop(const QVector<int>& node_list)
     {
         int counter{0};
         for(int i = 0; i < starting_nodes_.size(); i++)
         {
-            if(starting_nodes_.contains(node_list.at(i).data()->nodeName()))
+            if(is_starting_node_[node_list.at(i)])
             {
                 counter++;
             }
@@ -77,25 +75,16 @@ private:
         return (double) counter / starting_nodes_.size();
     }
 
-    double getAverageRankDifference(const QHash<QString, int>& previous_ranks, const QHash<QString, int>& current_ranks)
+    double getAverageRankDifference(const QVector<int>& previous_ranks, const QVector<int>& current_ranks)
     {
         double average_rank_diff{0.0};
-        QHashIterator<QString, int> it(current_ranks);
-        while(it.hasNext())
+        for(int i = 0; i < current_ranks.size(); i++)
         {
-            it.next();
-            average_rank_diff += abs((it.value() - previous_ranks[it.key()]));
+            average_rank_diff += abs((current_ranks[i] - previous_ranks[i]));
         }
         return average_rank_diff / current_ranks.size();
     }
 
-    Graph<NodeContent, EdgeContent>::NodePointer updateProbability(int steps, const Graph<NodeContent, EdgeContent>::NodePointer& node)
-    {
-        node.data()->nodeContent().score = node.data()->nodeContent().score_change;
-        node.data()->nodeContent().score_change = (double) node.data()->nodeContent().visit_count / steps;
-        return node;
-    }
-
 public:
     ConcreteTool(int& argc, char *argv[])
         : ToolBase(argc, argv)
@@ -106,41 +95,25 @@ public:
     {
 		setDescription("Performs gene prioritization based on list of known disease genes of a disease and a PPI graph.");
 		addInfile("in", "Input TSV file with one gene identifier per line (known disease genes of a disease).", false);
-		addInfile("graph", "Graph TSV file with two gene identifiers per line (PPI graph).", false);
+		addInfile("graph", "Graph TSV file with two gene identifiers per line (PPI graph), or binary graph file created by GraphStringDb.", false);
 		addOutfile("out", "Output TSV file containing prioritized genes for the disease.", false);
         //optional
-		addEnum("method", "Gene prioritization method to use.", true, QStringList() << "flooding" << "random_walk", "flooding");
+		addEnum("method", "Gene prioritization method to use: 'flooding', 'random_walk' (simulated) or 'rwr' (random walk with restart computed by power iteration).", true, QStringList() << "flooding" << "random_walk" << "rwr", "flooding");
 		addInt("n", "Number of network diffusion iterations (flooding).", true, 2);
-		addFloat("restart", "Restart probability (random_walk).", true, 0.4);
+		addFloat("restart", "Restart probability (random_walk, rwr).", true, 0.4);
+		addInt("threads", "Number of threads used for the power iteration (rwr).", true, 1);
 		addOutfile("debug", "Output TSV file for debugging", true);
-    }
-
-    Graph<NodeContent, EdgeContent> parseGraph(const QString& graph_file)
-    {
-
-        Graph<NodeContent, EdgeContent> graph;
-
-        QSharedPointer<QFile> reader = Helper::openFileForReading(graph_file);
-        QTextStream in(reader.data());
 
-        while(!in.atEnd())
-        {
-            QStringList line = in.readLine().split("\t", QString::SkipEmptyParts);
-            if(line.size() == 2)
-            {
-                NodeContent node_content_1{};
-                NodeContent node_content_2{};
-                EdgeContent edge_content{};
-                edge_content.weight = 1.0;
-                graph.addEdge(line.at(0), node_content_1,\
-                              line.at(1), node_content_2, edge_content);
-            }
-        }
-        return graph;
+		changeLog(2026, 10, 17, "Added binary graph input, method 'rwr' and parameter 'threads'.");
     }
 
-    void scoreDiseaseGenes(Graph<NodeContent, EdgeContent>& graph, QString disease_genes_file)
+    void scoreDiseaseGenes(const CsrGraph& graph, QString disease_genes_file)
     {
+        score_.fill(0.0, graph.nodeCount());
+        score_change_.fill(0.0, graph.nodeCount());
+        visit_count_.fill(0, graph.nodeCount());
+        is_starting_node_.fill(false, graph.nodeCount());
+
         QFile file(disease_genes_file);
 
         if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -150,27 +123,29 @@ public:
 
         QTextStream in(&file);
 
-        // read file line by line, changing node content of the disease genes
+        // read file line by line, changing score of the disease genes
         while(!in.atEnd())
         {
             QStringList line = in.readLine().split("\t", QString::SkipEmptyParts);
 
-            if(graph.hasNode(line.at(0)))
+            int node = graph.nodeIndex(line.at(0));
+            if(node != -1)
             {
-                graph.getNode(line.at(0)).data()->nodeContent().score = 1.0;
+                score_[node] = 1.0;
+                is_starting_node_[node] = true;
                 starting_nodes_.append(line.at(0));
             }
         }
     }
 
-    void performFlooding(Graph<NodeContent, EdgeContent>& graph, int n_iter, const QString& debug_file)
+    void performFlooding(const CsrGraph& graph, int n_iter, const QString& debug_file)
     {
         bool debug = (debug_file != "");
 
         QSharedPointer<QFile> writer;
         QTextStream stream;
 
-        QHash<QString, int> previous_ranks;
+        QVector<int> previous_ranks;
 
         // generate debug file with information about rank differences between iterations
         if(debug)
@@ -180,12 +155,8 @@ public:
 
             stream << "iteration\taverage_rank_change\tstart_at_top" << endl;
 
-            QList<Graph<NodeContent, EdgeContent>::NodePointer> node_list = graph.adjacencyList().keys();
-            sortGenesByScore(node_list);
-            for(int i = 0; i < node_list.length(); i++)
-            {
-                previous_ranks.insert(node_list.at(i).data()->nodeName(), i+1);
-            }
+            QVector<int> node_list = sortGenesByScore(graph);
+            previous_ranks = getRanks(node_list);
 
             stream << 0 << "\tNaN\t" << getStartGenesAtTop(node_list) << endl;
         }
@@ -193,55 +164,35 @@ public:
         // perform flooding algorithm
         for(int i = 0; i < n_iter; i++)
         {
-            Graph<NodeContent, EdgeContent>::NodePointer node;
-            foreach(node, graph.adjacencyList().keys())
+            for(int node = 0; node < graph.nodeCount(); node++)
             {
-                double node_score = node.data()->nodeContent().score;
+                double node_score = score_[node];
 
                 if(node_score != 0.0)
                 {
-                    QList<Graph<NodeContent, EdgeContent>::EdgePointer> adjacent_edges = graph.adjacencyList()[node];
-                    Graph<NodeContent, EdgeContent>::EdgePointer edge;
-
-                    int degree = graph.getDegree(node.data()->nodeName());
+                    int degree = graph.degree(node);
+                    const qint32* neighbors = graph.neighbors(node);
 
                     // propagate the score to all adjacent nodes, relative to node degree
-                    foreach(edge, adjacent_edges)
+                    for(int k = 0; k < degree; k++)
                     {
-                        double increment = node_score / degree;
-
-                        if(edge.data()->node1() == node)
-                        {
-                            edge.data()->node2().data()->nodeContent().score_change += increment;
-                        }
-                        else if(edge.data()->node2() == node)
-                        {
-                            edge.data()->node1().data()->nodeContent().score_change += increment;
-                        }
+                        score_change_[neighbors[k]] += node_score / degree;
                     }
-
-                    // add the value that was propagated to surrounding nodes to the node itself
-                    // node.data()->nodeContent().score_increment += node_score;
                 }
             }
 
             // add the score increment to the node scores, relative to target node degree; reset increments
-            foreach (node, graph.adjacencyList().keys())
+            for(int node = 0; node < graph.nodeCount(); node++)
             {
-                node.data()->nodeContent().score += node.data()->nodeContent().score_change / sqrt(graph.getDegree(node.data()->nodeName()));
-                node.data()->nodeContent().score_change = 0.0;
+                score_[node] += score_change_[node] / sqrt(graph.degree(node));
+                score_change_[node] = 0.0;
             }
 
             // write average rank difference to debug file
             if(debug)
             {
-                QList<Graph<NodeContent, EdgeContent>::NodePointer> node_list = graph.adjacencyList().keys();
-                sortGenesByScore(node_list);
-                QHash<QString, int> current_ranks;
-                for(int j = 0; j < node_list.length(); j++)
-                {
-                    current_ranks.insert(node_list.at(j).data()->nodeName(), j+1);
-                }
+                QVector<int> node_list = sortGenesByScore(graph);
+                QVector<int> current_ranks = getRanks(node_list);
 
                 stream << i+1 << "\t" << getAverageRankDifference(current_ranks, previous_ranks) \
                        << "\t" << getStartGenesAtTop(node_list) << endl;
@@ -250,16 +201,16 @@ public:
         }
     }
 
-    void randomWalk(Graph<NodeContent, EdgeContent>& graph, double restart_probability, const QString& debug_file, int max_steps = 1000000)
+    void randomWalk(const CsrGraph& graph, double restart_probability, const QString& debug_file, int max_steps = 1000000)
     {
         std::default_random_engine generator;
         std::uniform_real_distribution<double> restart_distrib(0.0,1.0);
 
         std::uniform_int_distribution<int> start_nodes_distrib(0, starting_nodes_.size() - 1);
 
-        Graph<NodeContent, EdgeContent>::NodePointer current_node = graph.getNode(starting_nodes_.at(start_nodes_distrib(generator)));
-        current_node.data()->nodeContent().visit_count++;
-        current_node.data()->nodeContent().score_change = current_node.data()->nodeContent().visit_count;
+        int current_node = graph.nodeIndex(starting_nodes_.at(start_nodes_distrib(generator)));
+        visit_count_[current_node]++;
+        score_change_[current_node] = visit_count_[current_node];
 
         int steps{1};
         double vector_diff{1.0};
@@ -288,15 +239,14 @@ public:
 
             if(restart_distrib(generator) < restart_probability)
             {
-                current_node = graph.getNode(starting_nodes_.at(start_nodes_distrib(generator)));
+                current_node = graph.nodeIndex(starting_nodes_.at(start_nodes_distrib(generator)));
             }
             else
             {
-                QList<Graph<NodeContent, EdgeContent>::NodePointer> adjacent_nodes = graph.getAdjacentNodes(current_node.data()->nodeName());
-                std::uniform_int_distribution<int> adjacency_distrib(0, adjacent_nodes.size() - 1);
-                current_node = adjacent_nodes.at(adjacency_distrib(generator));
+                std::uniform_int_distribution<int> adjacency_distrib(0, graph.degree(current_node) - 1);
+                current_node = graph.neighbors(current_node)[adjacency_distrib(generator)];
             }
-            current_node.data()->nodeContent().visit_count++;
+            visit_count_[current_node]++;
 
             // update probabilities and calculate vector difference (L1 norm)
 
@@ -304,13 +254,11 @@ public:
             {
                 vector_diff = 0.0;
 
-                QListIterator<Graph<NodeContent, EdgeContent>::NodePointer> iter(graph.adjacencyList().keys());
-                while(iter.hasNext())
+                for(int node = 0; node < graph.nodeCount(); node++)
                 {
-                    Graph<NodeContent, EdgeContent>::NodePointer node = iter.next();
-                    node.data()->nodeContent().score = node.data()->nodeContent().score_change;
-                    node.data()->nodeContent().score_change = (double) node.data()->nodeContent().visit_count / steps;
-                    vector_diff += fabs(node.data()->nodeContent().score_change - node.data()->nodeContent().score);
+                    score_[node] = score_change_[node];
+                    score_change_[node] = (double) visit_count_[node] / steps;
+                    vector_diff += fabs(score_change_[node] - score_[node]);
                 }
 
                 vector_diff /= update_frequency;
@@ -325,15 +273,31 @@ public:
         } while((vector_diff > 1.0e-6) && (steps < max_steps));
 
         // obtain final score with penalization of high degrees
-        QListIterator<Graph<NodeContent, EdgeContent>::NodePointer> iter(graph.adjacencyList().keys());
-        while(iter.hasNext())
+        for(int node = 0; node < graph.nodeCount(); node++)
         {
-            Graph<NodeContent, EdgeContent>::NodePointer node = iter.next();
-            node.data()->nodeContent().score = node.data()->nodeContent().visit_count / sqrt(graph.getDegree(node.data()->nodeName()));
+            score_[node] = visit_count_[node] / sqrt(graph.degree(node));
         }
     }
 
-    void writeOutputTsv(Graph<NodeContent, EdgeContent>& graph, QString out_file)
+    void randomWalkWithRestart(const CsrGraph& graph, double restart_probability, int threads)
+    {
+        QVector<int> seeds;
+        foreach(const QString& name, starting_nodes_)
+        {
+            seeds << graph.nodeIndex(name);
+        }
+
+        // visiting probabilities are scaled to 1 million steps to make the scores comparable to 'random_walk'
+        QVector<double> probabilities = graph.randomWalkWithRestart(seeds, restart_probability, threads);
+
+        // obtain final score with penalization of high degrees
+        for(int node = 0; node < graph.nodeCount(); node++)
+        {
+            score_[node] = probabilities[node] * 1e6 / sqrt(graph.degree(node));
+        }
+    }
+
+    void writeOutputTsv(const CsrGraph& graph, QString out_file)
     {
         // output all nodes that have a score unequal zero to the output file
         QSharedPointer<QFile> writer = Helper::openFileForWriting(out_file);
@@ -341,15 +305,12 @@ public:
 
         stream << "node\tscore\tstarting_node\tdegree" << endl;
 
-        QList<Graph<NodeContent, EdgeContent>::NodePointer> node_list = graph.adjacencyList().keys();
-        sortGenesByScore(node_list);
-
-        Graph<NodeContent, EdgeContent>::NodePointer node;
-        foreach(node, node_list)
+        QVector<int> node_list = sortGenesByScore(graph);
+        foreach(int node, node_list)
         {
-            stream << node.data()->nodeName() << "\t" << node.data()->nodeContent().score\
-                   << "\t" << starting_nodes_.contains(node.data()->nodeName()) \
-                   << "\t" << graph.getDegree(node.data()->nodeName()) << endl;
+            stream << graph.nodeName(node) << "\t" << score_[node]\
+                   << "\t" << is_starting_node_[node] \
+                   << "\t" << graph.degree(node) << endl;
         }
     }
 
@@ -357,7 +318,12 @@ public:
     {
         // init
         QString method = getEnum("method");
-        Graph<NodeContent, EdgeContent> interaction_network = parseGraph(getInfile("graph"));
+        CsrGraph interaction_network;
+        interaction_network.load(getInfile("graph"));
+        if(interaction_network.directed())
+        {
+            THROW(ArgumentException, "Graph file '" + getInfile("graph") + "' contains a directed graph!");
+        }
 
         scoreDiseaseGenes(interaction_network, getInfile("in"));
 
@@ -365,6 +331,10 @@ public:
         {
             randomWalk(interaction_network, getFloat("restart"), getOutfile("debug"));
         }
+        else if(method == "rwr")
+        {
+            randomWalkWithRestart(interaction_network, getFloat("restart"), getInt("threads"));
+        }
         else if(method == "flooding")
         {
             performFlooding(interaction_network, getInt("n"), getOutfile("debug"));
@@ -381,4 +351,3 @@ int main(int argc, char *argv[])
     ConcreteTool tool(argc, argv);
     return tool.execute();
 }
-
@@ -0,0 +1,64 @@
+#include "ToolBase.h"
+#include "NGSHelper.h"
+#include "TranscriptDatabase.h"
+#include "Helper.h"
+#include "Exceptions.h"
+
+class ConcreteTool
+		: public ToolBase
+{
+	Q_OBJECT
+
+public:
+	ConcreteTool(int& argc, char *argv[])
+		: ToolBase(argc, argv)
+	{
+	}
+
+	virtual void setup()
+	{
+		setDescription("Converts a GFF file with transcripts to a binary transcript database.");
+		setExtendedDescription(QStringList() << "The transcript database can be used instead of the GFF file in VcfAnnotateConsequence, which makes loading the transcripts much faster." << "The database has to be re-created when the GFF file changes.");
+		addInfile("in", "Ensembl-style GFF file with transcripts, e.g. from https://ftp.ensembl.org/pub/release-112/gff3/homo_sapiens/Homo_sapiens.GRCh38.112.gff3.gz.", false);
+		addOutfile("out", "Output transcript database file.", false);
+
+		//optional
+		addFlag("all", "If set, all transcripts are imported. The default is to skip transcripts not labeled as 'GENCODE basic' for Ensembl and not with RefSeq/BestRefSeq origin for Refseq.");
+		addFlag("skip_not_hgnc", "Skip genes that do not have a HGNC identifier.");
+		addEnum("source", "GFF source.", true, QStringList() << "ensembl" << "refseq", "ensembl");
+
+		changeLog(2026, 10, 17, "Initial version.");
+	}
+
+	virtual void main()
+	{
+		//init
+		QString in = getInfile("in");
+		QString out = getOutfile("out");
+		QTextStream stream(stdout);
+		QTime timer;
+		timer.start();
+
+		//parse GFF file
+		GffSettings settings;
+		settings.source = getEnum("source");
+		settings.print_to_stdout = true;
+		settings.include_all = getFlag("all");
+		settings.skip_not_hgnc = getFlag("skip_not_hgnc");
+		GffData data = NGSHelper::loadGffFile(in, settings);
+		stream << "Parsing transcripts took: " << Helper::elapsedTime(timer) << endl;
+
+		//store database
+		timer.restart();
+		TranscriptDatabase::store(data, settings, out, in);
+		stream << "Writing transcript database took: " << Helper::elapsedTime(timer) << endl;
+	}
+};
+
+#include "main.moc"
+
+int main(int argc, char *argv[])
+{
+	ConcreteTool tool(argc, argv);
+	return tool.execute();
+}
@@ -1,5 +1,6 @@
 #include "ToolBase.h"
 #include "Graph.h"
+#include "CsrGraph.h"
 #include "StringDbParser.h"
 #include "Exceptions.h"
 #include "Helper.h"
@@ -53,6 +54,9 @@ public:
 		addOutfile("out", "Output TSV file with edges.", false);
         //optional
 		addFloat("min_score", "Minimum confidence score cutoff for String-DB interaction (0-1).", true, 0.4);
+		addOutfile("out_binary", "Output binary graph file (memory-mapped by GenePrioritization for fast loading).", true);
+
+		changeLog(2026, 10, 17, "Added binary graph output.");
     }
 
     virtual void main()
@@ -62,6 +66,14 @@ public:
         Graph<NodeContent, EdgeContent> interaction_network = string_parser.interactionNetwork();
 
         interaction_network.store(getOutfile("out"));
+
+        QString out_binary = getOutfile("out_binary");
+        if(out_binary != "")
+        {
+            CsrGraph csr_graph;
+            csr_graph.create(interaction_network.sortedEdgeList());
+            csr_graph.store(out_binary);
+        }
     }
 };
 
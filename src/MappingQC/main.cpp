@@ -37,8 +37,10 @@ public:
 		addInfile("somatic_custom_bed", "Somatic custom region of interest (subpanel of actual roi). If specified, additional depth metrics will be calculated.", true, true);
 		addOutfile("read_qc", "If set, a read QC file in qcML format is created (just like ReadQC/SeqPurge).", true);
 		addFlag("long_read", "Support long reads (> 1kb).");
+		addInt("threads", "The number of threads used for BAM/CRAM compression and decompression.", true, 1);
 
 		//changelog
+		changeLog(2026, 10, 17, "Added 'threads' parameter for multi-threaded BAM/CRAM compression/decompression.");
 		changeLog(2023, 11,  8, "Added long_read support.");
 		changeLog(2023,  5, 12, "Added 'read_qc' parameter.");
 		changeLog(2022,  5, 25, "Added new QC metrics to WGS mode.");
@@ -63,6 +65,7 @@ public:
 		int min_mapq = getInt("min_mapq");
 		bool debug = getFlag("debug");
 		bool long_read = getFlag("long_read");
+		HtsThreadPool::setThreads(getInt("threads"));
 		QTextStream debug_stream(stdout);
 
 		// check that just one of roi_file, wgs, rna is set
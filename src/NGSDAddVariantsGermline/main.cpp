@@ -32,10 +32,12 @@ public:
 		addFlag("force", "Force import of variants, even if they are already imported.");
 		addOutfile("out", "Output file. If unset, writes to STDOUT.", true);
 		addFloat("max_af", "Maximum allele frequency of small variants to import (gnomAD).", true, 0.05);
+		addInt("batch_size", "Number of small variants that are imported with one query. If 0, small variants are imported one by one (slow, for comparison of import times only).", true, 1000);
 		addFlag("test", "Uses the test database instead of on the production database.");
 		addFlag("debug", "Enable verbose debug output.");
 		addFlag("no_time", "Disable timing output.");
 
+		changeLog(2026, 10, 17, "Added batched import of small variants (parameter 'batch_size'). The timing output now contains the imported rows per second.");
 		changeLog(2024,  8, 28, "Merged all force parameters into one. Implmented skipping of small variants import if the same callset was already imported.");
 		changeLog(2021,  7, 19, "Added support for 'CADD' and 'SpliceAI' columns in 'variant' table.");
 	}
@@ -86,9 +88,11 @@ public:
 		sub_timer.start();
 		int c_add, c_update;
 		double max_af = getFloat("max_af");
-		QList<int> variant_ids = db.addVariants(variants, max_af, c_add, c_update);
+		int batch_size = getInt("batch_size");
+		if (batch_size<0) THROW(ArgumentException, "Invalid batch size " + QString::number(batch_size) + "!");
+		QList<int> variant_ids = batch_size==0 ? db.addVariants(variants, max_af, c_add, c_update) : db.addVariantsBatched(variants, max_af, c_add, c_update, batch_size);
 		out << "Imported variants (added:" << c_add << " updated:" << c_update << ")" << endl;
-		sub_times << ("adding variants took: " + Helper::elapsedTime(sub_timer));
+		sub_times << ("adding variants took: " + NGSD::elapsedTimeAndRate(sub_timer, variants.count()));
 
 		//skip import of detected variants if same callset was already imported
 		VariantCaller caller = variants.getCaller();
@@ -164,26 +168,55 @@ public:
 		//add detected variants
 		sub_timer.start();
 		int i_geno = variants.getSampleHeader().infoByID(ps_name).column_index;
-		SqlQuery q_insert = db.getQuery();
-		q_insert.prepare("INSERT INTO detected_variant (processed_sample_id, variant_id, genotype, mosaic) VALUES (" + ps_id + ", :0, :1, :2)");
+		int c_skipped = variant_ids.count(-1);
 		db.transaction();
-		for (int i=0; i<variants.count(); ++i)
+		if (batch_size==0)
 		{
-			//skip high-AF variants or too long variants
-			int variant_id = variant_ids[i];
-			if (variant_id==-1) continue;
-
-			//bind
-			q_insert.bindValue(0, variant_id);
-			q_insert.bindValue(1, variants[i].annotations()[i_geno]);
-			q_insert.bindValue(2, variants[i].filters().contains("mosaic"));
-			q_insert.exec();
+			SqlQuery q_insert = db.getQuery();
+			q_insert.prepare("INSERT INTO detected_variant (processed_sample_id, variant_id, genotype, mosaic) VALUES (" + ps_id + ", :0, :1, :2)");
+			for (int i=0; i<variants.count(); ++i)
+			{
+				//skip high-AF variants or too long variants
+				int variant_id = variant_ids[i];
+				if (variant_id==-1) continue;
+
+				//bind
+				q_insert.bindValue(0, variant_id);
+				q_insert.bindValue(1, variants[i].annotations()[i_geno]);
+				q_insert.bindValue(2, variants[i].filters().contains("mosaic"));
+				q_insert.exec();
+			}
+		}
+		else
+		{
+			QList<int> indices;
+			for (int i=0; i<variants.count(); ++i)
+			{
+				//skip high-AF variants or too long variants
+				if (variant_ids[i]!=-1) indices << i;
+			}
+
+			for (int b=0; b<indices.count(); b+=batch_size)
+			{
+				QList<int> batch = indices.mid(b, batch_size);
+				QStringList placeholders;
+				for (int j=0; j<batch.count(); ++j) placeholders << "(" + ps_id + ",?,?,?)";
+
+				SqlQuery q_insert = db.getQuery();
+				q_insert.prepare("INSERT INTO detected_variant (processed_sample_id, variant_id, genotype, mosaic) VALUES " + placeholders.join(","));
+				foreach(int i, batch)
+				{
+					q_insert.addBindValue(variant_ids[i]);
+					q_insert.addBindValue(variants[i].annotations()[i_geno]);
+					q_insert.addBindValue(variants[i].filters().contains("mosaic"));
+				}
+				q_insert.exec();
+			}
 		}
 		db.commit();
-		sub_times << ("adding detected variants took: " + Helper::elapsedTime(sub_timer));
+		sub_times << ("adding detected variants took: " + NGSD::elapsedTimeAndRate(sub_timer, variant_ids.count()-c_skipped));
 
 		//output
-		int c_skipped = variant_ids.count(-1);
 		out << "Imported " << (variant_ids.count()-c_skipped) << " detected variants" << endl;
 		if (debug)
 		{
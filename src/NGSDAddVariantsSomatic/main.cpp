@@ -31,9 +31,12 @@ public:
 		addInfile("sv", "SV list in TSV format (as produced by megSAP).", true, true);
 		addFlag("sv_force", "Force import of SVs, even if already imported.");
 		addOutfile("out", "Output file. If unset, writes to STDOUT.", true);
+		addInt("batch_size", "Number of small variants that are imported with one query. If 0, small variants are imported one by one (slow, for comparison of import times only).", true, 1000);
 		addFlag("test", "Uses the test database instead of on the production database.");
 		addFlag("debug", "Enable verbose debug output.");
 		addFlag("no_time", "Disable timing output.");
+
+		changeLog(2026, 10, 17, "Added batched import of small variants (parameter 'batch_size'). The timing output now contains the imported rows per second.");
 	}
 
 	//import SNVs/INDELs from tumor-normal GSVar file
@@ -102,9 +105,11 @@ public:
 
 
 		int c_add, c_update;
-		QList<int> variant_ids = db.addVariants(variants, 1.0, c_add, c_update);
+		int batch_size = getInt("batch_size");
+		if (batch_size<0) THROW(ArgumentException, "Invalid batch size " + QString::number(batch_size) + "!");
+		QList<int> variant_ids = batch_size==0 ? db.addVariants(variants, 1.0, c_add, c_update) : db.addVariantsBatched(variants, 1.0, c_add, c_update, batch_size);
 		out << "Imported variants (added:" << c_add << " updated:" << c_update << ")" << endl;
-		sub_times << ("adding variants took: " + Helper::elapsedTime(sub_timer));
+		sub_times << ("adding variants took: " + NGSD::elapsedTimeAndRate(sub_timer, variants.count()));
 
 		//add detected somatic variants
 		sub_timer.start();
@@ -113,20 +118,42 @@ public:
 		int i_frq = variants.annotationIndexByName("tumor_af");
 		int i_qual = variants.annotationIndexByName("quality");
 
-		SqlQuery q_insert = db.getQuery();
-		q_insert.prepare("INSERT INTO detected_somatic_variant (processed_sample_id_tumor, processed_sample_id_normal, variant_id, variant_frequency, depth, quality_snp) VALUES (" + t_ps_id +", "+ n_ps_id +", :0, :1, :2, :3)");
-
 		db.transaction();
-		for(int i=0; i<variants.count(); ++i)
+		if (batch_size==0)
+		{
+			SqlQuery q_insert = db.getQuery();
+			q_insert.prepare("INSERT INTO detected_somatic_variant (processed_sample_id_tumor, processed_sample_id_normal, variant_id, variant_frequency, depth, quality_snp) VALUES (" + t_ps_id +", "+ n_ps_id +", :0, :1, :2, :3)");
+			for(int i=0; i<variants.count(); ++i)
+			{
+				q_insert.bindValue(0, variant_ids[i]);
+				q_insert.bindValue(1, variants[i].annotations()[i_frq]);
+				q_insert.bindValue(2, variants[i].annotations()[i_depth]);
+				q_insert.bindValue(3, variantQuality(variants[i], i_qual));
+				q_insert.exec();
+			}
+		}
+		else
 		{
-			q_insert.bindValue(0, variant_ids[i]);
-			q_insert.bindValue(1, variants[i].annotations()[i_frq]);
-			q_insert.bindValue(2, variants[i].annotations()[i_depth]);
-			q_insert.bindValue(3, variantQuality(variants[i], i_qual));
-			q_insert.exec();
+			for(int b=0; b<variants.count(); b+=batch_size)
+			{
+				int b_end = std::min(b+batch_size, variants.count());
+				QStringList placeholders;
+				for(int i=b; i<b_end; ++i) placeholders << "(" + t_ps_id + ", " + n_ps_id + ",?,?,?,?)";
+
+				SqlQuery q_insert = db.getQuery();
+				q_insert.prepare("INSERT INTO detected_somatic_variant (processed_sample_id_tumor, processed_sample_id_normal, variant_id, variant_frequency, depth, quality_snp) VALUES " + placeholders.join(","));
+				for(int i=b; i<b_end; ++i)
+				{
+					q_insert.addBindValue(variant_ids[i]);
+					q_insert.addBindValue(variants[i].annotations()[i_frq]);
+					q_insert.addBindValue(variants[i].annotations()[i_depth]);
+					q_insert.addBindValue(variantQuality(variants[i], i_qual));
+				}
+				q_insert.exec();
+			}
 		}
 		db.commit();
-		sub_times << ("Adding detected somatic variants took: " + Helper::elapsedTime(sub_timer));
+		sub_times << ("Adding detected somatic variants took: " + NGSD::elapsedTimeAndRate(sub_timer, variants.count()));
 
 		if(!no_time)
 		{
@@ -28,6 +28,7 @@ public:
 		addFlag("test", "Uses the test database instead of on the production database.");
 		addFlag("force", "If set, overwrites old data.");
 
+		changeLog(2026, 10, 17, "Added storing of the transcript import timestamp in table 'db_info'.");
 		changeLog(2023,  3, 22, "Removed parameters 'ensembl_canonical' and 'mane' as the information is now contained in the Ensembl GFF3 file.");
 		changeLog(2022, 10, 17, "Added transcript versions.");
 		changeLog(2022,  5, 29, "Added parameters 'ensembl_canonical' and 'mane'.");
@@ -423,6 +424,16 @@ public:
 			importPseudogenes(db, data.enst2ensg, data.ensg2symbol, file_path);
 		}
 
+		//store transcript import timestamp (used as key for the transcript snapshot that speeds up the transcript cache initialization)
+		if (db.tableExists("db_info", false) && db.getEnum("db_info", "name").contains("transcripts_timestamp"))
+		{
+			db.getQuery().exec("INSERT INTO db_info SET name='transcripts_timestamp', value='" + QDateTime::currentDateTime().toString(Qt::ISODate) + "' ON DUPLICATE KEY UPDATE value=VALUES(value)");
+		}
+		else
+		{
+			out << "Notice: Table 'db_info' does not support the entry 'transcripts_timestamp' - NGSD transcript snapshots are disabled!" << endl;
+		}
+
 		//statistics output
 		out << "Imported " << db.getValue("SELECT count(*) FROM gene_transcript").toInt() << " transcripts into NGSD" << endl;
 		statistics(db, out, true, gene2ensg);
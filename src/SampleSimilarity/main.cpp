@@ -38,9 +38,11 @@ public:
 		addEnum("build", "Genome build used to generate the input (BAM mode).", true, QStringList() << "hg19" << "hg38", "hg38");
 		addInfile("ref", "Reference genome for CRAM support (mandatory if CRAM is used).", true);
 		addFlag("include_single_end_reads", "In bam mode: include reads which are not (properly) paired. Required e.g. for long-read input data.");
+		addInt("threads", "The number of threads used for the similarity calculation.", true, 1);
 		addFlag("debug", "Print debug output.");
 
 		//changelog
+		changeLog(2026, 10, 17, "Added 'threads' parameter and faster all-vs-all calculation for large cohorts.");
 		changeLog(2023, 12, 22, "Added 'roi_hg38_wes_wgs' flag.");
 		changeLog(2022,  7,  7, "Changed BAM mode: max_snps is now 5000 by default because this results in a better separation of related and unrelated samples.");
 		changeLog(2022,  6, 30, "Changed GSvar mode: MODIFIER impact variants are now ingnored to make scores more similar between exomes and genomes.");
@@ -69,6 +71,7 @@ public:
 		bool roi_hg38_wes_wgs = getFlag("roi_hg38_wes_wgs");
 		bool include_gonosomes = getFlag("include_gonosomes");
 		GenomeBuild build = stringToBuild(getEnum("build"));
+		int threads = getInt("threads");
 		bool debug = getFlag("debug");
 		QTime timer;
 		timer.start();
@@ -101,7 +104,7 @@ public:
 
 		//load genotype data
 		QList<SampleSimilarity::VariantGenotypes> genotype_data;
-
+		QStringList files;
 		foreach(QString filename, in)
 		{
 			if (!QFile::exists(filename))
@@ -109,6 +112,7 @@ public:
 				out << "##skipped missing file " << filename << endl;
 				continue;
 			}
+			files << filename;
 			if (mode=="vcf")
 			{
 				genotype_data << (roi_reg.count()>0 ? SampleSimilarity::genotypesFromVcf(filename, include_gonosomes, true, roi_reg) : SampleSimilarity::genotypesFromVcf(filename, include_gonosomes, true));
@@ -129,36 +133,47 @@ public:
 			}
 		}
 
-		//process
-		for (int i=0; i<in.count(); ++i)
+		//create shared site index and genotype vectors
+		SampleSimilarityCohort cohort(genotype_data);
+		genotype_data.clear();
+		if (debug)
 		{
-			for (int j=i+1; j<in.count(); ++j)
-			{
-				SampleSimilarity sc;
-				QStringList cols;
-				cols << QFileInfo(in[i]).fileName();
-				cols << QFileInfo(in[j]).fileName();
-				if (mode=="vcf" || mode=="gsvar")
-				{
-					sc.calculateSimilarity(genotype_data[i], genotype_data[j]);
+			out << "##created " << (cohort.isPacked() ? "packed" : "sparse") << " genotype vectors with " << cohort.siteCount() << " shared sites (took: " << Helper::elapsedTime(timer, true) << ")" << endl;
+			timer.restart();
+		}
 
-					cols << QString::number(sc.olPerc(), 'f', 2);
-					cols << QString::number(sc.sampleCorrelation(), 'f', 4);
-					cols << QString::number(sc.ibs2Perc(), 'f', 2);
-					cols << QString::number(sc.noVariants1());
-					cols << QString::number(sc.noVariants2());
-				}
-				else
+		//process (in blocks of rows to limit the memory used for results)
+		const int block_rows = 64;
+		for (int start=0; start<files.count(); start+=block_rows)
+		{
+			QVector<SampleSimilarity> results = cohort.calculateSimilarityRows(start, start + block_rows, threads);
+			int r = 0;
+			for (int i=start; i<std::min(start + block_rows, files.count()); ++i)
+			{
+				for (int j=i+1; j<files.count(); ++j)
 				{
-					sc.calculateSimilarity(genotype_data[i], genotype_data[j]);
-
-					cols << QString::number(sc.olCount());
-					cols << QString::number(sc.sampleCorrelation(), 'f', 4);
-					cols << QString::number(sc.ibs0Perc(), 'f', 2);
-					cols << QString::number(sc.ibs2Perc(), 'f', 2);
+					SampleSimilarity& sc = results[r++];
+					QStringList cols;
+					cols << QFileInfo(files[i]).fileName();
+					cols << QFileInfo(files[j]).fileName();
+					if (mode=="vcf" || mode=="gsvar")
+					{
+						cols << QString::number(sc.olPerc(), 'f', 2);
+						cols << QString::number(sc.sampleCorrelation(), 'f', 4);
+						cols << QString::number(sc.ibs2Perc(), 'f', 2);
+						cols << QString::number(sc.noVariants1());
+						cols << QString::number(sc.noVariants2());
+					}
+					else
+					{
+						cols << QString::number(sc.olCount());
+						cols << QString::number(sc.sampleCorrelation(), 'f', 4);
+						cols << QString::number(sc.ibs0Perc(), 'f', 2);
+						cols << QString::number(sc.ibs2Perc(), 'f', 2);
+					}
+					cols << sc.messages().join(", ");
+					out << cols.join("\t") << endl;
 				}
-				cols << sc.messages().join(", ");
-				out << cols.join("\t") << endl;
 			}
 		}
 		if (debug)
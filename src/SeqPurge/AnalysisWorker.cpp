@@ -2,6 +2,7 @@
 #include "cmath"
 #include "NGSHelper.h"
 #include "BasicStatistics.h"
+#include "MatchCounter.h"
 
 AnalysisWorker::AnalysisWorker(AnalysisJob& job, TrimmingParameters& params, TrimmingStatistics& stats, ErrorCorrectionStatistics& ecstats)
 	: QObject()
@@ -149,27 +150,10 @@ void AnalysisWorker::run()
 				//              the base comparisons we would actually have to make.
 				int max_mismatches = (int)(std::ceil((1.0-params_.match_perc/100.0) * (min_length-offset)));
 
-				int matches = 0;
-				int mismatches = 0;
-				int invalid = 0;
-				for (int j=offset; j<min_length; ++j)
-				{
-					char b1 = seq1_data[j-offset];
-					char b2 = seq2_data[j];
-					if (b1=='N' || b2=='N')
-					{
-						++invalid;
-					}
-					else if (b1==b2)
-					{
-						++matches;
-					}
-					else
-					{
-						++mismatches;
-						if (mismatches>max_mismatches) break;
-					}
-				}
+				MatchCounts counts;
+				MatchCounter::count(seq1_data, seq2_data + offset, min_length - offset, counts, max_mismatches);
+				int matches = counts.matches;
+				int mismatches = counts.mismatches;
 				//debug_out << offset << matches << mismatches << (100.0*matches/(matches + mismatches)) << endl;
 
 				if ((matches + mismatches)==0 || 100.0*matches/(matches + mismatches) < params_.match_perc) continue;
@@ -186,52 +170,16 @@ void AnalysisWorker::run()
 
 				//check that at least on one side the adapter is present - if not continue
 				QByteArray adapter1 = seq1.mid(job_.length_r2_orig[r]-offset, params_.adapter_overlap);
-				int a1_matches = 0;
-				int a1_mismatches = 0;
-				int a1_invalid = 0;
-				for (int i=0; i<adapter1.count(); ++i)
-				{
-					//forward
-					char b1 = adapter1.constData()[i];
-					char b2 = params_.a1.constData()[i];
-
-					if (b1=='N' || b2=='N')
-					{
-						++a1_invalid;
-					}
-					else if (b1==b2)
-					{
-						++a1_matches;
-					}
-					else
-					{
-						++a1_mismatches;
-					}
-				}
+				MatchCounts a1_counts;
+				MatchCounter::count(adapter1.constData(), params_.a1.constData(), adapter1.count(), a1_counts);
+				int a1_matches = a1_counts.matches;
+				int a1_mismatches = a1_counts.mismatches;
 
 				QByteArray adapter2 = seq2.left(offset).toReverseComplement().left(params_.adapter_overlap);
-				int a2_matches = 0;
-				int a2_mismatches = 0;
-				int a2_invalid = 0;
-				for (int i=0; i<adapter2.count(); ++i)
-				{
-					//forward
-					char b1 = adapter2.constData()[i];
-					char b2 = params_.a2.constData()[i];
-
-					if (b1=='N' || b2=='N')
-					{
-						++a2_invalid;
-					}
-					else if (b1==b2)
-					{
-						++a2_matches;
-					}
-					else
-					{
-						++a2_mismatches;
-					}
-				}
+				MatchCounts a2_counts;
+				MatchCounter::count(adapter2.constData(), params_.a2.constData(), adapter2.count(), a2_counts);
+				int a2_matches = a2_counts.matches;
+				int a2_mismatches = a2_counts.mismatches;
 
 				if (offset<10) //when the adapter fragment is short => check only number of mismatches
 				{
@@ -313,30 +261,11 @@ void AnalysisWorker::run()
 				const char* a1_data = params_.a1.constData();
 				for (int offset=0; offset<job_.length_r1_orig[r]; ++offset)
 				{
-					int matches = 0;
-					int mismatches = 0;
-					int invalid = 0;
-					for (int i=0; i<params_.a_size; ++i)
-					{
-						if (offset+i>=job_.length_r1_orig[r]) break;
-
-						//forward
-						char b1 = seq1_data[offset+i];
-						char b2 = a1_data[i];
-
-						if (b1=='N' || b2=='N')
-						{
-							++invalid;
-						}
-						else if (b1==b2)
-						{
-							++matches;
-						}
-						else
-						{
-							++mismatches;
-						}
-					}
+					MatchCounts counts;
+					MatchCounter::count(seq1_data + offset, a1_data, std::min(params_.a_size, job_.length_r1_orig[r] - offset), counts);
+					int matches = counts.matches;
+					int mismatches = counts.mismatches;
+					int invalid = counts.invalid;
 					if (100.0*matches/(matches+mismatches) < params_.match_perc) continue;
 					double p = BasicStatistics::matchProbability(0.25, matches, matches+mismatches);
 					if (p>params_.mep) continue;
@@ -364,31 +293,11 @@ void AnalysisWorker::run()
 				const char* a2_data = params_.a2.constData();
 				for (int offset=0; offset<job_.length_r2_orig[r]; ++offset)
 				{
-					int matches = 0;
-					int mismatches = 0;
-					int invalid = 0;
-					for (int i=0; i<params_.a_size; ++i)
-					{
-						if (offset+i>=job_.length_r2_orig[r]) break;
-
-						//forward
-						char b1 = seq2_data[offset+i];
-						char b2 = a2_data[i];
-
-						if (b1=='N' || b2=='N')
-						{
-							++invalid;
-						}
-						else if (b1==b2)
-						{
-							++matches;
-						}
-						else
-						{
-							++mismatches;
-						}
-					}
-
+					MatchCounts counts;
+					MatchCounter::count(seq2_data + offset, a2_data, std::min(params_.a_size, job_.length_r2_orig[r] - offset), counts);
+					int matches = counts.matches;
+					int mismatches = counts.mismatches;
+					int invalid = counts.invalid;
 					if (100.0*matches/(matches+mismatches) < params_.match_perc) continue;
 					double p = BasicStatistics::matchProbability(0.25, matches, matches+mismatches);
 					if (p>params_.mep) continue;
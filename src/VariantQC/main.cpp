@@ -23,8 +23,10 @@ public:
 		addFlag("txt", "Writes TXT format instead of qcML.");
 		addFlag("long_read", "Adds LongRead specific QC values (e.g. phasing information)");
 		addOutfile("phasing_bed", "Output BED file containing phasing blocks with id. (requires parameter '-longread')", true);
+		addInt("threads", "The number of threads used to decompress and parse the VCF file.", true, 1);
 
 		//changelog
+		changeLog(2026, 10, 17, "Added 'threads' parameter for parallel loading of the VCF file.");
 		changeLog(2023,  9, 21, "Added parameter 'longread' to add longread specific QC values.");
 		changeLog(2020,  8,  7, "VCF files only as input format for variant list.");
 		changeLog(2018,  9, 12, "Now supports VEP CSQ annotations (no longer support SnpEff ANN annotations).");
@@ -36,7 +38,7 @@ public:
 		//load variant list
         VcfFile vl;
 		QString filename = getInfile("in");
-		vl.load(filename);
+		vl.load(filename, true, getInt("threads"));
 
 		//calculate metrics
 		QCCollection metrics = Statistics::variantList(vl, !getFlag("ignore_filter"));
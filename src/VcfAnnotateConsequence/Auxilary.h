@@ -3,6 +3,9 @@
 
 #include "Transcript.h"
 #include "VariantHgvsAnnotator.h"
+#include "FastaFileIndex.h"
+#include "ChromosomalIndex.h"
+#include <QSharedPointer>
 
 
 //Tool parameters
@@ -34,14 +37,18 @@ struct AnalysisJob
 struct MetaData
 {
 	const QByteArray tag;
-	const QString reference;
-	const TranscriptList transcripts;
+	const QSharedPointer<FastaFileIndex> reference; //thread-safe > shared by all worker threads
+	const QSharedPointer<const TranscriptList> transcripts; //read-only > shared by all worker threads
+	const QSharedPointer<const ChromosomalIndex<TranscriptList>> transcript_index; //created once, read-only > shared by all worker threads
+	const QSharedPointer<TranscriptSequenceCache> sequence_cache; //thread-safe > shared by all worker threads
 	VariantHgvsAnnotator::Parameters annotation_parameters;
 
-	MetaData(const QByteArray tag, const QString reference, TranscriptList transcripts)
+	MetaData(const QByteArray tag, QSharedPointer<FastaFileIndex> reference, const TranscriptList& transcripts)
 		: tag(tag)
 		, reference(reference)
-		, transcripts(transcripts)
+		, transcripts(new TranscriptList(transcripts))
+		, transcript_index(new ChromosomalIndex<TranscriptList>(*this->transcripts))
+		, sequence_cache(new TranscriptSequenceCache())
 	{
 	}
 };
@@ -15,8 +15,7 @@ ChunkProcessor::ChunkProcessor(AnalysisJob &job, const MetaData& settings, const
 	, job_(job)
 	, settings_(settings)
 	, params_(params)
-	, reference_(settings.reference)
-	, hgvs_anno_(reference_, settings_.annotation_parameters)
+	, hgvs_anno_(*settings.reference, settings_.annotation_parameters, settings_.sequence_cache)
 {
 	if (params_.debug) QTextStream(stdout) << "ChunkProcessor(): " << job_.index << endl;
 }
@@ -29,7 +28,6 @@ ChunkProcessor::~ChunkProcessor()
 // single chunks are processed
 void ChunkProcessor::run()
 {
-	ChromosomalIndex<TranscriptList> transcript_index(settings_.transcripts);
 	if (params_.debug) QTextStream(stdout) << "ChunkProcessor::run() " << job_.index << endl;
 	try
 	{
@@ -59,7 +57,7 @@ void ChunkProcessor::run()
 			}
 
 			//get annotation data
-			lines_new << annotateVcfLine(line, transcript_index);
+			lines_new << annotateVcfLine(line, *settings_.transcript_index);
 		}
 
 		job_.lines = lines_new;
@@ -119,7 +117,7 @@ QByteArray ChunkProcessor::annotateVcfLine(const QByteArray& line, const Chromos
 	//hgvs annotation for each transcript in proximity to variant
 	foreach(int idx, indices)
 	{
-		const Transcript& t = settings_.transcripts.at(idx);
+		const Transcript& t = settings_.transcripts->at(idx);
 
 		VcfLine variant = VcfLine(chr, pos, ref, QList<Sequence>());
 
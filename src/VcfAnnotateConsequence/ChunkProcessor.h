@@ -33,7 +33,6 @@ private:
 	AnalysisJob& job_;
 	const MetaData& settings_;
 	const Parameters& params_;
-	const FastaFileIndex reference_; // not thread-save -> each creates own copy
 	VariantHgvsAnnotator hgvs_anno_;
 
 	int lines_annotated_ = 0;
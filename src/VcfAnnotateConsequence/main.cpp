@@ -1,6 +1,7 @@
 #include "ToolBase.h"
 #include "Settings.h"
 #include "NGSHelper.h"
+#include "TranscriptDatabase.h"
 #include "Helper.h"
 #include "VcfFile.h"
 #include "VariantHgvsAnnotator.h"
@@ -28,7 +29,7 @@ public:
 		setDescription("Adds transcript-specific consequence predictions to a VCF file.");
 		setExtendedDescription(extendedDescription());
 		addInfile("in", "Input VCF file to annotate.", false);
-		addInfile("gff", "Ensembl-style GFF file with transcripts, e.g. from https://ftp.ensembl.org/pub/release-112/gff3/homo_sapiens/Homo_sapiens.GRCh38.112.gff3.gz.", false);
+		addInfile("gff", "Ensembl-style GFF file with transcripts, e.g. from https://ftp.ensembl.org/pub/release-112/gff3/homo_sapiens/Homo_sapiens.GRCh38.112.gff3.gz. A binary transcript database created with GffToTranscriptDb can be given instead, which is much faster to load.", false);
 
 		//optional
 		addInfile("ref", "Reference genome FASTA file. If unset 'reference_genome' from the 'settings.ini' file is used.", true, false);
@@ -44,8 +45,12 @@ public:
 		addInt("splice_region_in5", "Number of bases at intron boundaries (5') that are considered to be part of the splice region.", true, 20);
 		addInt("splice_region_in3", "Number of bases at intron boundaries (3') that are considered to be part of the splice region.", true, 20);
 		addEnum("source", "GFF source.", true, QStringList() << "ensembl" << "refseq", "ensembl");
+		addFlag("ref_preload", "Preload the reference genome into memory (2-bit packed, about 800MB for GRCh38). Speeds up the annotation of large VCF files.");
 		addFlag("debug", "Enable debug output");
 
+		changeLog(2026, 10, 17, "Coding sequences and reference proteins of transcripts are now cached and shared by all worker threads.");
+		changeLog(2026, 10, 17, "Added support for binary transcript databases (see GffToTranscriptDb). The transcript index is now created once and shared by all worker threads.");
+		changeLog(2026, 10, 17, "Added 'ref_preload' parameter and reference genome sharing between worker threads.");
 		changeLog(2024, 7, 26, "Added support for RefSeq GFF format (source parameter).");
 		changeLog(2022, 7,  7, "Change to event-driven multithreaded implementation.");
 	}
@@ -115,12 +120,30 @@ public:
 		gff_settings.print_to_stdout = true;
 		gff_settings.include_all = all;
 		gff_settings.skip_not_hgnc = skip_not_hgnc;
-		GffData data = NGSHelper::loadGffFile(gff_file, gff_settings);
-		stream << "Parsing transcripts took: " << Helper::elapsedTime(timer) << endl;
+		GffData data;
+		if (TranscriptDatabase::isDatabaseFile(gff_file))
+		{
+			GffSettings db_settings;
+			data = TranscriptDatabase::load(gff_file, &db_settings);
+			if (db_settings.source!=gff_settings.source || db_settings.include_all!=gff_settings.include_all || db_settings.skip_not_hgnc!=gff_settings.skip_not_hgnc)
+			{
+				THROW(ArgumentException, "Transcript database '" + gff_file + "' was created with different settings (source: " + db_settings.source + ", all: " + (db_settings.include_all ? "yes" : "no") + ", skip_not_hgnc: " + (db_settings.skip_not_hgnc ? "yes" : "no") + ")!");
+			}
+			stream << "Loaded " << data.transcripts.count() << " transcripts from transcript database" << endl;
+			stream << "Loading transcripts took: " << Helper::elapsedTime(timer) << endl;
+		}
+		else
+		{
+			data = NGSHelper::loadGffFile(gff_file, gff_settings);
+			stream << "Parsing transcripts took: " << Helper::elapsedTime(timer) << endl;
+			data.transcripts.sortByPosition();
+		}
 
 		//ceate transcript index
-		data.transcripts.sortByPosition();
-		MetaData meta(getString("tag").toUtf8(), ref_file, data.transcripts);
+		timer.restart();
+		QSharedPointer<FastaFileIndex> reference(new FastaFileIndex(ref_file, getFlag("ref_preload")));
+		if (reference->isPreloaded()) stream << "Preloading reference genome took: " << Helper::elapsedTime(timer) << endl;
+		MetaData meta(getString("tag").toUtf8(), reference, data.transcripts);
 		meta.annotation_parameters.max_dist_to_transcript = max_dist_to_trans;
 		meta.annotation_parameters.splice_region_ex = splice_region_ex;
 		meta.annotation_parameters.splice_region_in_3 = splice_region_in_3;
@@ -9,13 +9,13 @@
 #include <QMutex>
 #include "BigWigReader.h"
 
-ChunkProcessor::ChunkProcessor(AnalysisJob &job, const QByteArray& name, const QByteArray& bw_filepath, const QString& modus)
+ChunkProcessor::ChunkProcessor(AnalysisJob &job, const QByteArray& name, const QByteArray& bw_filepath, const BigWigReader& bw_reader, const QString& modus)
 	:QRunnable()
 	, terminate_(false)
 	, job_(job)
 	, name_(name)
 	, bw_filepath_(bw_filepath)
-	, bw_reader_(bw_filepath)
+	, bw_reader_(bw_reader)
 	, modus_(modus)
 {
 }
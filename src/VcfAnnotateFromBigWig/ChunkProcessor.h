@@ -10,7 +10,7 @@ class ChunkProcessor
 		:public QRunnable
 {
 public:
-	ChunkProcessor(AnalysisJob &job, const QByteArray& name, const QByteArray& bw_filepath, const QString& modus);
+	ChunkProcessor(AnalysisJob &job, const QByteArray& name, const QByteArray& bw_filepath, const BigWigReader& bw_reader, const QString& modus);
 	void run();
 	QList<float> getAnnotation(const QByteArray& chr, int start, int end, const QByteArray& ref, const QByteArray& alt);
 
@@ -26,7 +26,7 @@ private:
 	AnalysisJob& job_;
 	const QByteArray name_;
 	const QByteArray bw_filepath_;
-	BigWigReader bw_reader_;
+	const BigWigReader& bw_reader_; //shared by all chunk processors
 	const QString modus_;
 };
 
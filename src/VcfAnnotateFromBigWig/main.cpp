@@ -40,6 +40,7 @@ public:
 		addInt("prefetch", "Maximum number of blocks that may be pre-fetched into memory.", true, 64);
 		addInt("debug", "Enables debug output at the given interval in milliseconds (disabled by default, cannot be combined with writing to STDOUT).", true, -1);
 
+		changeLog(2026, 10, 17, "The bigWig file is opened once and shared by all threads (memory-mapped, with cache of decompressed blocks).");
 		changeLog(2022, 01, 14, "Initial implementation.");
 	}
 
@@ -86,6 +87,9 @@ public:
 		}
 		QSharedPointer<QFile> in_p = Helper::openFileForReading(in, true);
 
+		//open bigWig file (shared by all threads)
+		BigWigReader bw_reader(bw_path);
+
 		// create job pool
 		QList<AnalysisJob> job_pool;
 		while(job_pool.count() < prefetch)
@@ -136,7 +140,7 @@ public:
 								vcf_line_idx++;
 							}
 							vcf_line_idx = 0;
-							analysis_pool.start(new ChunkProcessor(job, name.toUtf8(), bw_path.toUtf8(), mode));
+							analysis_pool.start(new ChunkProcessor(job, name.toUtf8(), bw_path.toUtf8(), bw_reader, mode));
 							++current_chunk;
 							break;
 
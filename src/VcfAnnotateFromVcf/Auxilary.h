@@ -14,6 +14,7 @@ struct Parameters
 	int prefetch;
 	int threads;
 	int block_size;
+	bool sorted; //merge-join mode: input is sorted, chunks are split by genomic range and source files are streamed
 	bool debug;
 };
 
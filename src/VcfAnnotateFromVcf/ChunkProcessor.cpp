@@ -199,8 +199,18 @@ QByteArrayList getVcfHeaderLines(const QByteArray &vcf_file_path, QByteArrayList
 	return info_header_lines;
 }
 
+//splits an annotation file line into columns
+QByteArrayList splitAnnotationLine(const QByteArray& line)
+{
+	QByteArrayList parts = line.trimmed().split('\t');
+	if (parts.count()<VcfFile::MIN_COLS) THROW(FileParseException, "VCF line with too few columns in annotation file: " + line);
+	return parts;
+}
+
 //extends a given vcf line by a key-value-pair of the given annotation vcf
-QByteArray extendVcfDataLine(const QByteArray& vcf_line, const MetaData& meta, const QVector<int>& id_column_indices, const QVector<TabixIndexedFile>& annotation_files)
+//'get_matches' is called with annotation file index, chromosome, start and end of the variant and returns the overlapping annotation file lines split into columns
+template <typename MatchProvider>
+QByteArray extendVcfDataLine(const QByteArray& vcf_line, const MetaData& meta, const QVector<int>& id_column_indices, MatchProvider get_matches)
 {
 	int extended_lines_ = 0;
 
@@ -221,27 +231,22 @@ QByteArray extendVcfDataLine(const QByteArray& vcf_line, const MetaData& meta, c
 
     QByteArrayList additional_annotation;
     // iterate over all annotation files
-    for (int ann_file_idx = 0; ann_file_idx < annotation_files.size(); ann_file_idx++)
+    for (int ann_file_idx = 0; ann_file_idx < meta.annotation_file_list.size(); ann_file_idx++)
     {
         // get all matching variants for this annotaion file
-		QByteArrayList matches = annotation_files[ann_file_idx].getMatchingLines(chr, start, end, true);
+		QList<QByteArrayList> matches = get_matches(ann_file_idx, chr, start, end);
 
         // collect the key-value pairs for all matches to prevent key duplications
         QByteArrayList additional_keys;
         QByteArrayList additional_values;
         QByteArrayList additional_ids;
-        foreach(const QByteArray& match, matches)
+        foreach(const QByteArrayList& parts, matches)
         {
-
-            // parse vcf line
-            QByteArrayList parts = match.trimmed().split('\t');
-			if (parts.count()<VcfFile::MIN_COLS) THROW(FileParseException, "VCF line with too few columns in annotation file: " + match);
-
             // check if same variant
             if (parts[VcfFile::REF] != ref || parts[VcfFile::ALT] != obs) continue;
             bool ok;
             int pos = parts[VcfFile::POS].toInt(&ok);
-			if (!ok) THROW(FileParseException, "Could not convert VCF variant position '" + parts[VcfFile::POS] + "' to integer in annotation file line: " + match);
+			if (!ok) THROW(FileParseException, "Could not convert VCF variant position '" + parts[VcfFile::POS] + "' to integer in annotation file line: " + parts.join('\t'));
             if (pos != start) continue;
 
 			// add info key if existence only
@@ -386,6 +391,97 @@ void ChunkProcessor::run()
 			annotation_files[i].load(meta_.annotation_file_list[i]);
 		}
 
+		//sorted mode (merge-join): the chunk contains a sorted genomic range of one chromosome > stream the source lines of that range once instead of one index lookup per variant
+		struct SourceLine
+		{
+			int pos;
+			QByteArrayList parts;
+		};
+		QVector<QList<SourceLine>> windows(annotation_files.size()); //source lines at or after the position of the current variant
+		QVector<bool> streams_done(annotation_files.size(), true);
+		if (params_.sorted)
+		{
+			QByteArray chunk_chr;
+			int chunk_start = -1;
+			int chunk_end = -1;
+			foreach(const QByteArray& line, job_.lines)
+			{
+				if (line.startsWith('#') || line.trimmed().isEmpty()) continue;
+
+				int tab1 = line.indexOf('\t');
+				int tab2 = line.indexOf('\t', tab1+1);
+				QByteArray chr = line.left(tab1);
+				bool ok = false;
+				int pos = line.mid(tab1+1, tab2-tab1-1).toInt(&ok);
+				if (!ok) THROW(FileParseException, "Could not convert VCF variant position to integer in line: " + line);
+				if (chunk_start==-1)
+				{
+					chunk_chr = chr;
+					chunk_start = pos;
+				}
+				else if (chr!=chunk_chr || pos<chunk_end)
+				{
+					THROW(FileParseException, "Input VCF is not sorted by position (use the tool without '-sorted'): " + line);
+				}
+				chunk_end = pos;
+			}
+
+			if (chunk_start!=-1)
+			{
+				for (int i=0; i<annotation_files.size(); ++i)
+				{
+					streams_done[i] = !annotation_files[i].beginRegion(chunk_chr, chunk_start, chunk_end);
+				}
+			}
+		}
+
+		//returns the source lines overlapping a variant
+		auto get_matches_indexed = [&annotation_files](int ann_file_idx, const Chromosome& chr, int start, int end)
+		{
+			QList<QByteArrayList> output;
+			foreach(const QByteArray& line, annotation_files[ann_file_idx].getMatchingLines(chr, start, end, true))
+			{
+				output << splitAnnotationLine(line);
+			}
+			return output;
+		};
+		auto get_matches_sorted = [&annotation_files, &windows, &streams_done](int ann_file_idx, const Chromosome& /*chr*/, int start, int /*end*/)
+		{
+			//remove source lines before the variant
+			QList<SourceLine>& window = windows[ann_file_idx];
+			while (!window.isEmpty() && window.first().pos<start)
+			{
+				window.removeFirst();
+			}
+
+			//read source lines until the first line after the variant
+			QByteArray line;
+			while (!streams_done[ann_file_idx] && (window.isEmpty() || window.last().pos<=start))
+			{
+				if (!annotation_files[ann_file_idx].nextLine(line))
+				{
+					streams_done[ann_file_idx] = true;
+					break;
+				}
+
+				QByteArrayList parts = splitAnnotationLine(line);
+				bool ok = false;
+				int pos = parts[VcfFile::POS].toInt(&ok);
+				if (!ok) THROW(FileParseException, "Could not convert VCF variant position '" + parts[VcfFile::POS] + "' to integer in annotation file line: " + line);
+				if (pos<start) continue;
+
+				window.append(SourceLine{pos, parts});
+			}
+
+			//only source lines with the same start position can match
+			QList<QByteArrayList> output;
+			for (int i=0; i<window.count() && window[i].pos==start; ++i)
+			{
+				output << window[i].parts;
+			}
+			return output;
+		};
+
 		//process data
 		QList<QByteArray> lines_new;
 		lines_new.reserve(job_.lines.size());
@@ -412,7 +508,14 @@ void ChunkProcessor::run()
 			}
 			else //content line
 			{
-				lines_new << extendVcfDataLine(line, meta_, id_column_indices, annotation_files);
+				if (params_.sorted)
+				{
+					lines_new << extendVcfDataLine(line, meta_, id_column_indices, get_matches_sorted);
+				}
+				else
+				{
+					lines_new << extendVcfDataLine(line, meta_, id_column_indices, get_matches_indexed);
+				}
 			}
 		}
 		job_.lines = lines_new;
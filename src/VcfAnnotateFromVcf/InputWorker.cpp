@@ -17,6 +17,15 @@ InputWorker::~InputWorker()
 	if (params_.debug) QTextStream(stdout) << "~InputWorker(): " << job_.index << endl;
 }
 
+//determines chromosome and position string of a VCF content line
+static void chromosomeAndPosition(const QByteArray& line, QByteArray& chr, QByteArray& pos)
+{
+	int tab1 = line.indexOf('\t');
+	int tab2 = line.indexOf('\t', tab1+1);
+	chr = line.left(tab1);
+	pos = line.mid(tab1+1, tab2-tab1-1);
+}
+
 void InputWorker::run()
 {
 	//static data shared between input workers
@@ -24,6 +33,7 @@ void InputWorker::run()
 	static const int buffer_size = 1048576; //1MB buffer
 	static char* buffer = new char[buffer_size];
 	static bool reading_done = false;
+	static QByteArray next_line; //first line of the next chunk (sorted mode only)
 
 	try
 	{
@@ -33,7 +43,7 @@ void InputWorker::run()
 		if (reading_done) return;
 
 		//check if reading input is done
-		if (gzeof(in_stream_))
+		if (gzeof(in_stream_) && next_line.isEmpty())
 		{
 			reading_done = true;
 			emit inputDone(job_.index);
@@ -43,8 +53,18 @@ void InputWorker::run()
 		//init job
 		job_.chunk_nr = current_chunk++;
 
+		//sorted mode: chunks contain a contiguous genomic range of one chromosome and variants with the same position are never split between chunks
+		QByteArray chunk_chr;
+		QByteArray chunk_pos;
+		if (!next_line.isEmpty())
+		{
+			job_.lines.append(next_line);
+			chromosomeAndPosition(next_line, chunk_chr, chunk_pos);
+			next_line.clear();
+		}
+
 		//read lines
-		while(!gzeof(in_stream_) && job_.lines.count() < params_.block_size)
+		while(!gzeof(in_stream_) && (params_.sorted || job_.lines.count() < params_.block_size))
 		{
 			char* char_array = gzgets(in_stream_, buffer, buffer_size);
 
@@ -59,7 +79,24 @@ void InputWorker::run()
 				}
 			}
 
-			job_.lines.append(QByteArray(char_array));
+			QByteArray line = QByteArray(char_array);
+			if (params_.sorted && !line.startsWith('#') && !line.trimmed().isEmpty())
+			{
+				QByteArray chr;
+				QByteArray pos;
+				chromosomeAndPosition(line, chr, pos);
+
+				//start new chunk on chromosome change or if the chunk is full and the position changes
+				if (!chunk_chr.isEmpty() && (chr!=chunk_chr || (job_.lines.count() >= params_.block_size && pos!=chunk_pos)))
+				{
+					next_line = line;
+					break;
+				}
+				chunk_chr = chr;
+				chunk_pos = pos;
+			}
+
+			job_.lines.append(line);
 		}
 
 		emit done(job_.index);
@@ -41,8 +41,10 @@ public:
 		addInt("threads", "The number of threads used to process VCF lines.", true, 1);
 		addInt("block_size", "Number of lines processed in one chunk.", true, 10000);
 		addInt("prefetch", "Maximum number of chunks that may be pre-fetched into memory.", true, 64);
+		addFlag("sorted", "Merge-join mode for coordinate-sorted input: chunks are split by genomic range (chromosome and position) and the source files are streamed once per chunk instead of one index lookup per variant. Recommended for large input files, e.g. WGS.");
 		addFlag("debug", "Enables debug output (use only with one thread).");
 
+		changeLog(2026,10, 17, "Added merge-join mode for sorted input (parameter 'sorted').");
 		changeLog(2024, 5,  6, "Added option to annotate the existence of variants in the source file");
 		changeLog(2022, 7,  8, "Usability: changed parameter names and updated documentation.");
 		changeLog(2022, 2, 24, "Refactoring and change to event-driven implementation (improved scaling with many threads)");
@@ -73,6 +75,7 @@ public:
 		params.threads = getInt("threads");
 		params.prefetch = getInt("prefetch");
 		params.block_size = getInt("block_size");
+		params.sorted = getFlag("sorted");
 		params.debug = getFlag("debug");
 
 		//check parameters
@@ -200,6 +203,7 @@ public:
 		out << "Output file: \t" << params.out << "\n";
 		out << "Threads: \t" << params.threads << "\n";
 		out << "Block (Chunk) size: \t" << params.block_size << "\n";
+		if (params.sorted) out << "Mode: \tmerge-join (sorted input)\n";
 
 		for(int i = 0; i < meta.annotation_file_list.size(); i++)
         {
@@ -132,6 +132,28 @@ public:
 				}
 			}
 
+			//determine depth of all SNVs in one sorted pass over the BAM file (indels are handled separately)
+			QVector<int> snv_indices;
+			QVector<PileupPosition> snv_positions;
+			for(int i = 0; i < prs_variant_list.count(); ++i)
+			{
+				const VcfLine& prs_variant = prs_variant_list[i];
+				if (prs_variant.infoKeys().contains("IMPUTE") || prs_variant.isMultiAllelic()) continue;
+
+				VcfLine tmp = prs_variant;
+				if (tmp.altString() == ".") tmp.setSingleAlt(tmp.ref());
+				if (!Variant(tmp).isSNV()) continue;
+
+				snv_indices << i;
+				snv_positions << PileupPosition{prs_variant.chr(), prs_variant.start()};
+			}
+			QVector<Pileup> snv_pileups = bam_file.getPileups(snv_positions);
+			QHash<int, int> snv_depth;
+			for(int j = 0; j < snv_indices.count(); ++j)
+			{
+				snv_depth[snv_indices[j]] = snv_pileups[j].depth(true);
+			}
+
 			//iterate over all variants in PRS
 			int c_found = 0;
 			int c_low_depth = 0;
@@ -175,7 +197,7 @@ public:
 				}
 				else
 				{
-					var_depth = bam_file.getVariantDetails(reference, prs_variant).depth;
+					var_depth = snv_depth.contains(i) ? snv_depth[i] : bam_file.getVariantDetails(reference, prs_variant).depth;
 					if ( var_depth < min_depth)
 					{
 						//coverage too low --> use POP_AF
@@ -22,7 +22,11 @@ public:
 		addInfile("fai", "FAI file defining different chromosome order.", true, true);
 		addInt("compression_level", "Output VCF compression level from 1 (fastest) to 9 (best compression). If unset, an unzipped VCF is written.", true, BGZF_NO_COMPRESSION);
 		addFlag("remove_unused_contigs", "Remove comment lines of contigs, i.e. chromosomes, that are not used in the output VCF.");
+		addInt("buffer", "Enables external sorting for files that do not fit into memory: maximum size of the input chunks in MB that are sorted in memory. If unset, the whole file is sorted in memory.", true, 0);
+		addInt("threads", "Number of threads used to sort chunks in external sorting mode.", true, 1);
+		addFlag("compress_tmp", "Compress temporary files in external sorting mode.");
 
+		changeLog(2026, 10, 17, "Added external sorting mode (parameters '-buffer', '-threads' and '-compress_tmp').");
 		changeLog(2022, 12,  8, "Added parameter '-remove_unused_contigs'.");
 		changeLog(2020,  8, 12, "Added parameter '-compression_level' for compression level of output VCF files.");
 	}
@@ -33,6 +37,19 @@ public:
 		QString fai = getInfile("fai");
 		bool qual = getFlag("qual");
 		bool remove_unused_contigs = getFlag("remove_unused_contigs");
+		int compression_level = getInt("compression_level");
+
+		//external sort
+		int buffer = getInt("buffer");
+		if (buffer>0)
+		{
+			ExternalSortSettings settings;
+			settings.buffer_size = 1000000ll * buffer;
+			settings.threads = getInt("threads");
+			settings.compress_runs = getFlag("compress_tmp");
+			VcfFile::sortExternal(getInfile("in"), getOutfile("out"), settings, qual, fai, remove_unused_contigs, compression_level);
+			return;
+		}
 
 		//load
 		VcfFile vl;
@@ -55,7 +72,6 @@ public:
 		}
 
 		//store
-		int compression_level = getInt("compression_level");
 		vl.store(getOutfile("out"), false, compression_level);
     }
 };
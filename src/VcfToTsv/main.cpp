@@ -25,7 +25,9 @@ public:
 		//optional
 		addInfile("in", "Input variant list in VCF format. If unset, reads from STDIN.", true, true);
 		addOutfile("out", "Output variant list in TSV format. If unset, writes to STDOUT.", true, true);
+		addInt("threads", "The number of threads used to decompress and parse the VCF file.", true, 1);
 
+		changeLog(2026, 10, 17, "Added 'threads' parameter for parallel loading of the VCF file.");
 		changeLog(2022, 11,  3, "Changed output variant style from GSvar to VCF.");
 		changeLog(2022,  9,  7, "Added support for streaming (STDIN > STDOUT).");
 		changeLog(2020,  8,  7, "Multi-allelic and multi-sample VCFs are supported.");
@@ -35,7 +37,7 @@ public:
 	{
 		//load
 		VcfFile vl;
-		vl.load(getInfile("in"));
+		vl.load(getInfile("in"), true, getInt("threads"));
 
 		//store
 		vl.storeAsTsv(getOutfile("out"));
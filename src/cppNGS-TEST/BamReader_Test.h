@@ -69,6 +69,67 @@ private slots:
 		S_EQUAL(al.tag("XX"), "");
 	}
 
+	void BamAlignment_views()
+	{
+		BamReader reader(TESTDATA("data_in/panel.bam"));
+		BamAlignment al;
+		do
+		{
+			reader.getNextAlignment(al);
+		}
+		while(al.isUnmapped());
+
+		//name
+		S_EQUAL(QByteArray(al.nameRaw()), al.name());
+
+		//bases
+		Sequence bases = al.bases();
+		SequenceView bases_view = al.basesView();
+		I_EQUAL(bases_view.length(), bases.count());
+		for (int i=0; i<bases.count(); ++i)
+		{
+			S_EQUAL(bases_view[i], bases[i]);
+		}
+		S_EQUAL(bases_view.mid(5, 10), bases.mid(5, 10));
+
+		//qualities
+		QByteArray qualities = al.qualities();
+		const uint8_t* qualities_raw = al.qualitiesRaw();
+		for (int i=0; i<qualities.count(); ++i)
+		{
+			I_EQUAL((int)qualities_raw[i]+33, (int)qualities[i]);
+		}
+
+		//CIGAR
+		QList<CigarOp> cigar_new;
+		cigar_new.append(CigarOp{BAM_CSOFT_CLIP, 3});
+		cigar_new.append(CigarOp{BAM_CMATCH, 130});
+		cigar_new.append(CigarOp{BAM_CSOFT_CLIP, 18});
+		al.setCigarData(cigar_new);
+		CigarView cigar_view = al.cigarView();
+		I_EQUAL(cigar_view.count(), 3);
+		I_EQUAL(cigar_view[1].Type, BAM_CMATCH);
+		I_EQUAL(cigar_view[1].Length, 130);
+		int i = 0;
+		for (const CigarOp op : cigar_view)
+		{
+			I_EQUAL(op.Type, cigar_new[i].Type);
+			I_EQUAL(op.Length, cigar_new[i].Length);
+			++i;
+		}
+		I_EQUAL(i, 3);
+
+		//assignment operator (deep copy)
+		BamAlignment al2;
+		al2 = al;
+		S_EQUAL(al2.name(), al.name());
+		S_EQUAL(al2.cigarDataAsString(), "3S130M18S");
+		al.setCigarData(QList<CigarOp>() << CigarOp{BAM_CMATCH, 151});
+		S_EQUAL(al2.cigarDataAsString(), "3S130M18S");
+		al2 = al2;
+		S_EQUAL(al2.cigarDataAsString(), "3S130M18S");
+	}
+
 	void BamAlignment_setCigarData()
 	{
 		BamReader reader(TESTDATA("data_in/panel.bam"));
@@ -252,6 +313,50 @@ private slots:
 		I_EQUAL(countSequencesContaining(pileup.indels(), '-'), 14);
 	}
 
+	void BamReader_getPileups()
+	{
+		BamReader reader(TESTDATA("data_in/panel.bam"));
+
+		//unsorted positions on several chromosomes, with duplicates and close positions
+		QVector<PileupPosition> positions;
+		positions << PileupPosition{"chr6", 109732622} << PileupPosition{"chr1", 12002148} << PileupPosition{"chr1", 12002124} << PileupPosition{"chr1", 12002123} << PileupPosition{"chr14", 53046761} << PileupPosition{"chr1", 12002124} << PileupPosition{"chr1", 12001405} << PileupPosition{"chr1", 12002300} << PileupPosition{"chr6", 109732640} << PileupPosition{"chr1", 1000000};
+
+		foreach(bool anom, QList<bool>() << false << true)
+		{
+			foreach(int threads, QList<int>() << 1 << 3)
+			{
+				QVector<Pileup> pileups = reader.getPileups(positions, 1, 1, anom, 13, threads);
+				I_EQUAL(pileups.count(), positions.count());
+				for (int i=0; i<positions.count(); ++i)
+				{
+					Pileup expected = reader.getPileup(positions[i].chr, positions[i].pos, 1, 1, anom, 13);
+					I_EQUAL(pileups[i].a(), expected.a());
+					I_EQUAL(pileups[i].c(), expected.c());
+					I_EQUAL(pileups[i].g(), expected.g());
+					I_EQUAL(pileups[i].t(), expected.t());
+					I_EQUAL(pileups[i].depth(true), expected.depth(true));
+					I_EQUAL(pileups[i].indels().count(), expected.indels().count());
+					for (int j=0; j<expected.indels().count(); ++j)
+					{
+						S_EQUAL(pileups[i].indels()[j], expected.indels()[j]);
+					}
+					S_EQUAL(QString::number(pileups[i].mapq0Frac()), QString::number(expected.mapq0Frac()));
+				}
+			}
+		}
+
+		//values of getPileup test
+		QVector<Pileup> pileups = reader.getPileups(positions, 1);
+		I_EQUAL(pileups[0].depth(false), 40);
+		I_EQUAL(pileups[0].indels().count(), 27);
+		I_EQUAL(pileups[1].depth(false), 117);
+		F_EQUAL2(pileups[1].frequency('A', 'G'), 0.410, 0.001);
+		I_EQUAL(pileups[2].depth(false), 167);
+		I_EQUAL(pileups[4].depth(false), 52);
+		I_EQUAL(pileups[4].indels().count(), 14);
+		I_EQUAL(pileups[5].depth(false), 167);
+	}
+
 	//special test with RNA because it contains the CIGAR operations S and N
 	void BamReader_getPileup_RNA()
 	{
@@ -378,6 +483,37 @@ private slots:
 		IS_TRUE(size_without_special < size_with_special);
 	}
 
+	void BamReader_getNextBatch()
+	{
+		//read all alignments one by one
+		QByteArrayList names;
+		BamReader reader(TESTDATA("data_in/panel.bam"));
+		reader.setRegion("chr1", 1, 20000000);
+		BamAlignment al;
+		while (reader.getNextAlignment(al))
+		{
+			names << al.name() + "_" + QByteArray::number(al.start());
+		}
+		IS_TRUE(names.count()>10);
+
+		//read all alignments in batches
+		QByteArrayList names2;
+		BamReader reader2(TESTDATA("data_in/panel.bam"));
+		reader2.setRegion("chr1", 1, 20000000);
+		QVector<BamAlignment> batch;
+		int count = 0;
+		while ((count = reader2.getNextBatch(batch, 7)) > 0)
+		{
+			I_EQUAL(batch.count(), 7);
+			for (int i=0; i<count; ++i)
+			{
+				names2 << batch[i].name() + "_" + QByteArray::number(batch[i].start());
+			}
+		}
+		I_EQUAL(names2.count(), names.count());
+		IS_TRUE(names2==names);
+	}
+
 /************************************************************* Cram Support *************************************************************/
 
 	void CramSupport_referenceAsParameter_tests()
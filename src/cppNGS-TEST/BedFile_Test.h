@@ -105,6 +105,33 @@ private slots:
 		S_EQUAL(file[5].annotations()[0], "Y");
 	}
 
+	void sortExternal()
+	{
+		//in-memory sort for comparison
+		BedFile file;
+		file.load(TESTDATA("data_in/demo_unmerged.bed"));
+		file.sort();
+		file.store("out/BedFile_sortExternal_expected.bed");
+
+		//small chunks and merge fan-in to test intermediate merges
+		ExternalSortSettings settings;
+		settings.buffer_size = 1000;
+		settings.threads = 3;
+		settings.max_merge_runs = 3;
+		BedFile::sortExternal(TESTDATA("data_in/demo_unmerged.bed"), "out/BedFile_sortExternal_out1.bed", settings);
+		COMPARE_FILES("out/BedFile_sortExternal_out1.bed", "out/BedFile_sortExternal_expected.bed");
+
+		//compressed temporary files, with name and removal of duplicates
+		file.load(TESTDATA("data_in/demo_unmerged.bed"));
+		file.sortWithName();
+		file.removeDuplicates();
+		file.store("out/BedFile_sortExternal_expected2.bed");
+
+		settings.compress_runs = true;
+		BedFile::sortExternal(TESTDATA("data_in/demo_unmerged.bed"), "out/BedFile_sortExternal_out2.bed", settings, true, true);
+		COMPARE_FILES("out/BedFile_sortExternal_out2.bed", "out/BedFile_sortExternal_expected2.bed");
+	}
+
 	void removeDuplicates()
 	{
 		BedFile file;
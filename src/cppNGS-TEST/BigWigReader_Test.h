@@ -15,7 +15,7 @@ private slots:
 
     void read_local_values()
 	{
-		BigWigReader r = BigWigReader(QString(TESTDATA("data_in/BigWigReader.bw")));
+		BigWigReader r(TESTDATA("data_in/BigWigReader.bw"));
 
 		//Header
 		BigWigReader::Header header = r.header();
@@ -118,7 +118,7 @@ private slots:
 
     void read_local_intervals()
     {
-        BigWigReader r = BigWigReader(QString(TESTDATA("data_in/BigWigReader.bw")));
+        BigWigReader r(TESTDATA("data_in/BigWigReader.bw"));
 
         // Overlapping single value intervals
 		QList<BigWigReader::OverlappingInterval> intervals = r.getOverlappingIntervals("chr1", 0, 1, 0);
@@ -148,6 +148,57 @@ private slots:
 		intervals = r.getOverlappingIntervals("chr1", 99, 100, 0);
         I_EQUAL(intervals.length(), 0)
     }
+
+	void read_values_batch()
+	{
+		BigWigReader r(TESTDATA("data_in/BigWigReader.bw"));
+		r.setDefaultValue(-50);
+
+		QVector<int> positions;
+		positions << 0 << 1 << 2 << 50 << 99 << 100 << 101 << 149 << 150 << 151 << 5000;
+
+		//same values as single reads (without offset and with VCF offset)
+		foreach(int offset, QList<int>() << 0 << -1)
+		{
+			QVector<float> values = r.readValues("chr1", positions, offset);
+			I_EQUAL(values.count(), positions.count());
+			for (int i=0; i<positions.count(); ++i)
+			{
+				F_EQUAL2(values[i], r.readValue("chr1", positions[i], offset), 0.000001);
+			}
+		}
+
+		QVector<float> values = r.readValues("chr1", positions, 0);
+		F_EQUAL2(values[0], 0.1f, 0.000001);
+		F_EQUAL2(values[1], 0.2f, 0.000001);
+		F_EQUAL2(values[4], -50.0f, 0.000001);
+		F_EQUAL2(values[5], 1.4f, 0.000001);
+		F_EQUAL2(values[7], 1.4f, 0.000001);
+
+		//position 0 with VCF offset is before the chromosome start: default value, following positions are not affected
+		values = r.readValues("chr1", QVector<int>() << 0 << 1 << 2 << 101, -1);
+		I_EQUAL(values.count(), 4);
+		F_EQUAL2(values[0], -50.0f, 0.000001);
+		F_EQUAL2(values[1], 0.1f, 0.000001);
+		F_EQUAL2(values[2], 0.2f, 0.000001);
+		F_EQUAL2(values[3], 1.4f, 0.000001);
+		values = r.readValues("chr1", QVector<int>() << 0, -1);
+		I_EQUAL(values.count(), 1);
+		F_EQUAL2(values[0], -50.0f, 0.000001);
+		values = r.readValues("chr1", positions, 0);
+
+		//empty/unsorted input
+		I_EQUAL(r.readValues("chr1", QVector<int>(), 0).count(), 0);
+		IS_THROWN(ArgumentException, r.readValues("chr1", QVector<int>() << 5 << 1, 0));
+
+		//tiny cache (blocks are decompressed again)
+		r.setCacheSize(1);
+		QVector<float> values2 = r.readValues("chr1", positions, 0);
+		for (int i=0; i<positions.count(); ++i)
+		{
+			F_EQUAL2(values2[i], values[i], 0.000001);
+		}
+	}
 };
 
 
@@ -0,0 +1,95 @@
+#include "TestFramework.h"
+#include "BinaryFileHeader.h"
+#include "Helper.h"
+#include <cstring>
+
+TEST_CLASS(BinaryFileHeader_Test)
+{
+Q_OBJECT
+private:
+	void writeHeader(QString filename, const BinaryFileHeader& header)
+	{
+		QSharedPointer<QFile> file = Helper::openFileForWriting(filename);
+		file->write(reinterpret_cast<const char*>(&header), sizeof(BinaryFileHeader));
+		file->write(QByteArray(8, '\0'));
+	}
+
+private slots:
+	void init_check()
+	{
+		const char magic[8] = {'T', 'E', 'S', 'T', 'M', 'A', 'G', 'I'};
+		const char magic2[8] = {'T', 'E', 'S', 'T', 'M', 'A', 'G', '2'};
+
+		BinaryFileHeader header;
+		memset(&header, 0, sizeof(BinaryFileHeader));
+		header.init(magic, 3);
+		I_EQUAL(header.version, 3);
+		I_EQUAL(header.source_size, 0);
+		I_EQUAL(header.source_modified, 0);
+
+		header.check(magic, 3, "test.bin", "test file");
+		IS_THROWN(FileParseException, header.check(magic2, 3, "test.bin", "test file"));
+		IS_THROWN(FileParseException, header.check(magic, 4, "test.bin", "test file"));
+	}
+
+	void hasMagic_isUpToDate()
+	{
+		const char magic[8] = {'T', 'E', 'S', 'T', 'M', 'A', 'G', 'I'};
+		const char magic2[8] = {'T', 'E', 'S', 'T', 'M', 'A', 'G', '2'};
+		QString source = TESTDATA("data_in/panel_vep.GSvar");
+
+		BinaryFileHeader header;
+		memset(&header, 0, sizeof(BinaryFileHeader));
+		header.init(magic, 1, source);
+		IS_TRUE(header.source_size>0);
+		IS_TRUE(header.matchesSource(source));
+		writeHeader("out/BinaryFileHeader_out.bin", header);
+
+		IS_TRUE(BinaryFileHeader::hasMagic("out/BinaryFileHeader_out.bin", magic));
+		IS_FALSE(BinaryFileHeader::hasMagic("out/BinaryFileHeader_out.bin", magic2));
+		IS_FALSE(BinaryFileHeader::hasMagic(source, magic));
+		IS_FALSE(BinaryFileHeader::hasMagic("out/BinaryFileHeader_missing.bin", magic));
+
+		IS_TRUE(BinaryFileHeader::isUpToDate("out/BinaryFileHeader_out.bin", magic, 1, source));
+		IS_FALSE(BinaryFileHeader::isUpToDate("out/BinaryFileHeader_out.bin", magic, 2, source));
+		IS_FALSE(BinaryFileHeader::isUpToDate("out/BinaryFileHeader_out.bin", magic2, 1, source));
+		IS_FALSE(BinaryFileHeader::isUpToDate("out/BinaryFileHeader_out.bin", magic, 1, TESTDATA("data_in/VariantFilter_in.GSvar")));
+		IS_FALSE(BinaryFileHeader::isUpToDate("out/BinaryFileHeader_missing.bin", magic, 1, source));
+	}
+
+	void map()
+	{
+		QSharedPointer<QFile> writer = Helper::openFileForWriting("out/BinaryFileHeader_map.bin");
+		writer->write("0123456789");
+		writer->close();
+
+		QFile file("out/BinaryFileHeader_map.bin");
+		IS_TRUE(file.open(QIODevice::ReadOnly));
+		QByteArray buffer;
+		const uchar* data = BinaryFileHeader::map(file, buffer);
+		S_EQUAL(QByteArray(reinterpret_cast<const char*>(data), 10), QByteArray("0123456789"));
+	}
+
+	void paddedSize()
+	{
+		I_EQUAL(BinaryFileHeader::paddedSize(0), 0);
+		I_EQUAL(BinaryFileHeader::paddedSize(1), 8);
+		I_EQUAL(BinaryFileHeader::paddedSize(8), 8);
+		I_EQUAL(BinaryFileHeader::paddedSize(9), 16);
+	}
+
+	void calculateChecksum()
+	{
+		QByteArray data = "123456789";
+		const uchar* ptr = reinterpret_cast<const uchar*>(data.constData());
+		IS_TRUE(BinaryFileHeader::calculateChecksum(ptr, data.size())==0xCBF43926u);
+
+		//several blocks
+		quint32 crc = BinaryFileHeader::calculateChecksum(ptr, 4);
+		crc = BinaryFileHeader::calculateChecksum(ptr + 4, 5, crc);
+		IS_TRUE(crc==0xCBF43926u);
+
+		//empty
+		IS_TRUE(BinaryFileHeader::calculateChecksum(ptr, 0)==0);
+	}
+};
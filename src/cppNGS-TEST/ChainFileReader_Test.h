@@ -4,6 +4,7 @@
 #include <iostream>
 #include "HttpRequestHandler.h"
 #include <QTime>
+#include <QDir>
 
 TEST_CLASS(ChainFileReader_Test)
 {
@@ -127,4 +128,80 @@ private slots:
 			I_EQUAL(count, expected[i]);
 		}
 	}
+
+	void liftMany()
+	{
+		QString chain_file = Settings::string("liftover_hg38_hg19", true);
+		if (chain_file=="") SKIP("Test needs the liftOver hg38->hg19 chain file!");
+
+		ChainFileReader r(chain_file, 0.05);
+
+		BedFile regions;
+		regions.load(TESTDATA("data_in/ChainFileReader_in1.bed"));
+
+		//unsorted input (index queries) and sorted input (cursor) with several threads
+		for (int pass=0; pass<2; ++pass)
+		{
+			if (pass==1) regions.sort();
+
+			foreach(int threads, QList<int>() << 1 << 3)
+			{
+				QVector<ChainFileReader::LiftResult> results = r.liftMany(regions, threads);
+				I_EQUAL(results.count(), regions.count());
+				for (int i=0; i<regions.count(); ++i)
+				{
+					const BedLine& region = regions[i];
+					try
+					{
+						BedLine expected = r.lift(region.chr(), region.start(), region.end());
+						S_EQUAL(results[i].error, QString());
+						S_EQUAL(results[i].region.toString(false), expected.toString(false));
+					}
+					catch (ArgumentException& e)
+					{
+						S_EQUAL(results[i].error, e.message());
+					}
+				}
+			}
+		}
+	}
+
+	void storeBinary()
+	{
+		QString chain_file = Settings::string("liftover_hg38_hg19", true);
+		if (chain_file=="") SKIP("Test needs the liftOver hg38->hg19 chain file!");
+
+		ChainFileReader r(chain_file, 0.05);
+		r.storeBinary("out/ChainFileReader_hg38_hg19.bin");
+		IS_TRUE(ChainFileReader::isBinaryFile("out/ChainFileReader_hg38_hg19.bin"));
+		IS_FALSE(ChainFileReader::isBinaryFile(chain_file));
+
+		ChainFileReader r2("out/ChainFileReader_hg38_hg19.bin", 0.05);
+
+		BedFile regions;
+		regions.load(TESTDATA("data_in/ChainFileReader_in1.bed"));
+		QVector<ChainFileReader::LiftResult> results = r.liftMany(regions);
+		QVector<ChainFileReader::LiftResult> results2 = r2.liftMany(regions);
+		I_EQUAL(results2.count(), results.count());
+		for (int i=0; i<results.count(); ++i)
+		{
+			S_EQUAL(results2[i].error, results[i].error);
+			S_EQUAL(results2[i].region.toString(false), results[i].region.toString(false));
+		}
+
+		//cache file in separate folder
+		QString cache_folder = QDir("out").absolutePath();
+		QString cache_file = ChainFileReader::binaryCacheFile(chain_file, cache_folder);
+		IS_TRUE(cache_file.startsWith(cache_folder));
+		QFile::remove(cache_file);
+		IS_FALSE(ChainFileReader::binaryCacheIsValid(chain_file, cache_folder));
+		ChainFileReader r3(chain_file, 0.05, true, cache_folder);
+		IS_TRUE(ChainFileReader::binaryCacheIsValid(chain_file, cache_folder));
+		ChainFileReader r4(chain_file, 0.05, true, cache_folder);
+		QVector<ChainFileReader::LiftResult> results4 = r4.liftMany(regions);
+		for (int i=0; i<results.count(); ++i)
+		{
+			S_EQUAL(results4[i].region.toString(false), results[i].region.toString(false));
+		}
+	}
 };
@@ -3,6 +3,7 @@
 #include "BedFile.h"
 #include "VcfFile.h"
 #include "Log.h"
+#include <random>
 
 TEST_CLASS(ChromosomalIndex_Test)
 {
@@ -292,4 +293,123 @@ private slots:
 		index = var_index.matchingIndex("chr2", 500, 505);
 		I_EQUAL(index, -1);
 	}
+
+	void intervalTree_BedFile()
+	{
+		BedFile bed_file;
+		for (int c=1; c<=22; ++c)
+		{
+			for (int p=1; p<=100*c; ++p)
+			{
+				BedLine line ("chr" + QString::number(c), p, p);
+				if (p%10==0) line.setEnd(p + 10);
+				bed_file.append(line);
+			}
+		}
+		ChromosomalIndex<BedFile> bed_index(bed_file, 30, ChromosomalIndexType::INTERVAL_TREE);
+		IS_TRUE(bed_index.type()==ChromosomalIndexType::INTERVAL_TREE);
+
+		//chromosome not found
+		I_EQUAL(bed_index.matchingIndices("chrX", 5, 15).count(), 0);
+		I_EQUAL(bed_index.matchingIndex("chrX", 5, 15), -1);
+
+		//whole chromosomes
+		I_EQUAL(bed_index.matchingIndices("chr1", 0, 100000).count(), 100);
+		I_EQUAL(bed_index.matchingIndices("chr2", 0, 100000).count(), 200);
+		I_EQUAL(bed_index.matchingIndex("chr2", 0, 100000), 100);
+
+		//overlap with beginning
+		I_EQUAL(bed_index.matchingIndices("chr2", -10, 5).count(), 5);
+
+		//overlap with end
+		QVector<int> elements = bed_index.matchingIndices("chr2", 200, 205);
+		I_EQUAL(elements.count(), 2);
+		I_EQUAL(elements[0], 289);
+		I_EQUAL(elements[1], 299);
+		I_EQUAL(bed_index.matchingIndex("chr2", 200, 205), 289);
+
+		//no overlap
+		I_EQUAL(bed_index.matchingIndices("chr2", 500, 505).count(), 0);
+		I_EQUAL(bed_index.matchingIndex("chr2", 500, 505), -1);
+	}
+
+	void intervalTree_autoSelection()
+	{
+		//exome-like targets => binned index
+		BedFile bed_file;
+		for (int c=1; c<=5; ++c)
+		{
+			for (int p=1; p<=10000; ++p)
+			{
+				bed_file.append(BedLine("chr" + QString::number(c), p*1000, p*1000+150));
+			}
+		}
+		ChromosomalIndex<BedFile> index1(bed_file);
+		IS_TRUE(index1.type()==ChromosomalIndexType::BINNED);
+
+		//one large CNV => interval tree
+		bed_file.append(BedLine("chr1", 2000000, 7000000));
+		bed_file.sort();
+		ChromosomalIndex<BedFile> index2(bed_file);
+		IS_TRUE(index2.type()==ChromosomalIndexType::INTERVAL_TREE);
+
+		//few long elements only => binned index
+		BedFile bed_file2;
+		bed_file2.append(BedLine("chr1", 1, 120000000));
+		bed_file2.append(BedLine("chr1", 125000000, 248000000));
+		bed_file2.append(BedLine("chr2", 1, 93000000));
+		ChromosomalIndex<BedFile> index3(bed_file2);
+		IS_TRUE(index3.type()==ChromosomalIndexType::BINNED);
+	}
+
+	//compares binned index and interval tree on exome-like targets with some large CNVs
+	void intervalTree_binned_equal()
+	{
+		std::mt19937 gen(4711);
+		std::uniform_int_distribution<int> dist_pos(1, 50000000);
+		std::uniform_int_distribution<int> dist_len(1, 300);
+
+		BedFile bed_file;
+		for (int c=1; c<=3; ++c)
+		{
+			for (int i=0; i<50000; ++i)
+			{
+				int start = dist_pos(gen);
+				bed_file.append(BedLine("chr" + QString::number(c), start, start + dist_len(gen)));
+			}
+			for (int i=0; i<5; ++i)
+			{
+				int start = dist_pos(gen);
+				bed_file.append(BedLine("chr" + QString::number(c), start, start + 5000000 * (i+1)));
+			}
+		}
+		bed_file.sort();
+
+		ChromosomalIndex<BedFile> index_binned(bed_file, 30, ChromosomalIndexType::BINNED);
+		ChromosomalIndex<BedFile> index_tree(bed_file, 30, ChromosomalIndexType::INTERVAL_TREE);
+
+		QList<BedLine> queries;
+		for (int i=0; i<20000; ++i)
+		{
+			int start = dist_pos(gen);
+			queries << BedLine("chr" + QString::number(i%4+1), start, start + dist_len(gen));
+		}
+
+		QList<QVector<int>> matches_binned;
+		QList<QVector<int>> matches_tree;
+		foreach(const BedLine& query, queries)
+		{
+			matches_binned << index_binned.matchingIndices(query.chr(), query.start(), query.end());
+			matches_tree << index_tree.matchingIndices(query.chr(), query.start(), query.end());
+		}
+
+		//check that both index types return the same matches
+		I_EQUAL(matches_binned.count(), matches_tree.count());
+		for (int i=0; i<queries.count(); ++i)
+		{
+			IS_TRUE(matches_binned[i]==matches_tree[i]);
+			int first = matches_binned[i].isEmpty() ? -1 : matches_binned[i][0];
+			I_EQUAL(index_tree.matchingIndex(queries[i].chr(), queries[i].start(), queries[i].end()), first);
+		}
+	}
 };
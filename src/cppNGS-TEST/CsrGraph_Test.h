@@ -0,0 +1,115 @@
+#include "TestFramework.h"
+#include "CsrGraph.h"
+
+TEST_CLASS(CsrGraph_Test)
+{
+Q_OBJECT
+private:
+	QList<QPair<QString, QString>> testEdges()
+	{
+		QList<QPair<QString, QString>> edges;
+		edges << qMakePair(QString("A"), QString("B"));
+		edges << qMakePair(QString("B"), QString("C"));
+		edges << qMakePair(QString("C"), QString("A"));
+		edges << qMakePair(QString("B"), QString("A")); //duplicate
+		edges << qMakePair(QString("C"), QString("D"));
+		edges << qMakePair(QString("E"), QString("F"));
+		return edges;
+	}
+
+private slots:
+	void create()
+	{
+		CsrGraph graph;
+		graph.create(testEdges());
+		IS_FALSE(graph.directed());
+		I_EQUAL(graph.nodeCount(), 6);
+		I_EQUAL(graph.neighborEntryCount(), 10);
+
+		S_EQUAL(graph.nodeName(0), "A");
+		S_EQUAL(graph.nodeName(3), "D");
+		I_EQUAL(graph.nodeIndex("C"), 2);
+		I_EQUAL(graph.nodeIndex("X"), -1);
+
+		int c = graph.nodeIndex("C");
+		I_EQUAL(graph.degree(c), 3);
+		I_EQUAL(graph.neighbors(c)[0], graph.nodeIndex("B"));
+		I_EQUAL(graph.neighbors(c)[1], graph.nodeIndex("A"));
+		I_EQUAL(graph.neighbors(c)[2], graph.nodeIndex("D"));
+		I_EQUAL(graph.degree(graph.nodeIndex("D")), 1);
+
+		//directed
+		graph.create(testEdges(), true);
+		IS_TRUE(graph.directed());
+		I_EQUAL(graph.neighborEntryCount(), 6);
+		I_EQUAL(graph.degree(graph.nodeIndex("A")), 1);
+		I_EQUAL(graph.degree(graph.nodeIndex("B")), 2);
+		I_EQUAL(graph.degree(graph.nodeIndex("D")), 0);
+	}
+
+	void store_and_load()
+	{
+		CsrGraph graph;
+		graph.create(testEdges());
+		graph.store("out/CsrGraph_out1.bin");
+		IS_TRUE(CsrGraph::isBinaryFile("out/CsrGraph_out1.bin"));
+		IS_FALSE(CsrGraph::isBinaryFile(TESTDATA("data_in/GeneSet_in1.tsv")));
+
+		CsrGraph graph2;
+		graph2.load("out/CsrGraph_out1.bin");
+		IS_FALSE(graph2.directed());
+		I_EQUAL(graph2.nodeCount(), graph.nodeCount());
+		I_EQUAL(graph2.neighborEntryCount(), graph.neighborEntryCount());
+		for (int i=0; i<graph.nodeCount(); ++i)
+		{
+			S_EQUAL(graph2.nodeName(i), graph.nodeName(i));
+			I_EQUAL(graph2.nodeIndex(graph.nodeName(i)), i);
+			I_EQUAL(graph2.degree(i), graph.degree(i));
+			for (int k=0; k<graph.degree(i); ++k)
+			{
+				I_EQUAL(graph2.neighbors(i)[k], graph.neighbors(i)[k]);
+			}
+		}
+
+		//empty graph
+		graph.create(QList<QPair<QString, QString>>());
+		graph.store("out/CsrGraph_out2.bin");
+		graph2.load("out/CsrGraph_out2.bin");
+		I_EQUAL(graph2.nodeCount(), 0);
+		I_EQUAL(graph2.neighborEntryCount(), 0);
+	}
+
+	void random_walk_with_restart()
+	{
+		//single edge: p(A) = 1/(2-r)
+		CsrGraph graph;
+		graph.create(QList<QPair<QString, QString>>() << qMakePair(QString("A"), QString("B")));
+		QVector<double> p = graph.randomWalkWithRestart(QVector<int>() << 0, 0.4);
+		F_EQUAL2(p[0], 0.625, 0.000001);
+		F_EQUAL2(p[1], 0.375, 0.000001);
+
+		//probabilities sum up to one and are independent of the thread count
+		graph.create(testEdges());
+		QVector<int> seeds;
+		seeds << graph.nodeIndex("A") << graph.nodeIndex("E");
+		p = graph.randomWalkWithRestart(seeds, 0.3);
+		double sum = 0.0;
+		foreach(double value, p) sum += value;
+		F_EQUAL2(sum, 1.0, 0.000001);
+		IS_TRUE(p[graph.nodeIndex("A")] > p[graph.nodeIndex("B")]);
+		IS_TRUE(p[graph.nodeIndex("C")] > p[graph.nodeIndex("D")]);
+		F_EQUAL2(p[graph.nodeIndex("E")] + p[graph.nodeIndex("F")], 0.5, 0.000001);
+
+		QVector<double> p2 = graph.randomWalkWithRestart(seeds, 0.3, 4);
+		for (int i=0; i<p.count(); ++i)
+		{
+			F_EQUAL2(p2[i], p[i], 0.000000001);
+		}
+
+		//invalid input
+		IS_THROWN(ArgumentException, graph.randomWalkWithRestart(QVector<int>(), 0.3));
+		IS_THROWN(ArgumentException, graph.randomWalkWithRestart(seeds, 0.0));
+		graph.create(testEdges(), true);
+		IS_THROWN(ProgrammingException, graph.randomWalkWithRestart(seeds, 0.3));
+	}
+};
@@ -85,4 +85,30 @@ private slots:
 		S_EQUAL(names[3], QString("chr17"));
 	}
 
+	void seq_preloaded()
+	{
+		FastaFileIndex index(TESTDATA("data_in/example.fa"));
+		FastaFileIndex index_preloaded(TESTDATA("data_in/example.fa"), true);
+		IS_FALSE(index.isPreloaded());
+		IS_TRUE(index_preloaded.isPreloaded());
+
+		//complete chromosomes
+		foreach(QString chr, index.names())
+		{
+			S_EQUAL(index_preloaded.seq(chr, false), index.seq(chr, false));
+			S_EQUAL(index_preloaded.seq(chr), index.seq(chr));
+		}
+
+		//all sub-sequences of chr14 with lengths crossing line ends
+		for (int start=1; start<=index.lengthOf("chr14"); start+=7)
+		{
+			int length = std::min(170, index.lengthOf("chr14") - start + 1);
+			S_EQUAL(index_preloaded.seq("chr14", start, length, false), index.seq("chr14", start, length, false));
+			S_EQUAL(index_preloaded.seq("chr14", start, length), index.seq("chr14", start, length));
+		}
+
+		S_EQUAL(index_preloaded.seq("chr16", 1, 4, false), Sequence("gatt"));
+		S_EQUAL(index_preloaded.seq("chr17", 1, 4), Sequence("ACGT"));
+	}
+
 };
@@ -65,6 +65,75 @@ private slots:
 		IS_TRUE(result.flags()[120]);
 	}
 
+	void FilterColumnCache_invalidation()
+	{
+		VariantList vl;
+		vl.load(TESTDATA("data_in/VariantFilter_in.GSvar"));
+		int i_gnomad = vl.annotationIndexByName("gnomAD");
+
+		//cached data is re-used
+		QSharedPointer<const QVector<double>> numbers = FilterColumnCache::numbers(vl, i_gnomad);
+		I_EQUAL(numbers->count(), vl.count());
+		IS_TRUE(numbers==FilterColumnCache::numbers(vl, i_gnomad));
+
+		//changed annotation invalidates cached data
+		quint64 generation = vl.generation();
+		vl[0].annotations()[i_gnomad] = "0.5";
+		vl.markModified();
+		IS_TRUE(vl.generation()!=generation);
+		QSharedPointer<const QVector<double>> numbers2 = FilterColumnCache::numbers(vl, i_gnomad);
+		IS_FALSE(numbers==numbers2);
+		F_EQUAL((*numbers2)[0], 0.5);
+
+		//changed variant count invalidates cached data
+		generation = vl.generation();
+		vl.remove(1);
+		IS_TRUE(vl.generation()!=generation);
+		I_EQUAL(FilterColumnCache::numbers(vl, i_gnomad)->count(), vl.count());
+
+		//copies have their own generation
+		VariantList vl_copy = vl;
+		IS_TRUE(vl_copy.generation()!=vl.generation());
+		VariantList vl_assigned;
+		vl_assigned = vl;
+		IS_TRUE(vl_assigned.generation()!=vl.generation());
+		IS_TRUE(vl_assigned.generation()!=vl_copy.generation());
+		vl_copy[0].annotations()[i_gnomad] = "0.25";
+		vl_copy.markModified();
+		F_EQUAL((*FilterColumnCache::numbers(vl_copy, i_gnomad))[0], 0.25);
+		F_EQUAL((*FilterColumnCache::numbers(vl, i_gnomad))[0], 0.5);
+
+		//filter result changes accordingly
+		FilterAlleleFrequency filter;
+		filter.setDouble("max_af", 1.0);
+		FilterResult result(vl.count());
+		filter.apply(vl, result);
+		int passing = result.countPassing();
+		int i_1000g = vl.annotationIndexByName("1000g", true, false);
+		for (int i=0; i<vl.count(); ++i)
+		{
+			vl[i].annotations()[i_gnomad] = "0.001";
+			if (i_1000g!=-1) vl[i].annotations()[i_1000g] = "0.001";
+		}
+		vl.markModified();
+		result.reset();
+		filter.apply(vl, result);
+		IS_TRUE(passing<vl.count());
+		I_EQUAL(result.countPassing(), vl.count());
+
+		//impacts
+		int i_co_sp = vl.annotationIndexByName("coding_and_splicing");
+		QSharedPointer<const QVector<quint8>> impacts = FilterColumnCache::impacts(vl, i_co_sp);
+		for (int i=0; i<vl.count(); ++i)
+		{
+			IS_TRUE(((*impacts)[i] & FilterColumnCache::HIGH)==0 || vl[i].annotations()[i_co_sp].contains(":HIGH:"));
+		}
+		I_EQUAL((int)FilterColumnCache::impactMask("MODERATE"), (int)FilterColumnCache::MODERATE);
+		I_EQUAL((int)FilterColumnCache::impactMask("INVALID"), 0);
+
+		FilterColumnCache::clear();
+	}
+
 	void FilterSubpopulationAlleleFrequency_apply()
 	{
 		VariantList vl;
@@ -1155,6 +1224,67 @@ private slots:
 	}
 
 
+	/********************************************* Incremental filter cascade *********************************************/
+
+	void FilterCascade_applyIncremental()
+	{
+		VariantList vl;
+		vl.load(TESTDATA("data_in/VariantFilter_in.GSvar"));
+
+		FilterCascade cascade;
+		cascade.add(FilterFactory::create("Allele frequency", QStringList() << "max_af=1.0"));
+		cascade.add(FilterFactory::create("Impact", QStringList() << "impact=HIGH,MODERATE"));
+		cascade.add(FilterFactory::create("Filter column empty"));
+
+		//first application is the same as non-incremental application
+		FilterResult result = cascade.applyIncremental(vl);
+		IS_TRUE(result.flags()==cascade.apply(vl).flags());
+		I_EQUAL(cascade.filterTimes().count(), 3);
+
+		//change of last filter re-uses the results of the first filters
+		cascade[2]->toggleEnabled();
+		result = cascade.applyIncremental(vl);
+		QVector<int> times = cascade.filterTimes();
+		I_EQUAL(times[0], -1);
+		I_EQUAL(times[1], -1);
+		IS_TRUE(times[2]>=0);
+		IS_TRUE(result.flags()==cascade.apply(vl).flags());
+
+		//change of first filter
+		cascade[0]->setDouble("max_af", 5.0);
+		result = cascade.applyIncremental(vl);
+		IS_TRUE(cascade.filterTimes()[0]>=0);
+		IS_TRUE(result.flags()==cascade.apply(vl).flags());
+
+		//removed filter
+		cascade.removeAt(1);
+		result = cascade.applyIncremental(vl);
+		IS_TRUE(result.flags()==cascade.apply(vl).flags());
+
+		//changed variant list
+		vl.remove(0);
+		result = cascade.applyIncremental(vl);
+		I_EQUAL(result.flags().count(), vl.count());
+		IS_TRUE(result.flags()==cascade.apply(vl).flags());
+
+		//variants re-ordered in place (same count)
+		vl.sortByAnnotation(vl.annotationIndexByName("filter"));
+		result = cascade.applyIncremental(vl);
+		IS_TRUE(cascade.filterTimes()[0]>=0);
+		IS_TRUE(result.flags()==cascade.apply(vl).flags());
+
+		//variants modified in place (same count)
+		int i_filter = vl.annotationIndexByName("filter");
+		for (int i=0; i<vl.count(); ++i)
+		{
+			vl[i].annotations()[i_filter] = (i%2==0) ? "off-target" : "";
+		}
+		vl.markModified();
+		result = cascade.applyIncremental(vl);
+		IS_TRUE(cascade.filterTimes()[0]>=0);
+		IS_TRUE(result.flags()==cascade.apply(vl).flags());
+	}
+
 	/********************************************* Filters for small variants (somatic tumor-only) *********************************************/
 
 	void FilterSomaticAlleleFrequency_apply_tumor_only()
@@ -0,0 +1,111 @@
+#include "TestFramework.h"
+#include "KnownVariantPanel.h"
+
+TEST_CLASS(KnownVariantPanel_Test)
+{
+Q_OBJECT
+private slots:
+
+	void snps()
+	{
+		const KnownVariantPanel& panel = KnownVariantPanel::snps(GenomeBuild::HG38);
+		I_EQUAL(panel.count(), 100779);
+		I_EQUAL(panel.afKeys().count(), 1);
+		S_EQUAL(panel.afKeys()[0], "AF");
+
+		//first variant (insertion)
+		S_EQUAL(panel.chr(0).str(), "chr1");
+		I_EQUAL(panel.start(0), 13417);
+		I_EQUAL(panel.end(0), 13417);
+		S_EQUAL(panel.ref(0), "C");
+		S_EQUAL(panel.alt(0), "CGAGA");
+		IS_FALSE(panel.isSNV(0));
+		F_EQUAL(panel.af(0), 0.11359);
+
+		//panel is shared
+		IS_TRUE(&panel==&KnownVariantPanel::snps(GenomeBuild::HG38));
+	}
+
+	void select()
+	{
+		const KnownVariantPanel& panel = KnownVariantPanel::snps(GenomeBuild::HG38);
+
+		//AF range
+		QVector<int> indices = panel.select(true, 0.2, 0.8);
+		I_EQUAL(indices.count(), 29280);
+		I_EQUAL(indices[0], 10);
+		I_EQUAL(indices[1], 12);
+		I_EQUAL(indices[2], 13);
+
+		//ROI overlapping a deletion that starts before the region
+		BedFile roi("chr1", 939400, 939400);
+		indices = panel.select(false, roi);
+		I_EQUAL(indices.count(), 1);
+		I_EQUAL(indices[0], 26);
+		indices = panel.select(true, roi);
+		I_EQUAL(indices.count(), 0);
+
+		//invalid AF range
+		IS_THROWN(ArgumentException, panel.select(true, 0.2, 1.2));
+
+		//unsorted ROI
+		BedFile roi_unsorted;
+		roi_unsorted.append(BedLine("chr2", 1, 1000000));
+		roi_unsorted.append(BedLine("chr1", 1, 1000000));
+		IS_THROWN(ArgumentException, panel.select(false, roi_unsorted));
+	}
+
+	void toVcfFile()
+	{
+		const KnownVariantPanel& panel = KnownVariantPanel::snps(GenomeBuild::HG38);
+
+		//header, quality and INFO entries as in the resource file
+		VcfFile vcf = panel.toVcfFile(QVector<int>() << 0 << 1);
+		I_EQUAL(vcf.count(), 2);
+		const InfoFormatLine& info_line = vcf.vcfHeader().infoLineByID("AF");
+		S_EQUAL(info_line.number, ".");
+		S_EQUAL(info_line.type, "Float");
+		S_EQUAL(info_line.description, "Allele Frequency");
+		S_EQUAL(vcf[0].chr().str(), "chr1");
+		I_EQUAL(vcf[0].start(), 13417);
+		S_EQUAL(vcf[0].ref(), "C");
+		S_EQUAL(vcf[0].altString(), "CGAGA");
+		F_EQUAL(vcf[0].qual(), 30.0);
+		S_EQUAL(vcf[0].info("AF"), "0.11359");
+		S_EQUAL(vcf[1].info("AF"), "0.16844");
+	}
+
+	void ancestry()
+	{
+		const KnownVariantPanel& panel = KnownVariantPanel::ancestry(GenomeBuild::HG38);
+		I_EQUAL(panel.count(), 3900);
+
+		int index = panel.find("chr1", 946247, "G", "A");
+		I_EQUAL(index, 2);
+		F_EQUAL(panel.af(index, panel.afIndex("AF_AFR")), 0.130);
+		F_EQUAL(panel.af(index, panel.afIndex("AF_EAS")), 0.658);
+		F_EQUAL(panel.af(index, panel.afIndex("AF_EUR")), 0.636);
+		F_EQUAL(panel.af(index, panel.afIndex("AF_SAS")), 0.565);
+
+		I_EQUAL(panel.find("chr1", 946247, "G", "C"), -1);
+		I_EQUAL(panel.find("chr1", 946248, "G", "A"), -1);
+		I_EQUAL(panel.find("chrMT", 946247, "G", "A"), -1);
+		IS_THROWN(ArgumentException, panel.afIndex("AF"));
+	}
+
+	void createBinary()
+	{
+		//the binary resource files are up-to-date with the VCF files
+		QStringList panels = QStringList() << "hg19_snps" << "hg19_ancestry" << "hg38_snps" << "hg38_ancestry";
+		foreach(const QString& panel, panels)
+		{
+			KnownVariantPanel::createBinary(TESTDATA("../cppNGS/Resources/" + panel + ".vcf"), "out/KnownVariantPanel_" + panel + ".bin");
+
+			QFile file("out/KnownVariantPanel_" + panel + ".bin");
+			IS_TRUE(file.open(QIODevice::ReadOnly));
+			QFile resource(":/Resources/" + panel + ".bin");
+			IS_TRUE(resource.open(QIODevice::ReadOnly));
+			IS_TRUE(file.readAll()==resource.readAll());
+		}
+	}
+};
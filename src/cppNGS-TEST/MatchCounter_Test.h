@@ -0,0 +1,98 @@
+#include "TestFramework.h"
+#include "MatchCounter.h"
+#include <random>
+
+TEST_CLASS(MatchCounter_Test)
+{
+Q_OBJECT
+private:
+	QByteArray randomSequence(std::mt19937& gen, int length, const QByteArray& alphabet)
+	{
+		std::uniform_int_distribution<int> dist(0, alphabet.count()-1);
+		QByteArray output(length, ' ');
+		for (int i=0; i<length; ++i)
+		{
+			output[i] = alphabet[dist(gen)];
+		}
+		return output;
+	}
+
+	//compares the counts of all supported implementations with the scalar implementation
+	void compareImplementations(const QByteArray& seq1, const QByteArray& seq2, int max_mismatches)
+	{
+		MatchCounts expected;
+		MatchCounter::countScalar(seq1.constData(), seq2.constData(), seq1.count(), expected, max_mismatches);
+
+		QList<MatchCounter::Implementation> impls;
+		impls << MatchCounter::SCALAR << MatchCounter::SSE2 << MatchCounter::AVX2;
+		foreach(MatchCounter::Implementation impl, impls)
+		{
+			if (!MatchCounter::supported(impl)) continue;
+
+			MatchCounter::setImplementation(impl);
+			I_EQUAL(MatchCounter::implementation(), impl);
+
+			MatchCounts counts;
+			MatchCounter::count(seq1.constData(), seq2.constData(), seq1.count(), counts, max_mismatches);
+			I_EQUAL(counts.matches, expected.matches);
+			I_EQUAL(counts.mismatches, expected.mismatches);
+			I_EQUAL(counts.invalid, expected.invalid);
+		}
+	}
+
+private slots:
+
+	void scalar()
+	{
+		MatchCounts counts;
+		MatchCounter::countScalar("ACGTNACGTA", "ACGANNCGTT", 10, counts, 100);
+		I_EQUAL(counts.matches, 6);
+		I_EQUAL(counts.mismatches, 2);
+		I_EQUAL(counts.invalid, 2);
+
+		//abort after the mismatch limit is exceeded
+		counts = MatchCounts();
+		MatchCounter::countScalar("AAAAAAAAAA", "AACAACAAAC", 10, counts, 1);
+		I_EQUAL(counts.matches, 4);
+		I_EQUAL(counts.mismatches, 2);
+		I_EQUAL(counts.invalid, 0);
+	}
+
+	void implementations_equal()
+	{
+		std::mt19937 gen(4711);
+
+		//edge lengths around the SSE2/AVX2 block sizes
+		QList<int> lengths;
+		for (int length=0; length<=70; ++length) lengths << length;
+		lengths << 95 << 96 << 97 << 127 << 128 << 129 << 151 << 250 << 301;
+
+		//similar sequences (few mismatches), random sequences and sequences with many Ns
+		QList<QByteArray> alphabets;
+		alphabets << "ACGT" << "ACGTN" << "NNNA";
+
+		foreach(int length, lengths)
+		{
+			foreach(const QByteArray& alphabet, alphabets)
+			{
+				QByteArray seq1 = randomSequence(gen, length, alphabet);
+				QByteArray seq2 = randomSequence(gen, length, alphabet);
+				QByteArray seq2_similar = seq1;
+				for (int i=0; i<length; i+=13)
+				{
+					seq2_similar[i] = 'A';
+				}
+
+				foreach(int max_mismatches, QList<int>() << 0 << 1 << 3 << 10 << std::numeric_limits<int>::max())
+				{
+					compareImplementations(seq1, seq2, max_mismatches);
+					compareImplementations(seq1, seq2_similar, max_mismatches);
+					compareImplementations(seq1, seq1, max_mismatches);
+				}
+			}
+		}
+
+		MatchCounter::setImplementation(MatchCounter::AUTO);
+		IS_TRUE(MatchCounter::implementation()!=MatchCounter::AUTO);
+	}
+};
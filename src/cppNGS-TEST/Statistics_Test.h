@@ -687,6 +687,30 @@ TEST_CLASS(Statistics_Test)
 		I_EQUAL(low_cov.baseCount(), 0);
 	}
 
+	void lowCoverage_roi_mapq20_sweep()
+	{
+		BedFile bed_file;
+		bed_file.load(TESTDATA("data_in/panel.bed"));
+		bed_file.merge();
+
+		BedFile low_cov =  Statistics::lowCoverage(bed_file, TESTDATA("data_in/panel.bam"), 20, 20, 0, 2, QString(), false);
+		I_EQUAL(low_cov.count(), 450);
+		I_EQUAL(low_cov.baseCount(), 16129);
+
+		BedFile low_cov_random = Statistics::lowCoverage(bed_file, TESTDATA("data_in/panel.bam"), 20, 20, 0, 2, QString(), true);
+		I_EQUAL(low_cov.count(), low_cov_random.count());
+		for (int i=0; i<low_cov.count(); ++i)
+		{
+			S_EQUAL(low_cov[i].toString(true), low_cov_random[i].toString(true));
+		}
+
+		//with base quality cutoff
+		low_cov = Statistics::lowCoverage(bed_file, TESTDATA("data_in/panel.bam"), 20, 20, 30, 2, QString(), false);
+		low_cov_random = Statistics::lowCoverage(bed_file, TESTDATA("data_in/panel.bam"), 20, 20, 30, 2, QString(), true);
+		I_EQUAL(low_cov.count(), low_cov_random.count());
+		I_EQUAL(low_cov.baseCount(), low_cov_random.baseCount());
+	}
+
 	void highCoverage_roi_mapq20()
 	{
 		BedFile bed_file;
@@ -714,6 +738,17 @@ TEST_CLASS(Statistics_Test)
 		}
 	}
 
+	void highCoverage_roi_mapq20_sweep()
+	{
+		BedFile bed_file;
+		bed_file.load(TESTDATA("data_in/panel.bed"));
+		bed_file.merge();
+
+		BedFile high_cov = Statistics::highCoverage(bed_file, TESTDATA("data_in/panel.bam"), 20, 20, 0, 2, QString(), false);
+		I_EQUAL(high_cov.count(), 1707);
+		I_EQUAL(high_cov.baseCount(), 255407);
+	}
+
 	void avgCoverage_overlapping_regions()
 	{
 		BedFile bed_file;
@@ -772,6 +807,40 @@ TEST_CLASS(Statistics_Test)
 		}
 	}
 
+	void avgCoverage_sweep()
+	{
+		BedFile bed_file;
+		bed_file.append(BedLine("chr1", 11013718, 11013975));
+		bed_file.append(BedLine("chr1", 11013718, 11013818));
+		bed_file.append(BedLine("chr1", 11013818, 11013975));
+		bed_file.sort();
+
+		Statistics::avgCoverage(bed_file, TESTDATA("data_in/panel.bam"), 20, 1, 2, QString(), false);
+
+		I_EQUAL(bed_file.count(), 3);
+		I_EQUAL(bed_file[0].start(), 11013718);
+		I_EQUAL(bed_file[0].end(), 11013818);
+		S_EQUAL(bed_file[0].annotations()[0], QString("75.07"));
+		I_EQUAL(bed_file[1].start(), 11013718);
+		I_EQUAL(bed_file[1].end(), 11013975);
+		S_EQUAL(bed_file[1].annotations()[0], QString("106.40"));
+		I_EQUAL(bed_file[2].start(), 11013818);
+		I_EQUAL(bed_file[2].end(), 11013975);
+		S_EQUAL(bed_file[2].annotations()[0], QString("126.03"));
+
+		//compare to random access
+		BedFile bed_file2;
+		bed_file2.load(TESTDATA("data_in/panel.bed"));
+		BedFile bed_file3 = bed_file2;
+		Statistics::avgCoverage(bed_file2, TESTDATA("data_in/panel.bam"), 20, 4, 2, QString(), false);
+		Statistics::avgCoverage(bed_file3, TESTDATA("data_in/panel.bam"), 20, 4, 2, QString(), true);
+		I_EQUAL(bed_file2.count(), bed_file3.count());
+		for (int i=0; i<bed_file2.count(); ++i)
+		{
+			S_EQUAL(bed_file2[i].annotations().last(), bed_file3[i].annotations().last());
+		}
+	}
+
 	void genderXY()
 	{
 		GenderEstimate estimate = Statistics::genderXY(TESTDATA("data_in/panel.bam"));
@@ -0,0 +1,115 @@
+#include "TestFramework.h"
+#include "TranscriptDatabase.h"
+
+TEST_CLASS(TranscriptDatabase_Test)
+{
+Q_OBJECT
+private slots:
+
+	void store_and_load()
+	{
+		GffSettings settings;
+		settings.print_to_stdout = false;
+		settings.include_all = true;
+		GffData gff = NGSHelper::loadGffFile(TESTDATA("data_in/NGSHelper_loadGffFile_in1.gff3"), settings);
+		gff.transcripts.sortByPosition();
+
+		TranscriptDatabase::store(gff, settings, "out/TranscriptDatabase_out1.tdb", TESTDATA("data_in/NGSHelper_loadGffFile_in1.gff3"));
+		IS_TRUE(TranscriptDatabase::isDatabaseFile("out/TranscriptDatabase_out1.tdb"));
+		IS_FALSE(TranscriptDatabase::isDatabaseFile(TESTDATA("data_in/NGSHelper_loadGffFile_in1.gff3")));
+		IS_TRUE(TranscriptDatabase::isUpToDate("out/TranscriptDatabase_out1.tdb", TESTDATA("data_in/NGSHelper_loadGffFile_in1.gff3")));
+		IS_FALSE(TranscriptDatabase::isUpToDate("out/TranscriptDatabase_out1.tdb", TESTDATA("data_in/NGSHelper_loadGffFile_in2.gff3.gz")));
+
+		GffSettings db_settings;
+		GffData db = TranscriptDatabase::load("out/TranscriptDatabase_out1.tdb", &db_settings);
+		S_EQUAL(db_settings.source, "ensembl");
+		IS_TRUE(db_settings.include_all);
+		IS_FALSE(db_settings.skip_not_hgnc);
+
+		//transcripts
+		I_EQUAL(db.transcripts.count(), gff.transcripts.count());
+		for (int i=0; i<gff.transcripts.count(); ++i)
+		{
+			const Transcript& t1 = gff.transcripts[i];
+			const Transcript& t2 = db.transcripts[i];
+			S_EQUAL(t2.name(), t1.name());
+			I_EQUAL(t2.version(), t1.version());
+			S_EQUAL(t2.nameCcds(), t1.nameCcds());
+			S_EQUAL(t2.gene(), t1.gene());
+			S_EQUAL(t2.geneId(), t1.geneId());
+			S_EQUAL(t2.hgncId(), t1.hgncId());
+			I_EQUAL(t2.source(), t1.source());
+			I_EQUAL(t2.strand(), t1.strand());
+			I_EQUAL(t2.biotype(), t1.biotype());
+			S_EQUAL(t2.chr().str(), t1.chr().str());
+			I_EQUAL(t2.start(), t1.start());
+			I_EQUAL(t2.end(), t1.end());
+			I_EQUAL(t2.codingStart(), t1.codingStart());
+			I_EQUAL(t2.codingEnd(), t1.codingEnd());
+			S_EQUAL(t2.regions().toText(), t1.regions().toText());
+			S_EQUAL(t2.codingRegions().toText(), t1.codingRegions().toText());
+			IS_TRUE(t2.isGencodeBasicTranscript()==t1.isGencodeBasicTranscript());
+			IS_TRUE(t2.isEnsemblCanonicalTranscript()==t1.isEnsemblCanonicalTranscript());
+			IS_TRUE(t2.isManeSelectTranscript()==t1.isManeSelectTranscript());
+			IS_TRUE(t2.isManePlusClinicalTranscript()==t1.isManePlusClinicalTranscript());
+		}
+
+		//maps
+		I_EQUAL(db.enst2ensg.count(), gff.enst2ensg.count());
+		IS_TRUE(db.enst2ensg==gff.enst2ensg);
+		I_EQUAL(db.ensg2symbol.count(), gff.ensg2symbol.count());
+		IS_TRUE(db.ensg2symbol==gff.ensg2symbol);
+	}
+
+	void store_and_load_ids()
+	{
+		GffSettings settings;
+		settings.print_to_stdout = false;
+		GffData gff = NGSHelper::loadGffFile(TESTDATA("data_in/NGSHelper_loadGffFile_in1.gff3"), settings);
+
+		//unsorted transcripts with identifiers > exception
+		QVector<int> ids;
+		for (int i=0; i<gff.transcripts.count(); ++i) ids << 1000 + i;
+		if (!gff.transcripts.isSortedByPosition())
+		{
+			IS_THROWN(ArgumentException, TranscriptDatabase::store(gff, settings, "out/TranscriptDatabase_out3.tdb", QString(), ids));
+		}
+
+		//sorted transcripts with identifiers
+		gff.transcripts.sortByPosition();
+		IS_THROWN(ArgumentException, TranscriptDatabase::store(gff, settings, "out/TranscriptDatabase_out3.tdb", QString(), ids.mid(1)));
+		TranscriptDatabase::store(gff, settings, "out/TranscriptDatabase_out3.tdb", QString(), ids);
+
+		QVector<int> db_ids;
+		GffData db = TranscriptDatabase::load("out/TranscriptDatabase_out3.tdb", nullptr, &db_ids);
+		I_EQUAL(db.transcripts.count(), gff.transcripts.count());
+		IS_TRUE(db_ids==ids);
+
+		//no identifiers
+		TranscriptDatabase::store(gff, settings, "out/TranscriptDatabase_out4.tdb");
+		TranscriptDatabase::load("out/TranscriptDatabase_out4.tdb", nullptr, &db_ids);
+		I_EQUAL(db_ids.count(), gff.transcripts.count());
+		I_EQUAL(db_ids[0], -1);
+	}
+
+	void load_corrupt()
+	{
+		GffSettings settings;
+		settings.print_to_stdout = false;
+		GffData gff = NGSHelper::loadGffFile(TESTDATA("data_in/NGSHelper_loadGffFile_in1.gff3"), settings);
+		TranscriptDatabase::store(gff, settings, "out/TranscriptDatabase_out2.tdb");
+
+		//flip the last byte > checksum mismatch
+		QFile file("out/TranscriptDatabase_out2.tdb");
+		IS_TRUE(file.open(QIODevice::ReadWrite));
+		file.seek(file.size()-1);
+		char c;
+		file.getChar(&c);
+		file.seek(file.size()-1);
+		file.putChar(c ^ 1);
+		file.close();
+
+		IS_THROWN(FileParseException, TranscriptDatabase::load("out/TranscriptDatabase_out2.tdb"));
+		IS_THROWN(FileParseException, TranscriptDatabase::load(TESTDATA("data_in/NGSHelper_loadGffFile_in1.gff3")));
+	}
+};
@@ -1358,6 +1358,47 @@ private slots:
 		I_EQUAL(hgvs.intron_number, -1);
 	}
 
+	void shared_sequence_cache()
+	{
+		QString ref_file = Settings::string("reference_genome", true);
+		if (ref_file=="") SKIP("Test needs the reference genome!");
+		FastaFileIndex reference(ref_file);
+
+		QSharedPointer<TranscriptSequenceCache> cache(new TranscriptSequenceCache());
+		VariantHgvsAnnotator var_hgvs_anno(reference, VariantHgvsAnnotator::Parameters(5000, 3, 8, 8), cache);
+		VariantHgvsAnnotator var_hgvs_anno2(reference, VariantHgvsAnnotator::Parameters(5000, 3, 8, 8), cache);
+		Transcript t = trans_SLC51A();
+
+		//first variant: sequences are extracted from the reference genome
+		VcfLine variant(Chromosome("chr3"), 196217926, "A", QList<Sequence>() << "G");
+		VariantConsequence hgvs = var_hgvs_anno.annotate(t, variant);
+		S_EQUAL(hgvs.hgvs_p, "p.Gln41=");
+		I_EQUAL(cache->misses(), 1);
+		I_EQUAL(cache->hits(), 0);
+
+		//further variants: sequences are taken from the cache (also by the second annotator)
+		variant.setPos(196233116);
+		variant.setRef("C");
+		variant.setSingleAlt("T");
+		hgvs = var_hgvs_anno2.annotate(t, variant);
+		S_EQUAL(hgvs.hgvs_p, "p.Arg314Ter");
+
+		variant.setPos(196233197);
+		variant.setRef("T");
+		variant.setSingleAlt("C");
+		hgvs = var_hgvs_anno.annotate(t, variant);
+		S_EQUAL(hgvs.hgvs_p, "p.Ter341GlnextTer7");
+		I_EQUAL(cache->misses(), 1);
+		I_EQUAL(cache->hits(), 2);
+
+		//other transcript
+		t.setVersion(t.version() + 1);
+		hgvs = var_hgvs_anno2.annotate(t, variant);
+		S_EQUAL(hgvs.hgvs_p, "p.Ter341GlnextTer7");
+		I_EQUAL(cache->misses(), 2);
+		I_EQUAL(cache->hits(), 2);
+	}
+
 	//TODO Marc: Error processing variant chr7:157009949 A>CGCGGCGGCG and transcript ENST00000252971.11: Coding sequence length must be multiple of three. (1 times, e.g. in DNA2206556A1_02)
 	//TODO Marc: Error processing variant chr17:31229232 CGTA>TGTC: Coding sequence length must be multiple of three
 };
@@ -197,6 +197,85 @@ private slots:
 		I_EQUAL(vl.annotations().count(), 30);
 	}
 
+	void storeBinary()
+	{
+		//round-trip: TSV > binary > TSV
+		VariantList vl;
+		vl.load(TESTDATA("data_in/panel_vep.GSvar"));
+		vl.store("out/VariantList_storeBinary_01.tsv");
+		vl.storeBinary("out/VariantList_storeBinary.bin");
+		vl.clear();
+
+		vl.loadBinary("out/VariantList_storeBinary.bin");
+		vl.checkValid();
+		I_EQUAL(vl.count(), 329);
+		I_EQUAL(vl.annotations().count(), 30);
+		I_EQUAL(vl.filters().count(), 2);
+		S_EQUAL(vl[328].annotations().at(7), QByteArray("rs6512586"));
+		vl.store("out/VariantList_storeBinary_02.tsv");
+		COMPARE_FILES("out/VariantList_storeBinary_02.tsv", "out/VariantList_storeBinary_01.tsv");
+
+		//with ROI
+		BedFile roi;
+		roi.append(BedLine("chr16", 89805260, 89805978));
+		roi.append(BedLine("chr19", 17379550, 17382510));
+		vl.loadBinary("out/VariantList_storeBinary.bin", &roi);
+		I_EQUAL(vl.count(), 4);
+		X_EQUAL(vl[0].chr(), Chromosome("chr16"));
+		I_EQUAL(vl[0].start(), 89805261);
+		X_EQUAL(vl[3].chr(), Chromosome("chr19"));
+		I_EQUAL(vl[3].start(), 17382505);
+		vl.loadBinary("out/VariantList_storeBinary.bin", &roi, true);
+		I_EQUAL(vl.count(), 325);
+
+		//corrupt file
+		QFile::remove("out/VariantList_storeBinary_corrupt.bin");
+		QFile::copy("out/VariantList_storeBinary.bin", "out/VariantList_storeBinary_corrupt.bin");
+		QFile file("out/VariantList_storeBinary_corrupt.bin");
+		file.open(QIODevice::ReadWrite);
+		file.seek(file.size()-1);
+		char last = file.read(1)[0];
+		file.seek(file.size()-1);
+		file.write(QByteArray(1, last=='A' ? 'C' : 'A'));
+		file.close();
+		IS_THROWN(FileParseException, vl.loadBinary("out/VariantList_storeBinary_corrupt.bin"));
+
+		//truncated file
+		file.open(QIODevice::ReadWrite);
+		file.resize(file.size()-1);
+		file.close();
+		IS_THROWN(FileParseException, vl.loadBinary("out/VariantList_storeBinary_corrupt.bin"));
+	}
+
+	void loadWithCache()
+	{
+		QString filename = "out/VariantList_loadWithCache.GSvar";
+		QFile::remove(filename);
+		QFile::remove(VariantList::binaryCacheFile(filename));
+		QFile::copy(TESTDATA("data_in/panel_vep.GSvar"), filename);
+		IS_FALSE(VariantList::binaryCacheIsValid(filename));
+
+		//first load creates the cache file
+		VariantList vl;
+		vl.loadWithCache(filename);
+		I_EQUAL(vl.count(), 329);
+		IS_TRUE(VariantList::binaryCacheIsValid(filename));
+
+		//second load uses the cache file
+		vl.loadWithCache(filename);
+		I_EQUAL(vl.count(), 329);
+		I_EQUAL(vl.annotations().count(), 30);
+		S_EQUAL(vl[0].annotations().at(7), QByteArray("rs12569127"));
+
+		//cache is outdated when the file changes
+		vl.removeAnnotation(29);
+		vl.store(filename);
+		IS_FALSE(VariantList::binaryCacheIsValid(filename));
+		vl.loadWithCache(filename);
+		I_EQUAL(vl.annotations().count(), 29);
+		IS_TRUE(VariantList::binaryCacheIsValid(filename));
+	}
+
 	void annotationIndexByName()
 	{
 		VariantList vl;
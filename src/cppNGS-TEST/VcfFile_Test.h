@@ -358,6 +358,36 @@ private slots:
 		S_EQUAL(vl[156].info("EXAC_AF"), "0.516");
 	}
 
+	void loadParallel()
+	{
+		//small chunks to test merging of chunks
+		QStringList files;
+		files << TESTDATA("data_in/panel_vep.vcf") << TESTDATA("data_in/VariantList_load_zipped.vcf.gz") << TESTDATA("data_in/VariantList_loadFromVCF_undeclaredAnnotations.vcf") << TESTDATA("data_in/sort_in.vcf");
+		for (int i=0; i<files.count(); ++i)
+		{
+			VcfFile expected;
+			expected.load(files[i]);
+			expected.store("out/VcfFile_loadParallel_expected" + QString::number(i) + ".vcf");
+
+			VcfFile vl;
+			vl.loadParallel(files[i], true, nullptr, false, 3, 7);
+			I_EQUAL(vl.count(), expected.count());
+			vl.store("out/VcfFile_loadParallel_out" + QString::number(i) + ".vcf");
+			COMPARE_FILES("out/VcfFile_loadParallel_out" + QString::number(i) + ".vcf", "out/VcfFile_loadParallel_expected" + QString::number(i) + ".vcf");
+		}
+
+		//public interface with ROI
+		BedFile roi;
+		roi.append(BedLine("chr17", 72196820, 72196892));
+		roi.append(BedLine("chr18", 67904549, 67904670));
+		VcfFile vl;
+		vl.load(TESTDATA("data_in/panel_snpeff.vcf"), roi, false, false, 4);
+		I_EQUAL(vl.count(), 4);
+		I_EQUAL(vl.sampleIDs().count(), 1);
+		I_EQUAL(vl[0].start(), 72196887);
+		I_EQUAL(vl[3].start(), 67904586);
+	}
+
 	void vepIndexByName()
 	{
 		VcfFile vl;
@@ -379,6 +409,28 @@ private slots:
 		VCF_IS_VALID("out/sort_out.vcf")
 	}
 
+	void sortExternal()
+	{
+		//small chunks and merge fan-in to test intermediate merges
+		ExternalSortSettings settings;
+		settings.buffer_size = 20000;
+		settings.threads = 3;
+		settings.max_merge_runs = 4;
+		VcfFile::sortExternal(TESTDATA("data_in/sort_in.vcf"), "out/sortExternal_out.vcf", settings);
+		COMPARE_FILES("out/sortExternal_out.vcf",TESTDATA("data_out/sort_out.vcf"));
+
+		//sort by FAI file with compressed temporary files
+		VcfFile vl;
+		vl.load(TESTDATA("data_in/panel_snpeff.vcf"));
+		vl.sortByFile(TESTDATA("data_in/variantList_sortbyFile.fai"));
+		vl.store("out/sortExternal_expected2.vcf", false, BGZF_NO_COMPRESSION);
+
+		settings.buffer_size = 1000;
+		settings.compress_runs = true;
+		VcfFile::sortExternal(TESTDATA("data_in/panel_snpeff.vcf"), "out/sortExternal_out2.vcf", settings, false, TESTDATA("data_in/variantList_sortbyFile.fai"));
+		COMPARE_FILES("out/sortExternal_out2.vcf", "out/sortExternal_expected2.vcf");
+	}
+
 	void storeAfterAddingSample()
 	{
 		VcfFile vl;
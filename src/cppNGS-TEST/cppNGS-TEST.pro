@@ -44,6 +44,7 @@ HEADERS += \
     Chromosome_Test.h \
     BedLine_Test.h \
     BedFile_Test.h \
+    BinaryFileHeader_Test.h \
     VariantList_Test.h \
     FilterCascade_Test.h \
     ChromosomalIndex_Test.h \
@@ -70,7 +71,11 @@ HEADERS += \
     SomaticVariantInterpreter_Test.h \
     Graph_Test.h \
     ChainFileReader_Test.h \
+    KnownVariantPanel_Test.h \
+    MatchCounter_Test.h \
+    TranscriptDatabase_Test.h \
     BigWigReader_Test.h \
+    CsrGraph_Test.h \
     VariantHgvsAnnotator_Test.h \
     TabIndexedFile_Test.h \
     PipelineSettings_Test.h
@@ -1,6 +1,12 @@
 #include "BamReader.h"
 #include "Exceptions.h"
 #include "Helper.h"
+#include "htslib/thread_pool.h"
+#include <QMutex>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <algorithm>
 
 /*
 External documentation used for the implementation:
@@ -231,8 +237,7 @@ void BamAlignment::qualities(QBitArray& qualities, int min_baseq, int len) const
 	//position in the genome (e.g. contains deletions)
 	int genome_position_index = 0;
 
-	const QList<CigarOp> cigar_data = cigarData();
-	foreach(const CigarOp& op, cigar_data)
+	for (const CigarOp op : cigarView())
 	{
 		if (op.Type==BAM_CMATCH)
 		{
@@ -320,8 +325,8 @@ QPair<char, int> BamAlignment::extractBaseByCIGAR(int pos)
 	//sometimes reads consist of insertions only > skip them
 	if (cigarIsOnlyInsertion()) return qMakePair('~', -1);
 
-	const QList<CigarOp> cigar_data = cigarData();
-	foreach(const CigarOp& op, cigar_data)
+	const CigarView cigar_data = cigarView();
+	for (const CigarOp op : cigar_data)
 	{
 		//update positions
 		if (op.Type==BAM_CMATCH || op.Type==BAM_CEQUAL || op.Type==BAM_CDIFF)
@@ -371,7 +376,7 @@ QPair<char, int> BamAlignment::extractBaseByCIGAR(int pos)
 		}
 	}
 
-	foreach(const CigarOp& op, cigar_data)
+	for (const CigarOp op : cigar_data)
 	{
 		qDebug() <<  op.Type << op.Length;
 	}
@@ -389,9 +394,8 @@ QList<Sequence> BamAlignment::extractIndelsByCIGAR(int pos, int indel_window)
 	//look up indels
 	int read_pos = 0;
 	int genome_pos = start();
-	const QList<CigarOp> cigar_data = cigarData();
-	const QByteArray sequence = bases();
-	foreach(const CigarOp& op, cigar_data)
+	const SequenceView sequence = basesView();
+	for (const CigarOp op : cigarView())
 	{
 		//update positions
 		if (op.Type==BAM_CMATCH) //match or mismatch
@@ -458,6 +462,67 @@ void BamReader::checkChromosomeLengths(const QString& ref_genome)
 	}
 }
 
+//Shared htslib thread pool. It is destroyed when the program exits.
+struct HtsThreadPoolData
+{
+	QMutex mutex;
+	htsThreadPool pool = {nullptr, 0};
+	int threads = 1;
+
+	~HtsThreadPoolData()
+	{
+		if (pool.pool!=nullptr) hts_tpool_destroy(pool.pool);
+	}
+};
+
+static HtsThreadPoolData& htsThreadPoolData()
+{
+	static HtsThreadPoolData data;
+	return data;
+}
+
+void HtsThreadPool::setThreads(int threads)
+{
+	HtsThreadPoolData& data = htsThreadPoolData();
+	QMutexLocker locker(&data.mutex);
+
+	threads = std::max(1, threads);
+	if (threads==data.threads) return;
+
+	//the old pool is not destroyed because it can still be attached to open files
+	data.pool.pool = nullptr;
+	data.threads = threads;
+	if (threads>1)
+	{
+		data.pool.pool = hts_tpool_init(threads);
+		if (data.pool.pool==nullptr)
+		{
+			data.threads = 1;
+			THROW(Exception, "Could not create htslib thread pool with " + QString::number(threads) + " threads!");
+		}
+	}
+}
+
+int HtsThreadPool::threads()
+{
+	HtsThreadPoolData& data = htsThreadPoolData();
+	QMutexLocker locker(&data.mutex);
+
+	return data.threads;
+}
+
+void HtsThreadPool::attach(htsFile* fp, const QString& filename)
+{
+	HtsThreadPoolData& data = htsThreadPoolData();
+	QMutexLocker locker(&data.mutex);
+
+	if (data.pool.pool==nullptr) return;
+	if (hts_set_thread_pool(fp, &data.pool)!=0)
+	{
+		THROW(FileAccessException, "Could not attach thread pool to BAM/CRAM file " + filename);
+	}
+}
+
 void BamReader::init(const QString& bam_file, QString ref_genome)
 {
 	//open file
@@ -466,6 +531,9 @@ void BamReader::init(const QString& bam_file, QString ref_genome)
 		THROW(FileAccessException, "Could not open BAM/CRAM file " + bam_file_);
 	}
 
+	//use shared thread pool for decompression (if enabled)
+	HtsThreadPool::attach(fp_, bam_file_);
+
 	//read header
 	header_ = sam_hdr_read(fp_);
 	if (header_==nullptr)
@@ -485,6 +553,7 @@ void BamReader::init(const QString& bam_file, QString ref_genome)
 
 		checkChromosomeLengths(ref_genome);
 	}
+	ref_genome_ = ref_genome;
 
 	//parse chromosome names and sizes
 	for(int i=0; i<header_->n_targets; ++i)
@@ -606,6 +675,19 @@ void BamReader::setRegion(const Chromosome& chr, int start, int end)
 	}
 }
 
+int BamReader::getNextBatch(QVector<BamAlignment>& batch, int max_count)
+{
+	if (batch.count()<max_count) batch.resize(max_count);
+
+	int count = 0;
+	while (count<max_count && getNextAlignment(batch[count]))
+	{
+		++count;
+	}
+
+	return count;
+}
+
 const QList<Chromosome>& BamReader::chromosomes() const
 {
 	return chrs_;
@@ -689,6 +771,214 @@ Pileup BamReader::getPileup(const Chromosome& chr, int pos, int indel_window, in
 }
 
 
+//Calculates the pileups of one chromosome with an additional reader
+class PileupWorker
+	: public QRunnable
+{
+public:
+	PileupWorker(const QString& bam_file, const QString& ref_genome, const QVector<PileupPosition>& positions, const QVector<int>& order, int first, int last, int indel_window, int min_mapq, bool anom, int min_baseq, QVector<Pileup>& output, QString& error)
+		: bam_file_(bam_file)
+		, ref_genome_(ref_genome)
+		, positions_(positions)
+		, order_(order)
+		, first_(first)
+		, last_(last)
+		, indel_window_(indel_window)
+		, min_mapq_(min_mapq)
+		, anom_(anom)
+		, min_baseq_(min_baseq)
+		, output_(output)
+		, error_(error)
+	{
+	}
+
+	void run() override
+	{
+		try
+		{
+			BamReader reader(bam_file_, ref_genome_);
+			reader.getPileupsOfChromosome(positions_, order_, first_, last_, indel_window_, min_mapq_, anom_, min_baseq_, output_);
+		}
+		catch(Exception& e)
+		{
+			error_ = e.message();
+		}
+	}
+
+protected:
+	QString bam_file_;
+	QString ref_genome_;
+	const QVector<PileupPosition>& positions_;
+	const QVector<int>& order_;
+	int first_;
+	int last_;
+	int indel_window_;
+	int min_mapq_;
+	bool anom_;
+	int min_baseq_;
+	QVector<Pileup>& output_;
+	QString& error_;
+};
+
+QVector<Pileup> BamReader::getPileups(const QVector<PileupPosition>& positions, int indel_window, int min_mapq, bool anom, int min_baseq, int threads)
+{
+	QVector<Pileup> output(positions.count());
+
+	//sort positions by chromosome and position
+	QVector<int> order(positions.count());
+	for (int i=0; i<order.count(); ++i) order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&positions](int a, int b)
+	{
+		if (positions[a].chr!=positions[b].chr) return positions[a].chr<positions[b].chr;
+		return positions[a].pos<positions[b].pos;
+	});
+
+	//determine first/last position of each chromosome
+	QVector<QPair<int, int>> chr_ranges;
+	for (int i=0; i<order.count(); ++i)
+	{
+		if (i==0 || positions[order[i]].chr!=positions[order[i-1]].chr)
+		{
+			chr_ranges << qMakePair(i, i);
+		}
+		chr_ranges.last().second = i;
+	}
+
+	if (threads<=1 || chr_ranges.count()<=1)
+	{
+		foreach(const auto& range, chr_ranges)
+		{
+			getPileupsOfChromosome(positions, order, range.first, range.second, indel_window, min_mapq, anom, min_baseq, output);
+		}
+	}
+	else
+	{
+		//process chromosomes in parallel (each with its own reader)
+		QStringList errors;
+		for (int i=0; i<chr_ranges.count(); ++i) errors << "";
+		QThreadPool pool;
+		pool.setMaxThreadCount(threads);
+		for (int i=0; i<chr_ranges.count(); ++i)
+		{
+			pool.start(new PileupWorker(bam_file_, ref_genome_, positions, order, chr_ranges[i].first, chr_ranges[i].second, indel_window, min_mapq, anom, min_baseq, output, errors[i]));
+		}
+		pool.waitForDone();
+
+		foreach(const QString& error, errors)
+		{
+			if (!error.isEmpty()) THROW(FileAccessException, error);
+		}
+	}
+
+	return output;
+}
+
+void BamReader::getPileupsOfChromosome(const QVector<PileupPosition>& positions, const QVector<int>& order, int first, int last, int indel_window, int min_mapq, bool anom, int min_baseq, QVector<Pileup>& output)
+{
+	//positions that are further apart are processed with a new index query instead of reading all alignments in between
+	const int max_gap = 10000;
+
+	const Chromosome& chr = positions[order[first]].chr;
+	QList<QSharedPointer<BamAlignment>> active; //alignments that overlap the current position or start before it (in file order)
+	QList<QSharedPointer<BamAlignment>> unused; //alignment objects for re-use
+	QVector<BamAlignment> batch; //records re-used by getNextBatch
+	auto takeUnused = [&unused]()
+	{
+		return unused.isEmpty() ? QSharedPointer<BamAlignment>(new BamAlignment()) : unused.takeLast();
+	};
+
+	//calculates the pileup of one position from the active alignments
+	auto calculatePileup = [&](int index)
+	{
+		const int pos = positions[order[index]].pos;
+
+		//remove alignments that end before the position
+		for (int i=active.count()-1; i>=0; --i)
+		{
+			if (active[i]->end()<pos) unused << active.takeAt(i);
+		}
+
+		Pileup& pileup = output[order[index]];
+		int reads_mapped = 0;
+		int reads_mapq0 = 0;
+		foreach(const QSharedPointer<BamAlignment>& al, active)
+		{
+			reads_mapped += 1;
+			if (al->mappingQuality()==0) reads_mapq0 += 1;
+
+			if (al->mappingQuality()<min_mapq) continue;
+
+			//snps
+			QPair<char, int> base = al->extractBaseByCIGAR(pos);
+			if (base.second>=min_baseq)
+			{
+				pileup.inc(base.first);
+			}
+
+			//indels
+			if (indel_window>=0)
+			{
+				pileup.addIndels(al->extractIndelsByCIGAR(pos, indel_window));
+			}
+		}
+
+		pileup.setMapq0Frac((double)reads_mapq0 / reads_mapped);
+	};
+
+	int start = first;
+	while (start<=last)
+	{
+		//determine block of positions without large gaps
+		int end = start;
+		while (end<last && positions[order[end+1]].pos - positions[order[end]].pos <= max_gap) ++end;
+
+		//stream alignments of the block (sorted by start position)
+		setRegion(chr, positions[order[start]].pos, positions[order[end]].pos);
+		unused << active;
+		active.clear();
+		int next = start;
+		int batch_count = 0;
+		while (next<=end && (batch_count = getNextBatch(batch, 1000))>0)
+		{
+			for (int b=0; b<batch_count; ++b)
+			{
+				BamAlignment& al = batch[b];
+
+				//positions before the alignment start are complete
+				while (next<=end && positions[order[next]].pos<al.start())
+				{
+					calculatePileup(next);
+					++next;
+				}
+				if (next>end) break;
+
+				if (!al.isProperPair() && anom==false) continue;
+				if (al.isSecondaryAlignment() || al.isSupplementaryAlignment()) continue;
+				if (al.isDuplicate()) continue;
+				if (al.isUnmapped()) continue;
+
+				//skip alignments that do not overlap any of the remaining positions
+				if (al.end()<positions[order[next]].pos) continue;
+
+				//move the alignment out of the batch (the batch record gets the memory of an unused alignment)
+				QSharedPointer<BamAlignment> active_al = takeUnused();
+				active_al->swap(al);
+				active << active_al;
+			}
+		}
+
+		//remaining positions of the block
+		while (next<=end)
+		{
+			calculatePileup(next);
+			++next;
+		}
+
+		start = end + 1;
+	}
+}
+
+
 VariantDetails BamReader::getVariantDetails(const FastaFileIndex& reference, const Variant& variant)
 {
 	VariantDetails output;
@@ -783,8 +1073,8 @@ void BamReader::getIndels(const FastaFileIndex& reference, const Chromosome& chr
 
 		//run time optimization: skip reads that do not contain Indels
 		bool contains_indels_refskip = false;
-		const QList<CigarOp> cigar_data = al.cigarData();
-		foreach(const CigarOp& op, cigar_data)
+		const CigarView cigar_data = al.cigarView();
+		for (const CigarOp op : cigar_data)
 		{
 			if (op.Type==BAM_CINS || op.Type==BAM_CDEL || op.Type==BAM_CREF_SKIP)
 			{
@@ -797,8 +1087,7 @@ void BamReader::getIndels(const FastaFileIndex& reference, const Chromosome& chr
 		//look up indels
 		int read_pos = 0;
 		int genome_pos = al.start();
-		const QList<CigarOp> cigar_data2 = al.cigarData();
-		foreach(const CigarOp& op, cigar_data2)
+		for (const CigarOp op : cigar_data)
 		{
 			//update positions
 			if (op.Type==BAM_CMATCH)
@@ -810,7 +1099,7 @@ void BamReader::getIndels(const FastaFileIndex& reference, const Chromosome& chr
 			{
 				if (genome_pos>=start && genome_pos<=end)
 				{
-					indels.append(QByteArray("+") + al.bases().mid(read_pos, op.Length));
+					indels.append(QByteArray("+") + al.basesView().mid(read_pos, op.Length));
 				}
 				read_pos += op.Length;
 			}
@@ -27,6 +27,117 @@ struct CPPNGSSHARED_EXPORT CigarOp
 	}
 };
 
+//Read-only view of the CIGAR data of an alignment (no copy). Only valid as long as the alignment is not modified or overwritten.
+class CPPNGSSHARED_EXPORT CigarView
+{
+	public:
+		//Iterator over the CIGAR operations
+		class const_iterator
+		{
+			public:
+				const_iterator(const uint32_t* ptr)
+					: ptr_(ptr)
+				{
+				}
+				CigarOp operator*() const
+				{
+					return CigarOp { (int)bam_cigar_op(*ptr_), (int)bam_cigar_oplen(*ptr_) };
+				}
+				const_iterator& operator++()
+				{
+					++ptr_;
+					return *this;
+				}
+				bool operator!=(const const_iterator& rhs) const
+				{
+					return ptr_!=rhs.ptr_;
+				}
+				bool operator==(const const_iterator& rhs) const
+				{
+					return ptr_==rhs.ptr_;
+				}
+
+			protected:
+				const uint32_t* ptr_;
+		};
+
+		CigarView(const uint32_t* data, int count)
+			: data_(data)
+			, count_(count)
+		{
+		}
+
+		//Returns the number of CIGAR operations.
+		int count() const
+		{
+			return count_;
+		}
+		//Returns the n-th CIGAR operation.
+		CigarOp operator[](int n) const
+		{
+			return CigarOp { (int)bam_cigar_op(data_[n]), (int)bam_cigar_oplen(data_[n]) };
+		}
+		const_iterator begin() const
+		{
+			return const_iterator(data_);
+		}
+		const_iterator end() const
+		{
+			return const_iterator(data_ + count_);
+		}
+
+	protected:
+		const uint32_t* data_;
+		int count_;
+};
+
+//Read-only view of the 4-bit packed sequence bases of an alignment (no copy). Only valid as long as the alignment is not modified or overwritten.
+class CPPNGSSHARED_EXPORT SequenceView
+{
+	public:
+		SequenceView(const uint8_t* data, int length)
+			: data_(data)
+			, length_(length)
+		{
+		}
+
+		//Returns the number of bases.
+		int length() const
+		{
+			return length_;
+		}
+		//Returns the n-th base.
+		char operator[](int n) const
+		{
+			return seq_nt16_str[bam_seqi(data_, n)];
+		}
+		//Returns the 4-bit code of the n-th base (see seq_nt16_str).
+		int code(int n) const
+		{
+			return bam_seqi(data_, n);
+		}
+		//Returns a copy of the given range of bases.
+		Sequence mid(int pos, int length) const
+		{
+			Sequence output;
+			output.resize(length);
+			for (int i=0; i<length; ++i)
+			{
+				output[i] = seq_nt16_str[bam_seqi(data_, pos + i)];
+			}
+			return output;
+		}
+		//Returns a pointer to the packed bases (two bases per byte, high nibble first).
+		const uint8_t* data() const
+		{
+			return data_;
+		}
+
+	protected:
+		const uint8_t* data_;
+		int length_;
+};
+
 //Representation of a BAM alignment
 class CPPNGSSHARED_EXPORT BamAlignment
 {
@@ -37,17 +148,30 @@ class CPPNGSSHARED_EXPORT BamAlignment
 		~BamAlignment();
 		//Copy constructor (makes a deep copy of the alignment > slow)
 		BamAlignment(const BamAlignment& rhs);
-		//Assignment operator
+		//Assignment operator (makes a deep copy of the alignment, but re-uses the already allocated memory)
 		BamAlignment& operator=(const BamAlignment& rhs)
 		{
-			aln_ = bam_dup1(rhs.aln_);
+			if (this!=&rhs && bam_copy1(aln_, rhs.aln_)==nullptr)
+			{
+				THROW(Exception, "Could not copy BAM alignment!");
+			}
 			return *this;
 		}
+		//Swaps the data of two alignments (no copy)
+		void swap(BamAlignment& rhs)
+		{
+			std::swap(aln_, rhs.aln_);
+		}
 
 		//Returns the read name
 		QByteArray name() const
 		{
-			return QByteArray::fromStdString(bam_get_qname(aln_));
+			return QByteArray(bam_get_qname(aln_));
+		}
+		//Returns the read name without copying it (null-terminated).
+		const char* nameRaw() const
+		{
+			return bam_get_qname(aln_);
 		}
 
 		int chromosomeID() const
@@ -171,6 +295,11 @@ class CPPNGSSHARED_EXPORT BamAlignment
 
 		//Returns the CIGAR data.
 		QList<CigarOp> cigarData() const;
+		//Returns the CIGAR data without copying it.
+		CigarView cigarView() const
+		{
+			return CigarView(bam_get_cigar(aln_), aln_->core.n_cigar);
+		}
 		//Sets the CIGAR data.
 		void setCigarData(const QList<CigarOp>& cigar);
 		//Returns the CIGAR data as a string.
@@ -180,6 +309,11 @@ class CPPNGSSHARED_EXPORT BamAlignment
 
 		//Returns the sequence bases.
 		Sequence bases() const;
+		//Returns the sequence bases without copying them.
+		SequenceView basesView() const
+		{
+			return SequenceView(bam_get_seq(aln_), aln_->core.l_qseq);
+		}
 		//Sets the sequence bases.
 		void setBases(const Sequence& bases);
 		//Returns the n-th base.
@@ -199,6 +333,11 @@ class CPPNGSSHARED_EXPORT BamAlignment
 		{
 			return bam_get_qual(aln_)[n];
 		}
+		//Returns the base qualities without copying them (integer values, i.e. not ASCII encoded; length is length()).
+		const uint8_t* qualitiesRaw() const
+		{
+			return bam_get_qual(aln_);
+		}
 		//Fills a bit array representing base qualities - a bit is set if the base quality is >= min_baseq
 		//the array is of size al.end() - al.start() +1 and by that includes deletions
 		void qualities(QBitArray& qualities, int min_baseq, int len) const;
@@ -275,6 +414,29 @@ struct CPPNGSSHARED_EXPORT VariantDetails
 	int obs;
 };
 
+//Process-wide htslib thread pool for BGZF/CRAM (de)compression. It is shared by all BamReader and BamWriter instances.
+//Tools opt in by calling setThreads() before opening BAM/CRAM files. Files opened before are not affected.
+class CPPNGSSHARED_EXPORT HtsThreadPool
+{
+	public:
+		//Sets the number of threads used for (de)compression. Values smaller than 2 disable the pool (default).
+		static void setThreads(int threads);
+		//Returns the number of threads used for (de)compression (1 if the pool is disabled).
+		static int threads();
+		//Attaches the thread pool to an open file. Does nothing if the pool is disabled.
+		static void attach(htsFile* fp, const QString& filename);
+
+	protected:
+		HtsThreadPool() = delete;
+};
+
+//Chromosomal position for the batched pileup calculation (1-based).
+struct CPPNGSSHARED_EXPORT PileupPosition
+{
+	Chromosome chr;
+	int pos;
+};
+
 //C++ wrapper for htslib BAM file access
 class CPPNGSSHARED_EXPORT BamReader
 {
@@ -314,6 +476,9 @@ class CPPNGSSHARED_EXPORT BamReader
 
 			return res>=0;
 		}
+		//Reads up to @p max_count alignments into @p batch and returns the number of alignments read (0 at the end of the file/region).
+		//The alignments in @p batch are re-used, i.e. their memory is allocated only once when the same batch is passed repeatedly.
+		int getNextBatch(QVector<BamAlignment>& batch, int max_count);
 
 		//Returns all chromosomes stored in the BAM header.
 		const QList<Chromosome>& chromosomes() const;
@@ -333,6 +498,13 @@ class CPPNGSSHARED_EXPORT BamReader
 		  @param anom also uses reads which are not properly paired
 		*/
 		Pileup getPileup(const Chromosome& chr, int pos, int indel_window = -1, int min_mapq = 1, bool anom = false, int min_baseq = 13);
+		/**
+		  @brief Returns the pileups at the given chromosomal positions (1-based) in the order of the positions. The pileups are the same as returned by getPileup().
+		  @details The positions are processed sorted by chromosome and position. Each chromosome is read once with a window of the reads overlapping the current position - only large gaps between positions are skipped using the index.
+		  @param threads If larger than 1, chromosomes are processed in parallel, each with an additional reader for the BAM/CRAM file.
+		  @warning WARNING: function changes the set region, re-set your region afterwards
+		*/
+		QVector<Pileup> getPileups(const QVector<PileupPosition>& positions, int indel_window = -1, int min_mapq = 1, bool anom = false, int min_baseq = 13, int threads = 1);
 
 		//Returns the depth/frequency for a variant (start, ref, obs in TSV style). If the depth is 0, quiet_NaN is returned as frequency.
 		VariantDetails getVariantDetails(const FastaFileIndex& reference, const Variant& variant);
@@ -346,6 +518,7 @@ class CPPNGSSHARED_EXPORT BamReader
 
 	protected:
 		QString bam_file_;
+		QString ref_genome_;
 		QList<Chromosome> chrs_;
 		QHash<Chromosome, int> chrs_sizes_;
 		samFile* fp_ = nullptr;
@@ -357,6 +530,8 @@ class CPPNGSSHARED_EXPORT BamReader
 		void clearIterator();
 		void checkChromosomeLengths(const QString& ref_genome);
         void init(const QString& bam_file, QString ref_genome = QString());
+		//Calculates the pileups of the positions order[first] to order[last], which are on the same chromosome and sorted by position (see getPileups()).
+		void getPileupsOfChromosome(const QVector<PileupPosition>& positions, const QVector<int>& order, int first, int last, int indel_window, int min_mapq, bool anom, int min_baseq, QVector<Pileup>& output);
 
 		//"declared away" methods
 		BamReader(const BamReader&) = delete;
@@ -365,6 +540,7 @@ class CPPNGSSHARED_EXPORT BamReader
 		//friends
 		friend class BamWriter;
 		friend class BamWriter_Test;
+		friend class PileupWorker;
 };
 
 #endif // BAMREADER_H
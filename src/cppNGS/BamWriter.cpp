@@ -35,6 +35,9 @@ BamWriter::BamWriter(const QString& bam_file, const QString& ref_file)
 	{
 		THROW(FileAccessException, "Could not open file for writing: " + bam_file_);
 	}
+
+	//use shared thread pool for compression (if enabled)
+	HtsThreadPool::attach(fp_, bam_file_);
 }
 
 BamWriter::~BamWriter()
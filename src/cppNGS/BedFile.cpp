@@ -132,45 +132,59 @@ void BedFile::load(QString filename, bool stdin_if_empty, bool read_annotations)
 		if(line.length()==0) continue;
 
 		//store headers
-		if (line.startsWith("#") || line.startsWith("track ") || line.startsWith("browser ") || line.startsWith("Chromosome\tStart\tEnd"))
+		if (isHeaderLine(line))
 		{
 			headers_.append(line);
 			continue;
 		}
 
-		//error when less than 3 fields
-		QByteArrayList fields = line.split('\t');
-		if (fields.count()<3)
-		{
-			THROW(FileParseException, "BED file line with less than three fields found: '" + line.trimmed() + "'");
-		}
+		append(parseLine(line, str_cache, read_annotations));
+	}
+}
+
+bool BedFile::isHeaderLine(const QByteArray& line)
+{
+	return line.startsWith("#") || line.startsWith("track ") || line.startsWith("browser ") || line.startsWith("Chromosome\tStart\tEnd");
+}
 
-		//chr (save memory via cache)
-		QByteArray chr = fields[0];
-		if (!str_cache.contains(chr)) str_cache.insert(chr, chr);
-		chr = str_cache[chr];
+BedLine BedFile::parseLine(const QByteArray& line, QHash<QByteArray, QByteArray>& str_cache, bool read_annotations, bool cache_annotations)
+{
+	//error when less than 3 fields
+	QByteArrayList fields = line.split('\t');
+	if (fields.count()<3)
+	{
+		THROW(FileParseException, "BED file line with less than three fields found: '" + line.trimmed() + "'");
+	}
 
-		//check that start/end is number
-		bool ok = true;
-		int start = fields[1].toInt(&ok) + 1;
-		if (!ok) THROW(FileParseException, "BED file line with invalid starts position found: '" + line.trimmed() + "'");
-		int end = fields[2].toInt(&ok);
-		if (!ok) THROW(FileParseException, "BED file line with invalid end position found: '" + line.trimmed() + "'");
+	//chr (save memory via cache)
+	QByteArray chr = fields[0];
+	if (!str_cache.contains(chr)) str_cache.insert(chr, chr);
+	chr = str_cache[chr];
 
-		//annotations (save memory via cache)
-		QByteArrayList annos;
-		if (read_annotations)
+	//check that start/end is number
+	bool ok = true;
+	int start = fields[1].toInt(&ok) + 1;
+	if (!ok) THROW(FileParseException, "BED file line with invalid starts position found: '" + line.trimmed() + "'");
+	int end = fields[2].toInt(&ok);
+	if (!ok) THROW(FileParseException, "BED file line with invalid end position found: '" + line.trimmed() + "'");
+
+	//annotations (save memory via cache)
+	QByteArrayList annos;
+	if (read_annotations)
+	{
+		for (int i=3; i<fields.count(); ++i)
 		{
-			for (int i=3; i<fields.count(); ++i)
+			QByteArray entry = fields[i];
+			if (cache_annotations)
 			{
-				QByteArray entry = fields[i];
 				if (!str_cache.contains(entry)) str_cache.insert(entry, entry);
-				annos << str_cache[entry];
+				entry = str_cache[entry];
 			}
+			annos << entry;
 		}
-
-		append(BedLine(chr, start, end, annos));
 	}
+
+	return BedLine(chr, start, end, annos);
 }
 
 void BedFile::store(QString filename, bool stdout_if_empty) const
@@ -246,6 +260,134 @@ void BedFile::removeDuplicates()
 	lines_.erase(std::unique(lines_.begin(), lines_.end()), lines_.end());
 }
 
+void BedFile::sortExternal(QString in, QString out, const ExternalSortSettings& settings, bool with_name, bool uniq)
+{
+	ExternalSortRuns runs(settings);
+
+	//chunk of regions that is parsed, sorted and written to a run by a worker thread
+	QByteArrayList chunk;
+	qint64 chunk_size = 0;
+	auto sortChunk = [&]()
+	{
+		if (chunk.isEmpty()) return;
+
+		QString run_file = runs.addRun();
+		bool compress = settings.compress_runs;
+		QByteArrayList lines;
+		lines.swap(chunk);
+		runs.execute([lines, run_file, compress, with_name]() mutable
+		{
+			//parse
+			BedFile file;
+			QHash<QByteArray, QByteArray> str_cache;
+			file.lines_.reserve(lines.count());
+			foreach(const QByteArray& line, lines)
+			{
+				file.append(parseLine(line, str_cache, true));
+			}
+			lines.clear();
+
+			//sort
+			if (with_name)
+			{
+				file.sortWithName();
+			}
+			else
+			{
+				file.sort();
+			}
+
+			//write run (same format as store)
+			ExternalSortRuns::Writer writer(run_file, compress);
+			QByteArray text;
+			foreach(const BedLine& line, file.lines_)
+			{
+				text += line.chr().str() + '\t' + QByteArray::number(line.start()-1) + '\t' + QByteArray::number(line.end());
+				foreach(const QByteArray& anno, line.annotations())
+				{
+					text += '\t' + anno;
+				}
+				text += '\n';
+				if (text.size()>1048576)
+				{
+					writer.write(text);
+					text.clear();
+				}
+			}
+			writer.write(text);
+			writer.close();
+		});
+
+		chunk_size = 0;
+	};
+
+	//read input: store headers and create sorted runs
+	QVector<QByteArray> headers;
+	ExternalSortRuns::Reader reader(in);
+	QByteArray line;
+	while(reader.readLine(line))
+	{
+		while (line.endsWith('\r')) line.chop(1);
+
+		//skip empty lines
+		if(line.length()==0) continue;
+
+		//store headers
+		if (isHeaderLine(line))
+		{
+			headers.append(line);
+			continue;
+		}
+
+		chunk << line;
+		chunk_size += line.size();
+		if (chunk_size>=settings.buffer_size) sortChunk();
+	}
+	sortChunk();
+	runs.waitForJobs();
+
+	//write headers
+	QSharedPointer<QFile> file = Helper::openFileForWriting(out, true);
+	QByteArray buffer;
+	foreach(const QByteArray& header, headers)
+	{
+		buffer += header.trimmed() + '\n';
+	}
+
+	//merge runs (the name column is parsed only if it is used for sorting). Only chromosomes are cached, because the number of distinct names grows with the input size.
+	QHash<QByteArray, QByteArray> str_cache;
+	auto key = [&str_cache, with_name](const QByteArray& line, BedLine& region)
+	{
+		region = parseLine(line, str_cache, with_name, false);
+	};
+	BedLine last;
+	auto output = [&](const QByteArray& line)
+	{
+		if (uniq)
+		{
+			BedLine region = parseLine(line, str_cache, false);
+			if (region==last) return;
+			last = region;
+		}
+
+		buffer += line + '\n';
+		if (buffer.size()>1048576)
+		{
+			file->write(buffer);
+			buffer.clear();
+		}
+	};
+	if (with_name)
+	{
+		runs.merge<BedLine>(key, LessComparatorWithName(), output);
+	}
+	else
+	{
+		runs.merge<BedLine>(key, std::less<BedLine>(), output);
+	}
+	file->write(buffer);
+}
+
 void BedFile::merge(bool merge_back_to_back, bool merge_names, bool merged_names_unique)
 {
 	//in the following code, we assume that at least one line is present...
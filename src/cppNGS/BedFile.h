@@ -4,9 +4,11 @@
 #include "cppNGS_global.h"
 #include "Chromosome.h"
 #include "BasicStatistics.h"
+#include "ExternalSort.h"
 
 #include <QVector>
 #include <QSet>
+#include <QHash>
 #include <QByteArrayList>
 
 ///Representation of a BED file line (1-based)
@@ -219,6 +221,9 @@ public:
 	void sortWithName();
 	///Removes duplicate entries. Throws a ProgrammingException if not sorted.
 	void removeDuplicates();
+	///Sorts a BED file that does not fit into memory (external merge sort): chunks of regions are sorted in parallel, written to temporary files and merged.
+	///Sorting is done as in sort() or sortWithName(). If @p uniq is set, duplicates are removed as in removeDuplicates(). The output is the same as when loading, sorting and storing the file.
+	static void sortExternal(QString in, QString out, const ExternalSortSettings& settings, bool with_name = false, bool uniq = false);
 
 	///Merges overlapping regions (by default also merges back-to-back/bookshelf regions).
 	void merge(bool merge_back_to_back = true, bool merge_names = false, bool merged_names_unique = false);
@@ -263,6 +268,10 @@ public:
 protected:
     ///Removes empty lines.
     void removeInvalidLines();
+	///Returns if a line is a header line.
+	static bool isHeaderLine(const QByteArray& line);
+	///Parses a BED line (strings are shared via @p str_cache to save memory). If @p cache_annotations is unset, only the chromosome is added to the cache.
+	static BedLine parseLine(const QByteArray& line, QHash<QByteArray, QByteArray>& str_cache, bool read_annotations, bool cache_annotations = true);
 
 	QVector<QByteArray> headers_;
 	QVector<BedLine> lines_;
@@ -5,6 +5,8 @@
 #include <zlib.h>
 #include <Log.h>
 #include "Chromosome.h"
+#include "Helper.h"
+#include <algorithm>
 
 
 BigWigReader::BigWigReader(const QString& bigWigFilepath)
@@ -12,13 +14,23 @@ BigWigReader::BigWigReader(const QString& bigWigFilepath)
 	, default_value_(0)
 	, default_value_is_set_(false)
 	, fp_(bigWigFilepath)
+	, map_file_(bigWigFilepath)
+	, data_(nullptr)
+	, data_size_(0)
+	, block_cache_(1000000)
 {
 	//init
 	if (!fp_.open(QFile::ReadOnly))
 	{
 		THROW(FileAccessException, "Could not open file for reading: '" + bigWigFilepath + "'!");
 	}
-	buffer_.clear();
+
+	//memory-map local files (if that is not possible, we fall back to seek/read)
+	if (!Helper::isHttpUrl(bigWigFilepath) && map_file_.open(QFile::ReadOnly) && map_file_.size()>0)
+	{
+		data_ = map_file_.map(0, map_file_.size());
+		if (data_!=nullptr) data_size_ = map_file_.size();
+	}
 
 	parseInfo();
 	parseChrom();
@@ -27,6 +39,13 @@ BigWigReader::BigWigReader(const QString& bigWigFilepath)
 
 BigWigReader::~BigWigReader()
 {
+	if (data_!=nullptr) map_file_.unmap(const_cast<uchar*>(data_));
+}
+
+void BigWigReader::setCacheSize(int max_intervals)
+{
+	QMutexLocker locker(&block_cache_mutex_);
+	block_cache_.setMaxCost(max_intervals);
 }
 
 void BigWigReader::setDefaultValue(double default_value)
@@ -73,7 +92,7 @@ bool BigWigReader::containsChromosome(const QByteArray& chr) const
 	return chromosomes_.contains(chr);
 }
 
-float BigWigReader::readValue(const QByteArray& chr, int position, int offset)
+float BigWigReader::readValue(const QByteArray& chr, int position, int offset) const
 {
 	QVector<float> values = readValues(chr, position, position+1, offset);
 	if (values.size() == 1)
@@ -89,7 +108,7 @@ float BigWigReader::readValue(const QByteArray& chr, int position, int offset)
 
 }
 
-QVector<float> BigWigReader::readValues(const QByteArray& region, int offset)
+QVector<float> BigWigReader::readValues(const QByteArray& region, int offset) const
 {
 	QList<QByteArray> parts1 = region.split(':');
 	if (parts1.length() != 2) THROW(ArgumentException, "Given region is not formatted correctly: Expected 'chr:start-end'\n Given:" + QString(region));
@@ -100,7 +119,7 @@ QVector<float> BigWigReader::readValues(const QByteArray& region, int offset)
 	return readValues(parts1[0], parts2[0].toInt(), parts2[1].toInt(), offset);
 }
 
-QVector<float> BigWigReader::readValues(const QByteArray& chr, quint32 start, quint32 end, int offset)
+QVector<float> BigWigReader::readValues(const QByteArray& chr, quint32 start, quint32 end, int offset) const
 {
 	if (! default_value_is_set_)
 	{
@@ -122,7 +141,7 @@ QVector<float> BigWigReader::readValues(const QByteArray& chr, quint32 start, qu
 			int idx;
 			for(quint32 i=interval.start; i<interval.end; i++)
 			{
-				idx = i-start;
+				idx = i-(start+offset);
 				if(idx>= 0 && idx < (int) (end-start))
 				{
 					result[idx] = interval.value;
@@ -134,40 +153,81 @@ QVector<float> BigWigReader::readValues(const QByteArray& chr, quint32 start, qu
 	return result;
 }
 
-QList<BigWigReader::OverlappingInterval> BigWigReader::getOverlappingIntervals(const QByteArray& chr, quint32 start, quint32 end, int offset)
+QVector<float> BigWigReader::readValues(const QByteArray& chr, const QVector<int>& positions, int offset) const
 {
-    quint32 chr_id;
-    if (containsChromosome(chr))
-    {
-		chr_id = chromosomes_[chr].chrom_id;
-    }
-    else
-    {
-		THROW(ArgumentException, "Couldn't find given chromosome in file: " + chr)
-    }
-    QList<OverlappingInterval> intervals;
+	if (! default_value_is_set_)
+	{
+		THROW(ProgrammingException, "The default value has to be set before the readValue functions can be used!")
+	}
+
+	QVector<float> result = QVector<float>(positions.count(), default_value_);
+	if (positions.isEmpty()) return result;
+	if (!std::is_sorted(positions.begin(), positions.end()))
+	{
+		THROW(ArgumentException, "Positions need to be sorted in ascending order!")
+	}
+
+	// search the index tree once for the whole range (positions before the chromosome start have no value)
+	quint32 chr_id = chromosomeId(chr);
+	int end = positions.last()+offset+1;
+	if (end<=0) return result;
+	int start = std::max(positions.first()+offset, 0);
+	QList<OverlappingBlock> blocks = getOverlappingBlocks(chr_id, (quint32)start, (quint32)end);
+
+	foreach (const OverlappingBlock& b, blocks)
+	{
+		// skip blocks that do not contain any of the positions (without decompressing them)
+		int i = 0;
+		if (!b.spans_contigs)
+		{
+			i = std::lower_bound(positions.begin(), positions.end(), (int)b.start-offset) - positions.begin();
+			if (i==positions.count() || positions[i]+offset >= (int)b.end) continue;
+		}
+
+		QSharedPointer<const DataBlock> block = dataBlock(b);
+		if (block->chr_id != chr_id) continue;
 
-    // try to find it in the buffer:
-    if ( ! buffer_.contains(chr_id, start, end))
-    {
-        QList<OverlappingBlock> blocks = getOverlappingBlocks(chr_id, start+offset, end+offset);
+		// walk through the positions and the (sorted) intervals of the block in parallel
+		const QVector<OverlappingInterval>& intervals = block->intervals;
+		int j = 0;
+		for (; i<positions.count() && j<intervals.count(); ++i)
+		{
+			if (positions[i]+offset<0) continue;
+			quint32 pos = positions[i]+offset;
+			while (j<intervals.count() && intervals[j].end <= pos) ++j;
+			if (j<intervals.count() && intervals[j].start <= pos)
+			{
+				result[i] = intervals[j].value;
+			}
+		}
+	}
+
+	return result;
+}
+
+quint32 BigWigReader::chromosomeId(const QByteArray& chr) const
+{
+	if (!containsChromosome(chr))
+	{
+		THROW(ArgumentException, "Couldn't find given chromosome in file: " + chr)
+	}
+	return chromosomes_[chr].chrom_id;
+}
 
-        if (blocks.length() == 0)
-        {
-            return QList<OverlappingInterval>();
-        }
+QList<BigWigReader::OverlappingInterval> BigWigReader::getOverlappingIntervals(const QByteArray& chr, quint32 start, quint32 end, int offset) const
+{
+	quint32 chr_id = chromosomeId(chr);
 
-        intervals = extractOverlappingIntervals(blocks, chr_id, start+offset, end+offset);
-    }
-    else
-    {
-        intervals = buffer_.get(chr_id, start+offset, end+offset);
-    }
+	QList<OverlappingBlock> blocks = getOverlappingBlocks(chr_id, start+offset, end+offset);
+	if (blocks.length() == 0)
+	{
+		return QList<OverlappingInterval>();
+	}
 
-    return intervals;
+	return extractOverlappingIntervals(blocks, chr_id, start+offset, end+offset);
 }
 
-QList<BigWigReader::OverlappingBlock> BigWigReader::getOverlappingBlocks(quint32 chr_id, quint32 start, quint32 end)
+QList<BigWigReader::OverlappingBlock> BigWigReader::getOverlappingBlocks(quint32 chr_id, quint32 start, quint32 end) const
 {
 	QList<OverlappingBlock> result;
 
@@ -185,7 +245,7 @@ QList<BigWigReader::OverlappingBlock> BigWigReader::getOverlappingBlocks(quint32
 	return result;
 }
 
-QList<BigWigReader::OverlappingBlock> BigWigReader::overlapsTwig(const IndexRTreeNode& node, quint32 chr_id, quint32 start, quint32 end)
+QList<BigWigReader::OverlappingBlock> BigWigReader::overlapsTwig(const IndexRTreeNode& node, quint32 chr_id, quint32 start, quint32 end) const
 {
 	QList<OverlappingBlock> blocks;
 	for (quint16 i=0; i<node.count; i++)
@@ -225,7 +285,7 @@ QList<BigWigReader::OverlappingBlock> BigWigReader::overlapsTwig(const IndexRTre
 	return blocks;
 }
 
-QList<BigWigReader::OverlappingBlock> BigWigReader::overlapsLeaf(const IndexRTreeNode& node, quint32 chr_id, quint32 start, quint32 end)
+QList<BigWigReader::OverlappingBlock> BigWigReader::overlapsLeaf(const IndexRTreeNode& node, quint32 chr_id, quint32 start, quint32 end) const
 {
 	QList<OverlappingBlock> blocks;
 	for (quint16 i=0; i<node.count; i++)
@@ -270,6 +330,7 @@ QList<BigWigReader::OverlappingBlock> BigWigReader::overlapsLeaf(const IndexRTre
 		newBlock.size = node.size[i];
         newBlock.start = node.base_start[i];
         newBlock.end = node.base_end[i];
+		newBlock.spans_contigs = node.chr_idx_start[i] != node.chr_idx_end[i];
 
 		blocks.append(newBlock);
 	}
@@ -277,104 +338,137 @@ QList<BigWigReader::OverlappingBlock> BigWigReader::overlapsLeaf(const IndexRTre
 	return blocks;
 }
 
-QList<BigWigReader::OverlappingInterval> BigWigReader::extractOverlappingIntervals(const QList<OverlappingBlock>& blocks, quint32 chr_id, quint32 start, quint32 end)
+QList<BigWigReader::OverlappingInterval> BigWigReader::extractOverlappingIntervals(const QList<OverlappingBlock>& blocks, quint32 chr_id, quint32 start, quint32 end) const
 {
 	QList<OverlappingInterval> result;
-	buffer_.clear();
-	buffer_.chr_id = chr_id;
-
-	// Test if buffer would be too big -> split decompression into multiple steps but probably never needed
-	quint32 decompress_buffer_size = header_.uncompress_buf_size;
-	char out[decompress_buffer_size];
-	QByteArray decompressed_block;
 
 	foreach (const OverlappingBlock &b, blocks)
 	{
-		decompressed_block = "";
-		if (decompress_buffer_size > 0) // if data is compressed -> decompress it
+		QSharedPointer<const DataBlock> block = dataBlock(b);
+		if (block->chr_id != chr_id) continue;
+
+		foreach (const OverlappingInterval& interval, block->intervals)
 		{
-			fp_.seek(b.offset);
-			QByteArray compressed_block = fp_.read(b.size);
-
-			//set zlib vars
-			z_stream infstream;
-			infstream.zalloc = Z_NULL;
-			infstream.zfree = Z_NULL;
-			infstream.opaque = Z_NULL;
-			// setup "compressed_block.data()" as the input and "out" as the uncompressed output
-			infstream.avail_in = b.size; // size of input
-			infstream.next_in = (Bytef *)compressed_block.data(); // input char array
-			infstream.avail_out = decompress_buffer_size; // size of output
-			infstream.next_out = (Bytef *)out; // output char array
-
-			inflateInit(&infstream);
-			int ret = inflate(&infstream, Z_FINISH);
-
-			if (ret != Z_STREAM_END)
-			{
-				THROW(FileParseException, "Couldn't decompress a Data block. Too little buffer space?")
-			}
-			inflateEnd(&infstream);
+			if (start >= interval.end ||  end <= interval.start) continue; // doesn't overlap
 
-			decompressed_block.append(out, infstream.avail_out);
+			result.append(interval);
 		}
-		else // data is not compressed -> just read it
+	}
+	return result;
+}
+
+QSharedPointer<const BigWigReader::DataBlock> BigWigReader::dataBlock(const OverlappingBlock& b) const
+{
+	// try to find it in the cache
+	{
+		QMutexLocker locker(&block_cache_mutex_);
+		QSharedPointer<const DataBlock>* cached = block_cache_.object(b.offset);
+		if (cached!=nullptr) return *cached;
+	}
+
+	QByteArray decompressed_block;
+	quint32 decompress_buffer_size = header_.uncompress_buf_size;
+	if (decompress_buffer_size > 0) // if data is compressed -> decompress it
+	{
+		QByteArray compressed_block = readBytes(b.offset, b.size);
+		decompressed_block.resize(decompress_buffer_size);
+
+		//set zlib vars
+		z_stream infstream;
+		infstream.zalloc = Z_NULL;
+		infstream.zfree = Z_NULL;
+		infstream.opaque = Z_NULL;
+		// setup "compressed_block" as the input and "decompressed_block" as the uncompressed output
+		infstream.avail_in = b.size; // size of input
+		infstream.next_in = (Bytef *)compressed_block.constData(); // input char array
+		infstream.avail_out = decompress_buffer_size; // size of output
+		infstream.next_out = (Bytef *)decompressed_block.data(); // output char array
+
+		inflateInit(&infstream);
+		int ret = inflate(&infstream, Z_FINISH);
+		inflateEnd(&infstream);
+
+		if (ret != Z_STREAM_END)
 		{
-			fp_.seek(b.offset);
-			decompressed_block = fp_.read(b.size);
+			THROW(FileParseException, "Couldn't decompress a Data block. Too little buffer space?")
 		}
 
-		// parse decompressed block
-		QDataStream ds(decompressed_block);
-		ds.setByteOrder(byte_order_);
-		ds.setFloatingPointPrecision(QDataStream::SinglePrecision);
+		decompressed_block.resize(infstream.total_out);
+	}
+	else // data is not compressed -> just read it
+	{
+		decompressed_block = readBytes(b.offset, b.size);
+	}
+
+	// parse decompressed block
+	QDataStream ds(decompressed_block);
+	ds.setByteOrder(byte_order_);
+	ds.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	// parse header
+	DataHeader data_header;
+	ds >> data_header.chrom_id >> data_header.start >> data_header.end;
+	ds >> data_header.step >> data_header.span >> data_header.type;
+	quint8 padding;
+	ds >> padding >> data_header.num_items;
 
-		// parse header
-		DataHeader data_header;
-		ds >> data_header.chrom_id >> data_header.start >> data_header.end;
-		ds >> data_header.step >> data_header.span >> data_header.type;
-		quint8 padding;
-		ds >> padding >> data_header.num_items;
+	QSharedPointer<DataBlock> block(new DataBlock());
+	block->chr_id = data_header.chrom_id;
+	block->intervals.reserve(data_header.num_items);
 
-		if (data_header.chrom_id != chr_id) continue;
+	quint32 interval_start, interval_end;
+	float interval_value;
+
+	if (data_header.type == 3)
+	{
+		interval_start = data_header.start - data_header.step; // minus step as it is added below before evaluating.
+	}
 
-		quint32 interval_start, interval_end;
-		float interval_value;
-		
-		if (data_header.type == 3)
+	// parse items
+	for (quint16 i=0; i<data_header.num_items; i++)
+	{
+		switch (data_header.type)
 		{
-			interval_start = data_header.start - data_header.step; // minus step as it is added below before evaluating.
+			case 1:
+				ds >> interval_start >> interval_end >> interval_value;
+				break;
+			case 2:
+				ds >> interval_start >> interval_value;
+				interval_end = interval_start + data_header.span;
+				break;
+			case 3:
+				interval_start += data_header.step;
+				interval_end = interval_start + data_header.span;
+				ds >> interval_value;
+				break;
+			default:
+				THROW(FileParseException, "Unknown type while parsing a data block.")
+				break;
 		}
+		block->intervals.append(OverlappingInterval(interval_start, interval_end, interval_value));
+	}
 
-		// parse items
-		for (quint16 i=0; i<data_header.num_items; i++)
-		{
-			switch (data_header.type)
-			{
-				case 1:
-					ds >> interval_start >> interval_end >> interval_value;
-					break;
-				case 2:
-					ds >> interval_start >> interval_value;
-					interval_end = interval_start + data_header.span;
-					break;
-				case 3:
-					interval_start += data_header.step;
-					interval_end = interval_start + data_header.span;
-					ds >> interval_value;
-					break;
-				default:
-					THROW(FileParseException, "Unknown type while parsing a data block.")
-					break;
-			}
-			OverlappingInterval interval(interval_start, interval_end, interval_value);
-			buffer_.append(interval);
-			if (start >= interval_end ||  end <= interval_start) continue; // doesn't overlap
+	// add to cache
+	QMutexLocker locker(&block_cache_mutex_);
+	block_cache_.insert(b.offset, new QSharedPointer<const DataBlock>(block), std::max(1, block->intervals.count()));
 
-			result.append(interval);
+	return block;
+}
+
+QByteArray BigWigReader::readBytes(quint64 offset, quint64 size) const
+{
+	if (data_!=nullptr)
+	{
+		if (offset+size > (quint64)data_size_)
+		{
+			THROW(FileParseException, "Data block exceeds the size of the file: '" + file_path_ + "'!");
 		}
+		return QByteArray::fromRawData(reinterpret_cast<const char*>(data_ + offset), size);
 	}
-	return result;
+
+	QMutexLocker locker(&fp_mutex_);
+	fp_.seek(offset);
+	return fp_.read(size);
 }
 
 void BigWigReader::parseInfo()
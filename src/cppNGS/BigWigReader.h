@@ -6,9 +6,14 @@
 #include <QString>
 #include <QVector>
 #include <QDataStream>
+#include <QFile>
+#include <QMutex>
+#include <QCache>
+#include <QSharedPointer>
 
 
 // Reader for BigWig files:
+// Local files are memory-mapped and decompressed data blocks are kept in an LRU cache, i.e. one reader can be shared by several threads.
 class CPPNGSSHARED_EXPORT BigWigReader
 {
 public:
@@ -86,7 +91,7 @@ public:
 	 * @param offset Offset for regions as bigWig files use zero-based genome indexing -> 0 - length-1
 	 * @return the intervals that overlap with the given region
 	 */
-	QList<OverlappingInterval> getOverlappingIntervals(const QByteArray& chr, quint32 start, quint32 end, int offset=-1);
+	QList<OverlappingInterval> getOverlappingIntervals(const QByteArray& chr, quint32 start, quint32 end, int offset=-1) const;
 
 
 	/// Read Value functions below need the default value
@@ -102,7 +107,7 @@ public:
 	 * @param offset Offset for regions as bigWig files use zero-based genome indexing -> 0 - length-1
 	 * @return The value specified in the file or when the given position is not covered in the file returns the default_value.
 	 */
-	float readValue(const QByteArray& chr, int position, int offset=-1);
+	float readValue(const QByteArray& chr, int position, int offset=-1) const;
 
 	/**
 	 * @brief Reads the bigWig values for the given region of the genome.
@@ -110,11 +115,24 @@ public:
 	 * @param offset Offset for regions as bigWig files use zero-based genome indexing -> 0 - length-1
 	 * @return A QVector containing a value for each position requested: values specified in the file or when the given position is not covered in the file the default_value.
 	 */
-	QVector<float> readValues(const QByteArray& chr, quint32 start, quint32 end, int offset=-1);
+	QVector<float> readValues(const QByteArray& chr, quint32 start, quint32 end, int offset=-1) const;
 
 	/// Convenience function to call readValues with an unparsed region of type (chrNAME:start-end)
 	/// Default value HAS TO be set before it can be used.
-	QVector<float> readValues(const QByteArray& region, int offset=-1);
+	QVector<float> readValues(const QByteArray& region, int offset=-1) const;
+
+	/**
+	 * @brief Reads the bigWig values for a list of positions on one chromosome.
+	 * The index tree is searched once for the whole range and each data block is decompressed at most once.
+	 * Default value HAS TO be set before it can be used.
+	 * @param positions Positions sorted in ascending order.
+	 * @param offset Offset for regions as bigWig files use zero-based genome indexing -> 0 - length-1
+	 * @return A QVector containing the value for each position (same as readValue).
+	 */
+	QVector<float> readValues(const QByteArray& chr, const QVector<int>& positions, int offset=-1) const;
+
+	/// Sets the maximum number of intervals of decompressed data blocks that are kept in the cache.
+	void setCacheSize(int max_intervals);
 
 
 
@@ -129,72 +147,6 @@ public:
 
 private:
 
-	// Buffer for the intervals that were recently read from file to reduce decompression calls.
-	struct IntervalBuffer
-	{
-		quint32 chr_id;
-		quint32 start;
-		quint32 end;
-		QList<OverlappingInterval> intervals;
-
-		// returns true if the given region is covered by the intervals in the buffer
-		bool contains(quint32 pos_chr_id, quint32 pos_start, quint32 pos_end)
-		{
-			if (intervals.size() == 0) return false;
-			if (pos_chr_id != chr_id) return false;
-			if (pos_start >= end || pos_end < start) return false;
-
-			return true;
-		}
-
-		/**
-		 * @brief add the interval to the buffer and adjusts the end of the buffer accordingly
-		 * @note expects the appended intervals to be in increasing order and without gaps
-		 */
-		void append(OverlappingInterval interval)
-		{
-			if (intervals.length() == 0)
-			{
-				start = interval.start;
-				end = interval.end;
-			}
-			else
-			{
-				if (interval.start < end)
-				{
-					THROW(ProgrammingException, "Intervals need to be inserted in increasing order")
-				}
-				end = interval.end;
-			}
-
-			intervals.append(interval);
-		}
-
-		// returns the intervals in the buffer that overlap with the given region
-		QList<OverlappingInterval> get(quint32 pos_chr_id, quint32 pos_start, quint32 pos_end)
-		{
-			QList<OverlappingInterval> res = QList<OverlappingInterval>();
-			if (chr_id != pos_chr_id)
-			{
-				return res;
-			}
-
-			foreach (const OverlappingInterval& i, intervals)
-			{
-				if (pos_start >= i.end ||  pos_end <= i.start) continue;
-				res.append(i);
-			}
-			return res;
-		}
-
-		//clears the data within the buffer
-		void clear()
-		{
-			chr_id = start = end = 0;
-			intervals.clear();
-		}
-	};
-
 	/*Internaly used structs*/
 	// Currently only zoom level headers are parsed but the zoomlevel data isn't used and isn't supported.
 	struct ZoomLevel
@@ -241,6 +193,7 @@ private:
 		quint64 size;
 		quint32 start;
 		quint32 end;
+		bool spans_contigs; // start/end refer to different contigs
 
 		static bool lessThan(const OverlappingBlock& b1, const OverlappingBlock& b2)
 		{
@@ -248,6 +201,13 @@ private:
 		}
 	};
 
+	// Decompressed and parsed data block
+	struct DataBlock
+	{
+		quint32 chr_id;
+		QVector<OverlappingInterval> intervals;
+	};
+
 	struct IndexRTree
 	{
 		quint32 block_size;
@@ -266,12 +226,18 @@ private:
 	bool isLittleEndian() const;
 
 	// searches the indextree for blocks containing requested data
-	QList<OverlappingBlock> getOverlappingBlocks(quint32 chr_id, quint32 start, quint32 end);
-	QList<OverlappingBlock> overlapsTwig(const IndexRTreeNode& node, quint32 chr_id, quint32 start, quint32 end);
-	QList<OverlappingBlock> overlapsLeaf(const IndexRTreeNode& node, quint32 chr_id, quint32 start, quint32 end);
-
-	// if needed decompress blocks and return the Intervals that overlap the requested region
-	QList<OverlappingInterval> extractOverlappingIntervals(const QList<OverlappingBlock>& blocks, quint32 chr_id, quint32 start, quint32 end);
+	QList<OverlappingBlock> getOverlappingBlocks(quint32 chr_id, quint32 start, quint32 end) const;
+	QList<OverlappingBlock> overlapsTwig(const IndexRTreeNode& node, quint32 chr_id, quint32 start, quint32 end) const;
+	QList<OverlappingBlock> overlapsLeaf(const IndexRTreeNode& node, quint32 chr_id, quint32 start, quint32 end) const;
+
+	// return the Intervals of the blocks that overlap the requested region
+	QList<OverlappingInterval> extractOverlappingIntervals(const QList<OverlappingBlock>& blocks, quint32 chr_id, quint32 start, quint32 end) const;
+	// returns the decompressed data block (from the cache if possible)
+	QSharedPointer<const DataBlock> dataBlock(const OverlappingBlock& block) const;
+	// reads raw bytes from the file (memory-mapped if possible)
+	QByteArray readBytes(quint64 offset, quint64 size) const;
+	// returns the chromosome ID or throws an exception if the chromosome is not contained in the file
+	quint32 chromosomeId(const QByteArray& chr) const;
 
 	// Parse functions parse the corresponding part of the binary file (need to be called in the right order to set necessary member variables)
 	void parseInfo();
@@ -292,9 +258,14 @@ private:
 	ChromosomeHeader chr_header;
 	IndexRTree index_tree_;
 	QHash<QByteArray, ChromosomeItem> chromosomes_;
-	VersatileFile fp_;
+	mutable VersatileFile fp_;
+	mutable QMutex fp_mutex_; // protects 'fp_' if the file is not memory-mapped
+	QFile map_file_;
+	const uchar* data_; // memory-mapped file (nullptr if the file is not local or could not be mapped)
+	qint64 data_size_;
 	QDataStream::ByteOrder byte_order_;
-	IntervalBuffer buffer_;
+	mutable QCache<quint64, QSharedPointer<const DataBlock>> block_cache_; // decompressed blocks by file offset
+	mutable QMutex block_cache_mutex_;
 
 };
 
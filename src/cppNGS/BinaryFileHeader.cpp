@@ -0,0 +1,85 @@
+#include "BinaryFileHeader.h"
+#include "Exceptions.h"
+#include <QFileInfo>
+#include <QDateTime>
+#include <algorithm>
+#include <cstring>
+#include "zlib.h"
+
+void BinaryFileHeader::init(const char* magic, quint32 version, QString source_file)
+{
+	memcpy(this->magic, magic, sizeof(this->magic));
+	this->version = version;
+	checksum = 0;
+	source_size = 0;
+	source_modified = 0;
+	if (!source_file.isEmpty())
+	{
+		QFileInfo source_info(source_file);
+		source_size = source_info.size();
+		source_modified = source_info.lastModified().toMSecsSinceEpoch();
+	}
+}
+
+void BinaryFileHeader::check(const char* magic, quint32 version, QString filename, QString type) const
+{
+	if (memcmp(this->magic, magic, sizeof(this->magic))!=0) THROW(FileParseException, "File '" + filename + "' is not a " + type + "!");
+	if (this->version!=version) THROW(FileParseException, "File '" + filename + "' is a " + type + " with unsupported version " + QString::number(this->version) + " - please re-create it!");
+}
+
+bool BinaryFileHeader::matchesSource(QString source_file) const
+{
+	QFileInfo source_info(source_file);
+	return source_info.exists() && source_size==source_info.size() && source_modified==source_info.lastModified().toMSecsSinceEpoch();
+}
+
+bool BinaryFileHeader::hasMagic(QString filename, const char* magic)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) return false;
+
+	QByteArray file_magic = file.read(sizeof(BinaryFileHeader::magic));
+	return file_magic==QByteArray(magic, sizeof(BinaryFileHeader::magic));
+}
+
+bool BinaryFileHeader::isUpToDate(QString filename, const char* magic, quint32 version, QString source_file)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) return false;
+
+	BinaryFileHeader header;
+	if (file.read(reinterpret_cast<char*>(&header), sizeof(BinaryFileHeader))!=sizeof(BinaryFileHeader)) return false;
+	if (memcmp(header.magic, magic, sizeof(header.magic))!=0) return false;
+	if (header.version!=version) return false;
+
+	return header.matchesSource(source_file);
+}
+
+const uchar* BinaryFileHeader::map(QFile& file, QByteArray& buffer)
+{
+	const uchar* data = file.map(0, file.size());
+	if (data==nullptr)
+	{
+		buffer = file.readAll();
+		data = reinterpret_cast<const uchar*>(buffer.constData());
+	}
+	return data;
+}
+
+qint64 BinaryFileHeader::paddedSize(qint64 size)
+{
+	return (size + 7) / 8 * 8;
+}
+
+quint32 BinaryFileHeader::calculateChecksum(const uchar* data, qint64 size, quint32 crc)
+{
+	//zlib handles 32-bit lengths only
+	while (size>0)
+	{
+		uInt chunk = (uInt)std::min(size, (qint64)1073741824);
+		crc = crc32(crc, data, chunk);
+		data += chunk;
+		size -= chunk;
+	}
+	return crc;
+}
@@ -0,0 +1,39 @@
+#ifndef BINARYFILEHEADER_H
+#define BINARYFILEHEADER_H
+
+#include "cppNGS_global.h"
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+
+///Common start of the headers of binary file formats, e.g. the chain file cache.
+///Binary files consist of a format-specific header starting with this struct, followed by data sections. Data is stored in native byte order.
+struct CPPNGSSHARED_EXPORT BinaryFileHeader
+{
+	char magic[8];
+	quint32 version;
+	quint32 checksum; //CRC32 of the data after the format-specific header (0 if not used by the format)
+	qint64 source_size; //size of the file the binary file was created from (0 if not set)
+	qint64 source_modified; //modification time of the file the binary file was created from in ms since epoch (0 if not set)
+
+	///Initializes the header with magic and version. If @p source_file is given, its size and modification time are stored.
+	void init(const char* magic, quint32 version, QString source_file = QString());
+	///Throws a FileParseException if magic or version do not match. @p type is the file type used in error messages, e.g. 'binary variant list'.
+	void check(const char* magic, quint32 version, QString filename, QString type) const;
+	///Returns if the binary file was created from the current version of @p source_file (size and modification time).
+	bool matchesSource(QString source_file) const;
+
+	///Returns if the file starts with the given magic.
+	static bool hasMagic(QString filename, const char* magic);
+	///Returns if the file has the given magic and version and was created from the current version of @p source_file.
+	static bool isUpToDate(QString filename, const char* magic, quint32 version, QString source_file);
+
+	///Memory-maps the opened file. If that is not possible, the file is read into @p buffer. Returns the file data.
+	static const uchar* map(QFile& file, QByteArray& buffer);
+	///Returns the size padded to a multiple of 8 bytes (data sections are aligned to 8 bytes).
+	static qint64 paddedSize(qint64 size);
+	///Returns the CRC32 checksum of a data block. To calculate the checksum of several blocks, the checksum of the previous blocks is given as @p crc.
+	static quint32 calculateChecksum(const uchar* data, qint64 size, quint32 crc = 0);
+};
+
+#endif // BINARYFILEHEADER_H
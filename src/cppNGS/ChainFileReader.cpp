@@ -1,20 +1,115 @@
 #include "ChainFileReader.h"
 #include "Exceptions.h"
 #include "zlib.h"
-
-ChainFileReader::ChainFileReader(QString filepath, double percent_deletion):
+#include "Log.h"
+#include "Helper.h"
+#include "BinaryFileHeader.h"
+#include <QFileInfo>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <algorithm>
+#include <cstring>
+
+//header of binary chain files. It is followed by the chromosome names (separated by newlines, padded to a multiple of 8 bytes), the alignments and the alignment lines. Data is stored in native byte order.
+struct ChainFileBinaryHeader
+	: public BinaryFileHeader
+{
+	qint64 names_size;
+	qint64 alignment_count;
+	qint64 line_count;
+};
+static const char CHAIN_FILE_BINARY_MAGIC[8] = {'C', 'H', 'A', 'I', 'N', 'B', 'I', 'N'};
+static const quint32 CHAIN_FILE_BINARY_VERSION = 1;
+
+//alignment of binary chain files (chromosomes are given as index into the chromosome names)
+struct ChainFileBinaryAlignment
+{
+	double score;
+	qint32 id;
+	qint32 ref_chr;
+	qint32 ref_chr_size;
+	qint32 ref_start;
+	qint32 ref_end;
+	qint32 q_chr;
+	qint32 q_chr_size;
+	qint32 q_start;
+	qint32 q_end;
+	quint8 ref_on_plus;
+	quint8 q_on_plus;
+	quint16 reserved;
+	qint64 first_line;
+	qint64 line_count;
+};
+
+ChainFileReader::ChainFileReader(QString filepath, double percent_deletion, bool use_cache, QString cache_folder):
 	filepath_(filepath)
   , file_(filepath)
   , percent_deletion_(percent_deletion)
 {
-	load();
+	load(use_cache, cache_folder);
 }
 
 ChainFileReader::~ChainFileReader()
 {
 }
 
-void ChainFileReader::load()
+void ChainFileReader::load(bool use_cache, QString cache_folder)
+{
+	if (isBinaryFile(filepath_))
+	{
+		loadBinary(filepath_);
+	}
+	else if (use_cache)
+	{
+		QString cache_file = binaryCacheFile(filepath_, cache_folder);
+		bool loaded = false;
+		if (binaryCacheIsValid(filepath_, cache_folder))
+		{
+			try
+			{
+				loadBinary(cache_file);
+				loaded = true;
+			}
+			catch(Exception& e)
+			{
+				Log::warn("Could not load chain cache file '" + cache_file + "': " + e.message());
+				chromosomes_.clear();
+				ref_chrom_sizes_.clear();
+			}
+		}
+
+		if (!loaded)
+		{
+			loadText();
+
+			//create cache file (written to a temporary file first so that no incomplete cache file is used - the process ID avoids clashes when several processes create the cache file)
+			QString tmp_file = cache_file + "." + QString::number(QCoreApplication::applicationPid()) + ".tmp";
+			try
+			{
+				storeBinary(tmp_file, filepath_);
+				QFile::remove(cache_file);
+				if (!QFile::rename(tmp_file, cache_file)) THROW(FileAccessException, "Could not rename '" + tmp_file + "' to '" + cache_file + "'!");
+			}
+			catch(Exception& e)
+			{
+				QFile::remove(tmp_file);
+				Log::warn("Could not write chain cache file '" + cache_file + "': " + e.message());
+			}
+		}
+	}
+	else
+	{
+		loadText();
+	}
+
+	createIndex();
+}
+
+void ChainFileReader::loadText()
 {
 	QList<QByteArray> lines = getLines();
 
@@ -34,11 +129,7 @@ void ChainFileReader::load()
 		{
 			parts = line.split(' ');
 			// add last chain alignment to the chromosomes:
-			if (! chromosomes_.contains(currentAlignment.ref_chr))
-			{
-				chromosomes_.insert(currentAlignment.ref_chr, QList<GenomicAlignment>());
-			}
-			chromosomes_[currentAlignment.ref_chr].append(currentAlignment);
+			addAlignment(currentAlignment);
 
 			// parse the new Alignment
 			currentAlignment = parseChainLine(parts);
@@ -70,6 +161,195 @@ void ChainFileReader::load()
 	}
 }
 
+void ChainFileReader::loadBinary(QString filename)
+{
+	//memory-map file while it is parsed (if that is not possible, we read it into memory). The data is copied into the alignments, i.e. the file is not kept mapped (the checkpoint index of an alignment is built while its lines are added).
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) THROW(FileAccessException, "Could not open binary chain file '" + filename + "' for reading!");
+	qint64 file_size = file.size();
+	QByteArray file_data;
+	const uchar* data = BinaryFileHeader::map(file, file_data);
+
+	//header
+	if (file_size<(qint64)sizeof(ChainFileBinaryHeader)) THROW(FileParseException, "Binary chain file '" + filename + "' is truncated!");
+	ChainFileBinaryHeader header;
+	memcpy(&header, data, sizeof(ChainFileBinaryHeader));
+	header.check(CHAIN_FILE_BINARY_MAGIC, CHAIN_FILE_BINARY_VERSION, filename, "binary chain file");
+
+	const qint64 names_offset = sizeof(ChainFileBinaryHeader);
+	const qint64 alignments_offset = names_offset + BinaryFileHeader::paddedSize(header.names_size);
+	const qint64 lines_offset = alignments_offset + header.alignment_count * (qint64)sizeof(ChainFileBinaryAlignment);
+	if (file_size!=lines_offset + header.line_count * 3 * (qint64)sizeof(qint32)) THROW(FileParseException, "Binary chain file '" + filename + "' has invalid size!");
+
+	//chromosomes
+	QList<Chromosome> chrs;
+	QByteArray names = QByteArray::fromRawData(reinterpret_cast<const char*>(data + names_offset), header.names_size);
+	foreach(const QByteArray& name, names.split('\n'))
+	{
+		chrs << Chromosome(name);
+	}
+
+	//alignments
+	const qint32* lines = reinterpret_cast<const qint32*>(data + lines_offset);
+	for (qint64 i=0; i<header.alignment_count; ++i)
+	{
+		ChainFileBinaryAlignment a;
+		memcpy(&a, data + alignments_offset + i * sizeof(ChainFileBinaryAlignment), sizeof(ChainFileBinaryAlignment));
+		if (a.ref_chr<0 || a.ref_chr>=chrs.count() || a.q_chr<0 || a.q_chr>=chrs.count() || a.first_line<0 || a.line_count<0 || a.first_line+a.line_count>header.line_count)
+		{
+			THROW(FileParseException, "Binary chain file '" + filename + "' contains invalid alignment with ID " + QString::number(a.id) + "!");
+		}
+
+		GenomicAlignment alignment(a.score, chrs[a.ref_chr], a.ref_chr_size, a.ref_start, a.ref_end, a.ref_on_plus, chrs[a.q_chr], a.q_chr_size, a.q_start, a.q_end, a.q_on_plus, a.id);
+		alignment.alignment.reserve(a.line_count);
+		for (qint64 l=a.first_line; l<a.first_line+a.line_count; ++l)
+		{
+			alignment.addAlignmentLine(lines[3*l], lines[3*l+1], lines[3*l+2]);
+		}
+		if (!ref_chrom_sizes_.contains(alignment.ref_chr))
+		{
+			ref_chrom_sizes_.insert(alignment.ref_chr, alignment.ref_chr_size);
+		}
+		addAlignment(alignment);
+	}
+}
+
+void ChainFileReader::storeBinary(QString filename, QString source_file) const
+{
+	//chromosome names (sorted to make the output deterministic)
+	QList<Chromosome> ref_chrs = chromosomes_.keys();
+	std::sort(ref_chrs.begin(), ref_chrs.end());
+	QHash<QByteArray, qint32> chr_ids;
+	QByteArrayList names;
+	auto chrId = [&](const Chromosome& chr)
+	{
+		auto it = chr_ids.find(chr.str());
+		if (it!=chr_ids.end()) return it.value();
+		qint32 id = names.count();
+		chr_ids.insert(chr.str(), id);
+		names << chr.str();
+		return id;
+	};
+
+	//alignments
+	QVector<ChainFileBinaryAlignment> alignments;
+	qint64 line_count = 0;
+	foreach(const Chromosome& chr, ref_chrs)
+	{
+		foreach(const GenomicAlignment& alignment, chromosomes_[chr])
+		{
+			ChainFileBinaryAlignment a;
+			memset(&a, 0, sizeof(ChainFileBinaryAlignment));
+			a.score = alignment.score;
+			a.id = alignment.id;
+			a.ref_chr = chrId(alignment.ref_chr);
+			a.ref_chr_size = alignment.ref_chr_size;
+			a.ref_start = alignment.ref_start;
+			a.ref_end = alignment.ref_end;
+			a.q_chr = chrId(alignment.q_chr);
+			a.q_chr_size = alignment.q_chr_size;
+			a.q_start = alignment.q_start;
+			a.q_end = alignment.q_end;
+			a.ref_on_plus = alignment.ref_on_plus;
+			a.q_on_plus = alignment.q_on_plus;
+			a.first_line = line_count;
+			a.line_count = alignment.alignment.count();
+			alignments << a;
+			line_count += a.line_count;
+		}
+	}
+	QByteArray names_data = names.join('\n');
+
+	//header
+	ChainFileBinaryHeader header;
+	memset(&header, 0, sizeof(ChainFileBinaryHeader));
+	header.init(CHAIN_FILE_BINARY_MAGIC, CHAIN_FILE_BINARY_VERSION, source_file);
+	header.names_size = names_data.size();
+	header.alignment_count = alignments.count();
+	header.line_count = line_count;
+
+	//write
+	QSharedPointer<QFile> file = Helper::openFileForWriting(filename);
+	auto write = [&](const char* data, qint64 size)
+	{
+		if (file->write(data, size)!=size) THROW(FileAccessException, "Could not write binary chain file '" + filename + "'!");
+	};
+	write(reinterpret_cast<const char*>(&header), sizeof(ChainFileBinaryHeader));
+	write(names_data.constData(), names_data.size());
+	write(QByteArray(BinaryFileHeader::paddedSize(names_data.size()) - names_data.size(), 0).constData(), BinaryFileHeader::paddedSize(names_data.size()) - names_data.size());
+	write(reinterpret_cast<const char*>(alignments.constData()), alignments.count() * (qint64)sizeof(ChainFileBinaryAlignment));
+	QVector<qint32> lines;
+	lines.reserve(3 * line_count);
+	foreach(const Chromosome& chr, ref_chrs)
+	{
+		foreach(const GenomicAlignment& alignment, chromosomes_[chr])
+		{
+			for (const auto& line : alignment.alignment)
+			{
+				lines << line.size << line.ref_dt << line.q_dt;
+			}
+		}
+	}
+	write(reinterpret_cast<const char*>(lines.constData()), lines.count() * (qint64)sizeof(qint32));
+	file->close();
+}
+
+bool ChainFileReader::isBinaryFile(QString filename)
+{
+	return BinaryFileHeader::hasMagic(filename, CHAIN_FILE_BINARY_MAGIC);
+}
+
+QString ChainFileReader::binaryCacheFile(QString filename, QString cache_folder)
+{
+	if (cache_folder.isEmpty()) return filename + ".cache";
+
+	QFileInfo info(filename);
+	QByteArray hash = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Md5).toHex().left(12);
+	return QDir(cache_folder).filePath(info.fileName() + "_" + hash + ".cache");
+}
+
+bool ChainFileReader::binaryCacheIsValid(QString filename, QString cache_folder)
+{
+	return BinaryFileHeader::isUpToDate(binaryCacheFile(filename, cache_folder), CHAIN_FILE_BINARY_MAGIC, CHAIN_FILE_BINARY_VERSION, filename);
+}
+
+void ChainFileReader::addAlignment(const GenomicAlignment& alignment)
+{
+	chromosomes_[alignment.ref_chr].append(alignment);
+}
+
+void ChainFileReader::createIndex()
+{
+	spans_.clear();
+	span_alignment_.clear();
+	span_range_.clear();
+
+	QList<Chromosome> chrs = chromosomes_.keys();
+	std::sort(chrs.begin(), chrs.end());
+	foreach(const Chromosome& chr, chrs)
+	{
+		const QVector<GenomicAlignment>& alignments = chromosomes_[chr];
+
+		//sort alignments by reference start
+		QVector<int> order(alignments.count());
+		for (int i=0; i<order.count(); ++i) order[i] = i;
+		std::sort(order.begin(), order.end(), [&alignments](int a, int b)
+		{
+			if (alignments[a].ref_start!=alignments[b].ref_start) return alignments[a].ref_start<alignments[b].ref_start;
+			return alignments[a].ref_end<alignments[b].ref_end;
+		});
+
+		span_range_.insert(chr, qMakePair(spans_.count(), spans_.count() + order.count() - 1));
+		foreach(int i, order)
+		{
+			spans_.append(BedLine(chr, alignments[i].ref_start, alignments[i].ref_end));
+			span_alignment_ << i;
+		}
+	}
+
+	span_index_.reset(new ChromosomalIndex<BedFile>(spans_));
+}
+
 QList<QByteArray> ChainFileReader::getLines()
 {
 	file_ = VersatileFile(filepath_);
@@ -158,28 +438,180 @@ QList<QByteArray> ChainFileReader::getLines()
 }
 
 BedLine ChainFileReader::lift(const Chromosome& chr, int start, int end) const
+{
+	QString error = checkRegion(chr, start, end);
+	if (!error.isEmpty())
+	{
+		THROW(ArgumentException, error);
+	}
+
+	start = start-1;
+
+	//get alignments that overlap with the given region
+	QVector<int> candidates = span_index_->matchingIndices(chr, start, end);
+
+	BedLine result = liftCandidates(chr, start, end, candidates, error);
+	if (!error.isEmpty())
+	{
+		THROW(ArgumentException, error);
+	}
+
+	return result;
+}
+
+//Worker that lifts a chunk of regions
+class ChainLiftWorker
+	: public QRunnable
+{
+public:
+	ChainLiftWorker(const ChainFileReader& reader, const BedFile& regions, int first, int last, bool sorted, QVector<ChainFileReader::LiftResult>& results)
+		: reader_(reader)
+		, regions_(regions)
+		, first_(first)
+		, last_(last)
+		, sorted_(sorted)
+		, results_(results)
+	{
+		setAutoDelete(false);
+	}
+
+	void run() override
+	{
+		reader_.liftRange(regions_, first_, last_, sorted_, results_);
+	}
+
+private:
+	const ChainFileReader& reader_;
+	const BedFile& regions_;
+	int first_;
+	int last_;
+	bool sorted_;
+	QVector<ChainFileReader::LiftResult>& results_;
+};
+
+QVector<ChainFileReader::LiftResult> ChainFileReader::liftMany(const BedFile& regions, int threads) const
+{
+	QVector<LiftResult> results(regions.count());
+	bool sorted = regions.isSorted();
+
+	if (threads<=1)
+	{
+		liftRange(regions, 0, regions.count()-1, sorted, results);
+		return results;
+	}
+
+	//lift chunks of regions in parallel (each chunk uses its own cursor)
+	const int chunk_size = 10000;
+	QThreadPool pool;
+	pool.setMaxThreadCount(threads);
+	QVector<QSharedPointer<ChainLiftWorker>> workers;
+	for (int first=0; first<regions.count(); first+=chunk_size)
+	{
+		int last = std::min(first + chunk_size, regions.count()) - 1;
+		workers << QSharedPointer<ChainLiftWorker>(new ChainLiftWorker(*this, regions, first, last, sorted, results));
+		pool.start(workers.last().data());
+	}
+	pool.waitForDone();
+
+	return results;
+}
+
+void ChainFileReader::liftRange(const BedFile& regions, int first, int last, bool sorted, QVector<LiftResult>& results) const
+{
+	//cursor state: spans of the current chromosome that start before the current region end and have not ended before the current region start
+	Chromosome cursor_chr;
+	int cursor_pos = 0;
+	int cursor_last = -1;
+	int cursor_start = -1;
+	QVector<int> active;
+
+	QVector<int> candidates;
+	for (int i=first; i<=last; ++i)
+	{
+		const BedLine& region = regions[i];
+		LiftResult& result = results[i];
+
+		result.error = checkRegion(region.chr(), region.start(), region.end());
+		if (!result.error.isEmpty()) continue;
+
+		const int start = region.start() - 1;
+		const int end = region.end();
+		if (sorted)
+		{
+			//reset cursor for new chromosome
+			if (region.chr()!=cursor_chr || start<cursor_start)
+			{
+				cursor_chr = region.chr();
+				QPair<int, int> range = span_range_.value(cursor_chr);
+				cursor_pos = range.first;
+				cursor_last = range.second;
+				active.clear();
+			}
+			cursor_start = start;
+
+			//add spans that start before the region end
+			while (cursor_pos<=cursor_last && spans_[cursor_pos].start()<=end)
+			{
+				active << cursor_pos;
+				++cursor_pos;
+			}
+
+			//remove spans that end before the region start (they cannot overlap the following regions either)
+			int kept = 0;
+			for (int a=0; a<active.count(); ++a)
+			{
+				if (spans_[active[a]].end()>=start) active[kept++] = active[a];
+			}
+			active.resize(kept);
+
+			candidates.clear();
+			foreach(int span, active)
+			{
+				if (spans_[span].start()<=end) candidates << span;
+			}
+		}
+		else
+		{
+			candidates = span_index_->matchingIndices(region.chr(), start, end);
+		}
+
+		result.region = liftCandidates(region.chr(), start, end, candidates, result.error);
+	}
+}
+
+QString ChainFileReader::checkRegion(const Chromosome& chr, int start, int end) const
 {
 	if (end < start)
 	{
-		THROW(ArgumentException, "End is smaller than start!");
+		return "End is smaller than start!";
 	}
 
 	if ( ! chromosomes_.contains(chr))
 	{
-		THROW(ArgumentException, "Position to lift is in unknown chromosome. Tried to lift: " + chr.strNormalized(true));
+		return "Position to lift is in unknown chromosome. Tried to lift: " + chr.strNormalized(true);
 	}
 	if (start < 1 || end > ref_chrom_sizes_[chr])
 	{
-		THROW(ArgumentException, "Position to lift is outside of the chromosome size for chromosome. Tried to lift: " + chr.strNormalized(true) +": " + QByteArray::number(start) + "-" + QByteArray::number(end));
+		return "Position to lift is outside of the chromosome size for chromosome. Tried to lift: " + chr.strNormalized(true) +": " + QByteArray::number(start) + "-" + QByteArray::number(end);
 	}
 
-	start = start-1;
+	return QString();
+}
 
-	//get alignments that overlap with the given region
-	QList<GenomicAlignment> alignments = chromosomes_[chr];
+BedLine ChainFileReader::liftCandidates(const Chromosome& chr, int start, int end, QVector<int>& candidates, QString& error) const
+{
+	const QVector<GenomicAlignment>& alignments = chromosomes_.constFind(chr).value();
+
+	//try alignments in the order of the chain file
+	for (int i=0; i<candidates.count(); ++i)
+	{
+		candidates[i] = span_alignment_[candidates[i]];
+	}
+	std::sort(candidates.begin(), candidates.end());
 
-	foreach(const GenomicAlignment& a, alignments)
+	foreach(int i, candidates)
 	{
+		const GenomicAlignment& a = alignments[i];
 		if( ! a.overlapsWith(start, end))
 		{
 			continue;
@@ -194,11 +626,13 @@ BedLine ChainFileReader::lift(const Chromosome& chr, int start, int end) const
 		else
 		{
 			result.setStart(result.start() +1);
+			error.clear();
 			return result;
 		}
 	}
 
-	THROW(ArgumentException, "Region is unmapped or more than " + QByteArray::number(percent_deletion_*100) + "% deleted/unmapped bases.");
+	error = "Region is unmapped or more than " + QByteArray::number(percent_deletion_*100) + "% deleted/unmapped bases.";
+	return BedLine();
 }
 
 ChainFileReader::GenomicAlignment ChainFileReader::parseChainLine(QList<QByteArray> parts)
@@ -261,28 +695,15 @@ ChainFileReader::GenomicAlignment::GenomicAlignment(double score, Chromosome ref
 
 BedLine ChainFileReader::GenomicAlignment::lift(int start, int end, double percent_deletion) const
 {
-	int start_index = 0;
-	int ref_current_pos = ref_start;
-	int q_current_pos = q_start;
-
-	for (int cur=1; cur<index.size(); cur++)
+	// binary search for the last index checkpoint before the start (or the first checkpoint)
+	auto it = std::upper_bound(index.cbegin()+1, index.cend(), start, [](int pos, const IndexLine& line)
 	{
-		if (index[cur].ref_start > start)
-		{
-			ref_current_pos = index[cur-1].ref_start;
-			q_current_pos = index[cur-1].q_start;
-			start_index = index[cur-1].alignment_line_index;
-			break;
-		}
-
-		if (cur == index.size()-1)
-		{
-			ref_current_pos = index[cur].ref_start;
-			q_current_pos = index[cur].q_start;
-			start_index = index[cur].alignment_line_index;
-			break;
-		}
-	}
+		return pos < line.ref_start;
+	});
+	const IndexLine& checkpoint = *(it-1);
+	int start_index = checkpoint.alignment_line_index;
+	int ref_current_pos = checkpoint.ref_start;
+	int q_current_pos = checkpoint.q_start;
 
 	int lifted_start = -1;
 	int lifted_end = -1;
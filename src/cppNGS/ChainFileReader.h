@@ -4,19 +4,48 @@
 #include "cppNGS_global.h"
 #include "VersatileFile.h"
 #include "BedFile.h"
+#include "ChromosomalIndex.h"
+#include <QVector>
+#include <QScopedPointer>
 
 
 
 class CPPNGSSHARED_EXPORT ChainFileReader
 {
 public:
-	//Constructor
-	ChainFileReader(QString filepath, double percent_deletion);
+	//Constructor. If 'use_cache' is set, the parsed chain file is read from/written to the binary cache file in 'cache_folder' (see binaryCacheFile()). A binary chain file created by storeBinary() can also be given directly.
+	ChainFileReader(QString filepath, double percent_deletion, bool use_cache=false, QString cache_folder=QString());
 	~ChainFileReader();
 
 	// lifts the given region to the new genome
 	BedLine lift(const Chromosome& chr, int start, int end) const;
 
+	// result of lifting a single region with liftMany()
+	struct LiftResult
+	{
+		BedLine region; // lifted region (invalid if lifting was not possible)
+		QString error; // reason why the region could not be lifted (same message as the exception thrown by lift())
+	};
+
+	///
+	/// \brief lifts many regions to the new genome (1-based coordinates like lift()).
+	/// If the regions are sorted, the overlapping alignments are determined with a cursor moving along each chromosome. Otherwise the alignment index is queried for each region.
+	/// \param regions regions to lift
+	/// \param threads number of threads (the regions are processed in contiguous chunks)
+	/// \return one result per region in the order of the input regions.
+	///
+	QVector<LiftResult> liftMany(const BedFile& regions, int threads=1) const;
+
+	// stores the parsed chain file in binary format. If 'source_file' is given, its size and modification time are stored to validate the cache.
+	// Loading a binary file avoids parsing the text format. The data is copied into the alignments, i.e. the file is not accessed after loading.
+	void storeBinary(QString filename, QString source_file=QString()) const;
+	// returns if the file is a binary chain file created by storeBinary()
+	static bool isBinaryFile(QString filename);
+	// returns the binary cache file name of a chain file. If 'cache_folder' is empty, the cache file is located next to the chain file. Otherwise, it is located in the given folder and its name contains a hash of the chain file path.
+	static QString binaryCacheFile(QString filename, QString cache_folder=QString());
+	// returns if the binary cache file of a chain file exists and belongs to the current version of the chain file
+	static bool binaryCacheIsValid(QString filename, QString cache_folder=QString());
+
 private:
 	// internal class to represent the genomic alignment between the reference and query genome
 	class GenomicAlignment
@@ -30,6 +59,13 @@ private:
 			int q_start;
 			int alignment_line_index;
 
+			IndexLine():
+				ref_start(-1)
+			  , q_start(-1)
+			  , alignment_line_index(-1)
+			{
+			}
+
 			IndexLine(int ref_start, int q_start, int idx):
 				ref_start(ref_start)
 			  , q_start(q_start)
@@ -102,26 +138,48 @@ private:
 		int q_end;
 		bool q_on_plus;
 
-		QList<AlignmentLine> alignment;
+		QVector<AlignmentLine> alignment;
 
-		QList<IndexLine> index;
+		QVector<IndexLine> index;
 		// how often the index saves "checkpoints" every X alignmentLines.
 		// around 20-50 seems best
 		const static int index_frequency = 25;
 	};
 
 	//parse file and generate genomicAlignments
-	void load();
+	void load(bool use_cache, QString cache_folder);
+	void loadText();
+	void loadBinary(QString filename);
 	QList<QByteArray> getLines();
 	GenomicAlignment parseChainLine(QList<QByteArray> parts);
+	void addAlignment(const GenomicAlignment& alignment);
+	//creates the index of the reference regions of all alignments
+	void createIndex();
+
+	//returns an error message if the region cannot be lifted (unknown chromosome, etc.), or an empty string otherwise
+	QString checkRegion(const Chromosome& chr, int start, int end) const;
+	//lifts a region (0-based start) using the first candidate alignment (given as span indices) in file order that lifts it. Returns an invalid BedLine and sets 'error' if no alignment lifts the region.
+	BedLine liftCandidates(const Chromosome& chr, int start, int end, QVector<int>& candidates, QString& error) const;
+	//lifts the regions with the given index range (used by liftMany())
+	void liftRange(const BedFile& regions, int first, int last, bool sorted, QVector<LiftResult>& results) const;
+	friend class ChainLiftWorker;
 
 	QString filepath_;
 	VersatileFile file_;
 	double percent_deletion_;
 
-	QHash<Chromosome, QList<GenomicAlignment>> chromosomes_;
+	QHash<Chromosome, QVector<GenomicAlignment>> chromosomes_;
 	QHash<Chromosome, int> ref_chrom_sizes_;
 
+	//reference regions of all alignments sorted by chromosome and start position (0-based start), with an index for overlap queries
+	BedFile spans_;
+	QVector<int> span_alignment_; //index of the alignment in 'chromosomes_' for each span
+	QHash<Chromosome, QPair<int, int>> span_range_; //first and last span index of each chromosome
+	QScopedPointer<ChromosomalIndex<BedFile>> span_index_;
+
+	//"declared away" methods
+	ChainFileReader(const ChainFileReader&) = delete;
+	ChainFileReader& operator=(const ChainFileReader&) = delete;
 };
 
 #endif // CHAINFILEREADER_H
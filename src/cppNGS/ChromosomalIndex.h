@@ -6,6 +6,15 @@
 #include <QHash>
 #include <QVector>
 #include <QPair>
+#include <QVarLengthArray>
+
+///Index type used by ChromosomalIndex.
+enum class ChromosomalIndexType
+{
+	AUTO, ///< Automatic selection: INTERVAL_TREE if single long elements would make BINNED queries scan many elements, BINNED otherwise.
+	BINNED, ///< Bins with a fixed number of elements. Each query scans a window of the size of the longest element in the container.
+	INTERVAL_TREE ///< Implicit augmented interval tree over the sorted container. Query time does not depend on the length of the longest element.
+};
 
 ///Chromosomal index for fast access to @em sorted containers with chromosomal range elements like BedFile and VariantList.
 template <class T>
@@ -13,13 +22,15 @@ class CPPNGSSHARED_EXPORT ChromosomalIndex
 {
 public:
 	///Constructor.
-	ChromosomalIndex(const T& container, int bin_size = 30);
+	ChromosomalIndex(const T& container, int bin_size = 30, ChromosomalIndexType type = ChromosomalIndexType::AUTO);
 
 	///Re-creates the index (only needed if the container content changed after calling the index constructor).
 	void createIndex();
 
 	///Returns the underlying container
 	const T& container() const { return container_; }
+	///Returns the index type that is actually used (never AUTO).
+	ChromosomalIndexType type() const { return use_tree_ ? ChromosomalIndexType::INTERVAL_TREE : ChromosomalIndexType::BINNED; }
 
 	///Returns a vector of element indices overlapping the given chromosomal range.
 	QVector<int> matchingIndices(const Chromosome& chr, int start, int end) const;
@@ -31,18 +42,37 @@ protected:
 	QHash<int, QVector<QPair<int, int> > > index_;
 	int max_length_;
 	int bin_size_;
+	ChromosomalIndexType type_requested_;
+	bool use_tree_;
 	static bool firstOfPairComparator(const QPair<int, int>& a, const QPair<int, int>& b)
 	{
 		return	a.first < b.first;
 	}
+
+	///Implicit augmented interval tree of one chromosome (see cgranges by Heng Li). Node i is the i-th element of the chromosome, max_end contains the maximum end of the sub-tree rooted at node i.
+	struct IntervalTree
+	{
+		int offset;
+		int count;
+		int depth;
+		QVector<int> max_end;
+	};
+	QHash<int, IntervalTree> trees_;
+
+	void createTrees();
+	//Queries the interval tree. If 'matches' is nullptr, the first match is returned. Otherwise, all matches are appended and -1 is returned.
+	int queryTree(const IntervalTree& tree, int start, int end, QVector<int>* matches) const;
 };
 
 template <class T>
-ChromosomalIndex<T>::ChromosomalIndex(const T& container, int bin_size)
+ChromosomalIndex<T>::ChromosomalIndex(const T& container, int bin_size, ChromosomalIndexType type)
 	: container_(container)
 	, index_()
 	, max_length_(-1)
 	, bin_size_(bin_size)
+	, type_requested_(type)
+	, use_tree_(false)
+	, trees_()
 {
 	createIndex();
 }
@@ -52,6 +82,7 @@ void ChromosomalIndex<T>::createIndex()
 {
 	//clear index
 	index_.clear();
+	trees_.clear();
 	max_length_ = -1;
 
 	//re-create index
@@ -61,6 +92,8 @@ void ChromosomalIndex<T>::createIndex()
 	int bin_count = 0;
 	Chromosome last_chr;
 	QVector< QPair<int, int> > chr_indices;
+	double span_sum = 0.0;
+	int chr_first_start = 0;
 	for (int i=0; i<container_.count(); ++i)
 	{
 		if (container_[i].chr()!=last_chr)
@@ -69,11 +102,13 @@ void ChromosomalIndex<T>::createIndex()
 			{
 				chr_indices.append(QPair<int, int>(max,i-1));
 				index_.insert(last_chr.num(), chr_indices);
+				span_sum += container_[i-1].start() - chr_first_start + 1;
 			}
 			chr_indices.clear();
 			chr_indices.append(QPair<int, int>(min,i));
 			last_chr = container_[i].chr();
 			bin_count = 0;
+			chr_first_start = container_[i].start();
 		}
 		else if (bin_count==bin_size_)
 		{
@@ -89,6 +124,117 @@ void ChromosomalIndex<T>::createIndex()
 	//add last chromosome index
 	chr_indices.append(QPair<int, int>(max,container_.count()-1));
 	index_.insert(last_chr.num(), chr_indices);
+	if (container_.count()>0) span_sum += container_[container_.count()-1].start() - chr_first_start + 1;
+
+	//select index type: a binned query scans all elements starting within 'max_length_' of the query range => estimate that number from the element density
+	use_tree_ = type_requested_==ChromosomalIndexType::INTERVAL_TREE;
+	if (type_requested_==ChromosomalIndexType::AUTO && span_sum>0)
+	{
+		double elements_scanned = 2.0 * max_length_ * container_.count() / span_sum;
+		use_tree_ = elements_scanned > 4.0 * bin_size_;
+	}
+	if (use_tree_) createTrees();
+}
+
+template <class T>
+void ChromosomalIndex<T>::createTrees()
+{
+	if (container_.count()==0) return;
+
+	for (auto it=index_.cbegin(); it!=index_.cend(); ++it)
+	{
+		IntervalTree tree;
+		tree.offset = it.value().first().second;
+		tree.count = it.value().last().second - tree.offset + 1;
+		tree.depth = 0;
+		const int n = tree.count;
+		if (n<=0) continue;
+
+		//leaf level
+		tree.max_end.resize(n);
+		qint64 last_i = 0;
+		int last = 0;
+		for (qint64 i=0; i<n; i+=2)
+		{
+			last_i = i;
+			last = container_[tree.offset + i].end();
+			tree.max_end[i] = last;
+		}
+
+		//inner levels ('last' is the maximum end of the right-most node, which is needed for nodes that have a right sub-tree that is (partially) outside of the element range)
+		int k = 1;
+		for (; (1LL<<k)<=n; ++k)
+		{
+			qint64 x = 1LL<<(k-1);
+			qint64 i0 = (x<<1) - 1;
+			qint64 step = x<<2;
+			for (qint64 i=i0; i<n; i+=step)
+			{
+				int e = container_[tree.offset + i].end();
+				e = std::max(e, tree.max_end[i-x]);
+				e = std::max(e, i+x<n ? tree.max_end[i+x] : last);
+				tree.max_end[i] = e;
+			}
+			last_i = (last_i>>k&1) ? last_i - x : last_i + x;
+			if (last_i<n && tree.max_end[last_i]>last) last = tree.max_end[last_i];
+		}
+		tree.depth = k - 1;
+
+		trees_.insert(it.key(), tree);
+	}
+}
+
+template <class T>
+int ChromosomalIndex<T>::queryTree(const IntervalTree& tree, int start, int end, QVector<int>* matches) const
+{
+	struct StackItem
+	{
+		qint64 x;
+		int k;
+		bool left_done;
+	};
+
+	const qint64 n = tree.count;
+	QVarLengthArray<StackItem, 128> stack;
+	stack.append(StackItem{(1LL<<tree.depth) - 1, tree.depth, false});
+	while (!stack.isEmpty())
+	{
+		StackItem item = stack.last();
+		stack.removeLast();
+
+		if (item.k<=3) //small sub-tree: linear scan
+		{
+			qint64 i0 = item.x >> item.k << item.k;
+			qint64 i1 = std::min(i0 + (1LL<<(item.k+1)) - 1, n);
+			for (qint64 i=i0; i<i1; ++i)
+			{
+				const auto& element = container_[tree.offset + i];
+				if (element.start()>end) break;
+				if (element.overlapsWith(start, end))
+				{
+					if (matches==nullptr) return tree.offset + i;
+					matches->append(tree.offset + i);
+				}
+			}
+		}
+		else if (!item.left_done) //process left sub-tree first to return indices in ascending order
+		{
+			qint64 y = item.x - (1LL<<(item.k-1));
+			stack.append(StackItem{item.x, item.k, true});
+			if (y>=n || tree.max_end[y]>=start) stack.append(StackItem{y, item.k-1, false});
+		}
+		else if (item.x<n && container_[tree.offset + item.x].start()<=end) //current node and right sub-tree
+		{
+			if (container_[tree.offset + item.x].overlapsWith(start, end))
+			{
+				if (matches==nullptr) return tree.offset + item.x;
+				matches->append(tree.offset + item.x);
+			}
+			stack.append(StackItem{item.x + (1LL<<(item.k-1)), item.k-1, false});
+		}
+	}
+
+	return -1;
 }
 
 template <class T>
@@ -99,6 +245,14 @@ QVector<int> ChromosomalIndex<T>::matchingIndices(const Chromosome& chr, int sta
 	//chromosome not found
 	if (!index_.contains(chr.num())) return matches;
 
+	//interval tree
+	if (use_tree_)
+	{
+		auto it = trees_.constFind(chr.num());
+		if (it!=trees_.cend()) queryTree(it.value(), start, end, &matches);
+		return matches;
+	}
+
 	//find start iterator in index
 	const QVector<QPair<int,int> >& pos_array = index_[chr.num()];
 	QVector<QPair<int,int> >::const_iterator it = std::lower_bound(pos_array.begin(), pos_array.end(), QPair<int, int>(start, -1), firstOfPairComparator);
@@ -132,6 +286,14 @@ int ChromosomalIndex<T>::matchingIndex(const Chromosome& chr, int start, int end
 	//chromosome not found
 	if (!index_.contains(chr.num())) return -1;
 
+	//interval tree
+	if (use_tree_)
+	{
+		auto it = trees_.constFind(chr.num());
+		if (it==trees_.cend()) return -1;
+		return queryTree(it.value(), start, end, nullptr);
+	}
+
 	//find start iterator in index
 	const QVector<QPair<int,int> >& pos_array = index_[chr.num()];
 	QVector<QPair<int,int> >::const_iterator it = std::lower_bound(pos_array.begin(), pos_array.end(), QPair<int, int>(start, -1), firstOfPairComparator);
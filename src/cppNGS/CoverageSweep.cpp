@@ -0,0 +1,182 @@
+#include "CoverageSweep.h"
+#include "Exceptions.h"
+
+CoverageSweep::CoverageSweep(const BedFile& regions, int start_index, int end_index, int min_mapq, int min_baseq, int cutoff)
+	: regions_(regions)
+	, start_index_(start_index)
+	, end_index_(end_index)
+	, min_mapq_(min_mapq)
+	, min_baseq_(min_baseq)
+	, cutoff_(cutoff)
+	, depth_sums_(end_index-start_index+1, 0)
+	, depth_(1<<16, 0)
+	, mask_((1<<16)-1)
+	, flushed_(0)
+	, max_end_(0)
+	, next_region_(start_index)
+{
+	//sanity checks
+	if (start_index<0) THROW(ArgumentException, "Chunk start index is less than zero!");
+	if (start_index>end_index) THROW(ArgumentException, "Chunk start index is after chunk end index!");
+	if (end_index>=regions.count()) THROW(ArgumentException, "Chunk end index is behind data end!");
+	for (int i=start_index+1; i<=end_index; ++i)
+	{
+		if (regions[i].chr()!=regions[start_index].chr()) THROW(ArgumentException, "Coverage sweep regions are not on the same chromosome!");
+		if (regions[i].start()<regions[i-1].start()) THROW(ArgumentException, "Coverage sweep regions are not sorted!");
+	}
+}
+
+void CoverageSweep::run(BamReader& reader)
+{
+	//determine region to sweep
+	const Chromosome& chr = regions_[start_index_].chr();
+	int start = regions_[start_index_].start();
+	int end = regions_[start_index_].end();
+	for (int i=start_index_; i<=end_index_; ++i)
+	{
+		end = std::max(end, regions_[i].end());
+	}
+	flushed_ = start;
+	max_end_ = start - 1;
+
+	//iterate through all alignments
+	reader.setRegion(chr, start, end);
+	BamAlignment al;
+	QBitArray base_qualities;
+	while (reader.getNextAlignment(al))
+	{
+		if (al.isDuplicate()) continue;
+		if (al.isSecondaryAlignment() || al.isSupplementaryAlignment()) continue;
+		if (al.isUnmapped() || al.mappingQuality()<min_mapq_) continue;
+
+		//reads are sorted by start position => all positions before the read start are final
+		const int al_start = al.start();
+		const int al_end = al.end();
+		if (al_start>flushed_) flush(al_start);
+
+		//skip reads that do not overlap any region: active regions overlap the read start, inactive regions are sorted by start
+		if (al_end<flushed_) continue;
+		if (active_.isEmpty() && (next_region_>end_index_ || regions_[next_region_].start()>al_end)) continue;
+
+		//add read to depth
+		const int ol_start = std::max(al_start, flushed_);
+		const int ol_end = std::min(al_end, end);
+		ensureCapacity(ol_end);
+		int* depth = depth_.data();
+		if (min_baseq_>0)
+		{
+			al.qualities(base_qualities, min_baseq_, al_end - al_start + 1);
+			for (int p=ol_start; p<=ol_end; ++p)
+			{
+				if (base_qualities.testBit(p-al_start)) ++depth[p & mask_];
+			}
+		}
+		else
+		{
+			for (int p=ol_start; p<=ol_end; ++p)
+			{
+				++depth[p & mask_];
+			}
+		}
+		max_end_ = std::max(max_end_, ol_end);
+	}
+
+	//process remaining positions
+	flush(end+1);
+}
+
+void CoverageSweep::flush(int pos)
+{
+	if (pos<=flushed_) return;
+
+	//activate regions starting before 'pos'
+	while (next_region_<=end_index_ && regions_[next_region_].start()<pos)
+	{
+		active_.append(RegionState{next_region_, regions_[next_region_].start(), -1, false});
+		++next_region_;
+	}
+
+	//process active regions
+	int* depth = depth_.data();
+	for (int a=0; a<active_.count(); )
+	{
+		RegionState& state = active_[a];
+		const BedLine& line = regions_[state.index];
+		const int last = std::min(line.end(), pos-1);
+
+		//positions with reads
+		qint64& sum = depth_sums_[state.index-start_index_];
+		const int last_with_reads = std::min(last, max_end_);
+		for (int p=state.pos; p<=last_with_reads; ++p)
+		{
+			const int p_depth = depth[p & mask_];
+			sum += p_depth;
+			if (cutoff_>=0) updateRun(state, p, p_depth);
+		}
+
+		//positions without reads (depth 0)
+		const int first_without_reads = std::max(state.pos, max_end_+1);
+		if (cutoff_>=0 && first_without_reads<=last) updateRun(state, first_without_reads, 0);
+
+		state.pos = last + 1;
+
+		//region done
+		if (line.end()<pos)
+		{
+			if (state.run_start!=-1) closeRun(state, line.end());
+			active_.removeAt(a);
+		}
+		else
+		{
+			++a;
+		}
+	}
+
+	//clear processed positions
+	const int clear_end = std::min(max_end_, pos-1);
+	for (int p=flushed_; p<=clear_end; ++p)
+	{
+		depth[p & mask_] = 0;
+	}
+	flushed_ = pos;
+}
+
+void CoverageSweep::updateRun(CoverageSweep::RegionState& state, int pos, int depth)
+{
+	const bool low = depth<cutoff_;
+	if (state.run_start!=-1 && state.run_low!=low)
+	{
+		closeRun(state, pos-1);
+	}
+	if (state.run_start==-1)
+	{
+		state.run_start = pos;
+		state.run_low = low;
+	}
+}
+
+void CoverageSweep::closeRun(CoverageSweep::RegionState& state, int end)
+{
+	const BedLine& line = regions_[state.index];
+	BedFile& output = state.run_low ? low_ : high_;
+	output.append(BedLine(line.chr(), state.run_start, end, line.annotations()));
+	state.run_start = -1;
+}
+
+void CoverageSweep::ensureCapacity(int end)
+{
+	const int required = end - flushed_ + 1;
+	if (required<=depth_.count()) return;
+
+	//grow to next power of two and copy positions that are not flushed yet
+	int capacity = depth_.count();
+	while (capacity<required) capacity *= 2;
+	QVector<int> depth(capacity, 0);
+	const int mask = capacity - 1;
+	for (int p=flushed_; p<=max_end_; ++p)
+	{
+		depth[p & mask] = depth_[p & mask_];
+	}
+	depth_.swap(depth);
+	mask_ = mask;
+}
@@ -0,0 +1,82 @@
+#ifndef COVERAGESWEEP_H
+#define COVERAGESWEEP_H
+
+#include "cppNGS_global.h"
+#include "BedFile.h"
+#include "BamReader.h"
+
+///Sweep-line coverage calculation for a sorted range of BED regions on one chromosome.
+///Streams the reads of the chromosome once and keeps the per-base depth in a ring buffer that only spans the reads currently overlapping the sweep position.
+///Average coverage, low-coverage regions and high-coverage regions are calculated in the same pass.
+class CPPNGSSHARED_EXPORT CoverageSweep
+{
+public:
+	///Constructor. The regions @p start_index to @p end_index of @p regions must be on the same chromosome and sorted by start position. They may overlap.
+	///If @p cutoff is not negative, low-coverage (depth<cutoff) and high-coverage (depth>=cutoff) regions are determined as well.
+	CoverageSweep(const BedFile& regions, int start_index, int end_index, int min_mapq, int min_baseq, int cutoff = -1);
+
+	///Performs the sweep using the given reader.
+	void run(BamReader& reader);
+
+	///Returns the sum of the per-base depth of the region with the given index (index in the BED file).
+	qint64 depthSum(int index) const
+	{
+		return depth_sums_[index-start_index_];
+	}
+	///Returns the average depth of the region with the given index (index in the BED file).
+	double averageDepth(int index) const
+	{
+		return (double)depthSum(index) / regions_[index].length();
+	}
+	///Returns the parts of the regions with depth below the cutoff. The regions keep the annotations of the input regions.
+	const BedFile& lowCoverageRegions() const
+	{
+		return low_;
+	}
+	///Returns the parts of the regions with depth equal to or higher than the cutoff. The regions keep the annotations of the input regions.
+	const BedFile& highCoverageRegions() const
+	{
+		return high_;
+	}
+
+protected:
+	const BedFile& regions_;
+	int start_index_;
+	int end_index_;
+	int min_mapq_;
+	int min_baseq_;
+	int cutoff_;
+
+	//results
+	QVector<qint64> depth_sums_;
+	BedFile low_;
+	BedFile high_;
+
+	//ring buffer of the per-base depth: position p is stored at index p & mask_. All positions outside [flushed_, max_end_] have depth 0.
+	QVector<int> depth_;
+	int mask_;
+	int flushed_; //all positions before this position are final and processed
+	int max_end_; //maximum end of the reads added to the buffer
+
+	//state of a region that overlaps the sweep position
+	struct RegionState
+	{
+		int index; //index in the BED file
+		int pos; //next position to process
+		int run_start; //start of the current low/high run (-1 if no run is open)
+		bool run_low; //if the current run is a low-coverage run
+	};
+	QVector<RegionState> active_;
+	int next_region_; //index of the next region that is not active yet
+
+	//Processes and clears all positions before 'pos'
+	void flush(int pos);
+	//Updates low/high runs of the region for the given position
+	void updateRun(RegionState& state, int pos, int depth);
+	//Closes the current low/high run of the region at the given position
+	void closeRun(RegionState& state, int end);
+	//Makes sure that the ring buffer can hold all positions up to 'end'
+	void ensureCapacity(int end);
+};
+
+#endif // COVERAGESWEEP_H
@@ -0,0 +1,365 @@
+#include "CsrGraph.h"
+#include "Exceptions.h"
+#include "Helper.h"
+#include "BinaryFileHeader.h"
+#include <QSet>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QRunnable>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+//header of binary graph files (followed by node offsets, neighbors and node names separated by newlines). Data is stored in native byte order.
+struct CsrGraphHeader
+	: public BinaryFileHeader
+{
+	quint32 directed;
+	quint32 reserved;
+	qint64 node_count;
+	qint64 entry_count;
+	qint64 names_size;
+};
+static const char CSR_GRAPH_MAGIC[8] = {'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H'};
+static const quint32 CSR_GRAPH_VERSION = 2;
+
+CsrGraph::CsrGraph()
+	: directed_(false)
+	, offsets_(nullptr)
+	, neighbors_(nullptr)
+	, mapped_(nullptr)
+{
+}
+
+CsrGraph::~CsrGraph()
+{
+	clear();
+}
+
+void CsrGraph::clear()
+{
+	if (mapped_!=nullptr)
+	{
+		file_.unmap(const_cast<uchar*>(mapped_));
+		mapped_ = nullptr;
+	}
+	if (file_.isOpen()) file_.close();
+
+	directed_ = false;
+	names_.clear();
+	index_.clear();
+	offsets_ = nullptr;
+	neighbors_ = nullptr;
+	offsets_data_.clear();
+	neighbors_data_.clear();
+}
+
+void CsrGraph::create(const QList<QPair<QString, QString>>& edges, bool directed)
+{
+	clear();
+	directed_ = directed;
+
+	//determine node IDs and unique edges
+	QVector<QPair<qint32, qint32>> unique_edges;
+	QSet<quint64> edge_keys;
+	for (int i=0; i<edges.count(); ++i)
+	{
+		qint32 ids[2];
+		for (int j=0; j<2; ++j)
+		{
+			const QString& name = j==0 ? edges[i].first : edges[i].second;
+			if (name.isEmpty()) THROW(ArgumentException, "Invalid argument: Empty node name");
+
+			auto it = index_.find(name);
+			if (it==index_.end())
+			{
+				it = index_.insert(name, names_.count());
+				names_ << name;
+			}
+			ids[j] = it.value();
+		}
+
+		quint64 key = directed || ids[0]<=ids[1] ? ((quint64)ids[0]<<32 | (quint32)ids[1]) : ((quint64)ids[1]<<32 | (quint32)ids[0]);
+		if (edge_keys.contains(key)) continue;
+		edge_keys.insert(key);
+		unique_edges << qMakePair(ids[0], ids[1]);
+	}
+
+	//count neighbors
+	offsets_data_.fill(0, names_.count()+1);
+	foreach(const auto& edge, unique_edges)
+	{
+		++offsets_data_[edge.first+1];
+		if (!directed) ++offsets_data_[edge.second+1];
+	}
+	for (int i=0; i<names_.count(); ++i)
+	{
+		offsets_data_[i+1] += offsets_data_[i];
+	}
+
+	//fill neighbors (in the order of the edges)
+	neighbors_data_.resize(offsets_data_[names_.count()]);
+	QVector<qint64> pos = offsets_data_;
+	foreach(const auto& edge, unique_edges)
+	{
+		neighbors_data_[pos[edge.first]++] = edge.second;
+		if (!directed) neighbors_data_[pos[edge.second]++] = edge.first;
+	}
+
+	offsets_ = offsets_data_.constData();
+	neighbors_ = neighbors_data_.constData();
+}
+
+bool CsrGraph::isBinaryFile(QString filename)
+{
+	return BinaryFileHeader::hasMagic(filename, CSR_GRAPH_MAGIC);
+}
+
+void CsrGraph::load(QString filename)
+{
+	if (isBinaryFile(filename))
+	{
+		loadBinary(filename);
+	}
+	else
+	{
+		loadTsv(filename);
+	}
+}
+
+void CsrGraph::loadTsv(QString filename)
+{
+	QList<QPair<QString, QString>> edges;
+
+	QSharedPointer<QFile> reader = Helper::openFileForReading(filename);
+	QTextStream in(reader.data());
+	while(!in.atEnd())
+	{
+		QStringList line = in.readLine().split("\t", QString::SkipEmptyParts);
+		if(line.size() == 2)
+		{
+			edges << qMakePair(line.at(0), line.at(1));
+		}
+	}
+
+	create(edges, false);
+}
+
+void CsrGraph::loadBinary(QString filename)
+{
+	clear();
+
+	file_.setFileName(filename);
+	if (!file_.open(QIODevice::ReadOnly)) THROW(FileAccessException, "Could not open graph file '" + filename + "' for reading!");
+
+	//memory-map file (if that is not possible, we read it into memory)
+	QByteArray file_data;
+	const uchar* data = BinaryFileHeader::map(file_, file_data);
+	if (data!=reinterpret_cast<const uchar*>(file_data.constData()))
+	{
+		mapped_ = data;
+	}
+
+	//header
+	qint64 file_size = file_.size();
+	if (file_size<(qint64)sizeof(CsrGraphHeader)) THROW(FileParseException, "Graph file '" + filename + "' is truncated!");
+	CsrGraphHeader header;
+	memcpy(&header, data, sizeof(CsrGraphHeader));
+	header.check(CSR_GRAPH_MAGIC, CSR_GRAPH_VERSION, filename, "binary graph file");
+	qint64 offsets_bytes = (header.node_count+1) * (qint64)sizeof(qint64);
+	qint64 neighbors_bytes = header.entry_count * (qint64)sizeof(qint32);
+	if (file_size!=(qint64)sizeof(CsrGraphHeader) + offsets_bytes + neighbors_bytes + header.names_size) THROW(FileParseException, "Graph file '" + filename + "' has invalid size!");
+	directed_ = header.directed!=0;
+
+	//adjacency data
+	const uchar* offsets = data + sizeof(CsrGraphHeader);
+	const uchar* neighbors = offsets + offsets_bytes;
+	if (mapped_!=nullptr)
+	{
+		offsets_ = reinterpret_cast<const qint64*>(offsets);
+		neighbors_ = reinterpret_cast<const qint32*>(neighbors);
+	}
+	else
+	{
+		offsets_data_.resize(header.node_count+1);
+		memcpy(offsets_data_.data(), offsets, offsets_bytes);
+		neighbors_data_.resize(header.entry_count);
+		memcpy(neighbors_data_.data(), neighbors, neighbors_bytes);
+		offsets_ = offsets_data_.constData();
+		neighbors_ = neighbors_data_.constData();
+	}
+
+	//node names
+	QByteArray names = QByteArray::fromRawData(reinterpret_cast<const char*>(neighbors + neighbors_bytes), header.names_size);
+	if (header.node_count>0)
+	{
+		foreach(const QByteArray& name, names.split('\n'))
+		{
+			index_.insert(QString::fromUtf8(name), names_.count());
+			names_ << QString::fromUtf8(name);
+		}
+	}
+	if (names_.count()!=header.node_count) THROW(FileParseException, "Graph file '" + filename + "' contains " + QString::number(names_.count()) + " node names, but " + QString::number(header.node_count) + " were expected!");
+}
+
+void CsrGraph::store(QString filename) const
+{
+	QByteArray names = names_.join('\n').toUtf8();
+
+	CsrGraphHeader header;
+	memset(&header, 0, sizeof(CsrGraphHeader));
+	header.init(CSR_GRAPH_MAGIC, CSR_GRAPH_VERSION);
+	header.directed = directed_ ? 1 : 0;
+	header.node_count = nodeCount();
+	header.entry_count = neighborEntryCount();
+	header.names_size = names.size();
+
+	QSharedPointer<QFile> file = Helper::openFileForWriting(filename);
+	file->write(reinterpret_cast<const char*>(&header), sizeof(CsrGraphHeader));
+	if (offsets_!=nullptr)
+	{
+		file->write(reinterpret_cast<const char*>(offsets_), (header.node_count+1) * sizeof(qint64));
+		file->write(reinterpret_cast<const char*>(neighbors_), header.entry_count * sizeof(qint32));
+	}
+	else //empty graph
+	{
+		qint64 offset = 0;
+		file->write(reinterpret_cast<const char*>(&offset), sizeof(qint64));
+	}
+	file->write(names);
+}
+
+//Worker for one block of rows of the random walk with restart iteration
+class RandomWalkWorker
+	: public QRunnable
+{
+public:
+	RandomWalkWorker(const CsrGraph& graph, int start, int end, double restart, const double* restart_vector, const double& dangling, double* diff)
+		: graph_(graph)
+		, start_(start)
+		, end_(end)
+		, restart_(restart)
+		, restart_vector_(restart_vector)
+		, p_(nullptr)
+		, dangling_(dangling)
+		, p_new_(nullptr)
+		, diff_(diff)
+	{
+		setAutoDelete(false);
+	}
+
+	//sets the input and output probability buffers of the next iteration (raw pointers into unshared buffers, so that the workers never detach a shared QVector)
+	void setBuffers(const double* p, double* p_new)
+	{
+		p_ = p;
+		p_new_ = p_new;
+	}
+
+	void run() override
+	{
+		double diff = 0.0;
+		for (int i=start_; i<end_; ++i)
+		{
+			//pull probability mass from neighbors (graph is undirected, i.e. in-neighbors are the neighbors)
+			double sum = 0.0;
+			const qint32* neighbors = graph_.neighbors(i);
+			const int degree = graph_.degree(i);
+			for (int k=0; k<degree; ++k)
+			{
+				const int j = neighbors[k];
+				sum += p_[j] / graph_.degree(j);
+			}
+
+			double value = (1.0 - restart_) * (sum + dangling_ * restart_vector_[i]) + restart_ * restart_vector_[i];
+			diff += std::fabs(value - p_[i]);
+			p_new_[i] = value;
+		}
+		*diff_ = diff;
+	}
+
+private:
+	const CsrGraph& graph_;
+	int start_;
+	int end_;
+	double restart_;
+	const double* restart_vector_;
+	const double* p_;
+	const double& dangling_;
+	double* p_new_;
+	double* diff_;
+};
+
+QVector<double> CsrGraph::randomWalkWithRestart(const QVector<int>& seeds, double restart, int threads, double tolerance, int max_iterations) const
+{
+	if (directed_) THROW(ProgrammingException, "Random walk with restart is only implemented for undirected graphs!");
+	if (seeds.isEmpty()) THROW(ArgumentException, "Random walk with restart needs at least one seed node!");
+	if (restart<=0.0 || restart>1.0) THROW(ArgumentException, "Invalid restart probability " + QString::number(restart) + " for random walk with restart!");
+	if (threads<1) THROW(ArgumentException, "Invalid thread count " + QString::number(threads) + " for random walk with restart!");
+
+	//restart vector: seeds are chosen uniformly (seeds contained several times have a higher probability)
+	const int n = nodeCount();
+	QVector<double> restart_vector(n, 0.0);
+	foreach(int seed, seeds)
+	{
+		if (seed<0 || seed>=n) THROW(ArgumentException, "Invalid seed node " + QString::number(seed) + " for random walk with restart!");
+		restart_vector[seed] += 1.0 / seeds.count();
+	}
+
+	//probability buffers: allocated separately (not implicitly shared with 'restart_vector'), the workers only get raw pointers
+	QVector<double> p(n);
+	std::copy(restart_vector.constBegin(), restart_vector.constEnd(), p.begin());
+	QVector<double> p_new(n, 0.0);
+	double* p_data = p.data();
+	double* p_new_data = p_new.data();
+
+	//split rows into blocks (more blocks than threads to balance the load of high-degree nodes)
+	QThreadPool pool;
+	pool.setMaxThreadCount(threads);
+	int block_count = threads==1 ? 1 : std::min(n, 8 * threads);
+	QVector<double> diffs(block_count, 0.0);
+	double dangling = 0.0;
+	QVector<QSharedPointer<RandomWalkWorker>> workers;
+	for (int b=0; b<block_count; ++b)
+	{
+		int start = (qint64)n * b / block_count;
+		int end = (qint64)n * (b+1) / block_count;
+		workers << QSharedPointer<RandomWalkWorker>(new RandomWalkWorker(*this, start, end, restart, restart_vector.constData(), dangling, diffs.data() + b));
+	}
+
+	for (int iteration=0; iteration<max_iterations; ++iteration)
+	{
+		//probability of nodes without neighbors is restarted
+		dangling = 0.0;
+		for (int i=0; i<n; ++i)
+		{
+			if (degree(i)==0) dangling += p_data[i];
+		}
+
+		//sparse matrix-vector multiplication
+		foreach(const QSharedPointer<RandomWalkWorker>& worker, workers)
+		{
+			worker->setBuffers(p_data, p_new_data);
+		}
+		if (block_count==1)
+		{
+			workers[0]->run();
+		}
+		else
+		{
+			foreach(const QSharedPointer<RandomWalkWorker>& worker, workers)
+			{
+				pool.start(worker.data());
+			}
+			pool.waitForDone();
+		}
+		std::swap(p_data, p_new_data);
+
+		//check convergence
+		double diff = 0.0;
+		foreach(double d, diffs) diff += d;
+		if (diff<tolerance) break;
+	}
+
+	//result is in the buffer that was written last
+	return p_data==p.constData() ? p : p_new;
+}
@@ -0,0 +1,95 @@
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include "cppNGS_global.h"
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QFile>
+
+///Immutable graph in compressed sparse row (CSR) format with integer node IDs (0 to nodeCount()-1).
+///Neighbors of a node are stored in the order in which the edges were added. For undirected graphs, each edge is stored for both nodes.
+///The binary representation written by store() is memory-mapped by load(), so that large graphs (e.g. STRING) can be loaded quickly.
+class CPPNGSSHARED_EXPORT CsrGraph
+{
+public:
+	///Default constructor (empty graph).
+	CsrGraph();
+	///Destructor.
+	~CsrGraph();
+
+	///Creates the graph from edges given by node names. Nodes are numbered in the order of their first occurrence. Duplicate edges are ignored.
+	void create(const QList<QPair<QString, QString>>& edges, bool directed = false);
+	///Loads the graph from a binary file (see store()) or from a TSV file with two node names per line (undirected).
+	void load(QString filename);
+	///Stores the graph in binary format.
+	void store(QString filename) const;
+	///Returns if the file is a binary graph file.
+	static bool isBinaryFile(QString filename);
+
+	///Returns if the graph is directed.
+	bool directed() const
+	{
+		return directed_;
+	}
+	///Returns the number of nodes.
+	int nodeCount() const
+	{
+		return names_.count();
+	}
+	///Returns the number of neighbor entries (for undirected graphs, each edge is counted twice).
+	qint64 neighborEntryCount() const
+	{
+		return offsets_==nullptr ? 0 : offsets_[nodeCount()];
+	}
+
+	///Returns the node name.
+	const QString& nodeName(int node) const
+	{
+		return names_[node];
+	}
+	///Returns the node ID, or -1 if there is no node with the given name.
+	int nodeIndex(const QString& name) const
+	{
+		return index_.value(name, -1);
+	}
+	///Returns the (out-)degree of a node.
+	int degree(int node) const
+	{
+		return offsets_[node+1] - offsets_[node];
+	}
+	///Returns the first neighbor of a node (use with degree()).
+	const qint32* neighbors(int node) const
+	{
+		return neighbors_ + offsets_[node];
+	}
+
+	///Random walk with restart for undirected graphs: stationary visiting probability of each node for a walker that jumps back to a random seed node with probability @p restart in each step.
+	///Computed by iterated sparse matrix-vector multiplication (in parallel with @p threads threads) until the L1 norm of the change is below @p tolerance.
+	QVector<double> randomWalkWithRestart(const QVector<int>& seeds, double restart, int threads = 1, double tolerance = 1e-10, int max_iterations = 1000) const;
+
+protected:
+	bool directed_;
+	QStringList names_;
+	QHash<QString, int> index_;
+
+	//adjacency data: either owned (created/loaded from TSV) or memory-mapped (loaded from binary file)
+	const qint64* offsets_;
+	const qint32* neighbors_;
+	QVector<qint64> offsets_data_;
+	QVector<qint32> neighbors_data_;
+	QFile file_;
+	const uchar* mapped_;
+
+	void clear();
+	void loadBinary(QString filename);
+	void loadTsv(QString filename);
+
+	//"declared away" methods
+	CsrGraph(const CsrGraph&) = delete;
+	CsrGraph& operator=(const CsrGraph&) = delete;
+};
+
+#endif // CSRGRAPH_H
@@ -0,0 +1,164 @@
+#include "ExternalSort.h"
+#include "Exceptions.h"
+#include "Helper.h"
+#include <QFile>
+#include <QRunnable>
+#include <cstdio>
+
+//Runnable that executes a sort job and stores the first exception
+class ExternalSortJob
+	: public QRunnable
+{
+public:
+	ExternalSortJob(std::function<void()> job, QSemaphore& free_slots, QMutex& error_mutex, std::exception_ptr& error)
+		: job_(job)
+		, free_slots_(free_slots)
+		, error_mutex_(error_mutex)
+		, error_(error)
+	{
+	}
+
+	void run() override
+	{
+		try
+		{
+			job_();
+		}
+		catch(...)
+		{
+			QMutexLocker locker(&error_mutex_);
+			if (!error_) error_ = std::current_exception();
+		}
+		free_slots_.release();
+	}
+
+private:
+	std::function<void()> job_;
+	QSemaphore& free_slots_;
+	QMutex& error_mutex_;
+	std::exception_ptr& error_;
+};
+
+ExternalSortRuns::Writer::Writer(QString filename, bool compress)
+	: filename_(filename)
+{
+	file_ = gzopen(filename.toUtf8().data(), compress ? "wb1" : "wbT");
+	if (file_==nullptr) THROW(FileAccessException, "Could not open temporary file '" + filename + "' for writing!");
+	gzbuffer(file_, 1048576);
+}
+
+ExternalSortRuns::Writer::~Writer()
+{
+	if (file_!=nullptr) gzclose(file_);
+}
+
+void ExternalSortRuns::Writer::write(const QByteArray& text)
+{
+	if (text.isEmpty()) return;
+
+	int written = gzwrite(file_, text.constData(), text.size());
+	if (written!=text.size())
+	{
+		THROW(FileAccessException, "Writing temporary file '" + filename_ + "' failed; not all bytes were written.");
+	}
+}
+
+void ExternalSortRuns::Writer::close()
+{
+	int error = gzclose(file_);
+	file_ = nullptr;
+	if (error!=Z_OK) THROW(FileAccessException, "Could not close temporary file '" + filename_ + "'!");
+}
+
+ExternalSortRuns::Reader::Reader(QString filename)
+	: filename_(filename)
+	, buffer_(1048576, Qt::Uninitialized)
+{
+	file_ = filename.isEmpty() ? gzdopen(fileno(stdin), "rb") : gzopen(filename.toUtf8().data(), "rb"); //read binary: always open in binary mode because windows and mac open in text mode
+	if (file_==nullptr) THROW(FileAccessException, "Could not open file '" + filename + "' for reading!");
+	gzbuffer(file_, 1048576);
+}
+
+ExternalSortRuns::Reader::~Reader()
+{
+	gzclose(file_);
+}
+
+bool ExternalSortRuns::Reader::readLine(QByteArray& line)
+{
+	line.clear();
+	while(true)
+	{
+		char* char_array = gzgets(file_, buffer_.data(), buffer_.size());
+		if (char_array==nullptr)
+		{
+			int error_no = Z_OK;
+			QByteArray error_message = gzerror(file_, &error_no);
+			if (error_no!=Z_OK && error_no!=Z_STREAM_END)
+			{
+				THROW(FileParseException, "Error while reading file '" + filename_ + "': " + error_message);
+			}
+			return !line.isEmpty();
+		}
+
+		line.append(char_array);
+		if (line.endsWith('\n')) //lines longer than the buffer are read in several steps
+		{
+			line.chop(1);
+			return true;
+		}
+	}
+}
+
+ExternalSortRuns::ExternalSortRuns(const ExternalSortSettings& settings)
+	: settings_(settings)
+	, free_slots_(std::max(1, settings.threads))
+{
+	if (settings_.threads<1) THROW(ArgumentException, "Invalid thread count '" + QString::number(settings_.threads) + "' for external sort!");
+	if (settings_.buffer_size<1) THROW(ArgumentException, "Invalid buffer size '" + QString::number(settings_.buffer_size) + "' for external sort!");
+	if (settings_.max_merge_runs<2) THROW(ArgumentException, "Invalid maximum number of merged runs '" + QString::number(settings_.max_merge_runs) + "' for external sort!");
+
+	pool_.setMaxThreadCount(settings_.threads);
+}
+
+ExternalSortRuns::~ExternalSortRuns()
+{
+	pool_.waitForDone();
+	removeFiles(files_);
+}
+
+QString ExternalSortRuns::addRun()
+{
+	QString filename = createTempFile();
+	runs_ << filename;
+	return filename;
+}
+
+void ExternalSortRuns::execute(std::function<void()> job)
+{
+	free_slots_.acquire();
+	pool_.start(new ExternalSortJob(job, free_slots_, error_mutex_, error_));
+}
+
+void ExternalSortRuns::waitForJobs()
+{
+	pool_.waitForDone();
+
+	QMutexLocker locker(&error_mutex_);
+	if (error_) std::rethrow_exception(error_);
+}
+
+QString ExternalSortRuns::createTempFile()
+{
+	QString filename = Helper::tempFileName(settings_.compress_runs ? ".txt.gz" : ".txt");
+	files_ << filename;
+	return filename;
+}
+
+void ExternalSortRuns::removeFiles(const QStringList& files)
+{
+	foreach(const QString& filename, files)
+	{
+		QFile::remove(filename);
+	}
+}
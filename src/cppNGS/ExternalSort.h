@@ -0,0 +1,170 @@
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+#include "cppNGS_global.h"
+#include <QByteArray>
+#include <QStringList>
+#include <QSharedPointer>
+#include <QVector>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QMutex>
+#include <zlib.h>
+#include <exception>
+#include <functional>
+#include <queue>
+#include <vector>
+
+///Settings for external sorting of files that do not fit into memory.
+struct CPPNGSSHARED_EXPORT ExternalSortSettings
+{
+	///Number of threads used to sort chunks in parallel.
+	int threads = 1;
+	///Maximum size of an input chunk (in bytes) that is sorted in memory. At most 'threads+1' chunks are kept in memory at the same time.
+	qint64 buffer_size = 500000000;
+	///Compress temporary files.
+	bool compress_runs = false;
+	///Maximum number of temporary files that are merged at once.
+	int max_merge_runs = 64;
+};
+
+///Temporary files of sorted runs for external merge sort. Runs are written in the order of the input chunks and merged with a k-way merge.
+///Temporary files are removed when the object is destroyed.
+class CPPNGSSHARED_EXPORT ExternalSortRuns
+{
+public:
+	///Writer for a run file.
+	class CPPNGSSHARED_EXPORT Writer
+	{
+	public:
+		Writer(QString filename, bool compress);
+		~Writer();
+		///Writes text that consists of complete lines.
+		void write(const QByteArray& text);
+		///Closes the file.
+		void close();
+
+	private:
+		QString filename_;
+		gzFile file_;
+	};
+
+	///Line reader for run files and plain/gzipped input files.
+	class CPPNGSSHARED_EXPORT Reader
+	{
+	public:
+		///Constructor. If @p filename is empty, reads from STDIN.
+		Reader(QString filename);
+		~Reader();
+		///Reads the next line (without newline). Returns false if the end of the file is reached.
+		bool readLine(QByteArray& line);
+
+	private:
+		QString filename_;
+		gzFile file_;
+		QByteArray buffer_;
+	};
+
+	///Constructor.
+	ExternalSortRuns(const ExternalSortSettings& settings);
+	///Destructor - removes the temporary files.
+	~ExternalSortRuns();
+
+	///Creates a new run and returns the name of its temporary file. The order of the runs determines the order of equal lines in the output.
+	QString addRun();
+	///Executes @p job (sorting a chunk and writing it to a run) in a worker thread. Blocks while 'threads' jobs are running to limit the memory usage.
+	void execute(std::function<void()> job);
+	///Waits until all jobs are finished. Re-throws the first exception that occurred in a job.
+	void waitForJobs();
+	///Returns the number of runs.
+	int count() const
+	{
+		return runs_.count();
+	}
+
+	///Merges the runs. Lines are passed to @p output in sorted order.
+	///@p key fills the sort key of type T from a line, @p less compares two sort keys (must be the comparator used to sort the runs).
+	template <typename T, typename KeyFunction, typename LessThan, typename OutputFunction>
+	void merge(KeyFunction key, LessThan less, OutputFunction output)
+	{
+		//limit the number of open files: merge the first runs into one run that replaces them (keeps the order of equal lines)
+		while (runs_.count()>settings_.max_merge_runs)
+		{
+			QStringList inputs = runs_.mid(0, settings_.max_merge_runs);
+			QString merged = createTempFile();
+			Writer writer(merged, settings_.compress_runs);
+			QByteArray buffer;
+			mergeRuns<T>(inputs, key, less, [&](const QByteArray& line)
+			{
+				buffer.append(line);
+				buffer.append('\n');
+				if (buffer.size()>1048576)
+				{
+					writer.write(buffer);
+					buffer.clear();
+				}
+			});
+			writer.write(buffer);
+			writer.close();
+
+			removeFiles(inputs);
+			runs_ = QStringList() << merged << runs_.mid(settings_.max_merge_runs);
+		}
+
+		mergeRuns<T>(runs_, key, less, output);
+	}
+
+protected:
+	ExternalSortSettings settings_;
+	QStringList runs_;
+	QStringList files_; //all temporary files (for cleanup)
+	QThreadPool pool_;
+	QSemaphore free_slots_; //number of jobs that can be started without exceeding the thread count
+	QMutex error_mutex_;
+	std::exception_ptr error_; //first exception thrown by a job
+
+	QString createTempFile();
+	void removeFiles(const QStringList& files);
+
+	//k-way merge of the given run files
+	template <typename T, typename KeyFunction, typename LessThan, typename OutputFunction>
+	static void mergeRuns(const QStringList& files, KeyFunction key, LessThan less, OutputFunction output)
+	{
+		QVector<QSharedPointer<Reader>> readers;
+		QVector<QByteArray> lines(files.count());
+		QVector<T> keys(files.count());
+
+		//heap of run indices - smallest line on top, lower run index first for equal lines
+		auto greater = [&](int a, int b)
+		{
+			if (less(keys[b], keys[a])) return true;
+			if (less(keys[a], keys[b])) return false;
+			return a>b;
+		};
+		std::priority_queue<int, std::vector<int>, decltype(greater)> heap(greater);
+		for (int i=0; i<files.count(); ++i)
+		{
+			readers << QSharedPointer<Reader>(new Reader(files[i]));
+			if (readers[i]->readLine(lines[i]))
+			{
+				key(lines[i], keys[i]);
+				heap.push(i);
+			}
+		}
+
+		while (!heap.empty())
+		{
+			int i = heap.top();
+			heap.pop();
+			output(lines[i]);
+
+			if (readers[i]->readLine(lines[i]))
+			{
+				key(lines[i], keys[i]);
+				heap.push(i);
+			}
+		}
+	}
+};
+
+#endif // EXTERNALSORT_H
@@ -5,14 +5,17 @@
 #include <QNetworkProxy>
 #include <QRegExp>
 #include <QStringList>
+#include <QMutexLocker>
+#include <cstring>
 #include "HttpRequestHandler.h"
 
 using namespace std;
 
-FastaFileIndex::FastaFileIndex(QString fasta_file)
+FastaFileIndex::FastaFileIndex(QString fasta_file, bool preload)
 	: fasta_name_(fasta_file)
 	, index_name_(fasta_file + ".fai")
 	, file_(fasta_file)
+	, data_(nullptr)
 {
 	if (!isLocal())
 	{
@@ -33,11 +36,17 @@ FastaFileIndex::FastaFileIndex(QString fasta_file)
 	else
 	{
 		//open FASTA file handle
-		if (!file_.open(QIODevice::ReadOnly | QIODevice::Text))
+		if (!file_.open(QIODevice::ReadOnly))
 		{
 			THROW(FileAccessException, "Could not open FASTA file '" + fasta_name_ + "' for reading!");
 		}
 
+		//memory-map FASTA file (if that is not possible, we fall back to seek/read)
+		if (file_.size()>0)
+		{
+			data_ = file_.map(0, file_.size());
+		}
+
 		//load index file
 		int linenum = 0;
 		QSharedPointer<QFile> file = Helper::openFileForReading(index_name_);
@@ -58,12 +67,15 @@ FastaFileIndex::FastaFileIndex(QString fasta_file)
 	{
 		THROW(FileParseException, "Empty FAI file for " + fasta_file + "'!");
 	}
+
+	if (preload) preloadSequences();
 }
 
 FastaFileIndex::~FastaFileIndex()
 {
 	if (isLocal())
 	{
+		if (data_!=nullptr) file_.unmap(const_cast<uchar*>(data_));
 		file_.close();
 	}
 }
@@ -72,35 +84,18 @@ Sequence FastaFileIndex::seq(const Chromosome& chr, bool to_upper) const
 {
 	const FastaIndexEntry& entry = index(chr);
 
-	if (isLocal())
-	{
-		//jump to postion
-		if (!file_.seek(entry.offset))
-		{
-			THROW(FileAccessException, "QFile::seek did not work on " + fasta_name_ + "'!");
-		}
-	}
-
 	//read data
-	int newlines_in_sequence = entry.length / entry.line_blen;
-	int seqlen = newlines_in_sequence  + entry.length;
 	Sequence output {};
-
-	if (isLocal())
+	if (isPreloaded())
 	{
-		output = file_.read(seqlen).replace('\n', "");
+		output = unpackSequence(*packed_.constFind(chr.strNormalized(true)), 0, entry.length, to_upper);
 	}
 	else
 	{
-		QString byte_range = "bytes=" + QString::number(entry.offset) + "-" + QString::number(entry.offset + seqlen -1);
-		HttpHeaders add_headers;
-		add_headers.insert("Accept", "text/plain");
-		add_headers.insert("Range", byte_range.toUtf8());
-        output = HttpRequestHandler(QNetworkProxy(QNetworkProxy::NoProxy)).get(fasta_name_, add_headers).body.replace("\n", 1, "", 0);
+		output = readSequence(entry, 0, entry.length);
+		if (to_upper) output = output.toUpper();
 	}
 
-	//output
-	if (to_upper) output = output.toUpper();
 	return output;
 }
 
@@ -129,38 +124,18 @@ Sequence FastaFileIndex::seq(const Chromosome& chr, int start, int length, bool
 		length = min(length, entry.length - start);
 	}
 
-	//jump to postion
-	int newlines_before = start > 0 ? (start - 1) / entry.line_blen : 0;
-	qint64 read_start_pos = entry.offset + newlines_before + start;
-	if (isLocal())
-	{
-		if (!file_.seek(read_start_pos))
-		{
-			THROW(FileAccessException, "QFile::seek did not work on " + fasta_name_ + "'!");
-		}
-	}
-
 	//read data
-	int newlines_by_end = (start + length - 1) / entry.line_blen;
-	int newlines_inside = newlines_by_end - newlines_before;
-	int seqlen = length + newlines_inside;
 	Sequence output {};
-
-	if (isLocal())
+	if (isPreloaded())
 	{
-		output = file_.read(seqlen).replace('\n', "");
+		output = unpackSequence(*packed_.constFind(chr.strNormalized(true)), start, length, to_upper);
 	}
 	else
 	{
-		QString byte_range = "bytes=" + QString::number(read_start_pos) + "-" + QString::number(read_start_pos + seqlen - 1);
-		HttpHeaders add_headers;
-		add_headers.insert("Accept", "text/plain");
-		add_headers.insert("Range", byte_range.toUtf8());
-        output = HttpRequestHandler(QNetworkProxy(QNetworkProxy::NoProxy)).get(fasta_name_, add_headers).body.replace("\n", 1, "", 0);
+		output = readSequence(entry, start, length);
+		if (to_upper) output = output.toUpper();
 	}
 
-	//output
-	if (to_upper) output = output.toUpper();
 	return output;
 }
 
@@ -190,3 +165,146 @@ void FastaFileIndex::saveEntryToIndex(const QList<QByteArray>& fields)
 	QString name_norm = Chromosome(fields[0]).strNormalized(true);
 	index_[name_norm] = entry;
 }
+
+Sequence FastaFileIndex::readSequence(const FastaIndexEntry& entry, int start, int length) const
+{
+	Sequence output {};
+	if (length<=0) return output;
+
+	//memory-mapped file: copy line by line
+	if (data_!=nullptr)
+	{
+		output.resize(length);
+		char* out = output.data();
+		int pos = start;
+		int remaining = length;
+		while (remaining>0)
+		{
+			int line_pos = pos % entry.line_blen;
+			int count = min(entry.line_blen - line_pos, remaining);
+			memcpy(out, data_ + entry.offset + (qint64)(pos / entry.line_blen) * entry.line_len + line_pos, count);
+			out += count;
+			pos += count;
+			remaining -= count;
+		}
+		return output;
+	}
+
+	//determine byte range
+	qint64 first_byte = entry.offset + (qint64)(start / entry.line_blen) * entry.line_len + start % entry.line_blen;
+	int end = start + length - 1;
+	qint64 last_byte = entry.offset + (qint64)(end / entry.line_blen) * entry.line_len + end % entry.line_blen;
+
+	if (isLocal())
+	{
+		QMutexLocker locker(&file_mutex_);
+		if (!file_.seek(first_byte))
+		{
+			THROW(FileAccessException, "QFile::seek did not work on " + fasta_name_ + "'!");
+		}
+		output = file_.read(last_byte - first_byte + 1);
+	}
+	else
+	{
+		QString byte_range = "bytes=" + QString::number(first_byte) + "-" + QString::number(last_byte);
+		HttpHeaders add_headers;
+		add_headers.insert("Accept", "text/plain");
+		add_headers.insert("Range", byte_range.toUtf8());
+		output = HttpRequestHandler(QNetworkProxy(QNetworkProxy::NoProxy)).get(fasta_name_, add_headers).body;
+	}
+	output.replace('\n', "");
+	output.replace('\r', "");
+
+	return output;
+}
+
+Sequence FastaFileIndex::unpackSequence(const PackedSequence& packed, int start, int length, bool to_upper)
+{
+	static const char bases[4] = {'A', 'C', 'G', 'T'};
+
+	Sequence output {};
+	output.resize(length);
+	char* out = output.data();
+	const uchar* data = reinterpret_cast<const uchar*>(packed.bases.constData());
+	for (int i=0; i<length; ++i)
+	{
+		int pos = start + i;
+		out[i] = bases[(data[pos>>2] >> ((pos&3)*2)) & 3];
+	}
+
+	//apply runs overlapping the range
+	int end = start + length;
+	auto firstOverlappingRun = [start](const QVector<SequenceRun>& runs)
+	{
+		return std::upper_bound(runs.cbegin(), runs.cend(), start, [](int pos, const SequenceRun& run){ return pos < run.end; });
+	};
+	for (auto it=firstOverlappingRun(packed.other_bases); it!=packed.other_bases.cend() && it->start<end; ++it)
+	{
+		for (int pos=max(start, it->start); pos<min(end, it->end); ++pos)
+		{
+			out[pos-start] = it->base;
+		}
+	}
+	if (!to_upper)
+	{
+		for (auto it=firstOverlappingRun(packed.lower_case); it!=packed.lower_case.cend() && it->start<end; ++it)
+		{
+			for (int pos=max(start, it->start); pos<min(end, it->end); ++pos)
+			{
+				char& base = out[pos-start];
+				if (base>='A' && base<='Z') base += 'a' - 'A';
+			}
+		}
+	}
+
+	return output;
+}
+
+void FastaFileIndex::preloadSequences()
+{
+	auto appendToRuns = [](QVector<SequenceRun>& runs, int pos, char base)
+	{
+		if (!runs.isEmpty() && runs.last().end==pos && runs.last().base==base)
+		{
+			++runs.last().end;
+		}
+		else
+		{
+			runs.append(SequenceRun{pos, pos+1, base});
+		}
+	};
+
+	for (auto it=index_.cbegin(); it!=index_.cend(); ++it)
+	{
+		const FastaIndexEntry& entry = it.value();
+		Sequence raw = readSequence(entry, 0, entry.length);
+
+		PackedSequence packed;
+		packed.bases.fill(0, (entry.length + 3) / 4);
+		uchar* data = reinterpret_cast<uchar*>(packed.bases.data());
+		for (int i=0; i<raw.length(); ++i)
+		{
+			char base = raw[i];
+			if (base>='a' && base<='z')
+			{
+				base -= 'a' - 'A';
+				appendToRuns(packed.lower_case, i, 'N');
+			}
+
+			uchar code = 0;
+			switch(base)
+			{
+				case 'A': code = 0; break;
+				case 'C': code = 1; break;
+				case 'G': code = 2; break;
+				case 'T': code = 3; break;
+				default: appendToRuns(packed.other_bases, i, base);
+			}
+			data[i>>2] |= code << ((i&3)*2);
+		}
+		packed.other_bases.squeeze();
+		packed.lower_case.squeeze();
+
+		packed_.insert(it.key(), packed);
+	}
+}
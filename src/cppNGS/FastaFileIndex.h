@@ -5,14 +5,19 @@
 #include "Chromosome.h"
 #include "Sequence.h"
 #include <QMap>
+#include <QHash>
 #include <QFile>
+#include <QMutex>
 
 ///Fasta file index for fast access to seqences in a FASTA file.
+///Local FASTA files are memory-mapped, i.e. sequence access is thread-safe and one instance can be shared by several threads.
+///Optionally, the whole genome can be preloaded into memory in 2-bit packed form (about 800MB for GRCh38).
 class CPPNGSSHARED_EXPORT FastaFileIndex
 {
 public:
 	///Constructor, loads an index corresponding to @p fasta_file. The index is assumed to have the same name with appended '.fai' extension.
-	FastaFileIndex(QString fasta_file);
+	///If @p preload is set, all sequences are loaded into memory (2-bit packed bases plus runs of non-ACGT bases and soft-masked bases).
+	FastaFileIndex(QString fasta_file, bool preload = false);
 	///Descructor.
 	~FastaFileIndex();
 
@@ -33,6 +38,12 @@ public:
 		return index_.keys();
 	}
 
+	///Returns if the sequences are preloaded into memory.
+	bool isPreloaded() const
+	{
+		return !packed_.isEmpty();
+	}
+
 protected:
 	QString fasta_name_;
 	QString index_name_;
@@ -46,9 +57,34 @@ protected:
 	};
 	QMap<QString, FastaIndexEntry> index_;
 	mutable QFile file_;
+	const uchar* data_; //memory-mapped FASTA file (nullptr if the file is not local or could not be mapped)
+	mutable QMutex file_mutex_; //protects 'file_' if the file could not be memory-mapped
+
+	///Run of identical non-ACGT bases or of soft-masked bases (0-based, end exclusive).
+	struct SequenceRun
+	{
+		int start;
+		int end;
+		char base;
+	};
+	///2-bit packed sequence of one chromosome.
+	struct PackedSequence
+	{
+		QByteArray bases; //4 bases per byte: A=0, C=1, G=2, T=3
+		QVector<SequenceRun> other_bases; //runs of bases that are not A/C/G/T, e.g. N
+		QVector<SequenceRun> lower_case; //runs of soft-masked bases
+	};
+	QHash<QString, PackedSequence> packed_;
+
 	const FastaIndexEntry& index(const Chromosome& chr) const;
 	bool isLocal() const;
 	void saveEntryToIndex(const QList<QByteArray>& fields);
+	//Reads the sequence from the FASTA file (0-based start, not upper-cased).
+	Sequence readSequence(const FastaIndexEntry& entry, int start, int length) const;
+	//Extracts the sequence from the packed sequence (0-based start).
+	static Sequence unpackSequence(const PackedSequence& packed, int start, int length, bool to_upper);
+	//Loads all sequences into memory.
+	void preloadSequences();
 };
 
 #endif
@@ -6,6 +6,8 @@
 #include "Log.h"
 #include "GeneSet.h"
 #include "cmath"
+#include <limits>
+#include <QMutex>
 
 /*************************************************** FilterParameter ***************************************************/
 
@@ -232,6 +234,137 @@ void FilterResult::tagNonPassing(VcfFile& variants, const QByteArray& tag, const
 	}
 }
 
+/*************************************************** FilterColumnCache ***************************************************/
+
+namespace
+{
+	//Parsed data of one annotation column
+	struct CachedColumn
+	{
+		QSharedPointer<const QVector<double>> numbers;
+		QSharedPointer<const QVector<double>> max_numbers;
+		QSharedPointer<const QVector<quint8>> impacts;
+	};
+
+	//Cached columns of one variant list generation
+	struct CachedVariantList
+	{
+		quint64 generation;
+		QHash<int, CachedColumn> columns;
+	};
+
+	QMutex cache_mutex;
+	QList<CachedVariantList> cache_lists; //most recently used first
+	const int cache_max_lists = 3;
+
+	//Returns the cached column. Data of modified variant lists is not found because the generation of the list changed. Has to be called with locked mutex.
+	CachedColumn& cachedColumn(const VariantList& variants, int column)
+	{
+		//move variant list to front
+		int index = -1;
+		for (int i=0; i<cache_lists.count(); ++i)
+		{
+			if (cache_lists[i].generation==variants.generation())
+			{
+				index = i;
+				break;
+			}
+		}
+		if (index==-1)
+		{
+			cache_lists.prepend(CachedVariantList{variants.generation(), QHash<int, CachedColumn>()});
+			while (cache_lists.count()>cache_max_lists) cache_lists.removeLast();
+		}
+		else if (index>0)
+		{
+			cache_lists.move(index, 0);
+		}
+
+		return cache_lists[0].columns[column];
+	}
+}
+
+QSharedPointer<const QVector<double>> FilterColumnCache::numbers(const VariantList& variants, int column)
+{
+	QMutexLocker locker(&cache_mutex);
+
+	CachedColumn& cached = cachedColumn(variants, column);
+	if (cached.numbers.isNull())
+	{
+		QSharedPointer<QVector<double>> data(new QVector<double>(variants.count()));
+		for (int i=0; i<variants.count(); ++i)
+		{
+			(*data)[i] = variants[i].annotations()[column].toDouble();
+		}
+		cached.numbers = data;
+	}
+
+	return cached.numbers;
+}
+
+QSharedPointer<const QVector<double>> FilterColumnCache::maxNumbers(const VariantList& variants, int column)
+{
+	QMutexLocker locker(&cache_mutex);
+
+	CachedColumn& cached = cachedColumn(variants, column);
+	if (cached.max_numbers.isNull())
+	{
+		QSharedPointer<QVector<double>> data(new QVector<double>(variants.count()));
+		for (int i=0; i<variants.count(); ++i)
+		{
+			double max = -std::numeric_limits<double>::infinity();
+			foreach(const QByteArray& part, variants[i].annotations()[column].split(','))
+			{
+				max = std::max(max, part.toDouble());
+			}
+			(*data)[i] = max;
+		}
+		cached.max_numbers = data;
+	}
+
+	return cached.max_numbers;
+}
+
+QSharedPointer<const QVector<quint8>> FilterColumnCache::impacts(const VariantList& variants, int column)
+{
+	QMutexLocker locker(&cache_mutex);
+
+	CachedColumn& cached = cachedColumn(variants, column);
+	if (cached.impacts.isNull())
+	{
+		QSharedPointer<QVector<quint8>> data(new QVector<quint8>(variants.count(), 0));
+		for (int i=0; i<variants.count(); ++i)
+		{
+			const QByteArray& value = variants[i].annotations()[column];
+			quint8 mask = 0;
+			if (value.contains(":HIGH:")) mask |= HIGH;
+			if (value.contains(":MODERATE:")) mask |= MODERATE;
+			if (value.contains(":LOW:")) mask |= LOW;
+			if (value.contains(":MODIFIER:")) mask |= MODIFIER;
+			(*data)[i] = mask;
+		}
+		cached.impacts = data;
+	}
+
+	return cached.impacts;
+}
+
+quint8 FilterColumnCache::impactMask(const QString& impact)
+{
+	if (impact=="HIGH") return HIGH;
+	if (impact=="MODERATE") return MODERATE;
+	if (impact=="LOW") return LOW;
+	if (impact=="MODIFIER") return MODIFIER;
+	return 0;
+}
+
+void FilterColumnCache::clear()
+{
+	QMutexLocker locker(&cache_mutex);
+
+	cache_lists.clear();
+}
+
 /*************************************************** FilterBase ***************************************************/
 
 FilterBase::FilterBase()
@@ -597,16 +730,71 @@ FilterResult FilterCascade::apply(const VariantList& variants, bool throw_errors
 
 	//reset errors
 	errors_.fill(QStringList(), filters_.count());
+	times_.fill(-1, filters_.count());
 
 	if (debug_time)
 	{
 		Log::perf("FilterCascade: Initializing took ", timer);
-		timer.start();
 	}
 
-	for(int i=0; i<filters_.count(); ++i)
+	applySteps(variants, result, 0, throw_errors, debug_time, false);
+
+	return result;
+}
+
+FilterResult FilterCascade::applyIncremental(const VariantList& variants, bool throw_errors, bool debug_time) const
+{
+	//discard stored results if the variant list changed
+	if (step_generation_!=variants.generation())
 	{
+		clearStepResults();
+		step_generation_ = variants.generation();
+	}
+
+	//determine the first filter that changed since the last call
+	int first = 0;
+	while (first<filters_.count() && first<step_keys_.count() && step_keys_[first]==stepKey(*filters_[first]))
+	{
+		++first;
+	}
+	step_keys_.resize(first);
+	step_results_.resize(first);
+	step_errors_.resize(first);
+
+	//re-use errors of unchanged filters
+	errors_ = step_errors_;
+	errors_.resize(filters_.count());
+	times_.fill(-1, filters_.count());
+
+	if (debug_time)
+	{
+		Log::info("FilterCascade: Re-using results of the first " + QString::number(first) + " of " + QString::number(filters_.count()) + " filters");
+	}
+
+	//apply changed filters starting from the last stored result
+	FilterResult result = first==0 ? FilterResult(variants.count()) : step_results_[first-1];
+	applySteps(variants, result, first, throw_errors, debug_time, true);
+
+	return result;
+}
+
+void FilterCascade::clearStepResults() const
+{
+	step_generation_ = 0;
+	step_keys_.clear();
+	step_results_.clear();
+	step_errors_.clear();
+}
+
+void FilterCascade::applySteps(const VariantList& variants, FilterResult& result, int first, bool throw_errors, bool debug_time, bool store_steps) const
+{
+	QTime timer;
+	for(int i=first; i<filters_.count(); ++i)
+	{
+		timer.start();
+
 		QSharedPointer<FilterBase> filter = filters_[i];
+		QString key = store_steps ? stepKey(*filter) : QString();
 		try
 		{
 			//check type
@@ -615,10 +803,10 @@ FilterResult FilterCascade::apply(const VariantList& variants, bool throw_errors
 			//apply
 			filter->apply(variants, result);
 
+			times_[i] = timer.elapsed();
 			if (debug_time)
 			{
 				Log::perf("FilterCascade: Filter " + filter->name() + " took ", timer);
-				timer.start();
 			}
 		}
 		catch(const Exception& e)
@@ -629,9 +817,25 @@ FilterResult FilterCascade::apply(const VariantList& variants, bool throw_errors
 				throw e;
 			}
 		}
+
+		//store result after filter step
+		if (store_steps)
+		{
+			step_keys_ << key;
+			step_results_ << result;
+			step_errors_ << errors_[i];
+		}
 	}
+}
 
-	return result;
+QString FilterCascade::stepKey(const FilterBase& filter)
+{
+	QString key = filter.name() + "\t" + (filter.enabled() ? "enabled" : "disabled");
+	foreach(const FilterParameter& param, filter.parameters())
+	{
+		key += "\t" + param.name + "=" + param.valueAsString();
+	}
+	return key;
 }
 
 FilterResult FilterCascade::apply(const CnvList& cnvs, bool throw_errors, bool debug_time) const
@@ -643,15 +847,17 @@ FilterResult FilterCascade::apply(const CnvList& cnvs, bool throw_errors, bool d
 
 	//reset errors
 	errors_.fill(QStringList(), filters_.count());
+	times_.fill(-1, filters_.count());
 
 	if (debug_time)
 	{
 		Log::perf("FilterCascade: Initializing took ", timer);
-		timer.start();
 	}
 
 	for(int i=0; i<filters_.count(); ++i)
 	{
+		timer.start();
+
 		QSharedPointer<FilterBase> filter = filters_[i];
 		try
 		{
@@ -661,10 +867,10 @@ FilterResult FilterCascade::apply(const CnvList& cnvs, bool throw_errors, bool d
 			//apply
 			filter->apply(cnvs, result);
 
+			times_[i] = timer.elapsed();
 			if (debug_time)
 			{
 				Log::perf("FilterCascade: Filter " + filter->name() + " took ", timer);
-				timer.start();
 			}
 		}
 		catch(const Exception& e)
@@ -689,15 +895,17 @@ FilterResult FilterCascade::apply(const BedpeFile& svs, bool throw_errors, bool
 
 	//reset errors
 	errors_.fill(QStringList(), filters_.count());
+	times_.fill(-1, filters_.count());
 
 	if (debug_time)
 	{
 		Log::perf("FilterCascade: Initializing took ", timer);
-		timer.start();
 	}
 
 	for(int i=0; i<filters_.count(); ++i)
 	{
+		timer.start();
+
 		QSharedPointer<FilterBase> filter = filters_[i];
 		try
 		{
@@ -707,10 +915,10 @@ FilterResult FilterCascade::apply(const BedpeFile& svs, bool throw_errors, bool
 			//apply
 			filter->apply(svs, result);
 
+			times_[i] = timer.elapsed();
 			if (debug_time)
 			{
 				Log::perf("FilterCascade: Filter " + filter->name() + " took ", timer);
-				timer.start();
 			}
 		}
 		catch(const Exception& e)
@@ -1023,21 +1231,23 @@ void FilterAlleleFrequency::apply(const VariantList& variants, FilterResult& res
 	int i_1000g = annotationColumn(variants, "1000g", false);
 
 	//filter
+	QSharedPointer<const QVector<double>> gnomad = FilterColumnCache::numbers(variants, i_gnomad);
 	if (i_1000g == -1)
 	{
 		for(int i=0; i<variants.count(); ++i)
 		{
 			result.flags()[i] = result.flags()[i]
-				&& variants[i].annotations()[i_gnomad].toDouble()<=max_af;
+				&& (*gnomad)[i]<=max_af;
 		}
 	}
 	else
 	{
+		QSharedPointer<const QVector<double>> tg = FilterColumnCache::numbers(variants, i_1000g);
 		for(int i=0; i<variants.count(); ++i)
 		{
 			result.flags()[i] = result.flags()[i]
-				&& variants[i].annotations()[i_1000g].toDouble()<=max_af
-				&& variants[i].annotations()[i_gnomad].toDouble()<=max_af;
+				&& (*tg)[i]<=max_af
+				&& (*gnomad)[i]<=max_af;
 		}
 	}
 
@@ -1273,18 +1483,14 @@ void FilterSubpopulationAlleleFrequency::apply(const VariantList& variants, Filt
 
 	//filter
 	int i_gnomad = annotationColumn(variants, "gnomAD_sub");
+	QSharedPointer<const QVector<double>> gnomad_max = FilterColumnCache::maxNumbers(variants, i_gnomad);
 	for(int i=0; i<variants.count(); ++i)
 	{
 		if (!result.flags()[i]) continue;
 
-		QByteArrayList parts = variants[i].annotations()[i_gnomad].split(',');
-		foreach(const QByteArray& part, parts)
+		if ((*gnomad_max)[i]>max_af)
 		{
-			if (part.toDouble()>max_af)
-			{
-				result.flags()[i] = false;
-				break;
-			}
+			result.flags()[i] = false;
 		}
 	}
 }
@@ -1313,24 +1519,20 @@ void FilterVariantImpact::apply(const VariantList& variants, FilterResult& resul
 	//get column indices
 	int i_co_sp = annotationColumn(variants, "coding_and_splicing");
 
-	//prepare impacts list (convert to QByteArray and pad with ":")
-	QByteArrayList impacts = getStringList("impact").join(":,:").prepend(":").append(":").toUtf8().split(',');
+	//prepare impacts bit mask
+	quint8 mask = 0;
+	foreach(const QString& impact, getStringList("impact"))
+	{
+		mask |= FilterColumnCache::impactMask(impact);
+	}
 
 	//filter
+	QSharedPointer<const QVector<quint8>> impacts = FilterColumnCache::impacts(variants, i_co_sp);
 	for(int i=0; i<variants.count(); ++i)
 	{
 		if (!result.flags()[i]) continue;
 
-		bool pass_impact = false;
-		foreach(const QByteArray& impact, impacts)
-		{
-			if (variants[i].annotations()[i_co_sp].contains(impact))
-			{
-				pass_impact = true;
-				break;
-			}
-		}
-		result.flags()[i] = pass_impact;
+		result.flags()[i] = ((*impacts)[i] & mask) != 0;
 	}
 }
 
@@ -2260,11 +2462,24 @@ void FilterAnnotationText::apply(const VariantList& variants, FilterResult& resu
 
 bool FilterAnnotationText::match(const Variant& v) const
 {
+	//lower-case conversion table (same conversion as QByteArray::toLower)
+	static const QByteArray lower = []()
+	{
+		QByteArray all(256, 0);
+		for (int c=0; c<256; ++c) all[c] = (char)c;
+		return all.toLower();
+	}();
+
+	//case-insensitive search without converting the annotations (avoids one allocation per annotation)
+	const int term_len = term.length();
 	foreach(const QByteArray& anno, v.annotations())
 	{
-		if (anno.toLower().contains(term))
+		const int last = anno.length() - term_len;
+		for (int p=0; p<=last; ++p)
 		{
-			return true;
+			int k = 0;
+			while (k<term_len && lower[(uchar)anno[p+k]]==term[k]) ++k;
+			if (k==term_len) return true;
 		}
 	}
 
@@ -105,6 +105,39 @@ class CPPNGSSHARED_EXPORT FilterResult
 		QBitArray pass;
 };
 
+//Typed cache of parsed annotation columns of small variant lists. Filters use it to avoid re-parsing the annotations each time they are applied, e.g. when a filter cascade is changed in GSvar.
+//The data is cached per variant list generation and column, i.e. it is re-created when the variant list was loaded or modified (see VariantList::generation).
+//Attention: When variant annotations are changed via the read-write accessor of VariantList, VariantList::markModified has to be called.
+//The cache is thread-safe. It keeps the data of the most recently used variant lists only.
+class CPPNGSSHARED_EXPORT FilterColumnCache
+{
+	public:
+		//Impacts as bit mask
+		enum Impact : quint8
+		{
+			HIGH = 1,
+			MODERATE = 2,
+			LOW = 4,
+			MODIFIER = 8
+		};
+
+		//Returns the column converted to double (same as QByteArray::toDouble, i.e. 0.0 if the value is not numeric).
+		static QSharedPointer<const QVector<double>> numbers(const VariantList& variants, int column);
+		//Returns the maximum of the comma-separated values of the column converted to double (see numbers).
+		static QSharedPointer<const QVector<double>> maxNumbers(const VariantList& variants, int column);
+		//Returns the VEP impacts contained in a 'coding_and_splicing' column as bit mask.
+		static QSharedPointer<const QVector<quint8>> impacts(const VariantList& variants, int column);
+		//Returns the bit mask of a VEP impact, or 0 if the impact is not valid.
+		static quint8 impactMask(const QString& impact);
+
+		//Removes all cached data.
+		static void clear();
+
+	private:
+		//Declare constructor away
+		FilterColumnCache() = delete;
+};
+
 //Base class for all filters
 class CPPNGSSHARED_EXPORT FilterBase
 {
@@ -259,6 +292,11 @@ class CPPNGSSHARED_EXPORT FilterCascade
 
 		//Applies the filter cascade to a small variant list.
 		FilterResult apply(const VariantList& variants, bool throw_errors = true, bool debug_time = false) const;
+		//Applies the filter cascade to a small variant list incrementally: the result after each filter is stored and the stored results are re-used in the next call up to the first filter that changed (parameters, enabled state or order).
+		//The stored results are discarded when the generation of the variant list changed, i.e. when a different variant list is passed or the variants were modified (see VariantList::generation()).
+		FilterResult applyIncremental(const VariantList& variants, bool throw_errors = true, bool debug_time = false) const;
+		//Discards the results stored by applyIncremental().
+		void clearStepResults() const;
 
 		//Applies the filter cascade to a CNV list.
 		FilterResult apply(const CnvList& cnvs, bool throw_errors = true, bool debug_time = false) const;
@@ -268,6 +306,11 @@ class CPPNGSSHARED_EXPORT FilterCascade
 
 		//Returns errors occured during filter application.
 		QStringList errors(int index) const;
+		//Returns the time in milliseconds each filter took during the last application of the cascade (-1 if the filter was not applied, e.g. because a stored result was re-used).
+		QVector<int> filterTimes() const
+		{
+			return times_;
+		}
 
 		//Loads a filter cascade from file.
 		void load(QString filename);
@@ -289,6 +332,18 @@ class CPPNGSSHARED_EXPORT FilterCascade
 	private:
 		QList<QSharedPointer<FilterBase>> filters_;
 		mutable QVector<QStringList> errors_;
+		mutable QVector<int> times_;
+
+		//results after each filter step (see applyIncremental)
+		mutable quint64 step_generation_ = 0;
+		mutable QVector<QString> step_keys_;
+		mutable QVector<FilterResult> step_results_;
+		mutable QVector<QStringList> step_errors_;
+
+		//Applies the filters starting at index 'first' and optionally stores the result after each filter.
+		void applySteps(const VariantList& variants, FilterResult& result, int first, bool throw_errors, bool debug_time, bool store_steps) const;
+		//Returns a string that identifies the state of a filter (name, enabled state and parameters).
+		static QString stepKey(const FilterBase& filter);
 };
 
 //Handles loading filters from filter INI files
@@ -69,6 +69,9 @@ class CPPNGSSHARED_EXPORT Graph
         int getIndegree(const QString& name);
         int getOutdegree(const QString& name);
 
+        // get all edges (as pair of nodes) sorted by node names
+        QList<QPair<QString, QString>> sortedEdgeList() const;
+
         void store(const QString& file);
 
     protected:
@@ -469,13 +472,10 @@ int Graph<NodeType, EdgeType>::getOutdegree(const QString& name)
     }
 }
 
-// write all edges to tsv file (as pair of nodes)
+// get all edges (as pair of nodes) sorted by node names
 template <typename NodeType, typename EdgeType>
-void Graph<NodeType, EdgeType>::store(const QString& file)
+QList<QPair<QString, QString>> Graph<NodeType, EdgeType>::sortedEdgeList() const
 {
-    QSharedPointer<QFile> writer = Helper::openFileForWriting(file);
-    QTextStream stream(writer.data());
-
     QList<QPair<QString, QString>> sorted_edge_list = edge_list_.toList();
 
     std::sort(sorted_edge_list.begin(), sorted_edge_list.end(),
@@ -488,8 +488,18 @@ void Graph<NodeType, EdgeType>::store(const QString& file)
                     return a.first < b.first;
                 });
 
+    return sorted_edge_list;
+}
+
+// write all edges to tsv file (as pair of nodes)
+template <typename NodeType, typename EdgeType>
+void Graph<NodeType, EdgeType>::store(const QString& file)
+{
+    QSharedPointer<QFile> writer = Helper::openFileForWriting(file);
+    QTextStream stream(writer.data());
+
     QPair<QString, QString> node_pair;
-    foreach(node_pair, sorted_edge_list)
+    foreach(node_pair, sortedEdgeList())
     {
         stream << node_pair.first << "\t" << node_pair.second << endl;
     }
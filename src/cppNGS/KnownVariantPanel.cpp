@@ -0,0 +1,447 @@
+#include "KnownVariantPanel.h"
+#include "Exceptions.h"
+#include "Helper.h"
+#include "BasicStatistics.h"
+#include "BinaryFileHeader.h"
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+//header of binary panel files. It is followed by the text data (chromosome names, fileformat header line and INFO header lines separated by newlines), the variants, the sequences,
+//the allele frequencies, the position index, the chromosome ranges and the allele frequency index. Sections are padded to a multiple of 8 bytes. Data is stored in native byte order.
+struct KnownVariantPanelHeader
+	: public BinaryFileHeader
+{
+	qint32 max_ref_length;
+	qint32 reserved;
+	qint64 chr_count;
+	qint64 af_key_count;
+	qint64 variant_count;
+	qint64 by_af_count;
+	qint64 text_size;
+	qint64 sequences_size;
+};
+static const char KNOWN_VARIANT_PANEL_MAGIC[8] = {'K', 'V', 'P', 'A', 'N', 'E', 'L', '1'};
+static const quint32 KNOWN_VARIANT_PANEL_VERSION = 1;
+
+//copies an array from the binary panel file (the data of resource files is not necessarily aligned, so it is not used in place)
+template<typename T>
+static void copyArray(QVector<T>& output, const uchar* data, qint64 count)
+{
+	output.resize(count);
+	if (count>0) memcpy(output.data(), data, count * sizeof(T));
+}
+
+const KnownVariantPanel& KnownVariantPanel::snps(GenomeBuild build)
+{
+	return panel(build, "snps");
+}
+
+const KnownVariantPanel& KnownVariantPanel::ancestry(GenomeBuild build)
+{
+	return panel(build, "ancestry");
+}
+
+const KnownVariantPanel& KnownVariantPanel::panel(GenomeBuild build, const QString& type)
+{
+	static QMutex mutex;
+	static QHash<QString, QSharedPointer<const KnownVariantPanel>> panels;
+
+	QMutexLocker locker(&mutex);
+
+	QString filename = ":/Resources/" + buildToString(build) + "_" + type + ".bin";
+	if (!panels.contains(filename))
+	{
+		if (!QFile::exists(filename)) THROW(ProgrammingException, "Unsupported genome build '" + buildToString(build) + "' for known variant panel '" + type + "'!");
+		panels[filename] = QSharedPointer<const KnownVariantPanel>(new KnownVariantPanel(filename));
+	}
+
+	return *panels[filename];
+}
+
+KnownVariantPanel::KnownVariantPanel(const QString& filename)
+	: max_ref_length_(0)
+{
+	if (BinaryFileHeader::hasMagic(filename, KNOWN_VARIANT_PANEL_MAGIC))
+	{
+		loadBinary(filename);
+	}
+	else
+	{
+		loadVcf(filename);
+	}
+}
+
+void KnownVariantPanel::createBinary(QString vcf_file, QString binary_file)
+{
+	KnownVariantPanel panel(vcf_file);
+	panel.store(binary_file);
+}
+
+void KnownVariantPanel::loadVcf(const QString& filename)
+{
+	//read data
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) THROW(FileAccessException, "Could not open known variant panel '" + filename + "'!");
+	const QByteArray data = file.readAll();
+
+	QHash<QByteArray, int> chr_indices;
+	QVector<QByteArray> info_values;
+	int line_number = 0;
+	int line_start = 0;
+	while (line_start<data.size())
+	{
+		int line_end = data.indexOf('\n', line_start);
+		if (line_end==-1) line_end = data.size();
+		QByteArray line = data.mid(line_start, line_end - line_start).trimmed();
+		line_start = line_end + 1;
+		++line_number;
+		if (line.isEmpty()) continue;
+
+		//header: AF keys from INFO lines (header lines are kept for the VCF conversion)
+		if (line.startsWith("##fileformat="))
+		{
+			fileformat_line_ = line;
+			continue;
+		}
+		if (line.startsWith("##INFO=<ID="))
+		{
+			int id_end = line.indexOf(',');
+			if (id_end==-1) THROW(FileParseException, "Invalid INFO header line " + QString::number(line_number) + " in known variant panel '" + filename + "': " + line);
+			af_keys_ << line.mid(11, id_end - 11);
+			info_lines_ << line;
+			continue;
+		}
+		if (line.startsWith('#')) continue;
+
+		QByteArrayList parts = line.split('\t');
+		if (parts.count()<8) THROW(FileParseException, "Invalid line " + QString::number(line_number) + " in known variant panel '" + filename + "': " + line);
+
+		//chromosome
+		PackedVariant variant;
+		memset(&variant, 0, sizeof(PackedVariant));
+		if (!chr_indices.contains(parts[0]))
+		{
+			chr_indices[parts[0]] = chrs_.count();
+			chrs_ << Chromosome(parts[0]);
+		}
+		variant.chr = chr_indices[parts[0]];
+
+		//position
+		bool ok = false;
+		variant.pos = parts[1].toInt(&ok);
+		if (!ok) THROW(FileParseException, "Invalid position in line " + QString::number(line_number) + " of known variant panel '" + filename + "': " + line);
+
+		//quality
+		variant.qual = parts[5]=="." ? -1 : Helper::toDouble(parts[5], "quality", QString::number(line_number));
+
+		//sequences and INFO (the INFO column is kept as it is for the VCF conversion)
+		if (parts[3].size()>std::numeric_limits<quint16>::max() || parts[4].size()>std::numeric_limits<quint16>::max()) THROW(FileParseException, "Too long sequence in line " + QString::number(line_number) + " of known variant panel '" + filename + "'!");
+		if (parts[7].size()>std::numeric_limits<quint16>::max()) THROW(FileParseException, "Too long INFO column in line " + QString::number(line_number) + " of known variant panel '" + filename + "'!");
+		variant.seq_offset = sequences_.size();
+		variant.ref_length = parts[3].size();
+		variant.alt_length = parts[4].size();
+		variant.info_length = parts[7]=="." ? 0 : parts[7].size();
+		sequences_.append(parts[3]);
+		sequences_.append(parts[4]);
+		if (variant.info_length>0) sequences_.append(parts[7]);
+		max_ref_length_ = std::max(max_ref_length_, (int)variant.ref_length);
+		variants_ << variant;
+
+		//allele frequencies (NaN if missing)
+		info_values.fill(QByteArray(), af_keys_.count());
+		foreach(const QByteArray& entry, parts[7].split(';'))
+		{
+			int sep = entry.indexOf('=');
+			if (sep==-1) continue;
+			int index = af_keys_.indexOf(entry.left(sep));
+			if (index!=-1) info_values[index] = entry.mid(sep + 1);
+		}
+		foreach(const QByteArray& value, info_values)
+		{
+			afs_ << (value.isEmpty() ? std::numeric_limits<double>::quiet_NaN() : Helper::toDouble(value, "allele frequency"));
+		}
+	}
+
+	//position index (the panel files are not necessarily sorted within chromosomes)
+	by_pos_.resize(variants_.count());
+	for (int i=0; i<by_pos_.count(); ++i) by_pos_[i] = i;
+	std::stable_sort(by_pos_.begin(), by_pos_.end(), [this](int a, int b)
+	{
+		const PackedVariant& v1 = variants_[a];
+		const PackedVariant& v2 = variants_[b];
+		return v1.chr<v2.chr || (v1.chr==v2.chr && v1.pos<v2.pos);
+	});
+	chr_ranges_.fill(qMakePair(0, 0), chrs_.count());
+	for (int i=0; i<by_pos_.count(); ++i)
+	{
+		int chr = variants_[by_pos_[i]].chr;
+		if (i==0 || variants_[by_pos_[i-1]].chr!=chr) chr_ranges_[chr].first = i;
+		chr_ranges_[chr].second = i + 1;
+	}
+
+	//allele frequency index (by the first key)
+	if (!af_keys_.isEmpty())
+	{
+		for (int i=0; i<variants_.count(); ++i)
+		{
+			if (BasicStatistics::isValidFloat(af(i))) by_af_ << i;
+		}
+		std::stable_sort(by_af_.begin(), by_af_.end(), [this](int a, int b)
+		{
+			return af(a)<af(b);
+		});
+	}
+}
+
+void KnownVariantPanel::loadBinary(const QString& filename)
+{
+	//memory-map file (if that is not possible, we read it into memory)
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) THROW(FileAccessException, "Could not open known variant panel '" + filename + "' for reading!");
+	qint64 file_size = file.size();
+	QByteArray file_data;
+	const uchar* data = BinaryFileHeader::map(file, file_data);
+
+	//header
+	if (file_size<(qint64)sizeof(KnownVariantPanelHeader)) THROW(FileParseException, "Known variant panel '" + filename + "' is truncated!");
+	KnownVariantPanelHeader header;
+	memcpy(&header, data, sizeof(KnownVariantPanelHeader));
+	header.check(KNOWN_VARIANT_PANEL_MAGIC, KNOWN_VARIANT_PANEL_VERSION, filename, "binary known variant panel");
+
+	const qint64 text_offset = sizeof(KnownVariantPanelHeader);
+	const qint64 variants_offset = text_offset + BinaryFileHeader::paddedSize(header.text_size);
+	const qint64 sequences_offset = variants_offset + header.variant_count * (qint64)sizeof(PackedVariant);
+	const qint64 afs_offset = sequences_offset + BinaryFileHeader::paddedSize(header.sequences_size);
+	const qint64 by_pos_offset = afs_offset + header.variant_count * header.af_key_count * (qint64)sizeof(double);
+	const qint64 chr_ranges_offset = by_pos_offset + BinaryFileHeader::paddedSize(header.variant_count * (qint64)sizeof(qint32));
+	const qint64 by_af_offset = chr_ranges_offset + header.chr_count * 2 * (qint64)sizeof(qint32);
+	if (file_size!=by_af_offset + BinaryFileHeader::paddedSize(header.by_af_count * (qint64)sizeof(qint32))) THROW(FileParseException, "Known variant panel '" + filename + "' has invalid size!");
+
+	//checksum
+	if (BinaryFileHeader::calculateChecksum(data + text_offset, file_size - text_offset)!=header.checksum) THROW(FileParseException, "Known variant panel '" + filename + "' is corrupt (checksum mismatch)!");
+
+	//text data
+	QByteArrayList lines = QByteArray(reinterpret_cast<const char*>(data + text_offset), header.text_size).split('\n');
+	if (lines.count()!=header.chr_count + 1 + header.af_key_count) THROW(FileParseException, "Known variant panel '" + filename + "' contains " + QString::number(lines.count()) + " text lines, but " + QString::number(header.chr_count + 1 + header.af_key_count) + " were expected!");
+	for (int i=0; i<header.chr_count; ++i)
+	{
+		chrs_ << Chromosome(lines[i]);
+	}
+	fileformat_line_ = lines[header.chr_count];
+	for (int i=header.chr_count+1; i<lines.count(); ++i)
+	{
+		const QByteArray& line = lines[i];
+		af_keys_ << line.mid(11, line.indexOf(',') - 11);
+		info_lines_ << line;
+	}
+
+	//variants, sequences and indices
+	copyArray(variants_, data + variants_offset, header.variant_count);
+	sequences_ = QByteArray(reinterpret_cast<const char*>(data + sequences_offset), header.sequences_size);
+	copyArray(afs_, data + afs_offset, header.variant_count * header.af_key_count);
+	copyArray(by_pos_, data + by_pos_offset, header.variant_count);
+	copyArray(chr_ranges_, data + chr_ranges_offset, header.chr_count);
+	copyArray(by_af_, data + by_af_offset, header.by_af_count);
+	max_ref_length_ = header.max_ref_length;
+}
+
+void KnownVariantPanel::store(const QString& filename) const
+{
+	//text data
+	QByteArrayList lines;
+	foreach(const Chromosome& chr, chrs_)
+	{
+		lines << chr.str();
+	}
+	lines << fileformat_line_;
+	lines << info_lines_;
+	QByteArray text = lines.join('\n');
+
+	//payload
+	QByteArray payload;
+	auto append = [&payload](const void* data, qint64 size)
+	{
+		payload.append(reinterpret_cast<const char*>(data), size);
+		payload.append(QByteArray(BinaryFileHeader::paddedSize(size) - size, 0));
+	};
+	append(text.constData(), text.size());
+	append(variants_.constData(), variants_.count() * (qint64)sizeof(PackedVariant));
+	append(sequences_.constData(), sequences_.size());
+	append(afs_.constData(), afs_.count() * (qint64)sizeof(double));
+	append(by_pos_.constData(), by_pos_.count() * (qint64)sizeof(qint32));
+	append(chr_ranges_.constData(), chr_ranges_.count() * 2 * (qint64)sizeof(qint32));
+	append(by_af_.constData(), by_af_.count() * (qint64)sizeof(qint32));
+
+	//header (source file information is not stored to make the resource files reproducible)
+	KnownVariantPanelHeader header;
+	memset(&header, 0, sizeof(KnownVariantPanelHeader));
+	header.init(KNOWN_VARIANT_PANEL_MAGIC, KNOWN_VARIANT_PANEL_VERSION);
+	header.checksum = BinaryFileHeader::calculateChecksum(reinterpret_cast<const uchar*>(payload.constData()), payload.size());
+	header.max_ref_length = max_ref_length_;
+	header.chr_count = chrs_.count();
+	header.af_key_count = af_keys_.count();
+	header.variant_count = variants_.count();
+	header.by_af_count = by_af_.count();
+	header.text_size = text.size();
+	header.sequences_size = sequences_.size();
+
+	//write
+	QSharedPointer<QFile> file = Helper::openFileForWriting(filename);
+	if (file->write(reinterpret_cast<const char*>(&header), sizeof(KnownVariantPanelHeader))!=sizeof(KnownVariantPanelHeader) || file->write(payload)!=payload.size())
+	{
+		THROW(FileAccessException, "Could not write known variant panel '" + filename + "'!");
+	}
+	file->close();
+}
+
+bool KnownVariantPanel::isSNV(int i) const
+{
+	const PackedVariant& variant = variants_[i];
+	if (variant.ref_length!=1 || variant.alt_length!=1) return false;
+
+	char ref = sequences_[variant.seq_offset];
+	char alt = sequences_[variant.seq_offset + 1];
+	return ref!='-' && alt!='-';
+}
+
+int KnownVariantPanel::afIndex(const QByteArray& key) const
+{
+	int index = af_keys_.indexOf(key);
+	if (index==-1) THROW(ArgumentException, "Allele frequency '" + key + "' not contained in known variant panel!");
+
+	return index;
+}
+
+QVector<int> KnownVariantPanel::select(bool only_snvs, double min_af, double max_af) const
+{
+	//check input
+	if (min_af<0.0 || min_af>1.0) THROW(ArgumentException, "Minumum allele frequency out of range (0.0-1.0): " + QByteArray::number(min_af));
+	if (max_af<0.0 || max_af>1.0) THROW(ArgumentException, "Maximum allele frequency out of range (0.0-1.0): " + QByteArray::number(max_af));
+
+	QVector<int> output;
+	if (min_af>0.0 || max_af<1.0)
+	{
+		//index range of AF-sorted variants
+		auto range_begin = std::lower_bound(by_af_.begin(), by_af_.end(), min_af, [this](int i, double value) { return af(i)<value; });
+		auto range_end = std::upper_bound(range_begin, by_af_.end(), max_af, [this](double value, int i) { return value<af(i); });
+		output.reserve(range_end - range_begin);
+		for (auto it=range_begin; it!=range_end; ++it)
+		{
+			if (only_snvs && !isSNV(*it)) continue;
+			output << *it;
+		}
+		std::sort(output.begin(), output.end());
+	}
+	else
+	{
+		output.reserve(variants_.count());
+		for (int i=0; i<variants_.count(); ++i)
+		{
+			if (only_snvs && !isSNV(i)) continue;
+			output << i;
+		}
+	}
+
+	return output;
+}
+
+QVector<int> KnownVariantPanel::select(bool only_snvs, const BedFile& roi, double min_af, double max_af) const
+{
+	//check input
+	if (min_af<0.0 || min_af>1.0) THROW(ArgumentException, "Minumum allele frequency out of range (0.0-1.0): " + QByteArray::number(min_af));
+	if (max_af<0.0 || max_af>1.0) THROW(ArgumentException, "Maximum allele frequency out of range (0.0-1.0): " + QByteArray::number(max_af));
+	if (!roi.isSorted()) THROW(ArgumentException, "Target region unsorted, but needs to be sorted (given for selecting known variants)!");
+	bool filter_af = min_af>0.0 || max_af<1.0;
+
+	QVector<int> output;
+	for (int r=0; r<roi.count(); ++r)
+	{
+		const BedLine& region = roi[r];
+		int chr = chrIndex(region.chr());
+		if (chr==-1) continue;
+
+		//index range of position-sorted variants (variants can start up to 'max_ref_length_' bases before the region)
+		auto range_end = by_pos_.begin() + chr_ranges_[chr].second;
+		auto it = std::lower_bound(by_pos_.begin() + chr_ranges_[chr].first, range_end, region.start() - max_ref_length_ + 1, [this](int i, int pos) { return variants_[i].pos<pos; });
+		for (; it!=range_end && variants_[*it].pos<=region.end(); ++it)
+		{
+			int i = *it;
+			if (end(i)<region.start()) continue;
+			if (only_snvs && !isSNV(i)) continue;
+			if (filter_af && !(af(i)>=min_af && af(i)<=max_af)) continue;
+			output << i;
+		}
+	}
+
+	//restore file order (overlapping ROI regions can contain the same variant)
+	std::sort(output.begin(), output.end());
+	output.erase(std::unique(output.begin(), output.end()), output.end());
+
+	return output;
+}
+
+int KnownVariantPanel::find(const Chromosome& chr, int pos, const Sequence& ref, const Sequence& alt) const
+{
+	int chr_index = chrIndex(chr);
+	if (chr_index==-1) return -1;
+
+	auto range_end = by_pos_.begin() + chr_ranges_[chr_index].second;
+	auto it = std::lower_bound(by_pos_.begin() + chr_ranges_[chr_index].first, range_end, pos, [this](int i, int value) { return variants_[i].pos<value; });
+	for (; it!=range_end && variants_[*it].pos==pos; ++it)
+	{
+		if (this->ref(*it)==ref && this->alt(*it)==alt) return *it;
+	}
+
+	return -1;
+}
+
+VcfFile KnownVariantPanel::toVcfFile(const QVector<int>& indices) const
+{
+	VcfFile output;
+
+	//header (as in the resource file)
+	if (!fileformat_line_.isEmpty()) output.vcfHeader().setFormat(fileformat_line_);
+	foreach(const QByteArray& info_line, info_lines_)
+	{
+		output.vcfHeader().setInfoLine(info_line, 0);
+	}
+
+	//variants (quality and INFO entries as in the resource file)
+	foreach(int i, indices)
+	{
+		const PackedVariant& variant = variants_[i];
+		VcfLine line(chr(i), start(i), ref(i), QList<Sequence>() << alt(i));
+		line.setQual(variant.qual);
+		if (variant.info_length>0)
+		{
+			QByteArrayList keys;
+			QByteArrayList values;
+			foreach(const QByteArray& entry, sequences_.mid(variant.seq_offset + variant.ref_length + variant.alt_length, variant.info_length).split(';'))
+			{
+				int sep = entry.indexOf('=');
+				keys << (sep==-1 ? entry : entry.left(sep));
+				values << (sep==-1 ? QByteArray("TRUE") : entry.mid(sep + 1));
+			}
+			line.setInfo(keys, values);
+		}
+		output.append(line);
+	}
+
+	return output;
+}
+
+int KnownVariantPanel::chrIndex(const Chromosome& chr) const
+{
+	for (int i=0; i<chrs_.count(); ++i)
+	{
+		if (chrs_[i]==chr) return i;
+	}
+
+	return -1;
+}
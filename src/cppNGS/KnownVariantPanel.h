@@ -0,0 +1,125 @@
+#ifndef KNOWNVARIANTPANEL_H
+#define KNOWNVARIANTPANEL_H
+
+#include "cppNGS_global.h"
+#include "GenomeBuild.h"
+#include "Chromosome.h"
+#include "Sequence.h"
+#include "BedFile.h"
+#include "VcfFile.h"
+#include <QVector>
+
+///Compact, immutable panel of known variants (position, ref, alt and allele frequencies) loaded from a binary resource file.
+///The binary resource files are created from the VCF files in 'src/cppNGS/Resources/' using createBinary().
+///The variants are stored in file order in packed arrays. Selections by ROI and AF range are done via index ranges of a position-sorted and an AF-sorted index.
+class CPPNGSSHARED_EXPORT KnownVariantPanel
+{
+public:
+	///Returns the known SNPs and indels from gnomAD (AF>=1%, AN>=5000). The panel is loaded once and shared by all callers/threads.
+	static const KnownVariantPanel& snps(GenomeBuild build);
+	///Returns the SNPs used for ancestry estimation (AF_AFR, AF_EUR, AF_SAS, AF_EAS). The panel is loaded once and shared by all callers/threads.
+	static const KnownVariantPanel& ancestry(GenomeBuild build);
+
+	///Returns the variant count.
+	int count() const
+	{
+		return variants_.count();
+	}
+	///Returns the chromosome of a variant.
+	const Chromosome& chr(int i) const
+	{
+		return chrs_[variants_[i].chr];
+	}
+	///Returns the start position of a variant (1-based).
+	int start(int i) const
+	{
+		return variants_[i].pos;
+	}
+	///Returns the end position of a variant (1-based).
+	int end(int i) const
+	{
+		return variants_[i].pos + variants_[i].ref_length - 1;
+	}
+	///Returns the reference sequence of a variant.
+	Sequence ref(int i) const
+	{
+		return sequences_.mid(variants_[i].seq_offset, variants_[i].ref_length);
+	}
+	///Returns the alternative sequence of a variant.
+	Sequence alt(int i) const
+	{
+		return sequences_.mid(variants_[i].seq_offset + variants_[i].ref_length, variants_[i].alt_length);
+	}
+	///Returns if the variant is a SNV.
+	bool isSNV(int i) const;
+
+	///Returns the allele frequency keys (INFO keys) of the panel.
+	const QByteArrayList& afKeys() const
+	{
+		return af_keys_;
+	}
+	///Returns the index of an allele frequency key. Throws an exception if the key is not contained in the panel.
+	int afIndex(const QByteArray& key) const;
+	///Returns the allele frequency of a variant. @p af_index is the index in afKeys().
+	double af(int i, int af_index = 0) const
+	{
+		return afs_[i * af_keys_.count() + af_index];
+	}
+
+	///Returns the indices of variants with the first allele frequency in the range [min_af, max_af] (in file order).
+	QVector<int> select(bool only_snvs, double min_af = 0.0, double max_af = 1.0) const;
+	///Returns the indices of variants overlapping the ROI with the first allele frequency in the range [min_af, max_af] (in file order). Throws an exception if the ROI is not sorted.
+	QVector<int> select(bool only_snvs, const BedFile& roi, double min_af = 0.0, double max_af = 1.0) const;
+	///Returns the index of the variant with the given position, ref and alt, or -1 if it is not contained in the panel.
+	int find(const Chromosome& chr, int pos, const Sequence& ref, const Sequence& alt) const;
+
+	///Converts the given variants to a VCF file. Header, quality and INFO entries are the same as in the resource file.
+	VcfFile toVcfFile(const QVector<int>& indices) const;
+
+	///Converts a panel VCF file to a binary panel file (needed to update the resource files when the VCF files change).
+	static void createBinary(QString vcf_file, QString binary_file);
+
+protected:
+	///Constructor that loads a binary panel file or parses a panel VCF file.
+	KnownVariantPanel(const QString& filename);
+	//parses a panel VCF file
+	void loadVcf(const QString& filename);
+	//loads a binary panel file (see store())
+	void loadBinary(const QString& filename);
+	//stores the panel as binary file
+	void store(const QString& filename) const;
+	//loads a shared panel from the resources
+	static const KnownVariantPanel& panel(GenomeBuild build, const QString& type);
+	//returns the index of the chromosome in 'chrs_' or -1 if not contained
+	int chrIndex(const Chromosome& chr) const;
+
+	//packed variant (24 bytes, stored as it is in binary panel files)
+	struct PackedVariant
+	{
+		qint32 chr; //index in 'chrs_'
+		qint32 pos;
+		qint32 seq_offset; //offset of ref, alt and INFO column in 'sequences_'
+		quint16 ref_length;
+		quint16 alt_length;
+		quint16 info_length;
+		quint16 reserved;
+		float qual; //-1 if not set
+	};
+	QVector<Chromosome> chrs_;
+	QVector<QPair<int, int>> chr_ranges_; //range of each chromosome in 'by_pos_' (start, end exclusive)
+	QVector<PackedVariant> variants_;
+	QByteArray sequences_;
+	QByteArrayList af_keys_;
+	QByteArray fileformat_line_; //header lines used for the VCF conversion
+	QByteArrayList info_lines_;
+	QVector<double> afs_; //row-major: variant x AF key
+	QVector<int> by_pos_; //variant indices sorted by chromosome and position
+	QVector<int> by_af_; //variant indices sorted by the first allele frequency
+	int max_ref_length_;
+
+	//"declared away" methods
+	KnownVariantPanel(const KnownVariantPanel&) = delete;
+	KnownVariantPanel& operator=(const KnownVariantPanel&) = delete;
+};
+
+#endif // KNOWNVARIANTPANEL_H
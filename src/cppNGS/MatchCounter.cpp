@@ -0,0 +1,153 @@
+#include "MatchCounter.h"
+#include <bitset>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MATCHCOUNTER_X86
+#include <immintrin.h>
+#endif
+
+void MatchCounter::countScalar(const char* seq1, const char* seq2, int length, MatchCounts& counts, int max_mismatches)
+{
+	for (int i=0; i<length; ++i)
+	{
+		char b1 = seq1[i];
+		char b2 = seq2[i];
+		if (b1=='N' || b2=='N')
+		{
+			++counts.invalid;
+		}
+		else if (b1==b2)
+		{
+			++counts.matches;
+		}
+		else
+		{
+			++counts.mismatches;
+			if (counts.mismatches>max_mismatches) break;
+		}
+	}
+}
+
+#ifdef MATCHCOUNTER_X86
+
+static inline int popcount(unsigned int mask)
+{
+	return static_cast<int>(std::bitset<32>(mask).count());
+}
+
+__attribute__((target("sse2")))
+static void countSSE2(const char* seq1, const char* seq2, int length, MatchCounts& counts, int max_mismatches)
+{
+	const __m128i n = _mm_set1_epi8('N');
+	int i = 0;
+	for (; i+16<=length; i+=16)
+	{
+		__m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(seq1 + i));
+		__m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(seq2 + i));
+		unsigned int invalid = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(b1, n), _mm_cmpeq_epi8(b2, n))));
+		unsigned int equal = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(b1, b2)));
+		int mismatches = popcount(~(equal | invalid) & 0xFFFFu);
+
+		//abort inside this block => let the scalar implementation determine the exact abort position
+		if (counts.mismatches + mismatches > max_mismatches)
+		{
+			MatchCounter::countScalar(seq1 + i, seq2 + i, length - i, counts, max_mismatches);
+			return;
+		}
+
+		counts.matches += popcount(equal & ~invalid & 0xFFFFu);
+		counts.mismatches += mismatches;
+		counts.invalid += popcount(invalid);
+	}
+	MatchCounter::countScalar(seq1 + i, seq2 + i, length - i, counts, max_mismatches);
+}
+
+__attribute__((target("avx2")))
+static void countAVX2(const char* seq1, const char* seq2, int length, MatchCounts& counts, int max_mismatches)
+{
+	const __m256i n = _mm256_set1_epi8('N');
+	int i = 0;
+	for (; i+32<=length; i+=32)
+	{
+		__m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(seq1 + i));
+		__m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(seq2 + i));
+		unsigned int invalid = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(b1, n), _mm256_cmpeq_epi8(b2, n))));
+		unsigned int equal = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b1, b2)));
+		int mismatches = popcount(~(equal | invalid));
+
+		//abort inside this block => let the scalar implementation determine the exact abort position
+		if (counts.mismatches + mismatches > max_mismatches)
+		{
+			MatchCounter::countScalar(seq1 + i, seq2 + i, length - i, counts, max_mismatches);
+			return;
+		}
+
+		counts.matches += popcount(equal & ~invalid);
+		counts.mismatches += mismatches;
+		counts.invalid += popcount(invalid);
+	}
+	countSSE2(seq1 + i, seq2 + i, length - i, counts, max_mismatches);
+}
+
+#endif
+
+void MatchCounter::setImplementation(MatchCounter::Implementation impl)
+{
+	if (impl==AUTO)
+	{
+		impl = best();
+	}
+	else if (!supported(impl))
+	{
+		impl = SCALAR;
+	}
+
+	selected() = impl;
+	function() = functionOf(impl);
+}
+
+MatchCounter::Implementation MatchCounter::implementation()
+{
+	return selected();
+}
+
+MatchCounter::Function& MatchCounter::function()
+{
+	static Function output = functionOf(selected());
+	return output;
+}
+
+MatchCounter::Implementation& MatchCounter::selected()
+{
+	static Implementation output = best();
+	return output;
+}
+
+MatchCounter::Function MatchCounter::functionOf(MatchCounter::Implementation impl)
+{
+#ifdef MATCHCOUNTER_X86
+	if (impl==AVX2) return countAVX2;
+	if (impl==SSE2) return countSSE2;
+#else
+	(void)impl;
+#endif
+	return countScalar;
+}
+
+MatchCounter::Implementation MatchCounter::best()
+{
+	if (supported(AVX2)) return AVX2;
+	if (supported(SSE2)) return SSE2;
+	return SCALAR;
+}
+
+bool MatchCounter::supported(MatchCounter::Implementation impl)
+{
+	if (impl==SCALAR) return true;
+#ifdef MATCHCOUNTER_X86
+	__builtin_cpu_init();
+	if (impl==SSE2) return __builtin_cpu_supports("sse2");
+	if (impl==AVX2) return __builtin_cpu_supports("avx2");
+#endif
+	return false;
+}
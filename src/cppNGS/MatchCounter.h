@@ -0,0 +1,54 @@
+#ifndef MATCHCOUNTER_H
+#define MATCHCOUNTER_H
+
+#include "cppNGS_global.h"
+#include <limits>
+
+///Match/mismatch/invalid base counts of a sequence comparison.
+struct MatchCounts
+{
+	int matches = 0;
+	int mismatches = 0;
+	int invalid = 0; //comparisons where at least one of the bases is 'N'
+};
+
+///Base comparison kernel, e.g. for insert/adapter matching in SeqPurge.
+///Uses SSE2/AVX2 instructions if supported by the CPU (runtime dispatch) and a scalar implementation otherwise.
+class CPPNGSSHARED_EXPORT MatchCounter
+{
+public:
+	///Implementation types.
+	enum Implementation
+	{
+		AUTO,
+		SCALAR,
+		SSE2,
+		AVX2
+	};
+
+	///Compares @p length bases of @p seq1 and @p seq2 and adds the result to @p counts.
+	///The comparison is aborted as soon as the mismatch count exceeds @p max_mismatches. The counts are then identical to those of a base-by-base comparison that stops at this base.
+	static void count(const char* seq1, const char* seq2, int length, MatchCounts& counts, int max_mismatches = std::numeric_limits<int>::max())
+	{
+		function()(seq1, seq2, length, counts, max_mismatches);
+	}
+
+	///Sets the implementation used by 'count' - mainly for testing. If the implementation is not supported by the CPU, the scalar implementation is used.
+	static void setImplementation(Implementation impl);
+	///Returns the implementation used by 'count' (never AUTO).
+	static Implementation implementation();
+	///Returns if the implementation is supported by the CPU.
+	static bool supported(Implementation impl);
+
+	///Scalar implementation.
+	static void countScalar(const char* seq1, const char* seq2, int length, MatchCounts& counts, int max_mismatches);
+
+protected:
+	typedef void (*Function)(const char*, const char*, int, MatchCounts&, int);
+	static Function& function();
+	static Implementation& selected();
+	static Function functionOf(Implementation impl);
+	static Implementation best();
+};
+
+#endif // MATCHCOUNTER_H
@@ -1,95 +1,20 @@
 #include "NGSHelper.h"
 #include "Helper.h"
-#include "FilterCascade.h"
+#include "KnownVariantPanel.h"
 #include "Log.h"
 
 #include <QFileInfo>
 
-namespace {
-
-	QString copyFromResource(GenomeBuild build)
-	{
-		//check variant list exists
-		QString snp_file = ":/Resources/" + buildToString(build) + "_snps.vcf";
-		if (!QFile::exists(snp_file)) THROW(ProgrammingException, "Unsupported genome build '" + buildToString(build) + "'!");
-
-		//copy from resource file (gzopen cannot access Qt resources)
-		QString tmp = Helper::tempFileNameNonRandom(buildToString(build) + "_snps.vcf");
-		QFile::copy(snp_file, tmp);
-
-		return tmp;
-	}
-
-	void filterVcfFile(VcfFile& output, bool only_snvs, double min_af, double max_af)
-	{
-		FilterResult filter_result(output.count());
-
-		//check input
-		if (min_af<0.0 || min_af>1.0)
-		{
-			THROW(ArgumentException, "Minumum allele frequency out of range (0.0-1.0): " + QByteArray::number(min_af));
-		}
-		if (max_af<0.0 || max_af>1.0)
-		{
-			THROW(ArgumentException, "Maximum allele frequency out of range (0.0-1.0): " + QByteArray::number(max_af));
-		}
-
-		//filter by AF
-		if (min_af>0.0 || max_af<1.0)
-		{
-			for (int i=0; i<output.count(); ++i)
-			{
-				double af = output[i].info("AF").toDouble();
-				filter_result.flags()[i] = af>=min_af && af<=max_af;
-			}
-		}
-
-		//filter only SNVs
-		if (only_snvs)
-		{
-			FilterVariantIsSNV filter;
-			filter.apply(output, filter_result);
-		}
-
-		//apply filters
-		filter_result.removeFlagged(output);
-	}
-} // end anonymous namespace
-
 VcfFile NGSHelper::getKnownVariants(GenomeBuild build, bool only_snvs, const BedFile& roi, double min_af, double max_af)
 {
-	//check variant list exists
-	QString tmp = copyFromResource(build);
-
-	//load
-	VcfFile output;
-	output.load(tmp, roi, false);
-
-	//remove temporary file
-	QFile::remove(tmp);
-
-	//filter variants
-	filterVcfFile(output, only_snvs, min_af, max_af);
-
-	return output;
+	const KnownVariantPanel& panel = KnownVariantPanel::snps(build);
+	return panel.toVcfFile(panel.select(only_snvs, roi, min_af, max_af));
 }
 
 VcfFile NGSHelper::getKnownVariants(GenomeBuild build, bool only_snvs, double min_af, double max_af)
 {
-	//check variant list exists
-	QString tmp = copyFromResource(build);
-
-	//load
-	VcfFile output;
-	output.load(tmp, false);
-
-	//remove temporary file
-	QFile::remove(tmp);
-
-	//filter variants
-	filterVcfFile(output, only_snvs, min_af, max_af);
-
-	return output;
+	const KnownVariantPanel& panel = KnownVariantPanel::snps(build);
+	return panel.toVcfFile(panel.select(only_snvs, min_af, max_af));
 }
 
 void NGSHelper::createSampleOverview(QStringList in, QString out, int indel_window, bool cols_auto, QStringList cols)
@@ -1650,4 +1575,3 @@ QSet<QString> SampleHeaderInfo::sampleNames() const
 
 	return output;
 }
-
@@ -73,7 +73,7 @@ enum MaxEntScanImpact
 class CPPNGSSHARED_EXPORT NGSHelper
 {
 public:
-	///Returns known SNPs and indels from gnomAD (AF>=1%, AN>=5000).
+	///Returns known SNPs and indels from gnomAD (AF>=1%, AN>=5000). See KnownVariantPanel for access without conversion to VcfFile.
 	static VcfFile getKnownVariants(GenomeBuild build, bool only_snvs, const BedFile& roi, double min_af=0.0, double max_af=1.0);
 	static VcfFile getKnownVariants(GenomeBuild build, bool only_snvs, double min_af=0.0, double max_af=1.0);
 
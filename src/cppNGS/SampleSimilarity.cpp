@@ -2,6 +2,12 @@
 #include "Exceptions.h"
 #include "BasicStatistics.h"
 #include "NGSHelper.h"
+#include "KnownVariantPanel.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <bitset>
+#include <algorithm>
+#include <cmath>
 
 SampleSimilarity::VariantGenotypes SampleSimilarity::genotypesVcf(const VcfFile& variants, const QString& filename, bool include_gonosomes, bool skip_multi)
 {
@@ -76,29 +82,50 @@ SampleSimilarity::VariantGenotypes SampleSimilarity::genotypesGSvar(VariantList
 	return output;
 }
 
-SampleSimilarity::VariantGenotypes SampleSimilarity::genotypesBam(const VcfFile& snps, BamReader& reader, int min_cov, int max_snps, bool include_gonosomes,  bool include_single_end_reads)
+SampleSimilarity::VariantGenotypes SampleSimilarity::genotypesBam(const KnownVariantPanel& panel, const QVector<int>& snps, BamReader& reader, int min_cov, int max_snps, bool include_gonosomes,  bool include_single_end_reads)
 {
 	VariantGenotypes output;
-	for(int i=0; i<snps.count(); ++i)
+
+	//determine SNPs to use
+	QVector<int> indices;
+	foreach(int index, snps)
 	{
-		const Chromosome& chr = snps[i].chr();
-		int pos = snps[i].start();
+		if (!panel.chr(index).isAutosome() && !include_gonosomes) continue;
+		indices << index;
+	}
 
-		if (!chr.isAutosome() && !include_gonosomes) continue;
+	//calculate pileups in chunks, because we stop after 'max_snps' informative SNPs
+	const int chunk_size = 5000;
+	for (int chunk_start=0; chunk_start<indices.count(); chunk_start+=chunk_size)
+	{
+		int chunk_end = std::min(chunk_start + chunk_size, indices.count());
+		QVector<PileupPosition> positions;
+		for (int c=chunk_start; c<chunk_end; ++c)
+		{
+			positions << PileupPosition{panel.chr(indices[c]), panel.start(indices[c])};
+		}
+		QVector<Pileup> pileups = reader.getPileups(positions, -1, 1, include_single_end_reads);
+
+		for (int c=chunk_start; c<chunk_end; ++c)
+		{
+			int i = indices[c];
+			const Chromosome& chr = panel.chr(i);
+			int pos = panel.start(i);
 
-		Pileup pileup = reader.getPileup(chr, pos, -1, 1, include_single_end_reads);
-		if (pileup.depth(false)<min_cov) continue;
+			const Pileup& pileup = pileups[c-chunk_start];
+			if (pileup.depth(false)<min_cov) continue;
 
-		QChar ref = snps[i].ref()[0];
-		QChar obs = snps[i].alt(0)[0];
-		double frequency = pileup.frequency(ref, obs);
+			QChar ref = panel.ref(i)[0];
+			QChar obs = panel.alt(i)[0];
+			double frequency = pileup.frequency(ref, obs);
 
-		//skip non-informative snps
-		if (!BasicStatistics::isValidFloat(frequency)) continue;
+			//skip non-informative snps
+			if (!BasicStatistics::isValidFloat(frequency)) continue;
 
-		output[strToPointer(chr.strNormalized(false) + ":" + QString::number(pos) + " " + ref + ">" + obs)] = frequency;
+			output[strToPointer(chr.strNormalized(false) + ":" + QString::number(pos) + " " + ref + ">" + obs)] = frequency;
 
-		if (output.count()>=max_snps) break;
+			if (output.count()>=max_snps) return output;
+		}
 	}
 
 	return output;
@@ -169,14 +196,14 @@ SampleSimilarity::VariantGenotypes SampleSimilarity::genotypesFromGSvar(QString
 SampleSimilarity::VariantGenotypes SampleSimilarity::genotypesFromBam(GenomeBuild build, const QString& filename, int min_cov, int max_snps, bool include_gonosomes, const BedFile& roi, const QString& ref_file, bool include_single_end_reads)
 {
 	//get known SNP list
-	VcfFile snps;
-	snps = NGSHelper::getKnownVariants(build, true, roi, 0.2, 0.8);
+	const KnownVariantPanel& panel = KnownVariantPanel::snps(build);
+	QVector<int> snps = panel.select(true, roi, 0.2, 0.8);
 
 	//open BAM
 	BamReader reader(filename, ref_file);
 
 	//get VariantGenotypes
-	VariantGenotypes output = genotypesBam(snps, reader, min_cov, max_snps, include_gonosomes, include_single_end_reads);
+	VariantGenotypes output = genotypesBam(panel, snps, reader, min_cov, max_snps, include_gonosomes, include_single_end_reads);
 
 	return output;
 }
@@ -184,24 +211,22 @@ SampleSimilarity::VariantGenotypes SampleSimilarity::genotypesFromBam(GenomeBuil
 SampleSimilarity::VariantGenotypes SampleSimilarity::genotypesFromBam(GenomeBuild build, const QString& filename, int min_cov, int max_snps, bool include_gonosomes, const QString& ref_file, bool include_single_end_reads)
 {
 	//get known SNP list
-	VcfFile snps;
-	snps = NGSHelper::getKnownVariants(build, true, 0.2, 0.8);
+	const KnownVariantPanel& panel = KnownVariantPanel::snps(build);
+	QVector<int> snps = panel.select(true, 0.2, 0.8);
 
 	//open BAM
 	BamReader reader(filename, ref_file);
 
 	//get VariantGenotypes
-	VariantGenotypes output = genotypesBam(snps, reader, min_cov, max_snps, include_gonosomes, include_single_end_reads);
+	VariantGenotypes output = genotypesBam(panel, snps, reader, min_cov, max_snps, include_gonosomes, include_single_end_reads);
 
 	return output;
 }
 
 void SampleSimilarity::calculateSimilarity(const VariantGenotypes& in1, const VariantGenotypes& in2)
 {
-	static QVector<double> geno1;
-	geno1.clear();
-	static QVector<double> geno2;
-	geno2.clear();
+	QVector<double> geno1;
+	QVector<double> geno2;
 	clear();
 
 	//calculate overlap / correlation
@@ -290,3 +315,295 @@ const QChar* SampleSimilarity::strToPointer(const QString& str)
 
 	return it->constData();
 }
+
+SampleSimilarityCohort::SampleSimilarityCohort(const QList<SampleSimilarity::VariantGenotypes>& genotypes)
+	: packed_(true)
+	, site_count_(0)
+	, words_(0)
+{
+	//count in how many samples each site occurs and check if genotypes are discrete
+	QHash<const QChar*, int> occurrences;
+	foreach(const SampleSimilarity::VariantGenotypes& sample, genotypes)
+	{
+		counts_ << sample.count();
+		for (auto it=sample.cbegin(); it!=sample.cend(); ++it)
+		{
+			++occurrences[it.key()];
+
+			float geno = it.value();
+			if (geno!=0.0f && geno!=0.5f && geno!=1.0f) packed_ = false;
+		}
+	}
+
+	//create site index (sites that occur in one sample only do not contribute to the overlap)
+	QHash<const QChar*, int> site_index;
+	for (auto it=occurrences.cbegin(); it!=occurrences.cend(); ++it)
+	{
+		if (it.value()<2) continue;
+		site_index.insert(it.key(), site_count_);
+		++site_count_;
+	}
+
+	//create genotype vectors
+	if (packed_)
+	{
+		words_ = (site_count_ + 63) / 64;
+		lo_.fill(0, genotypes.count() * words_);
+		hi_.fill(0, genotypes.count() * words_);
+		for (int s=0; s<genotypes.count(); ++s)
+		{
+			quint64* lo = lo_.data() + s * words_;
+			quint64* hi = hi_.data() + s * words_;
+			const SampleSimilarity::VariantGenotypes& sample = genotypes[s];
+			for (auto it=sample.cbegin(); it!=sample.cend(); ++it)
+			{
+				int site = site_index.value(it.key(), -1);
+				if (site==-1) continue;
+
+				const quint64 bit = 1ull << (site % 64);
+				float geno = it.value();
+				if (geno!=0.5f) lo[site / 64] |= bit;
+				if (geno!=0.0f) hi[site / 64] |= bit;
+			}
+		}
+	}
+	else
+	{
+		sparse_.resize(genotypes.count());
+		for (int s=0; s<genotypes.count(); ++s)
+		{
+			QVector<SiteGenotype>& vector = sparse_[s];
+			const SampleSimilarity::VariantGenotypes& sample = genotypes[s];
+			for (auto it=sample.cbegin(); it!=sample.cend(); ++it)
+			{
+				int site = site_index.value(it.key(), -1);
+				if (site==-1) continue;
+
+				vector.append(SiteGenotype{site, it.value()});
+			}
+			std::sort(vector.begin(), vector.end(), [](const SiteGenotype& a, const SiteGenotype& b){ return a.site<b.site; });
+		}
+	}
+}
+
+SampleSimilarity SampleSimilarityCohort::calculateSimilarity(int i, int j) const
+{
+	SampleSimilarity output;
+	output.clear();
+
+	if (packed_)
+	{
+		calculatePacked(i, j, output);
+	}
+	else
+	{
+		calculateSparse(i, j, output);
+	}
+
+	return output;
+}
+
+static inline int popcount(quint64 bits)
+{
+	return static_cast<int>(std::bitset<64>(bits).count());
+}
+
+void SampleSimilarityCohort::calculatePacked(int i, int j, SampleSimilarity& output) const
+{
+	const quint64* lo1 = lo_.constData() + i * words_;
+	const quint64* hi1 = hi_.constData() + i * words_;
+	const quint64* lo2 = lo_.constData() + j * words_;
+	const quint64* hi2 = hi_.constData() + j * words_;
+
+	//genotypes are scaled to 0, 1, 2 for the correlation sums (the correlation is scale-invariant)
+	qint64 c_ol = 0;
+	qint64 c_ibs2 = 0;
+	qint64 c_ibs0 = 0;
+	qint64 c_equal = 0;
+	qint64 sum1 = 0;
+	qint64 sum2 = 0;
+	qint64 sum11 = 0;
+	qint64 sum22 = 0;
+	qint64 sum12 = 0;
+	for (int w=0; w<words_; ++w)
+	{
+		const quint64 both = (lo1[w] | hi1[w]) & (lo2[w] | hi2[w]);
+		if (both==0) continue;
+
+		const quint64 wt1 = lo1[w] & ~hi1[w];
+		const quint64 het1 = hi1[w] & ~lo1[w];
+		const quint64 hom1 = lo1[w] & hi1[w];
+		const quint64 wt2 = lo2[w] & ~hi2[w];
+		const quint64 het2 = hi2[w] & ~lo2[w];
+		const quint64 hom2 = lo2[w] & hi2[w];
+
+		c_ol += popcount(both);
+		c_ibs2 += popcount((hom1 & hom2) | (wt1 & wt2));
+		c_ibs0 += popcount((hom1 & wt2) | (wt1 & hom2));
+		c_equal += popcount(both & ~(lo1[w] ^ lo2[w]) & ~(hi1[w] ^ hi2[w]));
+
+		const int het1_ol = popcount(het1 & both);
+		const int hom1_ol = popcount(hom1 & both);
+		const int het2_ol = popcount(het2 & both);
+		const int hom2_ol = popcount(hom2 & both);
+		sum1 += het1_ol + 2 * hom1_ol;
+		sum2 += het2_ol + 2 * hom2_ol;
+		sum11 += het1_ol + 4 * hom1_ol;
+		sum22 += het2_ol + 4 * hom2_ol;
+		sum12 += popcount(het1 & het2) + 2 * popcount(het1 & hom2) + 2 * popcount(hom1 & het2) + 4 * popcount(hom1 & hom2);
+	}
+
+	//abort if no overlap
+	if (c_ol==0)
+	{
+		output.messages_.append("Zero overlap between variant lists!");
+		return;
+	}
+
+	const double cov = (double)(c_ol * sum12 - sum1 * sum2);
+	const double var1 = (double)(c_ol * sum11 - sum1 * sum1);
+	const double var2 = (double)(c_ol * sum22 - sum2 * sum2);
+	setResult(i, j, (int)c_ol, (int)c_ibs2, (int)c_ibs0, cov / std::sqrt(var1) / std::sqrt(var2), (double)c_equal / c_ol, output);
+}
+
+void SampleSimilarityCohort::calculateSparse(int i, int j, SampleSimilarity& output) const
+{
+	const QVector<SiteGenotype>& sample1 = sparse_[i];
+	const QVector<SiteGenotype>& sample2 = sparse_[j];
+
+	//merge-join of sorted vectors
+	QVector<double> geno1;
+	QVector<double> geno2;
+	int c_ibs2 = 0;
+	int c_ibs0 = 0;
+	int c_equal = 0;
+	int i1 = 0;
+	int i2 = 0;
+	while (i1<sample1.count() && i2<sample2.count())
+	{
+		if (sample1[i1].site<sample2[i2].site)
+		{
+			++i1;
+		}
+		else if (sample1[i1].site>sample2[i2].site)
+		{
+			++i2;
+		}
+		else
+		{
+			float freq1 = sample1[i1].geno;
+			float freq2 = sample2[i2].geno;
+			geno1.append(freq1);
+			geno2.append(freq2);
+
+			if ((freq1>0.9 && freq2>0.9) || (freq1<0.1 && freq2<0.1)) ++c_ibs2;
+			if ((freq1>0.9 && freq2<0.1) || (freq1<0.1 && freq2>0.9)) ++c_ibs0;
+			c_equal += (freq1==freq2);
+
+			++i1;
+			++i2;
+		}
+	}
+
+	//abort if no overlap
+	if (geno1.count()==0)
+	{
+		output.messages_.append("Zero overlap between variant lists!");
+		return;
+	}
+
+	setResult(i, j, geno1.count(), c_ibs2, c_ibs0, BasicStatistics::correlation(geno1, geno2), (double)c_equal / geno1.count(), output);
+}
+
+void SampleSimilarityCohort::setResult(int i, int j, int c_ol, int c_ibs2, int c_ibs0, double correlation, double equal_fraction, SampleSimilarity& output) const
+{
+	output.no_variants1_ = counts_[i];
+	output.no_variants2_ = counts_[j];
+	int min_count = std::min(output.no_variants1_, output.no_variants2_);
+	output.ol_perc_ = 100.0 * c_ol / min_count;
+	output.ol_count_ = c_ol;
+	output.sample_correlation_ = correlation;
+	output.ibs2_perc_ = 100.0 * c_ibs2 / min_count;
+	output.ibs0_perc_ = 100.0 * c_ibs0 / min_count;
+
+	//calulate percentage with same genotype if correlation is not calculatable
+	if (!BasicStatistics::isValidFloat(output.sample_correlation_))
+	{
+		output.sample_correlation_ = equal_fraction;
+		output.messages_.append("Could not calulate genotype correlation, calculated the fraction of matching genotypes instead.");
+	}
+}
+
+//Calculates one tile of the similarity matrix
+class SimilarityTileWorker
+	: public QRunnable
+{
+public:
+	SimilarityTileWorker(const SampleSimilarityCohort& cohort, int i_start, int i_end, int j_start, int j_end, const QVector<int>& row_offsets, int row_start, SampleSimilarity* output)
+		: cohort_(cohort)
+		, i_start_(i_start)
+		, i_end_(i_end)
+		, j_start_(j_start)
+		, j_end_(j_end)
+		, row_offsets_(row_offsets)
+		, row_start_(row_start)
+		, output_(output)
+	{
+	}
+
+	void run() override
+	{
+		for (int i=i_start_; i<i_end_; ++i)
+		{
+			const int offset = row_offsets_[i-row_start_] - (i+1);
+			for (int j=std::max(j_start_, i+1); j<j_end_; ++j)
+			{
+				output_[offset + j] = cohort_.calculateSimilarity(i, j);
+			}
+		}
+	}
+
+protected:
+	const SampleSimilarityCohort& cohort_;
+	int i_start_;
+	int i_end_;
+	int j_start_;
+	int j_end_;
+	const QVector<int>& row_offsets_;
+	int row_start_;
+	SampleSimilarity* output_;
+};
+
+QVector<SampleSimilarity> SampleSimilarityCohort::calculateSimilarityRows(int start, int end, int threads) const
+{
+	const int n = count();
+	end = std::min(end, n);
+
+	//determine output index of first pair of each row
+	QVector<int> row_offsets;
+	int pair_count = 0;
+	for (int i=start; i<end; ++i)
+	{
+		row_offsets << pair_count;
+		pair_count += n - i - 1;
+	}
+	QVector<SampleSimilarity> output(pair_count);
+	if (pair_count==0) return output;
+
+	//process tiles in parallel (tiles keep the genotype vectors of the row and column samples in the cache)
+	const int tile_rows = 16;
+	const int tile_cols = 256;
+	QThreadPool pool;
+	pool.setMaxThreadCount(std::max(1, threads));
+	for (int i=start; i<end; i+=tile_rows)
+	{
+		int i_end = std::min(i + tile_rows, end);
+		for (int j=i+1; j<n; j+=tile_cols)
+		{
+			pool.start(new SimilarityTileWorker(*this, i, i_end, j, std::min(j + tile_cols, n), row_offsets, start, output.data()));
+		}
+	}
+	pool.waitForDone();
+
+	return output;
+}
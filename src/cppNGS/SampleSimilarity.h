@@ -4,8 +4,10 @@
 #include "cppNGS_global.h"
 #include "BedFile.h"
 #include "Statistics.h"
+#include "KnownVariantPanel.h"
 #include <QStringList>
 #include <QHash>
+#include <QVector>
 
 // Sample similarity calculator
 class CPPNGSSHARED_EXPORT SampleSimilarity
@@ -82,11 +84,13 @@ public:
 	void clear();
 
 private:
+	friend class SampleSimilarityCohort;
+
 	static float genoToDouble(const QString& geno);
 
 	static VariantGenotypes genotypesVcf(const VcfFile& variants, const QString& filename, bool include_gonosomes, bool skip_multi);
 	static VariantGenotypes genotypesGSvar(VariantList variants, QString filename, bool include_gonosomes);
-	static VariantGenotypes genotypesBam(const VcfFile& snps, BamReader& reader, int min_cov, int max_snps, bool include_gonosomes, bool include_single_end_reads=false);
+	static VariantGenotypes genotypesBam(const KnownVariantPanel& panel, const QVector<int>& snps, BamReader& reader, int min_cov, int max_snps, bool include_gonosomes, bool include_single_end_reads=false);
 
 	//Returns a string pointer, which can be stored/compared instead of the string. Reduces memory and run-time.
 	//Beanchmark with 38 GSvar files with 66k variants: memory-consumption 430>118MB, comparison time 20>5s
@@ -101,4 +105,58 @@ private:
 	QStringList messages_;
 };
 
+//All-vs-all sample similarity calculation for a cohort. The results are identical to SampleSimilarity::calculateSimilarity for each pair.
+//The genotypes of all samples are mapped onto a shared site index, which contains only sites that occur in at least two samples.
+//If all genotypes are 0, 0.5 or 1 (VCF/GSvar mode), they are stored as 2-bit packed vectors and compared 64 sites at a time using popcount.
+//Otherwise (allele frequencies from BAM mode), each sample is stored as a sorted vector of (site, genotype) pairs and pairs are compared by merge-join.
+class CPPNGSSHARED_EXPORT SampleSimilarityCohort
+{
+public:
+	//Constructor. Builds the site index and the genotype vectors.
+	SampleSimilarityCohort(const QList<SampleSimilarity::VariantGenotypes>& genotypes);
+
+	//Returns the number of samples.
+	int count() const
+	{
+		return counts_.count();
+	}
+	//Returns if genotypes are stored as 2-bit packed vectors.
+	bool isPacked() const
+	{
+		return packed_;
+	}
+	//Returns the number of sites that are shared by at least two samples.
+	int siteCount() const
+	{
+		return site_count_;
+	}
+
+	//Calculates the similarity of the samples i and j.
+	SampleSimilarity calculateSimilarity(int i, int j) const;
+	//Calculates the similarity of each sample i in [start, end) with all samples j>i using @p threads threads.
+	//The results are returned in the order of the pairwise loop, i.e. (start, start+1), (start, start+2), ..., (start+1, start+2), ...
+	QVector<SampleSimilarity> calculateSimilarityRows(int start, int end, int threads) const;
+
+protected:
+	//Genotype of a site in the sparse representation
+	struct SiteGenotype
+	{
+		int site;
+		float geno;
+	};
+
+	bool packed_;
+	int site_count_;
+	int words_; //number of 64-bit words per packed vector
+	QVector<int> counts_; //number of variants per sample (including sites that are not shared)
+	QVector<quint64> lo_; //packed genotypes, low bit: words_ per sample (00=missing, 01=0.0, 10=0.5, 11=1.0)
+	QVector<quint64> hi_; //packed genotypes, high bit: words_ per sample
+	QVector<QVector<SiteGenotype>> sparse_; //sparse genotypes sorted by site
+
+	void calculatePacked(int i, int j, SampleSimilarity& output) const;
+	void calculateSparse(int i, int j, SampleSimilarity& output) const;
+	//Sets the result of the pair (i, j) in the same way as SampleSimilarity::calculateSimilarity
+	void setResult(int i, int j, int c_ol, int c_ibs2, int c_ibs0, double correlation, double equal_fraction, SampleSimilarity& output) const;
+};
+
 #endif // SAMPLESIMILARITY_H
@@ -19,6 +19,7 @@
 #include <QThreadPool>
 #include "Histogram.h"
 #include "FilterCascade.h"
+#include "KnownVariantPanel.h"
 #include "ToolBase.h"
 
 class RegionDepth
@@ -411,8 +412,7 @@ QCCollection Statistics::mapping(const BedFile& bed_file, const QString& bam_fil
 			const int start_pos = al.start();
 			const int end_pos = al.end();
 			bases_mapped += al.length();
-			const QList<CigarOp> cigar_data = al.cigarData();
-			foreach(const CigarOp& op, cigar_data)
+			for (const CigarOp op : al.cigarView())
 			{
 				if (op.Type==BAM_CSOFT_CLIP || op.Type==BAM_CHARD_CLIP)
 				{
@@ -768,8 +768,7 @@ QCCollection Statistics::mapping(const QString &bam_file, int min_mapq, const QS
 
 			//calculate soft/hard-clipped bases
 			bases_mapped += al.length();
-			const QList<CigarOp> cigar_data = al.cigarData();
-			foreach(const CigarOp& op, cigar_data)
+			for (const CigarOp op : al.cigarView())
 			{
 				if (op.Type==BAM_CSOFT_CLIP || op.Type==BAM_CHARD_CLIP)
 				{
@@ -974,8 +973,7 @@ QCCollection Statistics::mapping_wgs(const QString &bam_file, const QString& bed
 
 			//calculate soft/hard-clipped bases
 			bases_mapped += al.length();
-			const QList<CigarOp> cigar_data = al.cigarData();
-			foreach(const CigarOp& op, cigar_data)
+			for (const CigarOp op : al.cigarView())
 			{
 				if (op.Type==BAM_CSOFT_CLIP || op.Type==BAM_CHARD_CLIP)
 				{
@@ -2205,14 +2203,22 @@ QCCollection Statistics::contamination(GenomeBuild build, QString bam, const QSt
 	Histogram hist(0, 1, 0.05);
 	int passed = 0;
 	double passed_depth_sum = 0.0;
-	VcfFile snps = NGSHelper::getKnownVariants(build, true, 0.2, 0.8);
+	const KnownVariantPanel& panel = KnownVariantPanel::snps(build);
+	QVector<int> snps = panel.select(true, 0.2, 0.8);
+	QVector<PileupPosition> positions;
+	positions.reserve(snps.count());
+	foreach(int index, snps)
+	{
+		positions << PileupPosition{panel.chr(index), panel.start(index)};
+	}
+	QVector<Pileup> pileups = reader.getPileups(positions, -1, 1, longread);
 	for(int i=0; i<snps.count(); ++i)
 	{
-		Pileup pileup = reader.getPileup(snps[i].chr(), snps[i].start(), -1, 1, longread);
+		const Pileup& pileup = pileups[i];
 		int depth = pileup.depth(false);
 		if (depth<min_cov) continue;
 
-		double freq = pileup.frequency(snps[i].ref()[0], snps[i].alt(0)[0]);
+		double freq = pileup.frequency(panel.ref(snps[i])[0], panel.alt(snps[i])[0]);
 
 		//skip non-informative snps
 		if (!BasicStatistics::isValidFloat(freq)) continue;
@@ -2273,26 +2279,18 @@ AncestryEstimates Statistics::ancestry(GenomeBuild build, QString filename, int
 		scores["EAS"]["EAS"] = {0.47035, 0.0242};
 	}
 
-	//copy ancestry SNP file from resources (gzopen cannot access Qt resources)
-	QString snp_file = ":/Resources/" + buildToString(build) + "_ancestry.vcf";
-	if (!QFile::exists(snp_file)) THROW(ProgrammingException, "Unsupported genome build '" + buildToString(build) + "' for ancestry estimation!");
-	QString tmp = Helper::tempFileNameNonRandom(buildToString(build) + "_ancestry.vcf");
-	QFile::copy(snp_file, tmp);
-
-	//load ancestry SNP file
-	VcfFile vars_ancestry;
-	vars_ancestry.load(tmp);
-	ChromosomalIndex<VcfFile> vars_ancestry_idx(vars_ancestry);
-
-	//remove temporary file
-	QFile::remove(tmp);
+	//ancestry SNPs
+	const KnownVariantPanel& panel = KnownVariantPanel::ancestry(build);
+	const int af_afr_idx = panel.afIndex("AF_AFR");
+	const int af_eur_idx = panel.afIndex("AF_EUR");
+	const int af_sas_idx = panel.afIndex("AF_SAS");
+	const int af_eas_idx = panel.afIndex("AF_EAS");
 
 	//create ROI to speed up loading the sample file, e.g. for genomes.
 	BedFile roi;
-	for(int i=0; i<vars_ancestry.count(); ++i)
+	for(int i=0; i<panel.count(); ++i)
 	{
-		const VcfLine& var = vars_ancestry[i];
-		roi.append(BedLine(var.chr(), var.start(), var.end()));
+		roi.append(BedLine(panel.chr(i), panel.start(i), panel.end(i)));
 	}
 	roi.merge(true);
 
@@ -2323,20 +2321,18 @@ AncestryEstimates Statistics::ancestry(GenomeBuild build, QString filename, int
 		const VcfLine& v = vl[i];
 
 		//skip non-informative SNPs
-		int index = vars_ancestry_idx.matchingIndex(v.chr(), v.start(), v.end());
+		if (v.isMultiAllelic()) continue;
+		int index = panel.find(v.chr(), v.start(), v.ref(), v.alt(0));
 		if (index==-1) continue;
 
-		const VcfLine& v2 = vars_ancestry[index];
-		if (v.ref()!=v2.ref() || v.alt()!=v2.alt()) continue;
-
 		//genotype sample
 		geno_sample << vl[i].formatValueFromSample("GT").count('1');
 
 		//population AFs
-		af_afr << v2.info("AF_AFR").toDouble();
-		af_eur << v2.info("AF_EUR").toDouble();
-		af_sas << v2.info("AF_SAS").toDouble();
-		af_eas << v2.info("AF_EAS").toDouble();
+		af_afr << panel.af(index, af_afr_idx);
+		af_eur << panel.af(index, af_eur_idx);
+		af_sas << panel.af(index, af_sas_idx);
+		af_eas << panel.af(index, af_eas_idx);
 	}
 
 	//not enough informative SNPs
@@ -2392,7 +2388,11 @@ AncestryEstimates Statistics::ancestry(GenomeBuild build, QString filename, int
 BedFile Statistics::lowOrHighCoverage(const BedFile& bed_file, const QString& bam_file, int cutoff, int min_mapq, int min_baseq, int threads, const QString& ref_file, bool is_high, bool random_access, bool debug)
 {
 	//check BED is sorted for WGS mode
-	if (!random_access && !bed_file.isSorted()) THROW(ArgumentException, "Input BED file has to be sorted for sweep algorithm!");
+	bool is_sorted = bed_file.isSorted();
+	if (!random_access && !is_sorted) THROW(ArgumentException, "Input BED file has to be sorted for sweep algorithm!");
+
+	//use sweep algorithm for many regions (random access re-seeks and re-decodes the BAM/CRAM for each region)
+	if (random_access && is_sorted && bed_file.count()>=sweep_min_regions) random_access = false;
 
 	//create analysis chunks (200 lines)
 	QTime timer;
@@ -2477,28 +2477,20 @@ BedFile Statistics::lowOrHighCoverage(const BedFile& bed_file, const QString& ba
 	{
 		if (!random_access)
 		{
-			if (debug) QTextStream(stdout) << "Creating BED index" << endl;
-			ChromosomalIndex<BedFile> bed_index(bed_file);
-
-			if (debug) QTextStream(stdout) << "Starting worker " << i << endl;
-			WorkerLowOrHighCoverageChr* worker = new WorkerLowOrHighCoverageChr(bed_chunks[i], bed_index, bam_file, cutoff, min_mapq, min_baseq, ref_file, is_high, debug);
+			WorkerLowOrHighCoverageChr* worker = new WorkerLowOrHighCoverageChr(bed_chunks[i], bam_file, cutoff, min_mapq, min_baseq, ref_file, is_high, debug);
 			thread_pool.start(worker);
-
-			//wait until finished
-			if (debug) QTextStream(stdout) << "Waiting for workers to finish..." << endl;
-			thread_pool.waitForDone();
 		}
 		else
 		{
 			WorkerLowOrHighCoverage* worker = new WorkerLowOrHighCoverage(bed_chunks[i], bam_file, cutoff, min_mapq, min_baseq, ref_file, is_high, debug);
 			thread_pool.start(worker);
-
-			//wait until finished
-			if (debug) QTextStream(stdout) << "Waiting for workers to finish..." << endl;
-			thread_pool.waitForDone();
 		}
 	}
 
+	//wait until finished
+	if (debug) QTextStream(stdout) << "Waiting for workers to finish..." << endl;
+	thread_pool.waitForDone();
+
 	//debug output
 	if (debug) QTextStream(stdout) << "Writing output" << endl;
 
@@ -2552,7 +2544,11 @@ BedFile Statistics::lowCoverage(const BedFile& bed_file, const QString& bam_file
 void Statistics::avgCoverage(BedFile& bed_file, const QString& bam_file, int min_mapq, int threads, int decimals, const QString& ref_file, bool random_access, bool debug)
 {
 	//check BED is sorted for chromosomal sweep algorithm
-	if (!random_access && !bed_file.isSorted()) THROW(ArgumentException, "Input BED file has to be sorted for sweep algorithm!");
+	bool is_sorted = bed_file.isSorted();
+	if (!random_access && !is_sorted) THROW(ArgumentException, "Input BED file has to be sorted for sweep algorithm!");
+
+	//use sweep algorithm for many regions (random access re-seeks and re-decodes the BAM/CRAM for each region)
+	if (random_access && is_sorted && bed_file.count()>=sweep_min_regions) random_access = false;
 
 	//create analysis chunks
 	QTime timer;
@@ -2721,22 +2717,27 @@ GenderEstimate Statistics::genderHetX(GenomeBuild build, QString bam_file, doubl
 	int chrx_end_pos = reader.chromosomeSize(chrx);
 	BedFile roi_chrx(chrx, 1, chrx_end_pos);
 	roi_chrx.subtract(NGSHelper::pseudoAutosomalRegion(build));
-	VcfFile snps = NGSHelper::getKnownVariants(build, true, roi_chrx, 0.2, 0.8);
+	const KnownVariantPanel& panel = KnownVariantPanel::snps(build);
+	QVector<int> snps = panel.select(true, roi_chrx, 0.2, 0.8);
 
 	//count het SNPs
 	int c_all = 0;
 	int c_het = 0;
-	QVector<Pileup> counts;
-	counts.reserve(snps.count());
+	QVector<PileupPosition> positions;
+	positions.reserve(snps.count());
+	foreach(int index, snps)
+	{
+		positions << PileupPosition{panel.chr(index), panel.start(index)};
+	}
+	QVector<Pileup> pileups = reader.getPileups(positions, -1, 20, include_single_end_reads, 20);
 	for (int i=0; i<snps.count(); ++i)
 	{
-		const VcfLine& snp = snps[i];
-		Pileup pileup = reader.getPileup(snp.chr(), snp.start(), -1, 20, include_single_end_reads, 20);
+		const Pileup& pileup = pileups[i];
 
 		int depth = pileup.depth(false);
 		if (depth<20) continue;
 
-		double af = pileup.frequency(snp.ref()[0], snp.alt()[0][0]);
+		double af = pileup.frequency(panel.ref(snps[i])[0], panel.alt(snps[i])[0]);
 		if (!BasicStatistics::isValidFloat(af)) continue;
 
 		++c_all;
@@ -65,6 +65,9 @@ public:
 	///Returns ancestry estimates for a variant list in VCF format.
 	static AncestryEstimates ancestry(GenomeBuild build, QString filename, int min_snp=1000, double abs_score_cutoff = 0.32, double max_mad_dist = 4.2);
 
+	///Minimum number of regions for which coverage calculation functions use the chromosome-wise sweep algorithm, even if random access is requested (BED file has to be sorted).
+	static const int sweep_min_regions = 10000;
+
 	///Calculates the part of the target region that has a lower coverage than the given cutoff. The input BED file must be merged and sorted!
 	static BedFile lowCoverage(const BedFile& bed_file, const QString& bam_file, int cutoff, int min_mapq=1, int min_baseq=0, int threads=1, const QString& ref_file = QString(), bool random_access=true, bool debug=false);
 	///Calculates and annotates the average coverage of the regions in the bed file. Debug flag enables debug output to stdout.
@@ -13,6 +13,8 @@
 TabixIndexedFile::TabixIndexedFile()
 	: file_(nullptr)
 	, tbx_(nullptr)
+	, itr_(nullptr)
+	, str_{0, 0, nullptr}
 {
 }
 
@@ -52,6 +54,12 @@ void TabixIndexedFile::clear()
 {
 	filename_.clear();
 
+	if (itr_!=nullptr) tbx_itr_destroy(itr_);
+	itr_ = nullptr;
+
+	free(str_.s);
+	str_ = {0, 0, nullptr};
+
 	if (tbx_!=nullptr) tbx_destroy(tbx_);
 	tbx_ = nullptr;
 
@@ -104,3 +112,35 @@ QByteArrayList TabixIndexedFile::getMatchingLines(const Chromosome& chr, int sta
 
 	return output;
 }
+
+bool TabixIndexedFile::beginRegion(const Chromosome& chr, int start, int end)
+{
+	if (itr_!=nullptr) tbx_itr_destroy(itr_);
+	itr_ = nullptr;
+
+	//get chromsome identifier
+	int chr_id = chr2chr_.value(chr.num(), -1);
+	if (chr_id==-1) return false;
+
+	itr_ = tbx_itr_queryi(tbx_, chr_id, start-1, end);
+	if (itr_==nullptr) THROW(FileParseException, "Error while parsing the index file for " + filename_ + ".");
+
+	return true;
+}
+
+bool TabixIndexedFile::nextLine(QByteArray& line)
+{
+	if (itr_==nullptr) return false;
+
+	int r = tbx_itr_next(file_, tbx_, itr_, &str_);
+	if (r < -1) THROW(FileParseException, "Error while accessing file through the index file for " + filename_ + ".");
+	if (r < 0)
+	{
+		tbx_itr_destroy(itr_);
+		itr_ = nullptr;
+		return false;
+	}
+
+	line = QByteArray(str_.s, str_.l);
+	return true;
+}
@@ -24,10 +24,18 @@ public:
 	///Returns lines that overlap the region (1-based)
 	QByteArrayList getMatchingLines(const Chromosome& chr, int start, int end, bool ignore_missing_chr = false) const;
 
+	///Starts streaming the lines that overlap the region (1-based). Returns 'false' if the chromosome is not contained in the file.
+	///In contrast to getMatchingLines(), the lines are not collected, i.e. large regions can be processed line by line with each compressed block being decoded only once.
+	bool beginRegion(const Chromosome& chr, int start, int end);
+	///Reads the next line of the region started with beginRegion() into @p line. Returns 'false' if there are no more lines.
+	bool nextLine(QByteArray& line);
+
 protected:
 	QByteArray filename_;
 	htsFile* file_;
 	tbx_t* tbx_;
+	hts_itr_t* itr_; //iterator used for streaming
+	kstring_t str_; //line buffer used for streaming
 	QHash<int, int> chr2chr_; //dictionary to translate ngs-bits chromosome IDs to tabix chromosome IDs
 };
 
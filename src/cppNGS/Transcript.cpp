@@ -1033,6 +1033,12 @@ void TranscriptList::sortByPosition()
 	std::stable_sort(begin(), end(), comparator);
 }
 
+bool TranscriptList::isSortedByPosition() const
+{
+	TranscriptPositionComparator comparator;
+	return std::is_sorted(begin(), end(), comparator);
+}
+
 bool TranscriptList::TranscriptPositionComparator::operator()(const Transcript& a, const Transcript& b) const
 {
 	if (a.chr()<b.chr()) return true;
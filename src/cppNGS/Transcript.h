@@ -376,6 +376,8 @@ public:
 	void sortByCodingBases();
 	//sorts transcripts by chromosomal position
 	void sortByPosition();
+	//returns if the transcripts are sorted by chromosomal position (see sortByPosition)
+	bool isSortedByPosition() const;
 
 private:
 	//Comparator helper class used by sortByPosition
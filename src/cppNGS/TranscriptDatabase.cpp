@@ -0,0 +1,315 @@
+#include "TranscriptDatabase.h"
+#include "Exceptions.h"
+#include "Helper.h"
+#include "BinaryFileHeader.h"
+#include <QFile>
+#include <QHash>
+#include <algorithm>
+#include <cstring>
+
+//header of binary transcript databases. It is followed by the string offsets (string_count+1 values), the string data (padded to a multiple of 8 bytes), the transcripts, the exons (start/end pairs) and the ENST-ENSG and ENSG-symbol pairs (string indices). Data is stored in native byte order.
+struct TranscriptDatabaseHeader
+	: public BinaryFileHeader
+{
+	quint8 source_refseq;
+	quint8 include_all;
+	quint8 skip_not_hgnc;
+	quint8 reserved[5];
+	qint64 string_count;
+	qint64 string_data_size;
+	qint64 transcript_count;
+	qint64 exon_count;
+	qint64 enst2ensg_count;
+	qint64 ensg2symbol_count;
+};
+static const char TRANSCRIPT_DATABASE_MAGIC[8] = {'T', 'R', 'A', 'N', 'S', 'D', 'B', '1'};
+static const quint32 TRANSCRIPT_DATABASE_VERSION = 2;
+
+//transcript of binary transcript databases (strings are given as index into the string table)
+struct TranscriptDatabaseTranscript
+{
+	qint32 gene;
+	qint32 gene_id;
+	qint32 hgnc_id;
+	qint32 name;
+	qint32 name_ccds;
+	qint32 chr;
+	qint32 version;
+	qint32 coding_start;
+	qint32 coding_end;
+	quint8 source;
+	quint8 strand;
+	quint8 biotype;
+	quint8 flags;
+	qint32 id; //external identifier (-1 if not set)
+	qint64 first_exon;
+	qint64 exon_count;
+};
+
+//transcript flags
+enum TranscriptDatabaseFlags
+{
+	PREFERRED = 1,
+	GENCODE_BASIC = 2,
+	ENSEMBL_CANONICAL = 4,
+	MANE_SELECT = 8,
+	MANE_PLUS_CLINICAL = 16
+};
+
+//string table used to write the database
+class TranscriptDatabaseStrings
+{
+public:
+	qint32 id(const QByteArray& str)
+	{
+		auto it = ids_.find(str);
+		if (it!=ids_.end()) return it.value();
+
+		qint32 id = offsets_.count();
+		ids_.insert(str, id);
+		offsets_ << data_.size();
+		data_.append(str);
+		return id;
+	}
+
+	QVector<qint64> offsets() const
+	{
+		return offsets_ + QVector<qint64>{data_.size()};
+	}
+
+	const QByteArray& data() const
+	{
+		return data_;
+	}
+
+protected:
+	QHash<QByteArray, qint32> ids_;
+	QVector<qint64> offsets_;
+	QByteArray data_;
+};
+
+void TranscriptDatabase::store(const GffData& data, const GffSettings& settings, QString filename, QString source_file, const QVector<int>& ids)
+{
+	//sort transcripts by position
+	if (!ids.isEmpty() && ids.count()!=data.transcripts.count()) THROW(ArgumentException, "Transcript identifier count (" + QString::number(ids.count()) + ") does not match transcript count (" + QString::number(data.transcripts.count()) + ")!");
+	TranscriptList transcripts = data.transcripts;
+	if (!transcripts.isSortedByPosition())
+	{
+		if (!ids.isEmpty()) THROW(ArgumentException, "Transcripts have to be sorted by position if transcript identifiers are given!");
+		transcripts.sortByPosition();
+	}
+
+	//transcripts and exons
+	TranscriptDatabaseStrings strings;
+	QVector<TranscriptDatabaseTranscript> transcript_data;
+	transcript_data.reserve(transcripts.count());
+	QVector<qint32> exons;
+	for (int i=0; i<transcripts.count(); ++i)
+	{
+		const Transcript& t = transcripts[i];
+		TranscriptDatabaseTranscript r;
+		memset(&r, 0, sizeof(TranscriptDatabaseTranscript));
+		r.gene = strings.id(t.gene());
+		r.gene_id = strings.id(t.geneId());
+		r.hgnc_id = strings.id(t.hgncId());
+		r.name = strings.id(t.name());
+		r.name_ccds = strings.id(t.nameCcds());
+		r.chr = strings.id(t.chr().str());
+		r.version = t.version();
+		r.coding_start = t.codingStart();
+		r.coding_end = t.codingEnd();
+		r.source = t.source();
+		r.strand = t.strand();
+		r.biotype = t.biotype();
+		if (t.isPreferredTranscript()) r.flags |= PREFERRED;
+		if (t.isGencodeBasicTranscript()) r.flags |= GENCODE_BASIC;
+		if (t.isEnsemblCanonicalTranscript()) r.flags |= ENSEMBL_CANONICAL;
+		if (t.isManeSelectTranscript()) r.flags |= MANE_SELECT;
+		if (t.isManePlusClinicalTranscript()) r.flags |= MANE_PLUS_CLINICAL;
+		r.id = ids.isEmpty() ? -1 : ids[i];
+		r.first_exon = exons.count() / 2;
+		r.exon_count = t.regions().count();
+		for (int e=0; e<t.regions().count(); ++e)
+		{
+			exons << t.regions()[e].start() << t.regions()[e].end();
+		}
+		transcript_data << r;
+	}
+
+	//maps (sorted to make the output deterministic)
+	auto mapData = [&strings](const QHash<QByteArray, QByteArray>& map)
+	{
+		QByteArrayList keys = map.keys();
+		std::sort(keys.begin(), keys.end());
+		QVector<qint32> output;
+		output.reserve(2 * keys.count());
+		foreach(const QByteArray& key, keys)
+		{
+			output << strings.id(key) << strings.id(map[key]);
+		}
+		return output;
+	};
+	QVector<qint32> enst2ensg = mapData(data.enst2ensg);
+	QVector<qint32> ensg2symbol = mapData(data.ensg2symbol);
+
+	//payload
+	QVector<qint64> string_offsets = strings.offsets();
+	QByteArray payload;
+	auto append = [&payload](const void* data, qint64 size)
+	{
+		payload.append(reinterpret_cast<const char*>(data), size);
+	};
+	append(string_offsets.constData(), string_offsets.count() * (qint64)sizeof(qint64));
+	append(strings.data().constData(), strings.data().size());
+	payload.append(QByteArray(BinaryFileHeader::paddedSize(strings.data().size()) - strings.data().size(), 0));
+	append(transcript_data.constData(), transcript_data.count() * (qint64)sizeof(TranscriptDatabaseTranscript));
+	append(exons.constData(), exons.count() * (qint64)sizeof(qint32));
+	append(enst2ensg.constData(), enst2ensg.count() * (qint64)sizeof(qint32));
+	append(ensg2symbol.constData(), ensg2symbol.count() * (qint64)sizeof(qint32));
+
+	//header
+	TranscriptDatabaseHeader header;
+	memset(&header, 0, sizeof(TranscriptDatabaseHeader));
+	header.init(TRANSCRIPT_DATABASE_MAGIC, TRANSCRIPT_DATABASE_VERSION, source_file);
+	header.checksum = BinaryFileHeader::calculateChecksum(reinterpret_cast<const uchar*>(payload.constData()), payload.size());
+	if (settings.source!="ensembl" && settings.source!="refseq") THROW(ArgumentException, "Invalid GFF source '" + settings.source + "'!");
+	header.source_refseq = settings.source=="refseq";
+	header.include_all = settings.include_all;
+	header.skip_not_hgnc = settings.skip_not_hgnc;
+	header.string_count = string_offsets.count() - 1;
+	header.string_data_size = strings.data().size();
+	header.transcript_count = transcript_data.count();
+	header.exon_count = exons.count() / 2;
+	header.enst2ensg_count = enst2ensg.count() / 2;
+	header.ensg2symbol_count = ensg2symbol.count() / 2;
+
+	//write
+	QSharedPointer<QFile> file = Helper::openFileForWriting(filename);
+	if (file->write(reinterpret_cast<const char*>(&header), sizeof(TranscriptDatabaseHeader))!=sizeof(TranscriptDatabaseHeader) || file->write(payload)!=payload.size())
+	{
+		THROW(FileAccessException, "Could not write transcript database '" + filename + "'!");
+	}
+	file->close();
+}
+
+GffData TranscriptDatabase::load(QString filename, GffSettings* settings, QVector<int>* ids)
+{
+	//memory-map file (if that is not possible, we read it into memory)
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) THROW(FileAccessException, "Could not open transcript database '" + filename + "' for reading!");
+	qint64 file_size = file.size();
+	QByteArray file_data;
+	const uchar* data = BinaryFileHeader::map(file, file_data);
+
+	//header
+	if (file_size<(qint64)sizeof(TranscriptDatabaseHeader)) THROW(FileParseException, "Transcript database '" + filename + "' is truncated!");
+	TranscriptDatabaseHeader header;
+	memcpy(&header, data, sizeof(TranscriptDatabaseHeader));
+	header.check(TRANSCRIPT_DATABASE_MAGIC, TRANSCRIPT_DATABASE_VERSION, filename, "transcript database");
+
+	const qint64 offsets_offset = sizeof(TranscriptDatabaseHeader);
+	const qint64 strings_offset = offsets_offset + (header.string_count + 1) * (qint64)sizeof(qint64);
+	const qint64 transcripts_offset = strings_offset + BinaryFileHeader::paddedSize(header.string_data_size);
+	const qint64 exons_offset = transcripts_offset + header.transcript_count * (qint64)sizeof(TranscriptDatabaseTranscript);
+	const qint64 enst2ensg_offset = exons_offset + header.exon_count * 2 * (qint64)sizeof(qint32);
+	const qint64 ensg2symbol_offset = enst2ensg_offset + header.enst2ensg_count * 2 * (qint64)sizeof(qint32);
+	if (file_size!=ensg2symbol_offset + header.ensg2symbol_count * 2 * (qint64)sizeof(qint32)) THROW(FileParseException, "Transcript database '" + filename + "' has invalid size!");
+
+	//checksum
+	const uchar* payload = data + offsets_offset;
+	if (BinaryFileHeader::calculateChecksum(payload, file_size - offsets_offset)!=header.checksum) THROW(FileParseException, "Transcript database '" + filename + "' is corrupt (checksum mismatch)!");
+
+	//settings
+	if (settings!=nullptr)
+	{
+		settings->source = header.source_refseq ? "refseq" : "ensembl";
+		settings->include_all = header.include_all;
+		settings->skip_not_hgnc = header.skip_not_hgnc;
+	}
+
+	//strings
+	const qint64* offsets = reinterpret_cast<const qint64*>(data + offsets_offset);
+	const char* string_data = reinterpret_cast<const char*>(data + strings_offset);
+	QByteArrayList strings;
+	strings.reserve(header.string_count);
+	for (qint64 i=0; i<header.string_count; ++i)
+	{
+		if (offsets[i]<0 || offsets[i]>offsets[i+1] || offsets[i+1]>header.string_data_size) THROW(FileParseException, "Transcript database '" + filename + "' contains invalid string offsets!");
+		strings << QByteArray(string_data + offsets[i], offsets[i+1] - offsets[i]);
+	}
+	auto str = [&](qint32 id) -> const QByteArray&
+	{
+		if (id<0 || id>=strings.count()) THROW(FileParseException, "Transcript database '" + filename + "' contains invalid string index " + QString::number(id) + "!");
+		return strings[id];
+	};
+
+	//transcripts
+	GffData output;
+	QHash<qint32, Chromosome> chrs;
+	const qint32* exons = reinterpret_cast<const qint32*>(data + exons_offset);
+	output.transcripts.reserve(header.transcript_count);
+	if (ids!=nullptr)
+	{
+		ids->clear();
+		ids->reserve(header.transcript_count);
+	}
+	for (qint64 i=0; i<header.transcript_count; ++i)
+	{
+		TranscriptDatabaseTranscript r;
+		memcpy(&r, data + transcripts_offset + i * sizeof(TranscriptDatabaseTranscript), sizeof(TranscriptDatabaseTranscript));
+		if (r.first_exon<0 || r.exon_count<0 || r.first_exon+r.exon_count>header.exon_count) THROW(FileParseException, "Transcript database '" + filename + "' contains invalid exon range for transcript " + QString::number(i) + "!");
+
+		if (!chrs.contains(r.chr)) chrs[r.chr] = Chromosome(str(r.chr));
+		const Chromosome& chr = chrs[r.chr];
+
+		Transcript t;
+		t.setGene(str(r.gene));
+		t.setGeneId(str(r.gene_id));
+		t.setHgncId(str(r.hgnc_id));
+		t.setName(str(r.name));
+		t.setNameCcds(str(r.name_ccds));
+		t.setVersion(r.version);
+		t.setSource((Transcript::SOURCE)r.source);
+		t.setStrand((Transcript::STRAND)r.strand);
+		t.setBiotype((Transcript::BIOTYPE)r.biotype);
+		t.setPreferredTranscript(r.flags & PREFERRED);
+		t.setGencodeBasicTranscript(r.flags & GENCODE_BASIC);
+		t.setEnsemblCanonicalTranscript(r.flags & ENSEMBL_CANONICAL);
+		t.setManeSelectTranscript(r.flags & MANE_SELECT);
+		t.setManePlusClinicalTranscript(r.flags & MANE_PLUS_CLINICAL);
+		BedFile regions;
+		for (qint64 e=r.first_exon; e<r.first_exon+r.exon_count; ++e)
+		{
+			regions.append(BedLine(chr, exons[2*e], exons[2*e+1]));
+		}
+		t.setRegions(regions, r.coding_start, r.coding_end);
+		output.transcripts << t;
+		if (ids!=nullptr) *ids << r.id;
+	}
+
+	//maps
+	const qint32* enst2ensg = reinterpret_cast<const qint32*>(data + enst2ensg_offset);
+	output.enst2ensg.reserve(header.enst2ensg_count);
+	for (qint64 i=0; i<header.enst2ensg_count; ++i)
+	{
+		output.enst2ensg.insert(str(enst2ensg[2*i]), str(enst2ensg[2*i+1]));
+	}
+	const qint32* ensg2symbol = reinterpret_cast<const qint32*>(data + ensg2symbol_offset);
+	output.ensg2symbol.reserve(header.ensg2symbol_count);
+	for (qint64 i=0; i<header.ensg2symbol_count; ++i)
+	{
+		output.ensg2symbol.insert(str(ensg2symbol[2*i]), str(ensg2symbol[2*i+1]));
+	}
+
+	return output;
+}
+
+bool TranscriptDatabase::isDatabaseFile(QString filename)
+{
+	return BinaryFileHeader::hasMagic(filename, TRANSCRIPT_DATABASE_MAGIC);
+}
+
+bool TranscriptDatabase::isUpToDate(QString filename, QString source_file)
+{
+	return BinaryFileHeader::isUpToDate(filename, TRANSCRIPT_DATABASE_MAGIC, TRANSCRIPT_DATABASE_VERSION, source_file);
+}
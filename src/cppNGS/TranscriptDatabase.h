@@ -0,0 +1,25 @@
+#ifndef TRANSCRIPTDATABASE_H
+#define TRANSCRIPTDATABASE_H
+
+#include "cppNGS_global.h"
+#include "NGSHelper.h"
+
+///Binary transcript database compiled from a GFF file (transcripts with exons and coding range, ENST-ENSG and ENSG-symbol mapping).
+///The database is memory-mapped when loading and is much faster to load than parsing the GFF file. Transcripts are stored sorted by position, i.e. a ChromosomalIndex can be created directly.
+class CPPNGSSHARED_EXPORT TranscriptDatabase
+{
+public:
+	///Stores GFF data as binary transcript database. @p settings are the settings used to parse the GFF file @p source_file (both are stored for the checks on loading).
+	///@p ids are optional external transcript identifiers (e.g. NGSD transcript ids) in the order of the transcripts. If given, the transcripts have to be sorted by position already.
+	static void store(const GffData& data, const GffSettings& settings, QString filename, QString source_file = QString(), const QVector<int>& ids = QVector<int>());
+	///Loads a binary transcript database. The format version and the data checksum are checked. If @p settings is not null, the settings used to parse the GFF file are stored in it.
+	///If @p ids is not null, the external transcript identifiers are stored in it (-1 if not set).
+	static GffData load(QString filename, GffSettings* settings = nullptr, QVector<int>* ids = nullptr);
+
+	///Returns if the file is a binary transcript database.
+	static bool isDatabaseFile(QString filename);
+	///Returns if the database was created from the given GFF file and the GFF file has not changed since (size and modification time).
+	static bool isUpToDate(QString filename, QString source_file);
+};
+
+#endif // TRANSCRIPTDATABASE_H
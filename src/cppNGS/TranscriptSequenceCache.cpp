@@ -0,0 +1,58 @@
+#include "TranscriptSequenceCache.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+TranscriptSequenceCache::TranscriptSequenceCache(int max_bases)
+	: cache_(max_bases)
+	, hits_(0)
+	, misses_(0)
+{
+}
+
+void TranscriptSequenceCache::setMaxBases(int max_bases)
+{
+	QMutexLocker locker(&mutex_);
+	cache_.setMaxCost(max_bases);
+}
+
+QSharedPointer<const TranscriptSequences> TranscriptSequenceCache::get(const Transcript& trans) const
+{
+	QByteArray cache_key = key(trans);
+
+	QMutexLocker locker(&mutex_);
+	QSharedPointer<const TranscriptSequences>* cached = cache_.object(cache_key);
+	if (cached==nullptr)
+	{
+		++misses_;
+		return QSharedPointer<const TranscriptSequences>();
+	}
+
+	++hits_;
+	return *cached;
+}
+
+void TranscriptSequenceCache::insert(const Transcript& trans, QSharedPointer<const TranscriptSequences> sequences)
+{
+	QByteArray cache_key = key(trans);
+
+	QMutexLocker locker(&mutex_);
+	cache_.insert(cache_key, new QSharedPointer<const TranscriptSequences>(sequences), std::max(1, sequences->coding_sequence.length()));
+}
+
+int TranscriptSequenceCache::hits() const
+{
+	QMutexLocker locker(&mutex_);
+	return hits_;
+}
+
+int TranscriptSequenceCache::misses() const
+{
+	QMutexLocker locker(&mutex_);
+	return misses_;
+}
+
+QByteArray TranscriptSequenceCache::key(const Transcript& trans)
+{
+	return trans.name() + "." + QByteArray::number(trans.version()) + "|" + QByteArray::number(trans.source()) + "|" + trans.chr().str() + ":" + QByteArray::number(trans.start()) + "-" + QByteArray::number(trans.end())
+			+ "|" + QByteArray::number(trans.codingStart()) + "-" + QByteArray::number(trans.codingEnd()) + "|" + QByteArray::number(trans.regions().count());
+}
@@ -0,0 +1,55 @@
+#ifndef TRANSCRIPTSEQUENCECACHE_H
+#define TRANSCRIPTSEQUENCECACHE_H
+
+#include "cppNGS_global.h"
+#include "Transcript.h"
+#include "Sequence.h"
+#include <QCache>
+#include <QMutex>
+#include <QSharedPointer>
+
+///Reference sequences of a coding transcript used for HGVS annotation.
+struct CPPNGSSHARED_EXPORT TranscriptSequences
+{
+	///Coding sequence including the 3' UTR (in transcript direction, i.e. reverse-complemented for minus-strand transcripts).
+	Sequence coding_sequence;
+	///Translation of all complete codons of 'coding_sequence' in one-letter code, i.e. it does not end at the first stop codon. Invalid codons are stored as 'X'.
+	QByteArray protein;
+};
+
+///Thread-safe LRU cache of transcript sequences. The cost of an entry is the number of bases of its coding sequence.
+///NOTE: A cache must be used with one reference genome only, because the sequences are stored by transcript.
+class CPPNGSSHARED_EXPORT TranscriptSequenceCache
+{
+public:
+	///Constructor. @p max_bases is the maximum number of coding sequence bases kept in the cache.
+	TranscriptSequenceCache(int max_bases = 20000000);
+
+	///Sets the maximum number of coding sequence bases kept in the cache.
+	void setMaxBases(int max_bases);
+
+	///Returns the cached sequences of a transcript or a null pointer if the transcript is not cached.
+	QSharedPointer<const TranscriptSequences> get(const Transcript& trans) const;
+	///Adds the sequences of a transcript to the cache.
+	void insert(const Transcript& trans, QSharedPointer<const TranscriptSequences> sequences);
+
+	///Returns the number of cache hits.
+	int hits() const;
+	///Returns the number of cache misses.
+	int misses() const;
+
+protected:
+	//returns the cache key of a transcript (name and version alone are not enough, e.g. for transcripts from different sources)
+	static QByteArray key(const Transcript& trans);
+
+	mutable QCache<QByteArray, QSharedPointer<const TranscriptSequences>> cache_;
+	mutable QMutex mutex_;
+	mutable int hits_;
+	mutable int misses_;
+
+	//"declared away" methods
+	TranscriptSequenceCache(const TranscriptSequenceCache&) = delete;
+	TranscriptSequenceCache& operator=(const TranscriptSequenceCache&) = delete;
+};
+
+#endif // TRANSCRIPTSEQUENCECACHE_H
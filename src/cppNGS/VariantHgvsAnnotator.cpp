@@ -1,8 +1,9 @@
 #include "VariantHgvsAnnotator.h"
 
-VariantHgvsAnnotator::VariantHgvsAnnotator(const FastaFileIndex& genome_idx, Parameters params)
+VariantHgvsAnnotator::VariantHgvsAnnotator(const FastaFileIndex& genome_idx, Parameters params, QSharedPointer<TranscriptSequenceCache> sequence_cache)
 	: params_(params)
 	, genome_idx_(genome_idx)
+	, sequence_cache_(sequence_cache.isNull() ? QSharedPointer<TranscriptSequenceCache>(new TranscriptSequenceCache(1000000)) : sequence_cache)
 {
 }
 
@@ -910,7 +911,8 @@ QByteArray VariantHgvsAnnotator::getHgvsProteinAnnotation(const VcfLine& variant
     QByteArray aa_ref;
     QByteArray aa_obs;
     Sequence seq_obs;
-	Sequence coding_sequence = getCodingSequence(transcript, true);
+	QSharedPointer<const TranscriptSequences> sequences = getTranscriptSequences(transcript);
+	const Sequence& coding_sequence = sequences->coding_sequence;
 
     if(variant.isSNV())
 	{
@@ -919,7 +921,7 @@ QByteArray VariantHgvsAnnotator::getHgvsProteinAnnotation(const VcfLine& variant
         int offset = pos_trans_start % 3;
 
         //translate the reference sequence codon and obtain the observed sequence codon
-		aa_ref = NGSHelper::translateCodonThreeLetterCode(coding_sequence.mid(pos_trans_start - offset, 3), use_mito_table);
+		aa_ref = NGSHelper::threeLetterCode(referenceAminoAcid(*sequences, pos_trans_start - offset, use_mito_table));
         seq_obs = coding_sequence.mid(pos_trans_start - offset, 3);
         if(plus_strand)
         {
@@ -947,7 +949,7 @@ QByteArray VariantHgvsAnnotator::getHgvsProteinAnnotation(const VcfLine& variant
             bool stop_found = false;
             for(int i = pos_trans_start - offset + 3; i < coding_sequence.length() - 2; i += 3)
             {
-				if(NGSHelper::translateCodon(coding_sequence.mid(i, 3), use_mito_table) == '*')
+				if(referenceAminoAcid(*sequences, i, use_mito_table) == '*')
                 {
                     stop_found = true;
                     int stop_pos = i - (pos_trans_start - offset);
@@ -1228,7 +1230,7 @@ QByteArray VariantHgvsAnnotator::getHgvsProteinAnnotation(const VcfLine& variant
                 }
                 else
                 {
-					aa_ref.append(NGSHelper::translateCodonThreeLetterCode(coding_sequence.mid(pos_trans_start - offset + pos_shift + frame_diff, 3), use_mito_table));
+					aa_ref.append(NGSHelper::threeLetterCode(referenceAminoAcid(*sequences, pos_trans_start - offset + pos_shift + frame_diff, use_mito_table)));
                     aa_ref.append(QByteArray::number((pos_trans_start + pos_shift + frame_diff) / 3 + 1));
                 }
             }
@@ -1489,6 +1491,46 @@ Sequence VariantHgvsAnnotator::getCodingSequence(const Transcript& trans, bool a
     return seq;
 }
 
+//returns the coding sequence (with 3' UTR) and reference protein of the transcript (from the cache if possible)
+QSharedPointer<const TranscriptSequences> VariantHgvsAnnotator::getTranscriptSequences(const Transcript& trans)
+{
+	QSharedPointer<const TranscriptSequences> cached = sequence_cache_->get(trans);
+	if (!cached.isNull()) return cached;
+
+	QSharedPointer<TranscriptSequences> sequences(new TranscriptSequences());
+	sequences->coding_sequence = getCodingSequence(trans, true);
+
+	//translate complete codons (invalid codons are translated on demand in referenceAminoAcid, which throws an exception)
+	const Sequence& seq = sequences->coding_sequence;
+	bool is_mito = trans.chr().isM();
+	sequences->protein.reserve(seq.length() / 3);
+	for (int i=0; i+2<seq.length(); i+=3)
+	{
+		const char* codon = seq.constData() + i;
+		bool valid = true;
+		for (int j=0; j<3; ++j)
+		{
+			if (codon[j]!='A' && codon[j]!='C' && codon[j]!='G' && codon[j]!='T') valid = false;
+		}
+		sequences->protein.append(valid ? NGSHelper::translateCodon(seq.mid(i, 3), is_mito) : 'X');
+	}
+
+	sequence_cache_->insert(trans, sequences);
+	return sequences;
+}
+
+//returns the one-letter code of the reference amino acid of the codon starting at the given position of the coding sequence
+char VariantHgvsAnnotator::referenceAminoAcid(const TranscriptSequences& sequences, int codon_start, bool is_mito)
+{
+	if (codon_start>=0 && codon_start%3==0 && codon_start/3<sequences.protein.length())
+	{
+		char aa = sequences.protein[codon_start/3];
+		if (aa!='X') return aa;
+	}
+
+	return NGSHelper::translateCodon(sequences.coding_sequence.mid(codon_start, 3), is_mito);
+}
+
 //Returns the variant types as string (ordered alphabetically)
 QByteArray VariantConsequence::typesToString(QByteArray sep) const
 {
@@ -11,6 +11,7 @@
 #include "NGSHelper.h"
 #include "Exceptions.h"
 #include "VariantImpact.h"
+#include "TranscriptSequenceCache.h"
 
 ///Representation of the effect of a variant
 ///NOTE: the order is important as it defines the severity of the variant.
@@ -116,7 +117,8 @@ public:
 	};
 
     ///Constructor to change parameters for detecting up/downstream and splice region variants: different for 5 and 3 prime site intron
-	VariantHgvsAnnotator(const FastaFileIndex& genome_idx, Parameters params = Parameters());
+	///The coding sequence and reference protein of transcripts are cached in @p sequence_cache, which can be shared between annotators/threads. If unset, each annotator uses its own cache.
+	VariantHgvsAnnotator(const FastaFileIndex& genome_idx, Parameters params = Parameters(), QSharedPointer<TranscriptSequenceCache> sequence_cache = QSharedPointer<TranscriptSequenceCache>());
 
 	///Calculates variant consequence from VCF-style variant (not multi-allelic)
 	VariantConsequence annotate(const Transcript& transcript, const VcfLine& variant, bool debug=false);
@@ -129,6 +131,7 @@ public:
 private:
 	Parameters params_;
 	const FastaFileIndex& genome_idx_;
+	QSharedPointer<TranscriptSequenceCache> sequence_cache_;
 
 	QByteArray annotateRegionsCoding(const Transcript& transcript, VariantConsequence& hgvs, int gen_pos, bool is_dup, bool debug=false);
 	QByteArray annotateRegionsNonCoding(const Transcript& transcript, VariantConsequence& hgvs, int gen_pos, bool is_dup = false);
@@ -145,6 +148,8 @@ private:
 	QByteArray translate(const Sequence& seq, bool is_mito = false, bool end_at_stop = true);
 
 	Sequence getCodingSequence(const Transcript& trans, bool add_utr_3 = false);
+	QSharedPointer<const TranscriptSequences> getTranscriptSequences(const Transcript& trans);
+	static char referenceAminoAcid(const TranscriptSequences& sequences, int codon_start, bool is_mito);
 };
 
 #endif // VARIANTHGVSANNOTATOR_H
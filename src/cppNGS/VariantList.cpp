@@ -6,12 +6,16 @@
 #include "ChromosomalIndex.h"
 #include "NGSHelper.h"
 #include "VcfFile.h"
+#include "BinaryFileHeader.h"
 
 #include <QFile>
 #include <QTextStream>
 #include <QRegExp>
 #include <QBitArray>
 #include <QUrl>
+#include <QDataStream>
+#include <QCoreApplication>
+#include <cstring>
 
 #include <zlib.h>
 
@@ -524,13 +528,40 @@ bool VariantList::LessComparator::operator()(const Variant& a, const Variant& b)
 }
 
 
+QAtomicInteger<quint64> VariantList::next_generation_(1);
+
 VariantList::VariantList()
 	: comments_()
 	, annotation_descriptions_()
 	, annotation_headers_()
 	, filters_()
 	, variants_()
+	, generation_(0)
+{
+	markModified();
+}
+
+VariantList::VariantList(const VariantList& rhs)
+	: comments_(rhs.comments_)
+	, annotation_descriptions_(rhs.annotation_descriptions_)
+	, annotation_headers_(rhs.annotation_headers_)
+	, filters_(rhs.filters_)
+	, variants_(rhs.variants_)
+	, generation_(0)
+{
+	markModified();
+}
+
+VariantList& VariantList::operator=(const VariantList& rhs)
 {
+	comments_ = rhs.comments_;
+	annotation_descriptions_ = rhs.annotation_descriptions_;
+	annotation_headers_ = rhs.annotation_headers_;
+	filters_ = rhs.filters_;
+	variants_ = rhs.variants_;
+	markModified();
+
+	return *this;
 }
 
 QString VariantList::analysisName() const
@@ -693,6 +724,7 @@ int VariantList::addAnnotation(QString name, QString description, QByteArray def
 	{
 		variants_[i].annotations().push_back(default_value);
 	}
+	markModified();
 
 	annotationDescriptions().append(VariantAnnotationDescription(name, description));
 
@@ -729,6 +761,7 @@ int VariantList::prependAnnotation(QString name, QString description, QByteArray
 	{
 		variants_[i].annotations().prepend(default_value);
 	}
+	markModified();
 
 	annotationDescriptions().prepend(VariantAnnotationDescription(name, description));
 
@@ -747,6 +780,7 @@ void VariantList::removeAnnotation(int index)
 	{
 		variants_[i].annotations().removeAt(index);
 	}
+	markModified();
 }
 
 void VariantList::removeAnnotationByName(QString name, bool exact_match, bool error_on_mismatch)
@@ -968,6 +1002,319 @@ void VariantList::store(QString filename) const
 	}
 }
 
+//header of binary variant list files. It is followed by these sections, each padded to a multiple of 8 bytes:
+//meta data (QDataStream), chromosome blocks, start/end/ref/obs columns, annotation columns (column-major), string offsets, string pool
+struct VariantListBinaryHeader
+	: public BinaryFileHeader
+{
+	qint64 meta_size;
+	qint64 variant_count;
+	qint64 column_count;
+	qint64 block_count;
+	qint64 string_count;
+	qint64 pool_size;
+};
+
+//consecutive variants on the same chromosome (chromosomal index of binary variant list files)
+struct VariantListBinaryBlock
+{
+	qint64 first;
+	qint64 count;
+	qint32 chr;
+	qint32 reserved;
+};
+
+static const char VARIANT_LIST_BINARY_MAGIC[8] = {'G', 'S', 'V', 'A', 'R', 'B', 'I', 'N'};
+static const quint32 VARIANT_LIST_BINARY_VERSION = 2;
+
+void VariantList::loadWithCache(QString filename)
+{
+	QString cache_file = binaryCacheFile(filename);
+	if (binaryCacheIsValid(filename))
+	{
+		try
+		{
+			loadBinary(cache_file);
+			return;
+		}
+		catch(Exception& e)
+		{
+			Log::warn("Could not load variant list cache file '" + cache_file + "': " + e.message());
+		}
+	}
+
+	loadInternal(filename);
+
+	//create cache file (written to a temporary file first so that no incomplete cache file is used - the process ID avoids clashes when several processes create the cache file)
+	QString tmp_file = cache_file + "." + QString::number(QCoreApplication::applicationPid()) + ".tmp";
+	try
+	{
+		storeBinary(tmp_file, filename);
+		QFile::remove(cache_file);
+		if (!QFile::rename(tmp_file, cache_file)) THROW(FileAccessException, "Could not rename '" + tmp_file + "' to '" + cache_file + "'!");
+	}
+	catch(Exception& e)
+	{
+		QFile::remove(tmp_file);
+		Log::warn("Could not write variant list cache file '" + cache_file + "': " + e.message());
+	}
+}
+
+void VariantList::loadBinary(QString filename, const BedFile* roi, bool invert)
+{
+	//create ROI index (if given)
+	QScopedPointer<ChromosomalIndex<BedFile>> roi_idx;
+	if (roi!=nullptr)
+	{
+		if (!roi->isSorted())
+		{
+			THROW(ArgumentException, "Target region unsorted, but needs to be sorted (given for reading file " + filename + ")!");
+		}
+		roi_idx.reset(new ChromosomalIndex<BedFile>(*roi));
+	}
+
+	//remove old data
+	clear();
+
+	//memory-map file (if that is not possible, we read it into memory)
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) THROW(FileAccessException, "Could not open binary variant list '" + filename + "' for reading!");
+	qint64 file_size = file.size();
+	QByteArray file_data;
+	const uchar* data = BinaryFileHeader::map(file, file_data);
+
+	//header
+	if (file_size<(qint64)sizeof(VariantListBinaryHeader)) THROW(FileParseException, "Binary variant list '" + filename + "' is truncated!");
+	VariantListBinaryHeader header;
+	memcpy(&header, data, sizeof(VariantListBinaryHeader));
+	header.check(VARIANT_LIST_BINARY_MAGIC, VARIANT_LIST_BINARY_VERSION, filename, "binary variant list");
+
+	if (header.meta_size<0 || header.variant_count<0 || header.column_count<0 || header.block_count<0 || header.string_count<0 || header.pool_size<0
+		|| header.meta_size>file_size || header.variant_count>file_size || header.column_count>file_size || header.block_count>file_size || header.string_count>file_size || header.pool_size>file_size)
+	{
+		THROW(FileParseException, "Binary variant list '" + filename + "' has invalid header!");
+	}
+
+	const qint64 n = header.variant_count;
+	const qint64 meta_offset = sizeof(VariantListBinaryHeader);
+	const qint64 blocks_offset = meta_offset + BinaryFileHeader::paddedSize(header.meta_size);
+	const qint64 columns_offset = blocks_offset + header.block_count * (qint64)sizeof(VariantListBinaryBlock);
+	const qint64 annotations_offset = columns_offset + BinaryFileHeader::paddedSize(4 * n * (qint64)sizeof(qint32));
+	const qint64 string_offsets_offset = annotations_offset + BinaryFileHeader::paddedSize(header.column_count * n * (qint64)sizeof(qint32));
+	const qint64 pool_offset = string_offsets_offset + (header.string_count + 1) * (qint64)sizeof(qint64);
+	if (file_size!=pool_offset + header.pool_size) THROW(FileParseException, "Binary variant list '" + filename + "' has invalid size!");
+	if (BinaryFileHeader::calculateChecksum(data + meta_offset, file_size - meta_offset)!=header.checksum) THROW(FileParseException, "Binary variant list '" + filename + "' is corrupt (checksum mismatch)!");
+
+	//meta data
+	QByteArray meta = QByteArray::fromRawData(reinterpret_cast<const char*>(data + meta_offset), header.meta_size);
+	QDataStream meta_stream(meta);
+	meta_stream.setVersion(QDataStream::Qt_5_0);
+	meta_stream >> comments_;
+	qint32 description_count = 0;
+	meta_stream >> description_count;
+	for (int i=0; i<description_count; ++i)
+	{
+		QString name;
+		QString description;
+		qint32 type;
+		meta_stream >> name >> description >> type;
+		annotation_descriptions_.append(VariantAnnotationDescription(name, description, (VariantAnnotationDescription::AnnotationType)type));
+	}
+	meta_stream >> filters_;
+	QStringList column_names;
+	meta_stream >> column_names;
+	if (meta_stream.status()!=QDataStream::Ok || column_names.count()!=header.column_count) THROW(FileParseException, "Binary variant list '" + filename + "' contains invalid meta data!");
+	int filter_index = -1;
+	for (int i=0; i<column_names.count(); ++i)
+	{
+		if (column_names[i]=="filter")
+		{
+			filter_index = i;
+		}
+		annotation_headers_.append(VariantAnnotationHeader(column_names[i]));
+	}
+
+	//strings are copied from the pool when they are first used - variants share them via implicit sharing
+	const qint64* string_offsets = reinterpret_cast<const qint64*>(data + string_offsets_offset);
+	const char* pool = reinterpret_cast<const char*>(data + pool_offset);
+	QVector<QByteArray> strings(header.string_count);
+	QBitArray string_created(header.string_count);
+	auto string = [&](qint32 id) -> const QByteArray&
+	{
+		if (id<0 || id>=header.string_count) THROW(FileParseException, "Binary variant list '" + filename + "' contains invalid string index " + QString::number(id) + "!");
+		if (!string_created.testBit(id))
+		{
+			if (string_offsets[id]<0 || string_offsets[id]>string_offsets[id+1] || string_offsets[id+1]>header.pool_size) THROW(FileParseException, "Binary variant list '" + filename + "' contains invalid string offsets!");
+			strings[id] = QByteArray(pool + string_offsets[id], string_offsets[id+1] - string_offsets[id]);
+			string_created.setBit(id);
+		}
+		return strings[id];
+	};
+
+	//variants
+	const VariantListBinaryBlock* blocks = reinterpret_cast<const VariantListBinaryBlock*>(data + blocks_offset);
+	const qint32* starts = reinterpret_cast<const qint32*>(data + columns_offset);
+	const qint32* ends = starts + n;
+	const qint32* refs = ends + n;
+	const qint32* obs = refs + n;
+	const qint32* annotation_ids = reinterpret_cast<const qint32*>(data + annotations_offset);
+	if (roi_idx==nullptr) variants_.reserve(n);
+	for (int b=0; b<header.block_count; ++b)
+	{
+		const VariantListBinaryBlock& block = blocks[b];
+		if (block.first<0 || block.count<0 || block.first+block.count>n) THROW(FileParseException, "Binary variant list '" + filename + "' contains invalid chromosome block " + QString::number(b) + "!");
+		Chromosome chr = string(block.chr);
+		for (qint64 i=block.first; i<block.first+block.count; ++i)
+		{
+			//Skip variants that are not in the target region (if given)
+			if (roi_idx!=nullptr)
+			{
+				bool in_roi = roi_idx->matchingIndex(chr, starts[i], ends[i])!=-1;
+				if ((!in_roi && !invert) || (in_roi && invert))
+				{
+					continue;
+				}
+			}
+
+			QList<QByteArray> annotations;
+			annotations.reserve(header.column_count);
+			for (qint64 c=0; c<header.column_count; ++c)
+			{
+				annotations << string(annotation_ids[c * n + i]);
+			}
+
+			append(Variant(chr, starts[i], ends[i], string(refs[i]), string(obs[i]), annotations, filter_index));
+		}
+	}
+}
+
+void VariantList::storeBinary(QString filename, QString source_file) const
+{
+	//string pool
+	QHash<QByteArray, qint32> string_ids;
+	QByteArrayList strings;
+	auto stringId = [&](const QByteArray& str)
+	{
+		auto it = string_ids.find(str);
+		if (it==string_ids.end())
+		{
+			it = string_ids.insert(str, strings.count());
+			strings << str;
+		}
+		return it.value();
+	};
+
+	//chromosome blocks
+	QVector<VariantListBinaryBlock> blocks;
+	for (int i=0; i<variants_.count(); ++i)
+	{
+		qint32 chr = stringId(variants_[i].chr().str());
+		if (blocks.isEmpty() || blocks.last().chr!=chr)
+		{
+			VariantListBinaryBlock block;
+			block.first = i;
+			block.count = 0;
+			block.chr = chr;
+			block.reserved = 0;
+			blocks << block;
+		}
+		++blocks.last().count;
+	}
+
+	//variant and annotation columns
+	const qint64 n = variants_.count();
+	const qint64 column_count = annotation_headers_.count();
+	std::vector<qint32> columns(4 * n);
+	std::vector<qint32> annotation_ids(column_count * n);
+	for (int i=0; i<n; ++i)
+	{
+		const Variant& v = variants_[i];
+		if (v.annotations().count()!=column_count) THROW(ArgumentException, "Variant " + v.toString() + " has " + QString::number(v.annotations().count()) + " annotations, but " + QString::number(column_count) + " are expected!");
+
+		columns[i] = v.start();
+		columns[n + i] = v.end();
+		columns[2 * n + i] = stringId(v.ref());
+		columns[3 * n + i] = stringId(v.obs());
+		for (int c=0; c<column_count; ++c)
+		{
+			annotation_ids[c * n + i] = stringId(v.annotations()[c]);
+		}
+	}
+
+	//meta data
+	QByteArray meta;
+	QDataStream meta_stream(&meta, QIODevice::WriteOnly);
+	meta_stream.setVersion(QDataStream::Qt_5_0);
+	meta_stream << comments_;
+	meta_stream << (qint32)annotation_descriptions_.count();
+	foreach(const VariantAnnotationDescription& description, annotation_descriptions_)
+	{
+		meta_stream << description.name() << description.description() << (qint32)description.type();
+	}
+	meta_stream << filters_;
+	QStringList column_names;
+	foreach(const VariantAnnotationHeader& column, annotation_headers_)
+	{
+		column_names << column.name();
+	}
+	meta_stream << column_names;
+
+	//string offsets
+	std::vector<qint64> string_offsets(strings.count() + 1, 0);
+	for (int i=0; i<strings.count(); ++i)
+	{
+		string_offsets[i+1] = string_offsets[i] + strings[i].size();
+	}
+
+	//header
+	VariantListBinaryHeader header;
+	memset(&header, 0, sizeof(VariantListBinaryHeader));
+	header.init(VARIANT_LIST_BINARY_MAGIC, VARIANT_LIST_BINARY_VERSION, source_file);
+	header.meta_size = meta.size();
+	header.variant_count = n;
+	header.column_count = column_count;
+	header.block_count = blocks.count();
+	header.string_count = strings.count();
+	header.pool_size = string_offsets.back();
+
+	//write (the header is written again at the end, when the checksum is known)
+	QSharedPointer<QFile> file = Helper::openFileForWriting(filename);
+	quint32 checksum = 0;
+	auto write = [&](const void* section, qint64 size, bool pad)
+	{
+		if (size>0 && file->write(reinterpret_cast<const char*>(section), size)!=size) THROW(FileAccessException, "Could not write binary variant list '" + filename + "'!");
+		checksum = BinaryFileHeader::calculateChecksum(reinterpret_cast<const uchar*>(section), size, checksum);
+		if (pad && size%8!=0)
+		{
+			QByteArray padding(8 - size%8, '\0');
+			file->write(padding);
+			checksum = BinaryFileHeader::calculateChecksum(reinterpret_cast<const uchar*>(padding.constData()), padding.size(), checksum);
+		}
+	};
+	if (file->write(reinterpret_cast<const char*>(&header), sizeof(VariantListBinaryHeader))!=sizeof(VariantListBinaryHeader)) THROW(FileAccessException, "Could not write binary variant list '" + filename + "'!");
+	write(meta.constData(), meta.size(), true);
+	write(blocks.constData(), blocks.count() * (qint64)sizeof(VariantListBinaryBlock), true);
+	write(columns.data(), columns.size() * sizeof(qint32), true);
+	write(annotation_ids.data(), annotation_ids.size() * sizeof(qint32), true);
+	write(string_offsets.data(), string_offsets.size() * sizeof(qint64), true);
+	foreach(const QByteArray& str, strings)
+	{
+		write(str.constData(), str.size(), false);
+	}
+	header.checksum = checksum;
+	if (!file->seek(0) || file->write(reinterpret_cast<const char*>(&header), sizeof(VariantListBinaryHeader))!=sizeof(VariantListBinaryHeader)) THROW(FileAccessException, "Could not write binary variant list '" + filename + "'!");
+}
+
+QString VariantList::binaryCacheFile(QString filename)
+{
+	return filename + ".cache";
+}
+
+bool VariantList::binaryCacheIsValid(QString filename)
+{
+	return BinaryFileHeader::isUpToDate(binaryCacheFile(filename), VARIANT_LIST_BINARY_MAGIC, VARIANT_LIST_BINARY_VERSION, filename);
+}
+
 void VariantList::sort()
 {
 	sortCustom(LessComparator());
@@ -1009,6 +1356,7 @@ void VariantList::removeDuplicates()
 
 	//swap the old and new vector
 	variants_.swap(output);
+	markModified();
 }
 
 void VariantList::clear()
@@ -1027,11 +1375,13 @@ void VariantList::clearAnnotations()
 	{
 		variants_[i].annotations().clear();
 	}
+	markModified();
 }
 
 void VariantList::clearVariants()
 {
 	variants_.clear();
+	markModified();
 }
 
 void VariantList::leftAlign(QString ref_file)
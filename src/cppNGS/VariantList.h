@@ -9,6 +9,7 @@
 #include "GenomeBuild.h"
 #include "VcfLine.h"
 #include "VariantImpact.h"
+#include <QAtomicInteger>
 
 ///Variant caller information
 struct VariantCaller
@@ -270,6 +271,10 @@ class CPPNGSSHARED_EXPORT VariantList
 public:
     ///Default constructor
     VariantList();
+	///Copy constructor. The copy gets a new generation, so that it can be distinguished from the original.
+	VariantList(const VariantList& rhs);
+	///Assignment operator. The list gets a new generation.
+	VariantList& operator=(const VariantList& rhs);
 
 	///Returns the human readable name of the analysis, e.g. for showning in a GUI.
 	QString analysisName() const;
@@ -283,11 +288,13 @@ public:
     void append(const Variant& variant)
     {
         variants_.append(variant);
+        markModified();
     }
     ///Removes the variant with the index @p index.
     void remove(int index)
     {
         variants_.remove(index);
+        markModified();
     }
     ///Variant accessor to a single variant.
     const Variant& operator[](int index) const
@@ -308,6 +315,7 @@ public:
 	void resize(int size)
 	{
 		variants_.resize(size);
+		markModified();
 	}
 	///Reserves space for a defined number of variants.
 	void reserve(int size)
@@ -315,6 +323,18 @@ public:
 		variants_.reserve(size);
 	}
 
+	///Returns the modification generation of the variant list. It changes when variants are added, removed, re-ordered or loaded and when markModified() is called.
+	///Data derived from the variants (e.g. by FilterColumnCache) is up-to-date as long as the generation does not change.
+	quint64 generation() const
+	{
+		return generation_;
+	}
+	///Marks the variant list as modified. Has to be called after variants were changed via the read-write accessor.
+	void markModified()
+	{
+		generation_ = next_generation_.fetchAndAddRelaxed(1);
+	}
+
     ///Adds a comment line.
     void addCommentLine(QString comment_line)
     {
@@ -390,6 +410,18 @@ public:
 	///Stores the variant list to a file. If filename is empty, writes to STDOUT.
 	void store(QString filename) const;
 
+	///Loads a variant list from the binary cache file of @p filename if it is up-to-date. Otherwise, the TSV file is loaded and the cache file is (re-)created. Errors during writing the cache file are ignored, e.g. if the folder is not writable.
+	void loadWithCache(QString filename);
+	///Loads a variant list in binary format (see storeBinary). If @p roi is given, only variants that fall into the target regions are loaded. If @p invert is given, only variants that fall outside the target regions are loaded.
+	void loadBinary(QString filename, const BedFile* roi = nullptr, bool invert=false);
+	///Stores the variant list in binary format: string pool of unique strings, per-column annotation string indices and chromosome blocks. The binary file is memory-mapped when loaded.
+	///If @p source_file is given, its size and modification time is stored to check if the binary file is up-to-date.
+	void storeBinary(QString filename, QString source_file = QString()) const;
+	///Returns the binary cache file name for a variant list file.
+	static QString binaryCacheFile(QString filename);
+	///Returns if the binary cache file of a variant list file exists and belongs to the current version of the variant list file.
+	static bool binaryCacheIsValid(QString filename);
+
 	///Default sorting of variants. The order is chromosome (numeric), position, ref, obs.
 	void sort();
 	///Sort list alphabetically by annotation
@@ -401,6 +433,7 @@ public:
 	void sortCustom(const T& comarator)
 	{
 		std::sort(variants_.begin(), variants_.end(), comarator);
+		markModified();
 	}
 
     ///Remove duplicate variants.
@@ -451,6 +484,8 @@ protected:
 	QList<VariantAnnotationHeader> annotation_headers_;
 	QMap<QString, QString> filters_;
     QVector<Variant> variants_;
+	quint64 generation_;
+	static QAtomicInteger<quint64> next_generation_;
 
 	void loadInternal(QString filename, const BedFile* roi = nullptr, bool invert=false, bool header_only=false);
 
@@ -1,7 +1,14 @@
 #include "VcfFile.h"
 #include "Helper.h"
 #include <QFileInfo>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QRunnable>
 #include <zlib.h>
+#include <cstring>
+#include <functional>
+#include <exception>
+#include "htslib/kstring.h"
 
 VcfFile::VcfFile()
 	: vcf_lines_()
@@ -307,8 +314,14 @@ void VcfFile::processVcfLine(int& line_number, const QByteArray& line, QSet<QByt
 }
 
 //zlib also opens BGZF files (if index is not needed)
-void VcfFile::loadFromVCFGZ(const QString& filename, bool allow_multi_sample, ChromosomalIndex<BedFile>* roi_idx, bool invert)
+void VcfFile::loadFromVCFGZ(const QString& filename, bool allow_multi_sample, ChromosomalIndex<BedFile>* roi_idx, bool invert, int threads)
 {
+	if (threads>1 && !Helper::isHttpUrl(filename))
+	{
+		loadParallel(filename, allow_multi_sample, roi_idx, invert, threads);
+		return;
+	}
+
 	//clear content in case we load a second file
 	clear();
 
@@ -377,12 +390,160 @@ void VcfFile::loadFromVCFGZ(const QString& filename, bool allow_multi_sample, Ch
 	}
 }
 
-void VcfFile::load(const QString& filename, bool allow_multi_sample)
+//Runnable that executes a parse job and releases a slot of the semaphore afterwards
+class VcfParseJob
+	: public QRunnable
+{
+public:
+	VcfParseJob(std::function<void()> job, QSemaphore& free_slots)
+		: job_(job)
+		, free_slots_(free_slots)
+	{
+	}
+
+	void run() override
+	{
+		job_();
+		free_slots_.release();
+	}
+
+private:
+	std::function<void()> job_;
+	QSemaphore& free_slots_;
+};
+
+void VcfFile::loadParallel(const QString& filename, bool allow_multi_sample, ChromosomalIndex<BedFile>* roi_idx, bool invert, int threads, int chunk_lines)
+{
+	//clear content in case we load a second file
+	clear();
+
+	//open file - BGZF blocks are decompressed in parallel (plain VCF and non-blocked GZ files are read without threads)
+	BGZF* instream = filename.isEmpty() ? bgzf_dopen(fileno(stdin), "r") : bgzf_open(filename.toUtf8().constData(), "r");
+	if (instream==nullptr) THROW(FileAccessException, "Could not open file '" + filename + "' for reading!");
+	if (bgzf_mt(instream, threads, 256)!=0)
+	{
+		bgzf_close(instream);
+		THROW(FileAccessException, "Could not enable multi-threaded decompression for file '" + filename + "'!");
+	}
+
+	//chunk of variant lines that is parsed by a worker thread. Each thread uses its own string cache.
+	struct ParseChunk
+	{
+		VcfFile file; //parsed lines and header lines added during parsing
+		QByteArrayList lines;
+		QVector<int> line_numbers;
+		std::exception_ptr error;
+	};
+	QVector<QSharedPointer<ParseChunk>> chunks;
+
+	//the pool is destroyed at the end of loading, which also releases the string caches of its threads
+	QThreadPool pool;
+	pool.setMaxThreadCount(threads);
+	QSemaphore free_slots(2 * threads);
+	QSharedPointer<ParseChunk> chunk;
+	auto parseChunk = [&]()
+	{
+		if (chunk.isNull()) return;
+
+		QSharedPointer<ParseChunk> c = chunk;
+		free_slots.acquire();
+		pool.start(new VcfParseJob([c, allow_multi_sample, roi_idx, invert]()
+		{
+			try
+			{
+				QSet<QByteArray> info_ids;
+				QSet<QByteArray> format_ids;
+				QSet<QByteArray> filter_ids;
+				c->file.addMissingHeaderLines(c->file.vcf_header_, info_ids, format_ids, filter_ids);
+				for (int i=0; i<c->lines.count(); ++i)
+				{
+					c->file.parseVcfEntry(c->line_numbers[i], c->lines[i], info_ids, format_ids, filter_ids, allow_multi_sample, roi_idx, invert);
+				}
+			}
+			catch(...)
+			{
+				c->error = std::current_exception();
+			}
+			c->lines.clear();
+			c->line_numbers.clear();
+		}, free_slots));
+
+		chunks << chunk;
+		chunk.reset();
+	};
+
+	//read lines: header lines are parsed directly, variant lines in chunks
+	int line_number = 0;
+	QSet<QByteArray> info_ids;
+	QSet<QByteArray> format_ids;
+	QSet<QByteArray> filter_ids;
+	kstring_t buffer = {0, 0, nullptr};
+	int result;
+	try
+	{
+		while((result = bgzf_getline(instream, '\n', &buffer))>=0)
+		{
+			//determine end of read line
+			int length = buffer.l;
+			const char* carriage_return = static_cast<const char*>(memchr(buffer.s, '\r', length));
+			if (carriage_return!=nullptr) length = carriage_return - buffer.s;
+			QByteArray line = QByteArray::fromRawData(buffer.s, length);
+
+			if (line.startsWith("##") || line.startsWith("#CHROM") || line.trimmed().isEmpty())
+			{
+				processVcfLine(line_number, line, info_ids, format_ids, filter_ids, allow_multi_sample, roi_idx, invert);
+				continue;
+			}
+
+			++line_number;
+			if (chunk.isNull())
+			{
+				chunk.reset(new ParseChunk());
+				chunk->file.copyMetaData(*this);
+				chunk->lines.reserve(chunk_lines);
+				chunk->line_numbers.reserve(chunk_lines);
+			}
+			chunk->lines << QByteArray(line.constData(), line.size());
+			chunk->line_numbers << line_number;
+			if (chunk->lines.count()>=chunk_lines) parseChunk();
+		}
+		if (result<-1) THROW(FileParseException, "Error while reading file '" + filename + "'!");
+		parseChunk();
+	}
+	catch(...)
+	{
+		pool.waitForDone();
+		free(buffer.s);
+		bgzf_close(instream);
+		throw;
+	}
+	pool.waitForDone();
+	free(buffer.s);
+	bgzf_close(instream);
+
+	//merge chunks in the order of the input file (header lines added during parsing are added in the order of the input file, too)
+	int line_count = 0;
+	foreach(const QSharedPointer<ParseChunk>& c, chunks)
+	{
+		line_count += c->file.vcf_lines_.count();
+	}
+	vcf_lines_.reserve(line_count);
+	foreach(const QSharedPointer<ParseChunk>& c, chunks)
+	{
+		if (c->error) std::rethrow_exception(c->error);
+
+		addMissingHeaderLines(c->file.vcf_header_, info_ids, format_ids, filter_ids);
+		vcf_lines_.append(c->file.vcf_lines_);
+		c->file.clear();
+	}
+}
+
+void VcfFile::load(const QString& filename, bool allow_multi_sample, int threads)
 {
-	loadFromVCFGZ(filename, allow_multi_sample);
+	loadFromVCFGZ(filename, allow_multi_sample, nullptr, false, threads);
 }
 
-void VcfFile::load(const QString& filename, const BedFile& roi, bool allow_multi_sample, bool invert)
+void VcfFile::load(const QString& filename, const BedFile& roi, bool allow_multi_sample, bool invert, int threads)
 {
 	//create ROI index (if given)
 	QScopedPointer<ChromosomalIndex<BedFile>> roi_idx;
@@ -392,7 +553,7 @@ void VcfFile::load(const QString& filename, const BedFile& roi, bool allow_multi
 	}
 	roi_idx.reset(new ChromosomalIndex<BedFile>(roi));
 
-	loadFromVCFGZ(filename, allow_multi_sample, roi_idx.data(), invert);
+	loadFromVCFGZ(filename, allow_multi_sample, roi_idx.data(), invert, threads);
 }
 
 void VcfFile::storeAsTsv(const QString& filename)
@@ -582,6 +743,226 @@ void VcfFile::sortByFile(QString fai_file)
 	sortCustom(LessComparatorByFile(fai_file));
 }
 
+void VcfFile::sortExternal(QString in, QString out, const ExternalSortSettings& settings, bool use_quality, QString fai_file, bool remove_unused_contigs, int compression_level)
+{
+	if (compression_level!=BGZF_NO_COMPRESSION && (compression_level<0 || compression_level>9)) THROW(ArgumentException, "Invalid gzip compression level '" + QString::number(compression_level) +"' given for VCF file '" + out + "'!");
+
+	ExternalSortRuns runs(settings);
+	QSharedPointer<LessComparatorByFile> comparator_by_file;
+	if (!fai_file.isEmpty()) comparator_by_file.reset(new LessComparatorByFile(fai_file));
+
+	//chunk of variants that is parsed, sorted and written to a run by a worker thread
+	struct SortChunk
+	{
+		VcfFile file; //also contains the header lines added during parsing
+		QByteArrayList lines;
+		QVector<int> line_numbers;
+		QSet<QByteArray> chromosomes;
+	};
+	QVector<QSharedPointer<SortChunk>> chunks;
+
+	VcfFile header;
+	QSharedPointer<SortChunk> chunk;
+	qint64 chunk_size = 0;
+	auto sortChunk = [&]()
+	{
+		if (chunk.isNull()) return;
+
+		QString run_file = runs.addRun();
+		bool compress = settings.compress_runs;
+		QSharedPointer<SortChunk> c = chunk;
+		runs.execute([c, run_file, compress, use_quality, comparator_by_file]()
+		{
+			//parse
+			QSet<QByteArray> info_ids;
+			foreach(const InfoFormatLine& info, c->file.vcf_header_.infoLines()) info_ids << info.id;
+			QSet<QByteArray> format_ids;
+			foreach(const InfoFormatLine& format, c->file.vcf_header_.formatLines()) format_ids << format.id;
+			QSet<QByteArray> filter_ids;
+			foreach(const FilterLine& filter, c->file.vcf_header_.filterLines()) filter_ids << filter.id;
+			for (int i=0; i<c->lines.count(); ++i)
+			{
+				c->file.parseVcfEntry(c->line_numbers[i], c->lines[i], info_ids, format_ids, filter_ids, true, nullptr);
+			}
+			c->lines.clear();
+			c->line_numbers.clear();
+
+			//sort
+			if (comparator_by_file.isNull())
+			{
+				c->file.sort(use_quality);
+			}
+			else
+			{
+				c->file.sortCustom(*comparator_by_file);
+			}
+
+			//write run
+			ExternalSortRuns::Writer writer(run_file, compress);
+			QString text;
+			QTextStream stream(&text);
+			foreach(const VcfLine& line, c->file.vcf_lines_)
+			{
+				c->chromosomes << line.chr().str();
+				c->file.storeLineInformation(stream, line);
+				if (text.size()>1048576)
+				{
+					stream.flush();
+					writer.write(text.toUtf8());
+					text.clear();
+				}
+			}
+			stream.flush();
+			writer.write(text.toUtf8());
+			writer.close();
+
+			c->file.vcf_lines_.clear();
+		});
+
+		chunks << chunk;
+		chunk.reset();
+		chunk_size = 0;
+	};
+
+	//read input: parse header and create sorted runs
+	ExternalSortRuns::Reader reader(in);
+	QByteArray line;
+	int line_number = 0;
+	while(reader.readLine(line))
+	{
+		++line_number;
+		while (line.endsWith('\r')) line.chop(1);
+
+		//skip empty lines
+		if(line.trimmed().isEmpty()) continue;
+
+		//header
+		if (line.startsWith("##"))
+		{
+			header.parseVcfHeader(line_number, line);
+			continue;
+		}
+		if (line.startsWith("#CHROM"))
+		{
+			header.parseHeaderFields(line, true);
+			continue;
+		}
+
+		//variant
+		if (chunk.isNull())
+		{
+			chunk.reset(new SortChunk());
+			chunk->file.copyMetaData(header);
+		}
+		chunk->lines << line;
+		chunk->line_numbers << line_number;
+		chunk_size += line.size();
+		if (chunk_size>=settings.buffer_size) sortChunk();
+	}
+	sortChunk();
+	runs.waitForJobs();
+
+	//add header lines that were added during parsing (in the order of the input file)
+	QSet<QByteArray> info_ids;
+	QSet<QByteArray> format_ids;
+	QSet<QByteArray> filter_ids;
+	header.addMissingHeaderLines(header.vcf_header_, info_ids, format_ids, filter_ids);
+	QSet<QByteArray> chromosomes;
+	foreach(const QSharedPointer<SortChunk>& c, chunks)
+	{
+		header.addMissingHeaderLines(c->file.vcf_header_, info_ids, format_ids, filter_ids);
+		chromosomes.unite(c->chromosomes);
+	}
+	chunks.clear();
+
+	//remove unused contig headers
+	if (remove_unused_contigs)
+	{
+		header.removeUnusedContigHeaders(chromosomes);
+	}
+
+	//open output
+	QSharedPointer<QFile> outfile;
+	BGZF* outstream = nullptr;
+	if (compression_level==BGZF_NO_COMPRESSION)
+	{
+		outfile = Helper::openFileForWriting(out, true);
+	}
+	else
+	{
+		if (out.isEmpty()) THROW(ArgumentException, "Conflicting parameters for empty filename and compression level > 0");
+		outstream = bgzf_open(out.toUtf8().data(), ("wb" + QByteArray::number(compression_level)).constData());
+		if (outstream==nullptr) THROW(FileAccessException, "Could not open file '" + out + "' for writing!");
+	}
+	auto write = [&](const QByteArray& text)
+	{
+		if (outstream==nullptr)
+		{
+			outfile->write(text);
+		}
+		else if (bgzf_write(outstream, text.constData(), text.size())!=text.size())
+		{
+			THROW(FileAccessException, "Writing bgzipped vcf file failed; not all bytes were written.");
+		}
+	};
+
+	//write header
+	QString header_text;
+	QTextStream header_stream(&header_text);
+	header.vcf_header_.storeHeaderInformation(header_stream);
+	header.storeHeaderColumns(header_stream);
+	header_stream.flush();
+	write(header_text.toUtf8());
+
+	//merge runs - the sort key contains only the columns used by the comparators
+	QHash<QByteArray, Chromosome> chr_cache;
+	auto key = [&chr_cache](const QByteArray& line, VcfLine& v)
+	{
+		int tabs[6];
+		int pos = -1;
+		for (int i=0; i<6; ++i)
+		{
+			pos = line.indexOf('\t', pos+1);
+			if (pos==-1) THROW(FileParseException, "VCF data line with less than 8 columns in temporary file: " + line);
+			tabs[i] = pos;
+		}
+
+		QByteArray chr = line.left(tabs[0]);
+		auto it = chr_cache.find(chr);
+		if (it==chr_cache.end()) it = chr_cache.insert(chr, Chromosome(chr));
+		v.setChromosome(it.value());
+		v.setPos(line.mid(tabs[0]+1, tabs[1]-tabs[0]-1).toInt());
+		v.setRef(line.mid(tabs[2]+1, tabs[3]-tabs[2]-1));
+		QByteArray alt = line.mid(tabs[3]+1, tabs[4]-tabs[3]-1);
+		int comma = alt.indexOf(',');
+		v.setSingleAlt(comma==-1 ? alt : alt.left(comma));
+		QByteArray qual = line.mid(tabs[4]+1, tabs[5]-tabs[4]-1);
+		v.setQual(qual=="." ? -1 : qual.toDouble());
+	};
+	QByteArray buffer;
+	auto output = [&](const QByteArray& line)
+	{
+		buffer.append(line);
+		buffer.append('\n');
+		if (buffer.size()>1048576)
+		{
+			write(buffer);
+			buffer.clear();
+		}
+	};
+	if (comparator_by_file.isNull())
+	{
+		runs.merge<VcfLine>(key, LessComparator(use_quality), output);
+	}
+	else
+	{
+		runs.merge<VcfLine>(key, *comparator_by_file, output);
+	}
+	write(buffer);
+
+	if (outstream!=nullptr) bgzf_close(outstream);
+}
+
 void VcfFile::removeDuplicates(bool sort_by_quality)
 {
 	sort(sort_by_quality);
@@ -606,6 +987,36 @@ void VcfFile::removeDuplicates(bool sort_by_quality)
 	vcf_lines_.swap(output);
 }
 
+void VcfFile::addMissingHeaderLines(const VcfHeader& header, QSet<QByteArray>& info_ids, QSet<QByteArray>& format_ids, QSet<QByteArray>& filter_ids)
+{
+	//adds INFO/FORMAT/FILTER lines with IDs not contained in the given ID sets (if called with the own header, only the ID sets are filled)
+	foreach(const InfoFormatLine& info, header.infoLines())
+	{
+		if (info_ids.contains(info.id)) continue;
+		if (&header!=&vcf_header_) vcf_header_.addInfoLine(info);
+		info_ids << info.id;
+	}
+	foreach(const InfoFormatLine& format, header.formatLines())
+	{
+		if (format_ids.contains(format.id)) continue;
+		if (&header!=&vcf_header_)
+		{
+			vcf_header_.addFormatLine(format);
+			if (format.id=="GT")
+			{
+				vcf_header_.moveFormatLine(vcf_header_.formatLines().count()-1, 0);
+			}
+		}
+		format_ids << format.id;
+	}
+	foreach(const FilterLine& filter, header.filterLines())
+	{
+		if (filter_ids.contains(filter.id)) continue;
+		if (&header!=&vcf_header_) vcf_header_.addFilterLine(filter);
+		filter_ids << filter.id;
+	}
+}
+
 void VcfFile::storeLineInformation(QTextStream& stream, const VcfLine& line) const
 {
 	//chr
@@ -1620,7 +2031,7 @@ void VcfFile::checkValues(const DefinitionLine& def, const QByteArrayList& value
 
 const QByteArray& VcfFile::strCache(const QByteArray& str)
 {
-	static QSet<QByteArray> cache;
+	static thread_local QSet<QByteArray> cache; //per thread, so that files can be parsed in parallel
 
 	QSet<QByteArray>::iterator it = cache.find(str);
 	if (it==cache.end())
@@ -1633,7 +2044,7 @@ const QByteArray& VcfFile::strCache(const QByteArray& str)
 
 const QByteArrayList& VcfFile::strArrayCache(const QByteArrayList& str)
 {
-	static QSet<QByteArrayList> cache;
+	static thread_local QSet<QByteArrayList> cache; //per thread, so that files can be parsed in parallel
 
 	QSet<QByteArrayList>::iterator it = cache.find(str);
 	if (it==cache.end())
@@ -1688,6 +2099,11 @@ void VcfFile::removeUnusedContigHeaders()
 		chromosomes << line.chr().str();
 	}
 
+	removeUnusedContigHeaders(chromosomes);
+}
+
+void VcfFile::removeUnusedContigHeaders(const QSet<QByteArray>& chromosomes)
+{
 	//remove unused contig headers
 	for (int i=vcf_header_.comments().count()-1; i>=0; --i)
 	{
@@ -5,6 +5,7 @@
 #include "KeyValuePair.h"
 #include "ChromosomalIndex.h"
 #include "VariantList.h"
+#include "ExternalSort.h"
 #include "htslib/bgzf.h"
 
 #include <zlib.h>
@@ -61,10 +62,10 @@ public:
 	void leftNormalize(QString reference_genome);
 	///Right-normalize every VCF line in the vcf file according to a reference genome
 	void rightNormalize(QString reference_genome);
-	///Load a VCF file
-	void load(const QString& filename, bool allow_multi_sample = true);
+	///Load a VCF file. If @p threads is greater than 1, BGZF blocks are decompressed and variant lines are parsed in parallel (the result is the same as for one thread).
+	void load(const QString& filename, bool allow_multi_sample = true, int threads = 1);
 	///Load part of a VCF file defied by a region (inside the region of invert=false and outside the region otherwise)
-	void load(const QString& filename, const BedFile& roi,  bool allow_multi_sample = true, bool invert = false);
+	void load(const QString& filename, const BedFile& roi,  bool allow_multi_sample = true, bool invert = false, int threads = 1);
 	///removes duplicate variants
 	void removeDuplicates(bool sort_by_quality);
 	///Stores the data in a file
@@ -75,6 +76,9 @@ public:
 	void sort(bool use_quality = false);
 	///Sort according to chr/postion - chromosome order is taken from the given FAI file.
 	void sortByFile(QString fai_file);
+	///Sorts a VCF file that does not fit into memory (external merge sort): chunks of variants are parsed and sorted in parallel, written to temporary files and merged.
+	///Sorting is done as in sort() or, if @p fai_file is given, as in sortByFile(). The output is the same as when loading, sorting and storing the file.
+	static void sortExternal(QString in, QString out, const ExternalSortSettings& settings, bool use_quality = false, QString fai_file = QString(), bool remove_unused_contigs = false, int compression_level = BGZF_NO_COMPRESSION);
 
 	///Returns the VCF line at the given position
 	const VcfLine& operator[](int index) const
@@ -135,12 +139,15 @@ public:
 private:
 	void storeHeaderColumns(QTextStream& stream) const;
 	void clear();
-	void loadFromVCFGZ(const QString& filename, bool allow_multi_sample = true, ChromosomalIndex<BedFile>* roi_idx = nullptr, bool invert = false);
+	void loadFromVCFGZ(const QString& filename, bool allow_multi_sample = true, ChromosomalIndex<BedFile>* roi_idx = nullptr, bool invert = false, int threads = 1);
+	void loadParallel(const QString& filename, bool allow_multi_sample, ChromosomalIndex<BedFile>* roi_idx, bool invert, int threads, int chunk_lines = 10000);
 	void parseHeaderFields(const QByteArray& line, bool allow_multi_sample);
 	void parseVcfEntry(int line_number, const QByteArray& line, QSet<QByteArray>& info_ids, QSet<QByteArray>& format_ids, QSet<QByteArray>& filter_ids, bool allow_multi_sample, ChromosomalIndex<BedFile>* roi_idx, bool invert=false);
 	void parseVcfHeader(int line_number, const QByteArray& line);
 	void processVcfLine(int& line_number, const QByteArray& line, QSet<QByteArray>& info_ids, QSet<QByteArray>& format_ids, QSet<QByteArray>& filter_ids, bool allow_multi_sample, ChromosomalIndex<BedFile>* roi_idx, bool invert=false);
 	void storeLineInformation(QTextStream& stream, const VcfLine& line) const;
+	void removeUnusedContigHeaders(const QSet<QByteArray>& chromosomes);
+	void addMissingHeaderLines(const VcfHeader& header, QSet<QByteArray>& info_ids, QSet<QByteArray>& format_ids, QSet<QByteArray>& filter_ids);
 
 	QList<VcfLine> vcf_lines_; //variant lines
 	VcfHeader vcf_header_; //all informations from header
@@ -223,6 +230,7 @@ private:
 	};
 	//for using the parse functions in testing
 	friend class VcfLine_Test;
+	friend class VcfFile_Test;
 
 	//storing all QByteArrays in a list of unique QByteArrays
 	static const QByteArray& strCache(const QByteArray& str);
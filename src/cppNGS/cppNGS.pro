@@ -37,6 +37,9 @@ LIBS += -lz
 QMAKE_LFLAGS += "-Wl,-rpath,\'\$$ORIGIN\'"
 
 SOURCES += BedFile.cpp \
+    ExternalSort.cpp \
+    BinaryFileHeader.cpp \
+    CsrGraph.cpp \
     Chromosome.cpp \
     ClientHelper.cpp \
     RefGenomeService.cpp \
@@ -76,13 +79,21 @@ SOURCES += BedFile.cpp \
     RtfDocument.cpp \
     GenomeBuild.cpp \
     ChainFileReader.cpp \
+    KnownVariantPanel.cpp \
+    MatchCounter.cpp \
+    TranscriptDatabase.cpp \
+    TranscriptSequenceCache.cpp \
     BigWigReader.cpp \
+    CoverageSweep.cpp \
     VariantHgvsAnnotator.cpp \
     WorkerAverageCoverage.cpp \
     WorkerLowOrHighCoverage.cpp \
     PipelineSettings.cpp
 
 HEADERS += BedFile.h \
+    ExternalSort.h \
+    BinaryFileHeader.h \
+    CsrGraph.h \
     Chromosome.h \
     ClientHelper.h \
     FileInfo.h \
@@ -129,7 +140,12 @@ HEADERS += BedFile.h \
     GraphEdge.h \
     GenomeBuild.h \
     ChainFileReader.h \
+    KnownVariantPanel.h \
+    MatchCounter.h \
+    TranscriptDatabase.h \
+    TranscriptSequenceCache.h \
     BigWigReader.h \
+    CoverageSweep.h \
     VariantHgvsAnnotator.h \
     WorkerAverageCoverage.h \
     WorkerLowOrHighCoverage.h \
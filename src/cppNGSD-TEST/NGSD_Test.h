@@ -14,6 +14,8 @@
 #include "OntologyTermCollection.h"
 #include "RepeatLocusList.h"
 #include <QThread>
+#include <QDir>
+#include <QFileInfo>
 
 TEST_CLASS(NGSD_Test)
 {
@@ -3395,6 +3397,78 @@ private slots:
 		I_EQUAL(c_fail, 0);
 	}
 
+	void test_transcript_snapshot()
+	{
+		if (!NGSD::isAvailable(true)) SKIP("Test needs access to the NGSD test database!");
+
+		//text representation of the transcript cache, used to compare caches loaded from NGSD and from the snapshot
+		auto transcriptCacheState = [](NGSD& db)
+		{
+			QStringList output;
+			foreach(const Transcript& t, db.transcripts())
+			{
+				int id = db.transcriptId(t.name());
+				const Transcript& t2 = db.transcript(id);
+				output << QString::number(id) + " " + t2.gene() + " " + t2.nameWithVersion() + " " + Transcript::sourceToString(t2.source()) + " " + t2.chr().str() + ":" + QString::number(t2.start()) + "-" + QString::number(t2.end()) + " " + Transcript::strandToString(t2.strand())
+						+ " coding=" + QString::number(t2.codingStart()) + "-" + QString::number(t2.codingEnd()) + " exons=" + QString::number(t2.regions().count()) + " preferred=" + QString::number(t2.isPreferredTranscript())
+						+ " mane=" + QString::number(t2.isManeSelectTranscript()) + " canonical=" + QString::number(t2.isEnsemblCanonicalTranscript());
+			}
+			foreach(int gene_id, QList<int>() << 1 << 3 << 4)
+			{
+				QStringList names;
+				foreach(const Transcript& t, db.transcripts(gene_id, Transcript::ENSEMBL, false))
+				{
+					names << t.name() + (t.isPreferredTranscript() ? "*" : "");
+				}
+				output << "gene " + QString::number(gene_id) + ": " + names.join(", ");
+			}
+			return output;
+		};
+
+		//use an empty snapshot folder
+		QString folder = QDir("out/NGSD_transcript_snapshots").absolutePath();
+		QDir(folder).removeRecursively();
+		QDir().mkpath(folder);
+		QString folder_setting = Settings::string("ngsd_transcript_snapshot_folder", true);
+		Settings::setString("ngsd_transcript_snapshot_folder", folder);
+
+		//first initialization: transcripts are loaded from NGSD and the snapshot is written
+		NGSD db(true);
+		db.init();
+		db.executeQueriesFromFile(TESTDATA("data_in/NGSD_in1.sql"));
+		db.getQuery().exec("INSERT INTO db_info SET name='transcripts_timestamp', value='2026-10-17T12:00:00'");
+		QStringList state_ngsd = transcriptCacheState(db);
+		IS_TRUE(state_ngsd.count()>3);
+
+		QStringList snapshots = QDir(folder).entryList(QStringList() << "*.tdb", QDir::Files);
+		I_EQUAL(snapshots.count(), 1);
+		QString snapshot = folder + "/" + snapshots[0];
+		QDateTime snapshot_modified = QFileInfo(snapshot).lastModified();
+
+		//second initialization: transcripts are loaded from the snapshot (unchanged)
+		db.init();
+		db.executeQueriesFromFile(TESTDATA("data_in/NGSD_in1.sql"));
+		db.getQuery().exec("INSERT INTO db_info SET name='transcripts_timestamp', value='2026-10-17T12:00:00'");
+		QStringList state_snapshot = transcriptCacheState(db);
+		I_EQUAL(QDir(folder).entryList(QStringList() << "*.tdb", QDir::Files).count(), 1);
+		IS_TRUE(QFileInfo(snapshot).lastModified()==snapshot_modified);
+		I_EQUAL(state_snapshot.count(), state_ngsd.count());
+		for (int i=0; i<state_ngsd.count(); ++i)
+		{
+			S_EQUAL(state_snapshot[i], state_ngsd[i]);
+		}
+
+		//restore settings
+		if (folder_setting.isEmpty())
+		{
+			Settings::remove("ngsd_transcript_snapshot_folder");
+		}
+		else
+		{
+			Settings::setString("ngsd_transcript_snapshot_folder", folder_setting);
+		}
+	}
+
 	void test_overriding_the_processed_sample_data_folder()
 	{
 		if (!NGSD::isAvailable(true)) SKIP("Test needs access to the NGSD test database!");
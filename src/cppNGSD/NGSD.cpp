@@ -26,6 +26,10 @@
 #include "QUuid"
 #include "ClientHelper.h"
 #include "PipelineSettings.h"
+#include "TranscriptDatabase.h"
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include <QMutexLocker>
 
 
 NGSD::NGSD(bool test_db, QString test_name_override)
@@ -1484,6 +1488,229 @@ QList<int> NGSD::addVariants(const VariantList& variant_list, double max_af, int
 	return output;
 }
 
+QList<int> NGSD::addVariantsBatched(const VariantList& variant_list, double max_af, int& c_add, int& c_update, int batch_size)
+{
+	if (batch_size<1) THROW(ArgumentException, "Invalid batch size " + QString::number(batch_size) + " for adding variants!");
+
+	//get annotated column indices
+	int i_gnomad = variant_list.annotationIndexByName("gnomAD");
+	int i_co_sp = variant_list.annotationIndexByName("coding_and_splicing");
+	int i_cadd = variant_list.annotationIndexByName("CADD");
+	int i_spliceai = variant_list.annotationIndexByName("SpliceAI");
+	int i_pubmed = variant_list.annotationIndexByName("PubMed", true, false);
+
+	//determine variants to import (skipped variants get the ID -1)
+	QList<int> output;
+	QList<int> todo;
+	for (int i=0; i<variant_list.count(); ++i)
+	{
+		const Variant& variant = variant_list[i];
+
+		//skip variants over 500 bases length - the unique index of the variant table does not work for those
+		bool skip = variant.ref().count()>MAX_VARIANT_SIZE || variant.obs().count()>MAX_VARIANT_SIZE;
+
+		//skip variants with too high AF
+		QByteArray gnomad = variant.annotations()[i_gnomad].trimmed();
+		if (gnomad=="n/a") gnomad.clear();
+		if (!gnomad.isEmpty() && gnomad.toDouble()>max_af) skip = true;
+
+		output << (skip ? -1 : 0);
+		if (!skip) todo << i;
+	}
+
+	//returns the key used to match variants and database rows
+	auto key = [](const QString& chr, int start, int end, const QByteArray& ref, const QByteArray& obs)
+	{
+		return chr.toUtf8() + '\t' + QByteArray::number(start) + '\t' + QByteArray::number(end) + '\t' + ref + '\t' + obs;
+	};
+
+	//looks up the given variants (one query per chromosome with all start positions) and returns the database rows by key
+	struct DbVariant
+	{
+		int id;
+		QByteArray gnomad;
+		QByteArray coding;
+		QByteArray cadd;
+		QByteArray spliceai;
+	};
+	auto lookup = [&](const QList<int>& indices)
+	{
+		QHash<QByteArray, DbVariant> rows;
+
+		QMap<QString, QSet<int>> chr2starts;
+		foreach(int i, indices)
+		{
+			const Variant& variant = variant_list[i];
+			chr2starts[variant.chr().strNormalized(true)] << variant.start();
+		}
+
+		SqlQuery query = getQuery();
+		for (auto it=chr2starts.cbegin(); it!=chr2starts.cend(); ++it)
+		{
+			QStringList starts;
+			foreach(int start, it.value())
+			{
+				starts << QString::number(start);
+			}
+			query.prepare("SELECT id, start, end, ref, obs, gnomad, coding, cadd, spliceai FROM variant WHERE chr=:0 AND start IN (" + starts.join(",") + ")");
+			query.bindValue(0, it.key());
+			query.exec();
+			while (query.next())
+			{
+				DbVariant row{query.value(0).toInt(), query.value(5).toByteArray(), query.value(6).toByteArray(), query.value(7).toByteArray(), query.value(8).toByteArray()};
+				rows.insert(key(it.key(), query.value(1).toInt(), query.value(2).toInt(), query.value(3).toByteArray(), query.value(4).toByteArray()), row);
+			}
+		}
+
+		return rows;
+	};
+
+	c_add = 0;
+	c_update = 0;
+	for (int b=0; b<todo.count(); b+=batch_size)
+	{
+		QList<int> batch = todo.mid(b, batch_size);
+
+		//resolve IDs of existing variants
+		QHash<QByteArray, DbVariant> rows = lookup(batch);
+
+		QList<int> updates;
+		QList<int> inserts;
+		QSet<QByteArray> insert_keys;
+		foreach(int i, batch)
+		{
+			const Variant& variant = variant_list[i];
+			QByteArray gnomad = variant.annotations()[i_gnomad].trimmed();
+			if (gnomad=="n/a") gnomad.clear();
+			QByteArray cadd = variant.annotations()[i_cadd].trimmed();
+			double spliceai = NGSHelper::maxSpliceAiScore(variant.annotations()[i_spliceai]);
+
+			QByteArray variant_key = key(variant.chr().strNormalized(true), variant.start(), variant.end(), variant.ref(), variant.obs());
+			auto it = rows.find(variant_key);
+			if (it!=rows.end()) //update (common case)
+			{
+				output[i] = it->id;
+
+				//check if variant meta data needs to be updated (same checks as in addVariants)
+				if (it->gnomad.toDouble()!=gnomad.toDouble() || it->coding!=variant.annotations()[i_co_sp] || it->cadd.toDouble()!=cadd.toDouble() || it->spliceai.toDouble()!=std::max(0.0, spliceai))
+				{
+					updates << i;
+
+					//update the cached row so that duplicate variants in the list are updated only once
+					it->gnomad = gnomad;
+					it->coding = variant.annotations()[i_co_sp];
+					it->cadd = cadd;
+					it->spliceai = spliceai<0 ? QByteArray() : QByteArray::number(spliceai);
+				}
+			}
+			else if (!insert_keys.contains(variant_key)) //insert (rare case)
+			{
+				inserts << i;
+				insert_keys << variant_key;
+			}
+		}
+
+		//binds the variant columns to a multi-row query
+		auto bindVariant = [&](SqlQuery& query, const Variant& variant)
+		{
+			QByteArray gnomad = variant.annotations()[i_gnomad].trimmed();
+			if (gnomad=="n/a") gnomad.clear();
+			QByteArray cadd = variant.annotations()[i_cadd].trimmed();
+			double spliceai = NGSHelper::maxSpliceAiScore(variant.annotations()[i_spliceai]);
+
+			query.addBindValue(variant.chr().strNormalized(true));
+			query.addBindValue(variant.start());
+			query.addBindValue(variant.end());
+			query.addBindValue(variant.ref());
+			query.addBindValue(variant.obs());
+			query.addBindValue(gnomad.isEmpty() ? QVariant() : gnomad);
+			query.addBindValue(variant.annotations()[i_co_sp]);
+			query.addBindValue(cadd.isEmpty() ? QVariant() : cadd);
+			query.addBindValue(spliceai<0 ? QVariant() : spliceai);
+		};
+
+		//update meta data of existing variants (a duplicate primary key turns the insert into an update)
+		if (!updates.isEmpty())
+		{
+			QStringList placeholders;
+			for (int u=0; u<updates.count(); ++u) placeholders << "(?,?,?,?,?,?,?,?,?,?)";
+
+			SqlQuery q_update = getQuery(); //use binding (user input)
+			q_update.prepare("INSERT INTO variant (id, chr, start, end, ref, obs, gnomad, coding, cadd, spliceai) VALUES " + placeholders.join(",") + " ON DUPLICATE KEY UPDATE gnomad=VALUES(gnomad), coding=VALUES(coding), cadd=VALUES(cadd), spliceai=VALUES(spliceai)");
+			foreach(int i, updates)
+			{
+				q_update.addBindValue(output[i]);
+				bindVariant(q_update, variant_list[i]);
+			}
+			q_update.exec();
+			c_update += updates.count();
+		}
+
+		//insert new variants
+		if (!inserts.isEmpty())
+		{
+			QStringList placeholders;
+			for (int n=0; n<inserts.count(); ++n) placeholders << "(?,?,?,?,?,?,?,?,?)";
+
+			SqlQuery q_insert = getQuery(); //use binding (user input)
+			q_insert.prepare("INSERT INTO variant (chr, start, end, ref, obs, gnomad, coding, cadd, spliceai) VALUES " + placeholders.join(",") + " ON DUPLICATE KEY UPDATE id=id");
+			foreach(int i, inserts)
+			{
+				bindVariant(q_insert, variant_list[i]);
+			}
+			q_insert.exec();
+			c_add += inserts.count();
+
+			//resolve IDs of inserted variants (a multi-row insert does not return all IDs)
+			rows = lookup(inserts);
+			foreach(int i, batch)
+			{
+				if (output[i]!=0) continue;
+
+				const Variant& variant = variant_list[i];
+				auto it = rows.constFind(key(variant.chr().strNormalized(true), variant.start(), variant.end(), variant.ref(), variant.obs()));
+				if (it!=rows.cend())
+				{
+					output[i] = it->id;
+				}
+				else //the database matched the variant to an existing row that does not compare equal byte-wise (e.g. because of collation) > we need to get the variant id manually
+				{
+					output[i] = variantId(variant).toInt();
+				}
+			}
+		}
+
+		//add PubMed IDs
+		if (i_pubmed>0)
+		{
+			QStringList placeholders;
+			QVariantList values;
+			foreach(int i, batch)
+			{
+				foreach(const QByteArray& pubmed_id, variant_list[i].annotations()[i_pubmed].split(','))
+				{
+					if (pubmed_id.isEmpty()) continue;
+					placeholders << "(?,?)";
+					values << output[i] << pubmed_id;
+				}
+			}
+
+			if (!placeholders.isEmpty())
+			{
+				SqlQuery q_pubmed = getQuery();
+				q_pubmed.prepare("INSERT INTO `variant_literature` (`variant_id`, `pubmed`) VALUES " + placeholders.join(",") + " ON DUPLICATE KEY UPDATE id=id");
+				foreach(const QVariant& value, values)
+				{
+					q_pubmed.addBindValue(value);
+				}
+				q_pubmed.exec();
+			}
+		}
+	}
+
+	return output;
+}
+
 QString NGSD::variantId(const Variant& variant, bool throw_if_fails)
 {
 	SqlQuery query = getQuery(); //use binding user input (safety)
@@ -1869,7 +2096,7 @@ void NGSD::importGeneExpressionData(const QString& expression_data_file_path, co
 
 	//get id <-> gene mapping from expression gene table
 	QMap<QByteArray,int>& gene2id = getCache().gene_expression_gene2id;
-	if(gene2id.isEmpty()) initGeneExpressionCache();
+	initGeneExpressionCache();
 
 
 	// prepare query
@@ -2244,14 +2471,14 @@ QMap<QByteArray, double> NGSD::getGeneExpressionValuesOfSample(const QString& ps
 QMap<int, QByteArray> NGSD::getGeneExpressionId2GeneMapping()
 {
 	QMap<int, QByteArray>& id2gene = getCache().gene_expression_id2gene;
-	if(id2gene.isEmpty()) initGeneExpressionCache();
+	initGeneExpressionCache();
 	return id2gene;
 }
 
 QMap<QByteArray, int> NGSD::getGeneExpressionGene2IdMapping()
 {
 	QMap<QByteArray, int>& gene2id = getCache().gene_expression_gene2id;
-	if(gene2id.isEmpty()) initGeneExpressionCache();
+	initGeneExpressionCache();
 	return gene2id;
 }
 
@@ -5835,6 +6062,12 @@ QHash<QString, QStringList> NGSD::checkMetaData(const QString& ps_id, const Vari
 	return output;
 }
 
+QString NGSD::elapsedTimeAndRate(const QTime& timer, int rows)
+{
+	double secs = std::max(timer.elapsed(), 1) / 1000.0;
+	return Helper::elapsedTime(timer) + " (" + QString::number(rows) + " rows, " + QString::number(rows/secs, 'f', 0) + " rows/s)";
+}
+
 QString NGSD::escapeForSql(const QString& text)
 {
 	return text.trimmed().replace("\"", "").replace("'", "''").replace(";", "").replace("\n", "");
@@ -6978,8 +7211,8 @@ const Phenotype& NGSD::phenotype(int id)
 
 GeneSet NGSD::genesOverlapping(const Chromosome& chr, int start, int end, int extend)
 {
+	initTranscriptCache();
 	TranscriptList& cache = getCache().gene_transcripts;
-	if (cache.isEmpty()) initTranscriptCache();
 	ChromosomalIndex<TranscriptList>& index = getCache().gene_transcripts_index;
 
 	//create gene list
@@ -6994,8 +7227,8 @@ GeneSet NGSD::genesOverlapping(const Chromosome& chr, int start, int end, int ex
 
 GeneSet NGSD::genesOverlappingByExon(const Chromosome& chr, int start, int end, int extend)
 {
+	initTranscriptCache();
 	TranscriptList& cache = getCache().gene_transcripts;
-	if (cache.isEmpty()) initTranscriptCache();
 	ChromosomalIndex<TranscriptList>& index = getCache().gene_transcripts_index;
 
 	start -= extend;
@@ -7169,8 +7402,8 @@ int NGSD::transcriptId(QString name, bool throw_on_error)
 
 TranscriptList NGSD::transcripts(int gene_id, Transcript::SOURCE source, bool coding_only)
 {
+	initTranscriptCache();
 	TranscriptList& cache = getCache().gene_transcripts;
-	if (cache.isEmpty()) initTranscriptCache();
 	QHash<QByteArray, QSet<int>>& gene2indices = getCache().gene_transcripts_symbol2indices;
 
 	TranscriptList output;
@@ -7192,8 +7425,8 @@ TranscriptList NGSD::transcripts(int gene_id, Transcript::SOURCE source, bool co
 
 TranscriptList NGSD::transcriptsOverlapping(const Chromosome& chr, int start, int end, int extend, Transcript::SOURCE source)
 {
+	initTranscriptCache();
 	TranscriptList& cache = getCache().gene_transcripts;
-	if (cache.isEmpty()) initTranscriptCache();
 	ChromosomalIndex<TranscriptList>& index = getCache().gene_transcripts_index;
 
 	//create gene list
@@ -7335,16 +7568,16 @@ TranscriptList NGSD::relevantTranscripts(int gene_id)
 
 const TranscriptList& NGSD::transcripts()
 {
+	initTranscriptCache();
 	TranscriptList& cache = getCache().gene_transcripts;
-	if (cache.isEmpty()) initTranscriptCache();
 
 	return cache;
 }
 
 const Transcript& NGSD::transcript(int id)
 {
+	initTranscriptCache();
 	TranscriptList& cache = getCache().gene_transcripts;
-	if (cache.isEmpty()) initTranscriptCache();
 
 	//check transcript is in cache, i.e. in NGSD
 	int index = getCache().gene_transcripts_id2index.value(id, -1);
@@ -10000,13 +10233,21 @@ void NGSD::clearCache()
 	cache_instance.phenotypes_by_id.clear();
 	cache_instance.phenotypes_accession_to_id.clear();
 
-	cache_instance.gene_transcripts.clear();
-	cache_instance.gene_transcripts_index.createIndex();
-	cache_instance.gene_transcripts_id2index.clear();
-	cache_instance.gene_transcripts_symbol2indices.clear();
+	{
+		QMutexLocker locker(&cache_instance.gene_transcripts_mutex);
+		cache_instance.gene_transcripts_initialized.storeRelease(0);
+		cache_instance.gene_transcripts.clear();
+		cache_instance.gene_transcripts_index.createIndex();
+		cache_instance.gene_transcripts_id2index.clear();
+		cache_instance.gene_transcripts_symbol2indices.clear();
+	}
 
-	cache_instance.gene_expression_id2gene.clear();
-	cache_instance.gene_expression_gene2id.clear();
+	{
+		QMutexLocker locker(&cache_instance.gene_expression_mutex);
+		cache_instance.gene_expression_initialized.storeRelease(0);
+		cache_instance.gene_expression_id2gene.clear();
+		cache_instance.gene_expression_gene2id.clear();
+	}
 }
 
 
@@ -10018,31 +10259,104 @@ NGSD::Cache::Cache()
 
 void NGSD::initTranscriptCache()
 {
-	//make sure initialization is done only once
-	static bool initializing = false;
-	if (initializing)
+	//make sure initialization is done only once (like std::call_once, but the cache can be reset using clearCache())
+	Cache& cache_instance = getCache();
+	if (cache_instance.gene_transcripts_initialized.loadAcquire()) return;
+	QMutexLocker locker(&cache_instance.gene_transcripts_mutex);
+	if (cache_instance.gene_transcripts_initialized.loadAcquire()) return;
+
+	//load transcripts from snapshot if possible (transcripts are sorted by position)
+	TranscriptList transcripts;
+	QVector<int> ids;
+	QString snapshot = transcriptSnapshotFile();
+	bool snapshot_loaded = false;
+	if (!snapshot.isEmpty() && QFile::exists(snapshot))
+	{
+		try
+		{
+			transcripts = TranscriptDatabase::load(snapshot, nullptr, &ids).transcripts;
+			snapshot_loaded = true;
+		}
+		catch (Exception& e)
+		{
+			Log::warn("Could not load NGSD transcript snapshot '" + snapshot + "' - loading transcripts from NGSD: " + e.message());
+			transcripts.clear();
+			ids.clear();
+		}
+	}
+
+	//load transcripts from NGSD and create snapshot
+	if (!snapshot_loaded)
 	{
-		while(initializing)
+		loadTranscripts(transcripts, ids);
+
+		//sort (stable, so the order of identifiers is restored via the unique transcript names)
+		QHash<QByteArray, int> name2id;
+		for (int i=0; i<transcripts.count(); ++i)
+		{
+			name2id[transcripts[i].name()] = ids[i];
+		}
+		transcripts.sortByPosition();
+		for (int i=0; i<transcripts.count(); ++i)
+		{
+			ids[i] = name2id[transcripts[i].name()];
+		}
+
+		if (!snapshot.isEmpty())
 		{
-			QThread::msleep(1);
+			try
+			{
+				//write to temporary file and rename it, so that other processes never see an incomplete snapshot
+				QString tmp_file = snapshot + "." + QString::number(QCoreApplication::applicationPid()) + ".tmp";
+				GffData data;
+				data.transcripts = transcripts;
+				TranscriptDatabase::store(data, GffSettings(), tmp_file, QString(), ids);
+				QFile::remove(snapshot);
+				if (!QFile::rename(tmp_file, snapshot)) QFile::remove(tmp_file);
+
+				//remove outdated snapshots of the same database
+				QFileInfo snapshot_info(snapshot);
+				QString prefix = snapshot_info.fileName().left(snapshot_info.fileName().lastIndexOf('_') + 1);
+				foreach(QString file, QDir(snapshot_info.absolutePath()).entryList(QStringList() << (prefix + "*.tdb"), QDir::Files))
+				{
+					if (file!=snapshot_info.fileName()) QFile::remove(snapshot_info.absolutePath() + QDir::separator() + file);
+				}
+			}
+			catch (Exception& e)
+			{
+				Log::warn("Could not store NGSD transcript snapshot '" + snapshot + "': " + e.message());
+			}
 		}
-		return;
 	}
-	initializing = true;
 
-	//get preferred transcript list
+	//set preferred transcript flags (not part of the snapshot because they are changed independently of the transcript import)
 	QSet<QByteArray> pts;
 	foreach(QString trans, getValues("SELECT DISTINCT name FROM preferred_transcripts"))
 	{
 		pts.insert(trans.toUtf8());
 	}
+	for (int i=0; i<transcripts.count(); ++i)
+	{
+		transcripts[i].setPreferredTranscript(pts.contains(transcripts[i].name()));
+	}
 
-	TranscriptList& cache = getCache().gene_transcripts;
-	ChromosomalIndex<TranscriptList>& index = getCache().gene_transcripts_index;
-	QHash<int, int>& id2index = getCache().gene_transcripts_id2index;
-	QHash<QByteArray, QSet<int>>& symbol2indices = getCache().gene_transcripts_symbol2indices;
+	//fill cache and build indices
+	cache_instance.gene_transcripts = transcripts;
+	cache_instance.gene_transcripts_id2index.clear();
+	cache_instance.gene_transcripts_symbol2indices.clear();
+	for (int i=0; i<transcripts.count(); ++i)
+	{
+		cache_instance.gene_transcripts_id2index[ids[i]] = i;
+		cache_instance.gene_transcripts_symbol2indices[transcripts[i].gene()] << i;
+	}
+	cache_instance.gene_transcripts_index.createIndex();
 
+	//an empty cache is not marked as initialized, i.e. it is initialized again on the next call (e.g. after transcripts were imported)
+	if (!transcripts.isEmpty()) cache_instance.gene_transcripts_initialized.storeRelease(1);
+}
 
+void NGSD::loadTranscripts(TranscriptList& transcripts, QVector<int>& ids)
+{
 	//get exon coordinates for each transcript from NGSD
 	QHash<int, QList<QPair<int, int>>> tmp_coords;
 	SqlQuery query = getQuery();
@@ -10056,7 +10370,6 @@ void NGSD::initTranscriptCache()
 	}
 
 	//create all transcripts
-	QHash<QByteArray, int> tmp_name2id;
 	query.exec("SELECT t.id, g.symbol, t.name, t.source, t.strand, t.chromosome, t.start_coding, t.end_coding, t.biotype, t.is_gencode_basic, t.is_ensembl_canonical, t.is_mane_select, t.is_mane_plus_clinical, t.version, g.ensembl_id FROM gene_transcript t, gene g WHERE t.gene_id=g.id");
 	while(query.next())
 	{
@@ -10070,7 +10383,6 @@ void NGSD::initTranscriptCache()
 		transcript.setSource(Transcript::stringToSource(query.value(3).toString()));
 		transcript.setStrand(Transcript::stringToStrand(query.value(4).toByteArray()));
 		transcript.setBiotype(Transcript::stringToBiotype(query.value(8).toByteArray()));
-		transcript.setPreferredTranscript(pts.contains(transcript.name()));
 		transcript.setGencodeBasicTranscript(query.value(9).toInt()!=0);
 		transcript.setEnsemblCanonicalTranscript(query.value(10).toInt()!=0);
 		transcript.setManeSelectTranscript(query.value(11).toInt()!=0);
@@ -10094,44 +10406,54 @@ void NGSD::initTranscriptCache()
 		}
 		transcript.setRegions(regions, start_coding, end_coding);
 
-		cache << transcript;
-		tmp_name2id[transcript.name()] = trans_id;
+		transcripts << transcript;
+		ids << trans_id;
 	}
+}
 
-	//sort and build indices
-	cache.sortByPosition();
-	for (int i=0; i<cache.count(); ++i)
-	{
-		const Transcript& trans = cache[i];
+QString NGSD::transcriptSnapshotFile()
+{
+	//no snapshots for test databases (they are re-initialized all the time), unless a snapshot folder is set explicitly
+	QString folder = Settings::string("ngsd_transcript_snapshot_folder", true).trimmed();
+	if (test_db_ && folder.isEmpty()) return "";
 
-		int trans_id = tmp_name2id[trans.name()];
-		id2index[trans_id] = i;
+	//transcript import timestamp (written by NGSDImportEnsembl)
+	if (!tables().contains("db_info")) return "";
+	if (!getEnum("db_info", "name").contains("transcripts_timestamp")) return "";
+	QString timestamp = getValue("SELECT value FROM db_info WHERE name='transcripts_timestamp'", true).toString().trimmed();
+	if (timestamp.isEmpty()) return "";
 
-		symbol2indices[trans.gene()] << i;
-	}
+	//transcript count and maximum id (in case the tables were modified without NGSDImportEnsembl)
+	SqlQuery query = getQuery();
+	query.exec("SELECT COUNT(*), MAX(id) FROM gene_transcript");
+	query.next();
+	QString table_state = query.value(0).toString() + "_" + query.value(1).toString();
 
-	//build index
-	index.createIndex();
+	//folder
+	if (folder.isEmpty())
+	{
+		folder = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+		if (folder.isEmpty()) return "";
+		folder += QDir::separator() + QString("ngs-bits");
+	}
+	if (!QDir().mkpath(folder)) return "";
 
-	initializing = false;
+	//file name: database hash + data hash
+	QByteArray db_hash = QCryptographicHash::hash((db_->hostName() + ":" + QString::number(db_->port()) + "/" + db_->databaseName()).toUtf8(), QCryptographicHash::Md5).toHex().left(12);
+	QByteArray data_hash = QCryptographicHash::hash((timestamp + "_" + table_state).toUtf8(), QCryptographicHash::Md5).toHex().left(12);
+	return folder + QDir::separator() + "ngsd_transcripts_" + db_hash + "_" + data_hash + ".tdb";
 }
 
 void NGSD::initGeneExpressionCache()
 {
-	//make sure initialization is done only once
-	static bool initializing = false;
-	if (initializing)
-	{
-		while(initializing)
-		{
-			QThread::msleep(1);
-		}
-		return;
-	}
-	initializing = true;
+	//make sure initialization is done only once (like std::call_once, but the cache can be reset using clearCache())
+	Cache& cache_instance = getCache();
+	if (cache_instance.gene_expression_initialized.loadAcquire()) return;
+	QMutexLocker locker(&cache_instance.gene_expression_mutex);
+	if (cache_instance.gene_expression_initialized.loadAcquire()) return;
 
-	QMap<int, QByteArray>& id2gene = getCache().gene_expression_id2gene;
-	QMap<QByteArray, int>& gene2id = getCache().gene_expression_gene2id;
+	QMap<int, QByteArray>& id2gene = cache_instance.gene_expression_id2gene;
+	QMap<QByteArray, int>& gene2id = cache_instance.gene_expression_gene2id;
 
 	//reset cache
 	id2gene.clear();
@@ -10145,5 +10467,5 @@ void NGSD::initGeneExpressionCache()
 		gene2id.insert(query.value(1).toByteArray(), query.value(0).toInt());
 	}
 
-	initializing = false;
+	if (!id2gene.isEmpty()) cache_instance.gene_expression_initialized.storeRelease(1);
 }
@@ -8,6 +8,8 @@
 #include <QTextStream>
 #include <QDateTime>
 #include <QRegularExpression>
+#include <QMutex>
+#include <QAtomicInt>
 #include "VariantList.h"
 #include "BedFile.h"
 #include "Transcript.h"
@@ -854,6 +856,10 @@ public:
 	QString addVariant(const Variant& variant, const VariantList& variant_list);
 	///Adds all missing variants to the NGSD and returns the variant DB identifiers (or -1 if the variant was skipped due to 'max_af' or because it is over 500 bases long)
 	QList<int> addVariants(const VariantList& variant_list, double max_af, int& c_add, int& c_update);
+	///Same as addVariants, but uses batched queries: existing variants are looked up with one query per chromosome and batch, missing variants are added with multi-row inserts. Much faster for large variant lists, e.g. WGS.
+	QList<int> addVariantsBatched(const VariantList& variant_list, double max_af, int& c_add, int& c_update, int batch_size = 1000);
+	///Returns the elapsed time (see Helper::elapsedTime) and the number of imported rows per second, for the timing output of import tools.
+	static QString elapsedTimeAndRate(const QTime& timer, int rows);
 	///Returns the NGSD ID for a variant. Returns '' or throws an exception if the ID cannot be determined.
 	QString variantId(const Variant& variant, bool throw_if_fails = true);
 	///Returns the variant corresponding to the given identifier or throws an exception if the ID does not exist.
@@ -1252,15 +1258,23 @@ protected:
 		ChromosomalIndex<TranscriptList> gene_transcripts_index;
 		QHash<int, int> gene_transcripts_id2index; //NGSD transcript id > index in 'gene_transcripts'
 		QHash<QByteArray, QSet<int>> gene_transcripts_symbol2indices; //gene symbol > indices in 'gene_transcripts'
+		QMutex gene_transcripts_mutex; //guards initialization/clearing of the transcript cache
+		QAtomicInt gene_transcripts_initialized; //1 if the transcript cache is initialized (can be checked without locking)
 
 		//gene expression
 		QMap<int, QByteArray> gene_expression_id2gene;
 		QMap<QByteArray, int> gene_expression_gene2id;
+		QMutex gene_expression_mutex; //guards initialization/clearing of the gene expression cache
+		QAtomicInt gene_expression_initialized; //1 if the gene expression cache is initialized (can be checked without locking)
 	};
 	static Cache& getCache();
 	void clearCache();
 	void initTranscriptCache();
 	void initGeneExpressionCache();
+	//loads transcripts from the database (not sorted, preferred transcript flags not set). The NGSD transcript ids are appended to 'ids'.
+	void loadTranscripts(TranscriptList& transcripts, QVector<int>& ids);
+	//returns the transcript snapshot file of the database, or an empty string if no snapshot can be used (transcript import timestamp not set, or test database without snapshot folder setting)
+	QString transcriptSnapshotFile();
 };
 
 #endif // NGSD_H
@@ -2609,7 +2609,7 @@ DEFAULT CHARACTER SET = utf8;
 -- -----------------------------------------------------
 CREATE TABLE IF NOT EXISTS `db_info`
 (
-  `name` ENUM('init_timestamp','is_production') NOT NULL,
+  `name` ENUM('init_timestamp','is_production','transcripts_timestamp') NOT NULL,
   `value` TEXT,
   UNIQUE KEY `name` (`name`)
 )
@@ -82,5 +82,13 @@ private slots:
 		IS_TRUE(QFile::exists("out/BamClipOverlap_out6.bam"));
 		COMPARE_FILES("out/BamClipOverlap_Test_line81.log", TESTDATA("data_out/BamClipOverlap_out11.log"));
 	}
+
+	void test_threads()
+	{
+		//multi-threaded compression/decompression must not change the result
+		EXECUTE("BamClipOverlap", "-in " + TESTDATA("data_in/BamClipOverlap_in1.bam") + " -out out/BamClipOverlap_out_threads.bam -v -threads 4");
+		IS_TRUE(QFile::exists("out/BamClipOverlap_out_threads.bam"));
+		COMPARE_FILES("out/BamClipOverlap_Test_line89.log", TESTDATA("data_out/BamClipOverlap_out1.log"));
+	}
 };
 
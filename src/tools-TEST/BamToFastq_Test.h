@@ -4,6 +4,22 @@
 TEST_CLASS(BamToFastq_Test)
 {
 Q_OBJECT
+private:
+	//returns the FASTQ entries of a file as sorted list (header, bases, qualities)
+	QStringList sortedEntries(QString filename)
+	{
+		QStringList output;
+		FastqFileStream stream(filename);
+		FastqEntry entry;
+		while (!stream.atEnd())
+		{
+			stream.readEntry(entry);
+			output << entry.header + "\t" + entry.bases + "\t" + entry.qualities;
+		}
+		output.sort();
+		return output;
+	}
+
 private slots:
 
 	void test_mandatory_parameter()
@@ -33,12 +49,43 @@ private slots:
 		COMPARE_GZ_FILES("out/BamToFastq_out6.fastq.gz", TESTDATA("data_out/BamToFastq_out6.fastq.gz"));
 	}
 
+	void test_max_cache()
+	{
+		//small memory budget: unmatched mates are written to temporary files and paired at the end (the output order differs)
+		EXECUTE("BamToFastq", "-in " + TESTDATA("data_in/BamToFastq_in1.bam") + " -out1 out/BamToFastq_out8.fastq.gz -out2 out/BamToFastq_out9.fastq.gz -write_buffer_size 1 -max_cache 0.01 -compress_tmp");
+		QStringList entries1 = sortedEntries("out/BamToFastq_out8.fastq.gz");
+		QStringList entries2 = sortedEntries("out/BamToFastq_out9.fastq.gz");
+		IS_TRUE(entries1==sortedEntries(TESTDATA("data_out/BamToFastq_out1.fastq.gz")));
+		IS_TRUE(entries2==sortedEntries(TESTDATA("data_out/BamToFastq_out2.fastq.gz")));
+
+		//mates are written in the same order
+		FastqFileStream stream1("out/BamToFastq_out8.fastq.gz");
+		FastqFileStream stream2("out/BamToFastq_out9.fastq.gz");
+		FastqEntry e1;
+		FastqEntry e2;
+		while (!stream1.atEnd() && !stream2.atEnd())
+		{
+			stream1.readEntry(e1);
+			stream2.readEntry(e2);
+			S_EQUAL(e1.header, e2.header);
+		}
+		IS_TRUE(stream1.atEnd() && stream2.atEnd());
+	}
+
 	void single_end()
 	{
 		EXECUTE("BamToFastq", "-in " + TESTDATA("data_in/BamToFastq_in3.bam") + " -out1 out/BamToFastq_out7.fastq.gz -mode single-end -write_buffer_size 1");
 		IS_TRUE(QFile::exists("out/BamToFastq_out7.fastq.gz"));
 		COMPARE_GZ_FILES("out/BamToFastq_out7.fastq.gz", TESTDATA("data_out/BamToFastq_out7.fastq.gz"));
 	}
+
+	void test_threads()
+	{
+		//multi-threaded decompression must not change the result
+		EXECUTE("BamToFastq", "-in " + TESTDATA("data_in/BamToFastq_in1.bam") + " -out1 out/BamToFastq_out10.fastq.gz -out2 out/BamToFastq_out11.fastq.gz -write_buffer_size 1 -threads 4");
+		COMPARE_GZ_FILES("out/BamToFastq_out10.fastq.gz", TESTDATA("data_out/BamToFastq_out1.fastq.gz"));
+		COMPARE_GZ_FILES("out/BamToFastq_out11.fastq.gz", TESTDATA("data_out/BamToFastq_out2.fastq.gz"));
+	}
 };
 
 
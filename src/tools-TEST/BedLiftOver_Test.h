@@ -18,6 +18,19 @@ private slots:
 		COMPARE_FILES("out/BedLiftOver_out1_unmapped.bed", TESTDATA("../cppNGS-TEST/data_out/ChainFileReader_out1_unmapped.bed"));
 	}
 	
+	// multi-threaded lifting
+	void test_01_threads()
+	{
+		QString chain_file = Settings::string("liftover_hg38_hg19", true);
+		if (chain_file=="") SKIP("Test needs the liftOver hg38->hg19 chain file!");
+
+		EXECUTE("BedLiftOver", "-in " + TESTDATA("../cppNGS-TEST/data_in/ChainFileReader_in1.bed") + " -chain hg38_hg19 -out out/BedLiftOver_out5_lifted.bed -unmapped out/BedLiftOver_out5_unmapped.bed -max_deletion 5 -max_increase 9999 -threads 4");
+		REMOVE_LINES("out/BedLiftOver_out5_lifted.bed", QRegExp("#"));
+		REMOVE_LINES("out/BedLiftOver_out5_unmapped.bed", QRegExp("#"));
+		COMPARE_FILES("out/BedLiftOver_out5_lifted.bed", TESTDATA("../cppNGS-TEST/data_out/ChainFileReader_out1_lifted.bed"));
+		COMPARE_FILES("out/BedLiftOver_out5_unmapped.bed", TESTDATA("../cppNGS-TEST/data_out/ChainFileReader_out1_unmapped.bed"));
+	}
+
 	// testing allowed number of deleted bases
 	void test_02()
 	{
@@ -23,4 +23,10 @@ private slots:
 		COMPARE_FILES("out/BedSort_test03_out.bed", TESTDATA("data_out/BedSort_test03_out.bed"));
 	}
 
+	void external_sort()
+	{
+		EXECUTE("BedSort", "-in " + TESTDATA("data_in/BedSort_in2.bed") + " -out out/BedSort_test04_out.bed -uniq -buffer 1 -threads 2");
+		COMPARE_FILES("out/BedSort_test04_out.bed", TESTDATA("data_out/BedSort_test02_out.bed"));
+	}
+
 };
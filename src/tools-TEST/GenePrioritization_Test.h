@@ -32,4 +32,37 @@ private slots:
             COMPARE_FILES("out/GenePrioritization_out2.tsv", TESTDATA("data_out/GenePrioritization_out2.tsv"));
         }
     }
+
+    void test_rwr()
+    {
+        EXECUTE("GenePrioritization", "-in " + TESTDATA("data_in/GenePrioritization_in.tsv") + " -graph " +
+                TESTDATA("data_in/GenePrioritization_graph.tsv") + " -out out/GenePrioritization_out3.tsv" +
+                " -method rwr");
+        IS_TRUE(QFile::exists("out/GenePrioritization_out3.tsv"));
+
+        // multi-threaded power iteration has to produce the same result
+        EXECUTE("GenePrioritization", "-in " + TESTDATA("data_in/GenePrioritization_in.tsv") + " -graph " +
+                TESTDATA("data_in/GenePrioritization_graph.tsv") + " -out out/GenePrioritization_out4.tsv" +
+                " -method rwr -threads 4");
+        IS_TRUE(QFile::exists("out/GenePrioritization_out4.tsv"));
+        COMPARE_FILES("out/GenePrioritization_out4.tsv", "out/GenePrioritization_out3.tsv");
+    }
+
+    void test_binary_graph()
+    {
+        // create graph in TSV and binary format
+        EXECUTE("GraphStringDb", "-string " + TESTDATA("data_in/GraphStringDb_in.txt") + " -alias " +
+                TESTDATA("data_in/GraphStringDb_alias.tsv") + " -out out/GenePrioritization_graph.tsv -out_binary out/GenePrioritization_graph.bin");
+        IS_TRUE(QFile::exists("out/GenePrioritization_graph.bin"));
+
+        EXECUTE("GenePrioritization", "-in " + TESTDATA("data_in/GenePrioritization_in.tsv") + " -graph out/GenePrioritization_graph.bin" +
+                " -out out/GenePrioritization_out5.tsv -method rwr -threads 4");
+        IS_TRUE(QFile::exists("out/GenePrioritization_out5.tsv"));
+
+        // binary graph has to produce the same result as the TSV graph
+        EXECUTE("GenePrioritization", "-in " + TESTDATA("data_in/GenePrioritization_in.tsv") + " -graph out/GenePrioritization_graph.tsv" +
+                " -out out/GenePrioritization_out6.tsv -method rwr");
+        IS_TRUE(QFile::exists("out/GenePrioritization_out6.tsv"));
+        COMPARE_FILES("out/GenePrioritization_out6.tsv", "out/GenePrioritization_out5.tsv");
+    }
 };
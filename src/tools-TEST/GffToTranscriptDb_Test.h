@@ -0,0 +1,22 @@
+#include "TestFramework.h"
+#include "Settings.h"
+
+TEST_CLASS(GffToTranscriptDb_Test)
+{
+Q_OBJECT
+private slots:
+
+	//annotation with the transcript database has to be the same as with the GFF file
+	void test_01()
+	{
+		QString ref_file = Settings::string("reference_genome", true);
+		if (ref_file=="") SKIP("Test needs the reference genome!");
+
+		EXECUTE("GffToTranscriptDb", "-in " + TESTDATA("data_in/VcfAnnotateConsequence_transcripts.gff3") + " -out out/GffToTranscriptDb_out1.tdb");
+		EXECUTE("VcfAnnotateConsequence", "-in " + TESTDATA("data_in/VcfAnnotateConsequence_in1.vcf") + " -gff out/GffToTranscriptDb_out1.tdb -out out/GffToTranscriptDb_out1.vcf -splice_region_in5 8 -splice_region_in3 8");
+		COMPARE_FILES("out/GffToTranscriptDb_out1.vcf", TESTDATA("data_out/VcfAnnotateConsequence_out1.vcf"));
+
+		//settings of the database must match
+		EXECUTE_FAIL("VcfAnnotateConsequence", "-in " + TESTDATA("data_in/VcfAnnotateConsequence_in1.vcf") + " -gff out/GffToTranscriptDb_out1.tdb -out out/GffToTranscriptDb_out2.vcf -all");
+	}
+};
@@ -129,5 +129,15 @@ private slots:
 		COMPARE_FILES("out/MappingQC_test13_out.qcML", TESTDATA("data_out/MappingQC_test13_out.qcML"));
 	}
 
+	void roi_amplicon_threads()
+	{
+		QString ref_file = Settings::string("reference_genome_hg19", true);
+		if (ref_file=="") SKIP("Test needs the reference genome HG19!");
 
+		//multi-threaded decompression must not change the result
+		EXECUTE("MappingQC", "-in " + TESTDATA("../cppNGS-TEST/data_in/panel.bam") + " -roi " + TESTDATA("../cppNGS-TEST/data_in/panel.bed") + " -build hg19 -out out/MappingQC_test01_threads_out.qcML -threads 4 -ref " + ref_file);
+		REMOVE_LINES("out/MappingQC_test01_threads_out.qcML", QRegExp("creation "));
+		REMOVE_LINES("out/MappingQC_test01_threads_out.qcML", QRegExp("<binary>"));
+		COMPARE_FILES("out/MappingQC_test01_threads_out.qcML", TESTDATA("data_out/MappingQC_test01_out.qcML"));
+	}
 };
@@ -297,6 +297,42 @@ private slots:
 		S_EQUAL(db.getValue("SELECT call_date FROM re_callset").toDateTime().toString(Qt::ISODate), "2024-06-06T00:00:00");
 	}
 
+	void small_variants_batched_import()
+	{
+		if (!NGSD::isAvailable(true)) SKIP("Test needs access to the NGSD test database!");
+
+		//import one by one
+		NGSD db(true);
+		db.init();
+		db.executeQueriesFromFile(TESTDATA("data_in/NGSDAddVariantsGermline_init.sql"));
+		EXECUTE("NGSDAddVariantsGermline", "-test -no_time -batch_size 0 -ps NA12878_38 -var " + TESTDATA("data_in/NGSDAddVariantsGermline_in2.GSvar"));
+		QStringList variants = db.getValues("SELECT CONCAT_WS(' ', chr, start, end, ref, obs, gnomad, coding, cadd, spliceai) FROM variant ORDER BY id");
+		QStringList detected = db.getValues("SELECT CONCAT_WS(' ', v.chr, v.start, v.end, v.ref, v.obs, dv.genotype, dv.mosaic) FROM detected_variant dv, variant v WHERE dv.variant_id=v.id ORDER BY v.id");
+		QStringList pubmed = db.getValues("SELECT CONCAT_WS(' ', v.chr, v.start, v.end, v.ref, v.obs, vl.pubmed) FROM variant_literature vl, variant v WHERE vl.variant_id=v.id ORDER BY v.id, vl.pubmed");
+		IS_TRUE(variants.count()>0);
+		IS_TRUE(detected.count()>0);
+
+		//import with small batches (several batches and lookups)
+		db.init();
+		db.executeQueriesFromFile(TESTDATA("data_in/NGSDAddVariantsGermline_init.sql"));
+		EXECUTE("NGSDAddVariantsGermline", "-test -no_time -batch_size 7 -ps NA12878_38 -var " + TESTDATA("data_in/NGSDAddVariantsGermline_in2.GSvar"));
+		S_EQUAL(db.getValues("SELECT CONCAT_WS(' ', chr, start, end, ref, obs, gnomad, coding, cadd, spliceai) FROM variant ORDER BY id").join("\n"), variants.join("\n"));
+		S_EQUAL(db.getValues("SELECT CONCAT_WS(' ', v.chr, v.start, v.end, v.ref, v.obs, dv.genotype, dv.mosaic) FROM detected_variant dv, variant v WHERE dv.variant_id=v.id ORDER BY v.id").join("\n"), detected.join("\n"));
+		S_EQUAL(db.getValues("SELECT CONCAT_WS(' ', v.chr, v.start, v.end, v.ref, v.obs, vl.pubmed) FROM variant_literature vl, variant v WHERE vl.variant_id=v.id ORDER BY v.id, vl.pubmed").join("\n"), pubmed.join("\n"));
+
+		//re-import updates nothing
+		int c_add = -1;
+		int c_update = -1;
+		VariantList vl;
+		vl.load(TESTDATA("data_in/NGSDAddVariantsGermline_in2.GSvar"));
+		QList<int> ids = db.addVariantsBatched(vl, 0.05, c_add, c_update, 5);
+		I_EQUAL(c_add, 0);
+		I_EQUAL(c_update, 0);
+		IS_TRUE(ids==db.addVariants(vl, 0.05, c_add, c_update));
+		I_EQUAL(c_add, 0);
+		I_EQUAL(c_update, 0);
+	}
+
 };
 
 
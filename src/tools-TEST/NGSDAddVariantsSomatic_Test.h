@@ -33,7 +33,34 @@ private slots:
 		EXECUTE_FAIL("NGSDAddVariantsSomatic", "-test -no_time -t_ps DX184894_01 -n_ps DX184263_01 -var " + TESTDATA("data_in/NGSDAddVariantsSomatic_in1.GSvar"));
 	}
 
-	void test_addCNvs()
+	void test_addSmallVariants_batched()
+	{
+		if (!NGSD::isAvailable(true)) SKIP("Test needs access to the NGSD test database!");
+
+		//import one by one
+		NGSD db(true);
+		db.init();
+		db.executeQueriesFromFile(TESTDATA("data_in/NGSDAddVariantsSomatic_init.sql"));
+		EXECUTE("NGSDAddVariantsSomatic", "-test -no_time -batch_size 0 -t_ps DX184894_01 -n_ps DX184263_01 -var " + TESTDATA("data_in/NGSDAddVariantsSomatic_in1.GSvar"));
+		QStringList variants = db.getValues("SELECT CONCAT_WS(' ', chr, start, end, ref, obs, gnomad, coding) FROM variant ORDER BY id");
+		I_EQUAL(variants.count(), 3);
+		DBTable detected = db.createTable("test", "SELECT * FROM detected_somatic_variant ORDER BY id");
+		I_EQUAL(detected.rowCount(), 3);
+
+		//import with small batches (several batches, last one incomplete)
+		db.init();
+		db.executeQueriesFromFile(TESTDATA("data_in/NGSDAddVariantsSomatic_init.sql"));
+		EXECUTE("NGSDAddVariantsSomatic", "-test -no_time -batch_size 2 -t_ps DX184894_01 -n_ps DX184263_01 -var " + TESTDATA("data_in/NGSDAddVariantsSomatic_in1.GSvar"));
+		S_EQUAL(db.getValues("SELECT CONCAT_WS(' ', chr, start, end, ref, obs, gnomad, coding) FROM variant ORDER BY id").join("\n"), variants.join("\n"));
+		DBTable detected_batched = db.createTable("test", "SELECT * FROM detected_somatic_variant ORDER BY id");
+		I_EQUAL(detected_batched.rowCount(), detected.rowCount());
+		for (int r=0; r<detected.rowCount(); ++r)
+		{
+			S_EQUAL(detected_batched.row(r).asString(';'), detected.row(r).asString(';'));
+		}
+
+	}
+
 	{
 		if (!NGSD::isAvailable(true)) SKIP("Test needs access to the NGSD test database!");
 
@@ -11,6 +11,12 @@ private slots:
 		COMPARE_FILES("out/SampleSimilarity_out1.tsv", TESTDATA("data_out/SampleSimilarity_out1.tsv"));
 	}
 
+	void test_gsvar_multisample_threads()
+	{
+		EXECUTE("SampleSimilarity", "-in " + TESTDATA("data_in/SampleSimilarity_in1.GSvar") + " " + TESTDATA("data_in/SampleSimilarity_in2.GSvar") + " " + TESTDATA("data_in/SampleSimilarity_in3.GSvar") + " -build hg19 -out out/SampleSimilarity_out8.tsv -include_gonosomes -mode gsvar -threads 3");
+		COMPARE_FILES("out/SampleSimilarity_out8.tsv", TESTDATA("data_out/SampleSimilarity_out1.tsv"));
+	}
+
 	void test_bam()
 	{
 		EXECUTE("SampleSimilarity", "-in " + TESTDATA("data_in/SampleSimilarity_in4.bam") + " " + TESTDATA("data_in/SampleSimilarity_in5.bam") + " -build hg19 -out out/SampleSimilarity_out2.tsv -mode bam -max_snps 200");
@@ -38,6 +38,19 @@ private slots:
 		}
 	}
 
+	//merge-join mode for sorted input
+	void test_sorted()
+	{
+		EXECUTE("VcfAnnotateFromVcf", "-in " + TESTDATA("data_in/VcfAnnotateFromVcf_in1.vcf") + " -out out/VcfAnnotateFromVcf_out1_sorted.vcf -config_file " + TESTDATA("data_in/VcfAnnotateFromVcf_config.tsv") + " -sorted");
+		COMPARE_FILES("out/VcfAnnotateFromVcf_out1_sorted.vcf", TESTDATA("data_out/VcfAnnotateFromVcf_out1.vcf"));
+
+		EXECUTE("VcfAnnotateFromVcf", "-in " + TESTDATA("data_in/VcfAnnotateFromVcf_in1.vcf") + " -out out/VcfAnnotateFromVcf_out2_sorted.vcf -source " + TESTDATA("data_in/VcfAnnotateFromVcf_an2_NGSD.vcf.gz") + " -info_keys COUNTS,GSC01=GROUP,HAF,CLAS,CLAS_COM,COM -id_column ID -prefix NGSD -sorted -block_size 5 -threads 4");
+		COMPARE_FILES("out/VcfAnnotateFromVcf_out2_sorted.vcf", TESTDATA("data_out/VcfAnnotateFromVcf_out2.vcf"));
+
+		EXECUTE("VcfAnnotateFromVcf", "-in " + TESTDATA("data_in/VcfAnnotateFromVcf_in1.vcf") + " -source " + TESTDATA("data_in/VcfAnnotateFromVcf_an3_ExOnly.vcf.gz") + " -out out/VcfAnnotateFromVcf_out6_sorted.vcf -existence_only -sorted -block_size 1");
+		COMPARE_FILES("out/VcfAnnotateFromVcf_out6_sorted.vcf", TESTDATA("data_out/VcfAnnotateFromVcf_out6.vcf"));
+	}
+
 	void test_with_unordered_info_ids()
 	{
 		EXECUTE("VcfAnnotateFromVcf", "-in " + TESTDATA("data_in/VcfAnnotateFromVcf_in1.vcf") + " -out out/VcfAnnotateFromVcf_out3.vcf -source " + TESTDATA("data_in/VcfAnnotateFromVcf_an2_NGSD.vcf.gz") + " -info_keys GSC01=GROUP,CLAS,COM,CLAS_COM,COUNTS,HAF -id_column ID -prefix NGSD" );
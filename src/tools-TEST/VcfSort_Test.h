@@ -40,6 +40,13 @@ private slots:
 		COMPARE_FILES("out/VcfSort_out5.vcf", TESTDATA("data_out/VcfSort_out5.vcf"));
 		VCF_IS_VALID_HG19("out/VcfSort_out5.vcf")
 	}
+
+	void external_sort()
+	{
+		EXECUTE("VcfSort", "-in " + TESTDATA("data_in/VcfSort_in3.vcf") + " -remove_unused_contigs -out out/VcfSort_out6.vcf -buffer 1 -threads 2 -compress_tmp");
+		COMPARE_FILES("out/VcfSort_out6.vcf", TESTDATA("data_out/VcfSort_out5.vcf"));
+		VCF_IS_VALID_HG19("out/VcfSort_out6.vcf")
+	}
 };
 
 
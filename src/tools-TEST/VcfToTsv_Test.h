@@ -16,5 +16,11 @@ private slots:
         EXECUTE("VcfToTsv", "-in " + TESTDATA("data_in/VcfBreakMulti_in2.vcf") + " -out out/VcfToTsv_out2.tsv");
         COMPARE_FILES("out/VcfToTsv_out2.tsv", TESTDATA("data_out/VcfToTsv_out2.tsv"));
     }
+
+	void multi_threaded()
+	{
+		EXECUTE("VcfToTsv", "-in " + TESTDATA("data_in/VcfToTsv_in1.vcf") + " -out out/VcfToTsv_out3.tsv -threads 3");
+		COMPARE_FILES("out/VcfToTsv_out3.tsv", TESTDATA("data_out/VcfToTsv_out1.tsv"));
+	}
 };
 
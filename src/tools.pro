@@ -602,3 +602,7 @@ BamRemoveVariants.depends = cppNGS
 SUBDIRS += CnvReferenceCohort
 tools-TEST.depends += CnvReferenceCohort
 CnvReferenceCohort.depends = cppNGS
+
+SUBDIRS += GffToTranscriptDb
+tools-TEST.depends += GffToTranscriptDb
+GffToTranscriptDb.depends = cppNGS